@@ -97,6 +97,15 @@ fi
 if [[ -n "${RP2350_DEBUG_INDEX_BAR:-}" ]]; then
   cmake_args+=("-DRP2350_DEBUG_INDEX_BAR=${RP2350_DEBUG_INDEX_BAR}")
 fi
+if [[ -n "${RP2350_TRACE_HUD:-}" ]]; then
+  cmake_args+=("-DRP2350_TRACE_HUD=${RP2350_TRACE_HUD}")
+fi
+if [[ -n "${RP2350_BLIT_BENCH:-}" ]]; then
+  cmake_args+=("-DRP2350_BLIT_BENCH=${RP2350_BLIT_BENCH}")
+fi
+if [[ -n "${RP2350_PSRAM_CALIBRATE:-}" ]]; then
+  cmake_args+=("-DRP2350_PSRAM_CALIBRATE=${RP2350_PSRAM_CALIBRATE}")
+fi
 if [[ -n "${RP2350_BOOT_TEST_PATTERN:-}" ]]; then
   cmake_args+=("-DRP2350_BOOT_TEST_PATTERN=${RP2350_BOOT_TEST_PATTERN}")
 fi
@@ -73,7 +73,21 @@ int get_video_mode() {
 // Forward declaration - actual implementation is after variable definitions
 static void vsync_swap_buffers(void);
 
+// Start of every frame's scanout (latency measurement)
+static volatile uint32_t vsync_count = 0;
+static volatile uint32_t vsync_time_us = 0;
+
+uint32_t graphics_get_vsync_count(void) {
+    return vsync_count;
+}
+
+uint32_t graphics_get_vsync_time_us(void) {
+    return vsync_time_us;
+}
+
 void vsync_handler() {
+    vsync_time_us = time_us_32();
+    vsync_count++;
     vsync_swap_buffers();
 }
 
@@ -889,6 +903,10 @@ void graphics_set_palette(uint8_t i, uint32_t color888) {
     graphics_set_palette_hdmi(i, color888);
 }
 
+uint32_t graphics_get_palette(uint8_t i) {
+    return palette_original[i];
+}
+
 void graphics_set_bgcolor(uint32_t color888) {
     graphics_set_bgcolor_hdmi(color888);
 }
@@ -60,6 +60,7 @@ uint32_t graphics_get_height(void);
 void graphics_set_res(int w, int h);
 void graphics_set_shift(int x, int y);
 void graphics_set_palette(uint8_t i, uint32_t color888);
+uint32_t graphics_get_palette(uint8_t i); // unfaded RGB888
 void graphics_restore_sync_colors(void);
 void startVIDEO(uint8_t vol);
 void set_palette(uint8_t n); // переключение палитр
@@ -84,6 +85,11 @@ uint32_t graphics_get_hdmi_underrun_count(void);
 // Get double-buffer swap counter (for diagnostics)
 uint32_t graphics_get_buffer_swap_count(void);
 
+// Frames started and time_us_32() at the start of the latest one; the
+// count is bumped after the time is stored
+uint32_t graphics_get_vsync_count(void);
+uint32_t graphics_get_vsync_time_us(void);
+
 struct video_mode_t graphics_get_video_mode(int mode);
 void graphics_set_bgcolor(uint32_t color888);
 
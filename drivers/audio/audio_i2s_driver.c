@@ -4,7 +4,7 @@
  * 
  * PIO/SM Allocation:
  *   - HDMI: pio1 SM0, SM1 (video output)
- *   - PS/2 Keyboard: pio0 SM0 (input)
+ *   - PS/2 Keyboard: pio0 SM0 (input), SM1 (host commands)
  *   - I2S Audio: pio0 SM2, DMA channel 6
  * 
  * Architecture:
@@ -50,11 +50,6 @@
 #define AUDIO_I2S_DMA_IRQ 0
 #endif
 
-// Disable Core 1 audio processing - just use IRQ separation
-#ifndef AUDIO_USE_CORE1
-#define AUDIO_USE_CORE1 0
-#endif
-
 // ============================================================================
 // State
 // ============================================================================
@@ -65,6 +60,7 @@ static struct {
     volatile bool core1_running;
     volatile bool core1_init_done;
     volatile bool core1_init_result;
+    volatile uint32_t heartbeat;
     uint32_t sample_rate;
     uint8_t channels;
     audio_callback_fn callback;
@@ -161,6 +157,7 @@ static void __attribute__((noreturn)) audio_core1_entry(void) {
             buffer->sample_count = buffer->max_sample_count;
             give_audio_buffer(audio_state.producer_pool, buffer);
         }
+        audio_state.heartbeat++;
         
         // Small sleep to avoid busy-waiting
         sleep_us(100);
@@ -288,6 +285,17 @@ void audio_i2s_driver_set_enabled(bool enable) {
     } else if (!enable && audio_state.enabled) {
         DBG_PRINTF("audio_i2s_driver: pausing audio\n");
         audio_state.enabled = false;
+#if AUDIO_USE_CORE1
+        // A callback already running on Core 1 finishes its pass first:
+        // after two heartbeats it is done. Bounded, in case Core 1 stalled.
+        if (audio_state.core1_running && get_core_num() != 1) {
+            const uint32_t start = audio_state.heartbeat;
+            const absolute_time_t deadline = make_timeout_time_ms(50);
+            while (audio_state.heartbeat - start < 2 && !time_reached(deadline)) {
+                tight_loop_contents();
+            }
+        }
+#endif
     }
 }
 
@@ -328,6 +336,14 @@ void audio_i2s_driver_unlock(void) {
 }
 
 // Pump audio - call from main loop to fill audio buffers
+uint32_t audio_i2s_driver_heartbeat(void) {
+    return audio_state.heartbeat;
+}
+
+bool audio_i2s_driver_runs_on_core1(void) {
+    return AUDIO_USE_CORE1 != 0;
+}
+
 void audio_i2s_driver_pump(void) {
 #if AUDIO_USE_CORE1
     // Core 1 handles all buffer processing - nothing to do here
@@ -4,7 +4,7 @@
  * 
  * PIO/SM allocation:
  *   - HDMI: pio1 SM0, SM1
- *   - PS/2 Keyboard: pio0 SM0
+ *   - PS/2 Keyboard: pio0 SM0 (input), SM1 (host commands)
  *   - I2S Audio: pio0 SM2 (avoiding PS/2 on SM0)
  * 
  * SPDX-License-Identifier: GPL-3.0-or-later
@@ -27,6 +27,12 @@ extern "C" {
 #define AUDIO_BUFFER_SAMPLES 1024
 #define AUDIO_BUFFER_COUNT 4
 
+// Disable Core 1 audio processing - just use IRQ separation. Code that
+// writes flash relies on core 1 being idle (see clock_select.c).
+#ifndef AUDIO_USE_CORE1
+#define AUDIO_USE_CORE1 0
+#endif
+
 // Audio callback function type (matches SDL_AudioCallback)
 typedef void (*audio_callback_fn)(void *userdata, uint8_t *stream, int len);
 
@@ -45,6 +51,8 @@ bool audio_i2s_driver_init(uint32_t sample_rate, uint8_t channels,
 /**
  * Enable or disable audio playback.
  * When enabled, the callback will be called to fill audio buffers.
+ * Pausing returns once a callback running on Core 1 has finished, so the
+ * caller may then change what the callback reads.
  * @param enable true to enable, false to pause
  */
 void audio_i2s_driver_set_enabled(bool enable);
@@ -83,6 +91,18 @@ void audio_i2s_driver_unlock(void);
  */
 void audio_i2s_driver_pump(void);
 
+/**
+ * Counter bumped once per pass of the Core 1 buffer loop.
+ * A value that stops changing while audio is open means Core 1 stalled.
+ */
+uint32_t audio_i2s_driver_heartbeat(void);
+
+/**
+ * True when buffers are filled on Core 1 (heartbeat is meaningful),
+ * false when they are filled by audio_i2s_driver_pump() on the caller.
+ */
+bool audio_i2s_driver_runs_on_core1(void);
+
 #ifdef __cplusplus
 }
 #endif
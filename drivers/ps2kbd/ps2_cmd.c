@@ -0,0 +1,137 @@
+#include "ps2_cmd.h"
+
+#include <string.h>
+
+#define QUEUE_MASK (PS2_CMD_QUEUE_SIZE - 1)
+
+void ps2_cmd_init(ps2_cmd_t *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+static uint8_t queued(const ps2_cmd_t *c) {
+    return (uint8_t)(c->head - c->tail);
+}
+
+bool ps2_cmd_busy(const ps2_cmd_t *c) {
+    return queued(c) != 0;
+}
+
+bool ps2_cmd_queue(ps2_cmd_t *c, uint8_t cmd, int arg) {
+    // Entries after the one in flight have not touched the wire yet.
+    const uint8_t first = (uint8_t)(c->tail + (c->state != PS2_CMD_IDLE ? 1 : 0));
+    for (uint8_t i = first; i != c->head; ++i) {
+        ps2_cmd_entry_t *e = &c->queue[i & QUEUE_MASK];
+        if (e->bytes[0] == cmd && (e->len == 2) == (arg >= 0)) {
+            if (arg >= 0) e->bytes[1] = (uint8_t)arg;
+            return true;
+        }
+    }
+    if (queued(c) >= PS2_CMD_QUEUE_SIZE) return false;
+    ps2_cmd_entry_t *e = &c->queue[c->head & QUEUE_MASK];
+    e->bytes[0] = cmd;
+    e->bytes[1] = arg >= 0 ? (uint8_t)arg : 0;
+    e->len = arg >= 0 ? 2 : 1;
+    c->head++;
+    return true;
+}
+
+void ps2_cmd_clear(ps2_cmd_t *c) {
+    const ps2_cmd_stats_t stats = c->stats;
+    ps2_cmd_init(c);
+    c->stats = stats;
+}
+
+static void finish(ps2_cmd_t *c, bool ok) {
+    if (ok) c->stats.completed++;
+    else c->stats.failed++;
+    c->tail++;
+    c->state = PS2_CMD_IDLE;
+    c->pos = 0;
+    c->tries = 0;
+}
+
+// Send the current byte again, or give up on the command.
+static void retry(ps2_cmd_t *c, bool from_start) {
+    c->state = PS2_CMD_IDLE;
+    if (++c->tries > PS2_CMD_RETRIES) {
+        finish(c, false);
+        return;
+    }
+    // After a timeout the keyboard may have dropped the command: start it
+    // over. FE asks for the last byte only.
+    if (from_start) c->pos = 0;
+}
+
+ps2_cmd_action_t ps2_cmd_poll(ps2_cmd_t *c, uint32_t now_ms, uint8_t *byte) {
+    if (c->state != PS2_CMD_IDLE) {
+        if ((int32_t)(now_ms - c->deadline) < 0) return PS2_CMD_ACT_NONE;
+        c->stats.timeouts++;
+        const bool on_line = c->state == PS2_CMD_SENDING;
+        retry(c, true);
+        if (on_line) return PS2_CMD_ACT_ABORT;
+    }
+    if (!ps2_cmd_busy(c)) return PS2_CMD_ACT_NONE;
+
+    const ps2_cmd_entry_t *e = &c->queue[c->tail & QUEUE_MASK];
+    *byte = e->bytes[c->pos];
+    c->state = PS2_CMD_SENDING;
+    c->deadline = now_ms + PS2_CMD_LINE_TIMEOUT_MS;
+    c->stats.bytes_sent++;
+    return PS2_CMD_ACT_SEND;
+}
+
+void ps2_cmd_line_done(ps2_cmd_t *c, uint32_t now_ms, bool acked) {
+    if (c->state != PS2_CMD_SENDING) return;
+    if (!acked) {
+        c->stats.resends++;
+        retry(c, false);
+        return;
+    }
+    c->state = PS2_CMD_WAIT_ACK;
+    c->deadline = now_ms + PS2_CMD_REPLY_TIMEOUT_MS;
+}
+
+void ps2_cmd_on_reply(ps2_cmd_t *c, uint8_t code, uint32_t now_ms) {
+    // The FA may overtake the line-done report: both end the transfer.
+    if (c->state != PS2_CMD_SENDING && c->state != PS2_CMD_WAIT_ACK) return;
+    if (code == 0xFE) {
+        c->stats.resends++;
+        retry(c, false);
+        return;
+    }
+    if (code != 0xFA) return;
+
+    const ps2_cmd_entry_t *e = &c->queue[c->tail & QUEUE_MASK];
+    if (++c->pos < e->len) {
+        c->state = PS2_CMD_IDLE;
+        return;
+    }
+    if (e->bytes[0] == PS2_CMD_RESET) {
+        c->state = PS2_CMD_WAIT_BAT;
+        c->deadline = now_ms + PS2_CMD_RESET_TIMEOUT_MS;
+        return;
+    }
+    finish(c, true);
+}
+
+bool ps2_cmd_on_reset(ps2_cmd_t *c) {
+    if (c->state == PS2_CMD_WAIT_BAT) {
+        finish(c, true);
+        return true;
+    }
+    // Unasked: whatever was half sent is lost; send it again from the top.
+    // A byte still on the line finishes through ps2_cmd_line_done().
+    if (c->state != PS2_CMD_SENDING) {
+        c->state = PS2_CMD_IDLE;
+        c->pos = 0;
+    }
+    return false;
+}
+
+uint32_t ps2_cmd_tx_frame(uint8_t byte) {
+    uint32_t ones = 0;
+    for (uint8_t v = byte; v; v &= (uint8_t)(v - 1)) ++ones;
+    const uint32_t parity = (ones & 1) ? 0 : 1;
+    const uint32_t bits = byte | (parity << 8) | (1u << 9);
+    return ~bits & 0x3FF;
+}
@@ -0,0 +1,108 @@
+#ifndef PS2_CMD_H
+#define PS2_CMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Host-to-keyboard PS/2 commands. Commands wait in a small queue and go
+// out one byte at a time: each byte is sent on the line, then answered by
+// the keyboard with FA (ACK) or FE (resend). Reset (FF) is complete only
+// when the keyboard also reports its self-test (AA). Lost replies and a
+// missing keyboard end in timeouts; a command is retried a few times and
+// then dropped.
+// Pure logic: the driver moves the bytes and feeds replies and the clock,
+// so the protocol can be run on a host against a simulated keyboard.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PS2_CMD_RESET      0xFF
+#define PS2_CMD_TYPEMATIC  0xF3 // argument: delay << 5 | rate
+#define PS2_CMD_SET_LEDS   0xED // argument: PS2_LED_* bits
+
+#define PS2_LED_SCROLL 0x01
+#define PS2_LED_NUM    0x02
+#define PS2_LED_CAPS   0x04
+
+#define PS2_CMD_QUEUE_SIZE 8  // power of two
+#define PS2_CMD_RETRIES 3     // resends and timeouts per command
+
+// The keyboard must start clocking a host byte within 15 ms and answer
+// within 20 ms; self-test after reset takes 500-750 ms.
+#define PS2_CMD_LINE_TIMEOUT_MS 20
+#define PS2_CMD_REPLY_TIMEOUT_MS 25
+#define PS2_CMD_RESET_TIMEOUT_MS 1000
+
+typedef enum {
+    PS2_CMD_IDLE = 0,
+    PS2_CMD_SENDING,     // byte on the line
+    PS2_CMD_WAIT_ACK,    // byte sent, waiting for FA/FE
+    PS2_CMD_WAIT_BAT,    // reset acknowledged, waiting for AA
+} ps2_cmd_state_t;
+
+typedef enum {
+    PS2_CMD_ACT_NONE = 0,
+    PS2_CMD_ACT_SEND,    // start sending *byte on the line
+    PS2_CMD_ACT_ABORT,   // the line transfer timed out: release the lines
+} ps2_cmd_action_t;
+
+typedef struct {
+    uint32_t bytes_sent;
+    uint32_t resends;    // FE replies and missing line ACKs
+    uint32_t timeouts;
+    uint32_t completed;
+    uint32_t failed;     // dropped after PS2_CMD_RETRIES
+} ps2_cmd_stats_t;
+
+typedef struct {
+    uint8_t bytes[2];
+    uint8_t len;
+} ps2_cmd_entry_t;
+
+typedef struct {
+    ps2_cmd_entry_t queue[PS2_CMD_QUEUE_SIZE];
+    uint8_t head;        // next free entry
+    uint8_t tail;        // command in flight or next to send
+    ps2_cmd_state_t state;
+    uint8_t pos;         // byte of the current command on the wire
+    uint8_t tries;
+    uint32_t deadline;
+    ps2_cmd_stats_t stats;
+} ps2_cmd_t;
+
+void ps2_cmd_init(ps2_cmd_t *c);
+
+// Queue a command; arg < 0 for none. A command still waiting to be sent
+// is updated in place instead of queued twice, so status LEDs can be set
+// every frame. False if the queue is full.
+bool ps2_cmd_queue(ps2_cmd_t *c, uint8_t cmd, int arg);
+
+// Drop queued commands (after a hot-plug the keyboard starts over).
+void ps2_cmd_clear(ps2_cmd_t *c);
+
+bool ps2_cmd_busy(const ps2_cmd_t *c);
+
+// Advance timeouts and start the next byte; call often.
+ps2_cmd_action_t ps2_cmd_poll(ps2_cmd_t *c, uint32_t now_ms, uint8_t *byte);
+
+// The line transfer of the byte finished; acked is the keyboard's line
+// ACK bit (its FA/FE reply follows as a normal scancode byte).
+void ps2_cmd_line_done(ps2_cmd_t *c, uint32_t now_ms, bool acked);
+
+// Reply byte from the keyboard (FA or FE).
+void ps2_cmd_on_reply(ps2_cmd_t *c, uint8_t code, uint32_t now_ms);
+
+// Self-test passed (AA). Returns true if it completed a queued reset,
+// false if the keyboard was plugged in or reset itself.
+bool ps2_cmd_on_reset(ps2_cmd_t *c);
+
+// Frame of a host-to-keyboard byte for the TX PIO program: data LSB
+// first, odd parity, stop; inverted, as a 1 pulls the line low.
+uint32_t ps2_cmd_tx_frame(uint8_t byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
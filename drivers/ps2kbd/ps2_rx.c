@@ -0,0 +1,127 @@
+#include "ps2_rx.h"
+
+#include <string.h>
+
+ps2_frame_status_t ps2_rx_decode_frame(uint32_t word, uint8_t *byte) {
+    const uint32_t bits = word >> 22;
+    const uint8_t data = (uint8_t)bits;
+    *byte = data;
+    if (!(bits & 0x200)) return PS2_FRAME_STOP;
+    // Odd parity over the data bits and the parity bit.
+    uint32_t ones = (bits >> 8) & 1;
+    for (uint8_t v = data; v; v &= (uint8_t)(v - 1)) ++ones;
+    return (ones & 1) ? PS2_FRAME_OK : PS2_FRAME_PARITY;
+}
+
+void ps2_rx_init(ps2_rx_ring_t *r) {
+    memset((void *)r, 0, sizeof(*r));
+}
+
+static void ps2_rx_put(ps2_rx_ring_t *r, uint16_t entry) {
+    const uint32_t head = r->head;
+    if (head - r->tail >= PS2_RX_RING_SIZE) {
+        r->stats.ring_overflows++;
+        r->overflowed = true;
+        return;
+    }
+    r->buf[head & (PS2_RX_RING_SIZE - 1)] = entry;
+    r->head = head + 1;
+}
+
+void ps2_rx_push_frame(ps2_rx_ring_t *r, uint32_t word) {
+    uint8_t byte;
+    switch (ps2_rx_decode_frame(word, &byte)) {
+        case PS2_FRAME_OK:
+            r->stats.frames++;
+            // 00 (set 2) and FF (set 1) are the keyboard's own overrun codes.
+            if (byte == 0x00 || byte == 0xFF) r->stats.kbd_overruns++;
+            ps2_rx_put(r, byte);
+            break;
+        case PS2_FRAME_PARITY:
+            r->stats.parity_errors++;
+            ps2_rx_put(r, PS2_RX_LINE_ERROR);
+            break;
+        case PS2_FRAME_STOP:
+            r->stats.framing_errors++;
+            ps2_rx_put(r, PS2_RX_LINE_ERROR);
+            break;
+    }
+}
+
+bool ps2_rx_pop(ps2_rx_ring_t *r, uint16_t *entry) {
+    const uint32_t tail = r->tail;
+    if (tail == r->head) return false;
+    *entry = r->buf[tail & (PS2_RX_RING_SIZE - 1)];
+    r->tail = tail + 1;
+    return true;
+}
+
+bool ps2_rx_take_overflow(ps2_rx_ring_t *r) {
+    if (!r->overflowed) return false;
+    r->overflowed = false;
+    return true;
+}
+
+void ps2_decoder_init(ps2_decoder_t *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+bool ps2_decoder_feed(ps2_decoder_t *d, uint16_t entry, ps2_event_t *ev) {
+    memset(ev, 0, sizeof(*ev));
+    // A dropped byte may have been a prefix: start over.
+    if (entry == PS2_RX_LINE_ERROR) {
+        ps2_decoder_init(d);
+        ev->type = PS2_EV_ERROR;
+        return true;
+    }
+    const uint8_t byte = (uint8_t)entry;
+    switch (byte) {
+        case 0xAA:
+            ps2_decoder_init(d);
+            ev->type = PS2_EV_RESET;
+            return true;
+        case 0x00:
+        case 0xFF:
+        case 0xFC: // self-test failed
+            ps2_decoder_init(d);
+            ev->type = PS2_EV_ERROR;
+            return true;
+        case 0xFA:
+        case 0xFE:
+        case 0xEE:
+            ev->type = PS2_EV_REPLY;
+            ev->code = byte;
+            return true;
+        case 0xE0:
+        case 0xE1:
+            d->prefix = byte;
+            return false;
+        case 0xF0:
+            d->release = true;
+            return false;
+        default:
+            break;
+    }
+
+    if (d->prefix == 0xE1) {
+        // Pause: E1 14 77 (make), E1 F0 14 F0 77 (break).
+        if (d->e1_codes++ == 0) {
+            d->e1_first = byte;
+            return false;
+        }
+        ev->type = PS2_EV_KEY;
+        ev->prefix = 0xE1;
+        ev->code = byte;
+        ev->release = d->release;
+        const bool pause = d->e1_first == 0x14 && byte == 0x77;
+        ps2_decoder_init(d);
+        return pause;
+    }
+
+    ev->type = PS2_EV_KEY;
+    ev->prefix = d->prefix;
+    ev->code = byte;
+    ev->release = d->release;
+    ps2_decoder_init(d);
+    return true;
+}
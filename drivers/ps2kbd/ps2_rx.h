@@ -0,0 +1,95 @@
+#ifndef PS2_RX_H
+#define PS2_RX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// PS/2 keyboard receive path. The PIO RX FIFO is drained from its "not
+// empty" interrupt into a ring, so scancodes survive frames in which
+// tick() is not called for a long time (level loads, MIDI renders).
+// Frames are checked for odd parity and the stop bit on the way in.
+// The consumer side decodes the E0/E1/F0 prefixes into key events.
+// Pure logic: builds on a host and can be fed recorded frames.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Power of two. A key press and release is 3-8 bytes, so this holds
+// several seconds of fast typing.
+#define PS2_RX_RING_SIZE 512
+
+// Ring entry after a frame that failed its checks (the byte is dropped).
+#define PS2_RX_LINE_ERROR 0x100
+
+typedef enum {
+    PS2_FRAME_OK = 0,
+    PS2_FRAME_PARITY,   // odd parity did not hold
+    PS2_FRAME_STOP,     // stop bit was 0
+} ps2_frame_status_t;
+
+typedef struct {
+    uint32_t frames;          // bytes accepted
+    uint32_t parity_errors;
+    uint32_t framing_errors;
+    uint32_t ring_overflows;  // entries dropped because the ring was full
+    uint32_t kbd_overruns;    // keyboard reported its own buffer overrun
+} ps2_rx_stats_t;
+
+typedef struct {
+    volatile uint16_t buf[PS2_RX_RING_SIZE];
+    volatile uint32_t head;   // written by the interrupt only
+    volatile uint32_t tail;   // written by the consumer only
+    volatile bool overflowed; // set by the interrupt, cleared by the consumer
+    volatile ps2_rx_stats_t stats;
+} ps2_rx_ring_t;
+
+// A frame as the PIO program captures it: 10 bits shifted right into the
+// top of the word (data LSB first at bit 22, parity at 30, stop at 31).
+ps2_frame_status_t ps2_rx_decode_frame(uint32_t word, uint8_t *byte);
+
+void ps2_rx_init(ps2_rx_ring_t *r);
+
+// Interrupt side: check one captured frame and queue its byte, or a
+// PS2_RX_LINE_ERROR marker if it is damaged.
+void ps2_rx_push_frame(ps2_rx_ring_t *r, uint32_t word);
+
+// Consumer side: next entry (a byte or PS2_RX_LINE_ERROR); false if empty.
+bool ps2_rx_pop(ps2_rx_ring_t *r, uint16_t *entry);
+
+// True once after entries were dropped on a full ring.
+bool ps2_rx_take_overflow(ps2_rx_ring_t *r);
+
+// Scancode set 2 decoding.
+typedef enum {
+    PS2_EV_NONE = 0,
+    PS2_EV_KEY,        // prefix/code/release are valid
+    PS2_EV_RESET,      // keyboard (re)connected: self-test passed (AA)
+    PS2_EV_ERROR,      // line error or keyboard error: key state is unknown
+    PS2_EV_REPLY,      // reply to a host command (code: FA, FE or EE)
+} ps2_event_type_t;
+
+typedef struct {
+    ps2_event_type_t type;
+    uint8_t prefix;    // 0, 0xE0 or 0xE1 (Pause)
+    uint8_t code;
+    bool release;
+} ps2_event_t;
+
+typedef struct {
+    uint8_t prefix;
+    bool release;
+    uint8_t e1_codes;  // codes of an E1 sequence seen so far
+    uint8_t e1_first;
+} ps2_decoder_t;
+
+void ps2_decoder_init(ps2_decoder_t *d);
+
+// Feed one ring entry; returns true when ev holds an event.
+bool ps2_decoder_feed(ps2_decoder_t *d, uint16_t entry, ps2_event_t *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,7 +15,11 @@
 #else
 #include "ps2kbd_mrmltr.pio.h"
 #endif
+#include "ps2kbd_tx.pio.h"
 #include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "pico/time.h"
+#include "latency_probe.h"
 
 #ifdef DEBUG_PS2
 #define DBG_PRINTF(...) printf(__VA_ARGS__)
@@ -25,6 +29,11 @@
 
 #define HID_KEYBOARD_REPORT_MAX_KEYS 6
 
+// Held keys are tracked by make and break codes, and repeated makes are
+// dropped: the slowest repeat (1 s delay, 2 per second) keeps the line
+// quietest, so host commands rarely have to wait for the keyboard.
+#define PS2_TYPEMATIC_QUIET 0x7F
+
 // PS/2 set 2 to HID key conversion
 static uint8_t ps2kbd_page_0[] {
   /* 00 (  0) */ HID_KEY_NONE,
@@ -165,12 +174,16 @@ static uint8_t ps2kbd_page_0[] {
 Ps2Kbd_Mrmltr::Ps2Kbd_Mrmltr(PIO pio, uint base_gpio, std::function<void(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev)> keyHandler) :
   _pio(pio),
   _base_gpio(base_gpio),
-  _double(false),
-  _overflow(false),
+  _tx_done(false),
+  _tx_acked(false),
+  _leds(0),
+  _typematic(PS2_TYPEMATIC_QUIET),
   _keyHandler(keyHandler)
 {
   clearHidKeys();
-  clearActions();
+  ps2_rx_init(&_rx);
+  ps2_decoder_init(&_decoder);
+  ps2_cmd_init(&_cmd);
 }
 
 void Ps2Kbd_Mrmltr::clearHidKeys() {
@@ -266,57 +279,50 @@ uint8_t Ps2Kbd_Mrmltr::hidCodePage1(uint8_t ps2code) {
   }
 }
 
-void Ps2Kbd_Mrmltr::handleActions() {
-  /*
-  FIL f;
-  f_open(&f, "1.log", FA_OPEN_APPEND | FA_WRITE);
-  char tmp[64];
-  for (uint i = 0; i <= _action; ++i) {
-    snprintf(tmp, 64, "PS/2 key %s (i: %d) page %2.2X (%3.3d) code %2.2X (%3.3d)\n",
-      _actions[i].release ? "release" : "press", i,
-      _actions[i].page,
-      _actions[i].page,
-      _actions[i].code,
-      _actions[i].code);
-    UINT bw;
-    f_write(&f, tmp, strlen(tmp), &bw); 
+void Ps2Kbd_Mrmltr::releaseAllKeys() {
+  hid_keyboard_report_t prev = _report;
+  clearHidKeys();
+  _keyHandler(&_report, &prev);
+}
+
+void Ps2Kbd_Mrmltr::handleEvent(const ps2_event_t &ev) {
+  switch (ev.type) {
+    case PS2_EV_KEY:
+      break;
+    case PS2_EV_RESET:
+      DBG_PRINTF("PS/2 keyboard Self test passed\n");
+      // After a reset or hot-plug the keyboard is back at its defaults.
+      ps2_cmd_on_reset(&_cmd);
+      applySettings();
+      releaseAllKeys();
+      return;
+    case PS2_EV_ERROR:
+      // A lost byte may have been a release: better up than stuck.
+      DBG_PRINTF("PS/2 keyboard line error\n");
+      releaseAllKeys();
+      return;
+    case PS2_EV_REPLY:
+      ps2_cmd_on_reply(&_cmd, ev.code, to_ms_since_boot(get_absolute_time()));
+      return;
+    default:
+      return;
   }
-  f_close(&f);
-  */
+
   uint8_t hidCode;
-  bool release;
-  if (_action == 0) {
-    switch (_actions[0].page) {
-      case 1: {
-        hidCode = hidCodePage1(_actions[0].code);
-        break;
-      }
-      default: {
-        hidCode = hidCodePage0(_actions[0].code);
-        break;
-      }
-    }
-    release = _actions[0].release;
-  }
-  else {
-    if (_action == 1 && _actions[0].code == 0x14 && _actions[1].code == 0x77) {
-       hidCode = HID_KEY_PAUSE;
-       release = _actions[0].release;
-    } else {
-    // TODO get the HID code for extended PS/2 codes
-      hidCode = HID_KEY_NONE;
-      release = false;
-    }
+  switch (ev.prefix) {
+    case 0xE0: hidCode = hidCodePage1(ev.code); break;
+    case 0xE1: hidCode = HID_KEY_PAUSE; break;
+    default:   hidCode = hidCodePage0(ev.code); break;
   }
   
   if (hidCode != HID_KEY_NONE) {
     
     DBG_PRINTF("HID key %s code %2.2X (%3.3d)\n",
-      release ? "release" : "press",
+      ev.release ? "release" : "press",
       hidCode,
       hidCode);
       
-    if (release) {
+    if (ev.release) {
       handleHidKeyRelease(hidCode);
     }
     else {
@@ -331,67 +337,119 @@ void Ps2Kbd_Mrmltr::handleActions() {
   #endif
 }
 
+// The keyboard whose PIO RX FIFO the interrupt drains.
+static Ps2Kbd_Mrmltr *s_irq_kbd = nullptr;
+
+void Ps2Kbd_Mrmltr::rxIrqHandler() {
+  Ps2Kbd_Mrmltr *k = s_irq_kbd;
+  if (!k) return;
+  if (!pio_sm_is_rx_fifo_empty(k->_pio, k->_sm)) latency_probe_input(KEY_SOURCE_PS2);
+  while (!pio_sm_is_rx_fifo_empty(k->_pio, k->_sm)) {
+    ps2_rx_push_frame(&k->_rx, k->_pio->rxf[k->_sm]);
+  }
+  // A sent byte: listen again at once, the reply follows within 20 ms.
+  if (!pio_sm_is_rx_fifo_empty(k->_pio, k->_tx_sm)) {
+    const uint32_t sample = k->_pio->rxf[k->_tx_sm];
+    k->_tx_acked = (sample >> 31) == 0; // DAT low on the ACK clock
+    k->_tx_done = true;
+    k->restartRx();
+  }
+}
+
+void Ps2Kbd_Mrmltr::restartRx() {
+  // Drop any half-received frame and wait for the next start bit.
+  pio_sm_restart(_pio, _sm);
+  pio_sm_exec(_pio, _sm, pio_encode_jmp(_rx_offset));
+  pio_sm_set_enabled(_pio, _sm, true);
+}
+
+void Ps2Kbd_Mrmltr::startTx(uint8_t byte) {
+  DBG_PRINTF("PS/2 tx %2.2X\n", byte);
+  // The receiver would take the keyboard clocking our bits for a frame.
+  pio_sm_set_enabled(_pio, _sm, false);
+  pio_sm_put(_pio, _tx_sm, ps2_cmd_tx_frame(byte));
+}
+
+void Ps2Kbd_Mrmltr::abortTx() {
+  // Nothing clocked the byte in (no keyboard?): release both lines.
+  DBG_PRINTF("PS/2 tx timeout\n");
+  pio_sm_set_enabled(_pio, _tx_sm, false);
+  pio_sm_clear_fifos(_pio, _tx_sm);
+  pio_sm_restart(_pio, _tx_sm);
+  pio_sm_exec(_pio, _tx_sm, pio_encode_set(pio_pindirs, 0));
+  pio_sm_exec(_pio, _tx_sm, pio_encode_jmp(_tx_offset));
+  pio_sm_set_enabled(_pio, _tx_sm, true);
+  restartRx();
+}
+
+void Ps2Kbd_Mrmltr::applySettings() {
+  ps2_cmd_queue(&_cmd, PS2_CMD_TYPEMATIC, _typematic);
+  ps2_cmd_queue(&_cmd, PS2_CMD_SET_LEDS, _leds);
+}
+
+void Ps2Kbd_Mrmltr::setLeds(uint8_t leds) {
+  if (leds == _leds) return;
+  _leds = leds;
+  ps2_cmd_queue(&_cmd, PS2_CMD_SET_LEDS, _leds);
+}
+
+void Ps2Kbd_Mrmltr::setTypematic(uint8_t typematic) {
+  if (typematic == _typematic) return;
+  _typematic = typematic;
+  ps2_cmd_queue(&_cmd, PS2_CMD_TYPEMATIC, _typematic);
+}
+
+void Ps2Kbd_Mrmltr::reset() {
+  // Settings follow when the self-test result (AA) arrives.
+  ps2_cmd_queue(&_cmd, PS2_CMD_RESET, -1);
+}
+
 void Ps2Kbd_Mrmltr::tick() {
-  if (pio_sm_is_rx_fifo_full(_pio, _sm)) {
-    DBG_PRINTF("PS/2 keyboard PIO overflow\n");
-    _overflow = true;
-    while (!pio_sm_is_rx_fifo_empty(_pio, _sm)) {
-      // pull a scan code from the PIO SM fifo
-      uint32_t rc = _pio->rxf[_sm];    
-      DBG_PRINTF("PS/2 drain rc %4.4lX (%ld)\n", (unsigned long)rc, (long)rc);
-    }
-    // Release all currently pressed keys to prevent sticky keys
-    hid_keyboard_report_t prev = _report;
-    clearHidKeys();
-    clearActions();
-    // Notify the handler that all keys are now released
-    _keyHandler(&_report, &prev);
-    return;
+  const uint32_t now = to_ms_since_boot(get_absolute_time());
+  if (_tx_done) {
+    _tx_done = false;
+    ps2_cmd_line_done(&_cmd, now, _tx_acked);
   }
-  
-  while (!pio_sm_is_rx_fifo_empty(_pio, _sm)) {
-    // pull a scan code from the PIO SM fifo
-    uint32_t rc = _pio->rxf[_sm];    
-    DBG_PRINTF("PS/2 rc %4.4lX (%ld)\n", (unsigned long)rc, (long)rc);
-    
-    uint32_t code = (rc << 2) >> 24;
-    DBG_PRINTF("PS/2 keycode %2.2lX (%ld)\n", (unsigned long)code, (long)code);
 
-    // TODO Handle PS/2 overflow/error messages
-    switch (code) {
-      case 0xaa: {
-         DBG_PRINTF("PS/2 keyboard Self test passed\n");
-         break;       
-      }
-      case 0xe1: {
-        _double = true;
-        break;
-      }
-      case 0xe0: {
-        _actions[_action].page = 1;
-        break;
-      }
-      case 0xf0: {
-        _actions[_action].release = true;
-        break;
-      }
-      default: {
-        _actions[_action].code = code;
-        if (_double) {
-          _action = 1;
-          _double = false;
-        }
-        else {
-          handleActions();
-          clearActions();
-        }
-        break;
-      }
+  if (ps2_rx_take_overflow(&_rx)) {
+    // Only if tick() was starved for seconds: key state is unknown.
+    DBG_PRINTF("PS/2 keyboard ring overflow\n");
+    ps2_decoder_init(&_decoder);
+    releaseAllKeys();
+  }
+  
+  uint16_t entry;
+  ps2_event_t ev;
+  while (ps2_rx_pop(&_rx, &entry)) {
+    DBG_PRINTF("PS/2 rx %3.3X\n", (unsigned)entry);
+    if (ps2_decoder_feed(&_decoder, entry, &ev)) {
+      handleEvent(ev);
     }
   }
+
+  uint8_t byte;
+  switch (ps2_cmd_poll(&_cmd, now, &byte)) {
+    case PS2_CMD_ACT_SEND:
+      startTx(byte);
+      break;
+    case PS2_CMD_ACT_ABORT:
+      abortTx();
+      break;
+    default:
+      break;
+  }
+}
+
+ps2_rx_stats_t Ps2Kbd_Mrmltr::stats() const {
+  ps2_rx_stats_t s;
+  s.frames = _rx.stats.frames;
+  s.parity_errors = _rx.stats.parity_errors;
+  s.framing_errors = _rx.stats.framing_errors;
+  s.ring_overflows = _rx.stats.ring_overflows;
+  s.kbd_overruns = _rx.stats.kbd_overruns;
+  return s;
 }
 
-// TODO Error checking and reporting
 void Ps2Kbd_Mrmltr::init_gpio() {
     // init KBD pins to input
     gpio_init(_base_gpio);     // Data
@@ -428,5 +486,33 @@ void Ps2Kbd_Mrmltr::init_gpio() {
     sm_config_set_clkdiv(&c, div);
     // Ready to go
     pio_sm_init(_pio, _sm, offset, &c);
+    _rx_offset = offset;
+    // Host-to-keyboard on a second state machine. It pulls a line low by
+    // making it an output (the output level stays 0) and releases it to
+    // the pull-up by making it an input, as open-collector PS/2 wants.
+    _tx_sm = pio_claim_unused_sm(_pio, true);
+    _tx_offset = pio_add_program(_pio, &ps2kbd_tx_program);
+    pio_sm_config t = ps2kbd_tx_program_get_default_config(_tx_offset);
+    sm_config_set_set_pins(&t, _base_gpio, 2);
+    sm_config_set_out_pins(&t, _base_gpio + 1, 1);
+    sm_config_set_in_pins(&t, _base_gpio);
+    sm_config_set_out_shift(&t, true, false, 10);
+    sm_config_set_in_shift(&t, true, false, 2);
+    sm_config_set_clkdiv(&t, div);
+    pio_sm_set_pins_with_mask(_pio, _tx_sm, 0, 3u << _base_gpio);
+    pio_sm_set_pindirs_with_mask(_pio, _tx_sm, 0, 3u << _base_gpio);
+    pio_gpio_init(_pio, _base_gpio);
+    pio_gpio_init(_pio, _base_gpio + 1);
+    pio_sm_init(_pio, _tx_sm, _tx_offset, &t);
+    // Drain the FIFO from its "not empty" interrupt into the ring.
+    s_irq_kbd = this;
+    const uint irq = _pio == pio0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
+    irq_add_shared_handler(irq, rxIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    pio_set_irq0_source_enabled(_pio, (pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + _sm), true);
+    pio_set_irq0_source_enabled(_pio, (pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + _tx_sm), true);
+    irq_set_enabled(irq, true);
+    pio_sm_set_enabled(_pio, _tx_sm, true);
     pio_sm_set_enabled(_pio, _sm, true);
+    // A keyboard that powered up in a bad state starts over.
+    reset();
 }
@@ -10,48 +10,46 @@
 #define _PS2KBD_H
 
 #include "hid_codes.h"
+#include "ps2_rx.h"
+#include "ps2_cmd.h"
 #include "hardware/pio.h"
 #include "hardware/gpio.h"
 #include <functional>
 
 
-typedef struct {
-  uint8_t code;
-  bool release;
-  uint8_t page;
-} Ps2KbdAction_;
-
-
 class Ps2Kbd_Mrmltr {
 private:
   PIO _pio;                        // pio0 or pio1
   uint _sm;                        // pio state machine index
+  uint _tx_sm;                     // host-to-keyboard state machine
+  uint _rx_offset;
+  uint _tx_offset;
   uint _base_gpio;                 // data signal gpio
   hid_keyboard_report_t _report;   // HID report structure
-  Ps2KbdAction_ _actions[2];
-  uint _action;
-  bool _double;
-  bool _overflow;
+  ps2_rx_ring_t _rx;               // filled from the PIO RX interrupt
+  ps2_decoder_t _decoder;
+  ps2_cmd_t _cmd;                  // host commands (reset, typematic, LEDs)
+  volatile bool _tx_done;          // set by the interrupt after a sent byte
+  volatile bool _tx_acked;
+  uint8_t _leds;
+  uint8_t _typematic;
   
   std::function<void(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev)> _keyHandler;
 
-  inline void clearActions() {
-    _actions[0].page = 0;
-    _actions[0].release = false;
-    _actions[0].code = 0;
-    _actions[1].page = 0;
-    _actions[1].release = false;
-    _actions[1].code = 0;
-    _action = 0;
-  }
+  static void __not_in_flash_func(rxIrqHandler)();
+  void __not_in_flash_func(restartRx)();
+  void startTx(uint8_t byte);
+  void abortTx();
+  void applySettings();
   
   void __not_in_flash_func(handleHidKeyPress)(uint8_t hidKeyCode);
   void __not_in_flash_func(handleHidKeyRelease)(uint8_t hidKeyCode);
   
-  void __not_in_flash_func(handleActions)();
+  void __not_in_flash_func(handleEvent)(const ps2_event_t &ev);
   uint8_t __not_in_flash_func(hidCodePage0)(uint8_t ps2code);
   uint8_t __not_in_flash_func(hidCodePage1)(uint8_t ps2code);
   void clearHidKeys();
+  void releaseAllKeys();
   
 public:
 
@@ -63,6 +61,16 @@ public:
   void init_gpio();
   
   void __not_in_flash_func(tick)();
+
+  // Receive counters (parity/framing errors, ring overflows).
+  ps2_rx_stats_t stats() const;
+  ps2_cmd_stats_t cmdStats() const { return _cmd.stats; }
+
+  // Host commands, sent from tick(). LEDs and typematic are also restored
+  // whenever the keyboard reports a self-test (reset or hot-plug).
+  void setLeds(uint8_t leds);             // PS2_LED_* bits
+  void setTypematic(uint8_t typematic);   // delay << 5 | rate
+  void reset();
 };
 
 #endif
\ No newline at end of file
@@ -223,3 +223,31 @@ extern "C" int ps2kbd_is_key_pressed(int scancode) {
 extern "C" int ps2kbd_events_pending(void) {
     return (int)event_queue.size();
 }
+
+extern "C" void ps2kbd_get_stats(ps2_rx_stats_t* stats) {
+    if (kbd) {
+        *stats = kbd->stats();
+    } else {
+        *stats = ps2_rx_stats_t{};
+    }
+}
+
+extern "C" void ps2kbd_set_leds(uint8_t leds) {
+    if (kbd) kbd->setLeds(leds);
+}
+
+extern "C" void ps2kbd_set_typematic(uint8_t delay, uint8_t rate) {
+    if (kbd) kbd->setTypematic((uint8_t)(((delay & 0x03) << 5) | (rate & 0x1F)));
+}
+
+extern "C" void ps2kbd_reset(void) {
+    if (kbd) kbd->reset();
+}
+
+extern "C" void ps2kbd_get_cmd_stats(ps2_cmd_stats_t* stats) {
+    if (kbd) {
+        *stats = kbd->cmdStats();
+    } else {
+        *stats = ps2_cmd_stats_t{};
+    }
+}
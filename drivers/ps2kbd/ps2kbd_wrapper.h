@@ -1,6 +1,9 @@
 #ifndef PS2KBD_WRAPPER_H
 #define PS2KBD_WRAPPER_H
 
+#include "ps2_rx.h"
+#include "ps2_cmd.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +19,20 @@ int ps2kbd_is_key_pressed(int scancode);
 // Get count of pending events in the queue
 int ps2kbd_events_pending(void);
 
+// Receive counters (all zero before ps2kbd_init)
+void ps2kbd_get_stats(ps2_rx_stats_t* stats);
+
+// Host commands, queued and sent from ps2kbd_tick(). Unchanged values are
+// not sent again, so status LEDs may be set every frame.
+// leds: PS2_LED_SCROLL | PS2_LED_NUM | PS2_LED_CAPS
+void ps2kbd_set_leds(uint8_t leds);
+// delay: 0-3 = 250/500/750/1000 ms; rate: 0-31 = 30 down to 2 per second
+void ps2kbd_set_typematic(uint8_t delay, uint8_t rate);
+void ps2kbd_reset(void);
+
+// Command counters (resends, timeouts, failures)
+void ps2kbd_get_cmd_stats(ps2_cmd_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
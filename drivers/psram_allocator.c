@@ -16,7 +16,8 @@ static spin_lock_t *psram_lock = NULL;
 // PSRAM (CS1) is usually mapped at 0x11000000.
 
 #define PSRAM_BASE 0x11000000
-#define PSRAM_SIZE (8 * 1024 * 1024) // Assume 8MB
+#define PSRAM_SIZE (8 * 1024 * 1024) // Until psram_set_size() with the detected size
+static size_t psram_size = PSRAM_SIZE;
 
 static uint8_t *psram_start = (uint8_t *)PSRAM_BASE;
 // Reserve 512KB for scratch buffers at the beginning
@@ -30,7 +31,7 @@ static size_t psram_offset = SCRATCH_SIZE;
 // NOTE: In this project, audio is currently stubbed during bring-up.
 // Keep temp space small so most PSRAM is available for game assets.
 #define TEMP_SIZE (512 * 1024) // 512KB for temp (music)
-#define PERM_SIZE (PSRAM_SIZE - TEMP_SIZE)
+#define PERM_SIZE (psram_size - TEMP_SIZE)
 static size_t psram_temp_offset = 0;
 static int psram_temp_mode = 0;
 static int psram_sram_mode = 0; // Force SRAM allocation (proper malloc/free)
@@ -51,6 +52,16 @@ void psram_set_sram_mode(int enable) {
     psram_sram_mode = enable;
 }
 
+void psram_set_size(size_t size) {
+    // Scratch and temp areas must fit; nothing may be allocated yet.
+    if (size < SCRATCH_SIZE + TEMP_SIZE + 1024 * 1024) return;
+    psram_size = size;
+}
+
+size_t psram_get_size(void) {
+    return psram_size;
+}
+
 void psram_reset_temp(void) {
     if (!psram_lock) {
         int lock_num = spin_lock_claim_unused(true);
@@ -132,7 +143,7 @@ void *psram_realloc(void *ptr, size_t new_size) {
     if (ptr == NULL) return psram_malloc(new_size);
     if (new_size == 0) { psram_free(ptr); return NULL; }
 
-    if ((uintptr_t)ptr >= PSRAM_BASE && (uintptr_t)ptr < (PSRAM_BASE + PSRAM_SIZE)) {
+    if ((uintptr_t)ptr >= PSRAM_BASE && (uintptr_t)ptr < (PSRAM_BASE + psram_size)) {
         // It's in PSRAM
         size_t *header = (size_t *)ptr - 1;
         size_t old_size = *header;
@@ -176,7 +187,7 @@ void *psram_get_file_buffer(size_t size) {
 
 
 void psram_free(void *ptr) {
-    if (ptr >= (void*)PSRAM_BASE && ptr < (void*)(PSRAM_BASE + PSRAM_SIZE)) {
+    if (ptr >= (void*)PSRAM_BASE && ptr < (void*)(PSRAM_BASE + psram_size)) {
         // It's in PSRAM, do nothing (bump allocator)
         return;
     }
@@ -190,6 +201,23 @@ void psram_reset(void) {
     psram_session_mark = 0;
 }
 
+size_t psram_get_offset(void) {
+    return psram_offset;
+}
+
+void psram_set_offset(size_t offset) {
+    if (offset < SCRATCH_SIZE || offset > psram_offset) return;
+    if (!psram_lock) {
+        int lock_num = spin_lock_claim_unused(true);
+        psram_lock = spin_lock_instance(lock_num);
+    }
+    spin_lock_unsafe_blocking(psram_lock);
+    psram_offset = offset;
+    // A session mark above the new offset would point at reclaimed memory
+    if (psram_session_mark > psram_offset) psram_session_mark = 0;
+    spin_unlock_unsafe(psram_lock);
+}
+
 void psram_mark_session(void) {
     psram_session_mark = psram_offset;
     DBG_PRINTF("PSRAM: Session marked at offset %d (%.2f MB used)\n", 
@@ -9,6 +9,8 @@ void psram_free(void *ptr);
 void psram_reset(void);
 void psram_mark_session(void);    // Mark current offset for game session
 void psram_restore_session(void); // Restore to marked offset
+size_t psram_get_offset(void);    // Current permanent-area offset (watermark)
+void psram_set_offset(size_t offset); // Roll back to a watermark from psram_get_offset()
 void *psram_get_scratch_1(size_t size);
 void *psram_get_scratch_2(size_t size);
 void *psram_get_file_buffer(size_t size);
@@ -20,4 +22,7 @@ void psram_set_temp_offset(size_t offset);
 
 void psram_set_sram_mode(int enable); // Force SRAM allocation for proper malloc/free
 
+void psram_set_size(size_t size); // Detected chip size, before the first allocation
+size_t psram_get_size(void);      // Bytes managed (8 MB unless set)
+
 #endif
@@ -0,0 +1,105 @@
+#include "psram_cal.h"
+
+#include <string.h>
+
+void psram_cal_search(int min_divisor, int max_divisor, int min_width,
+                      psram_cal_probe_fn probe, void *ctx, psram_cal_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (min_divisor < 1) min_divisor = 1;
+    if (min_width < 1) min_width = 1;
+
+    for (int divisor = min_divisor; divisor <= max_divisor; ++divisor) {
+        int best_lo = -1, best_hi = -1;
+        int run_lo = -1;
+        for (int rxdelay = 0; rxdelay <= PSRAM_CAL_RXDELAY_MAX + 1; ++rxdelay) {
+            bool pass = false;
+            if (rxdelay <= PSRAM_CAL_RXDELAY_MAX) {
+                pass = probe(ctx, divisor, rxdelay);
+                out->probes++;
+            }
+            if (pass) {
+                if (run_lo < 0) run_lo = rxdelay;
+            } else if (run_lo >= 0) {
+                // Run [run_lo, rxdelay - 1] ended; keep the widest (first on ties).
+                if (best_lo < 0 || (rxdelay - 1 - run_lo) > (best_hi - best_lo)) {
+                    best_lo = run_lo;
+                    best_hi = rxdelay - 1;
+                }
+                run_lo = -1;
+            }
+        }
+
+        if (best_lo >= 0 && (best_hi - best_lo + 1) >= min_width) {
+            // Centre, rounding towards the later sample point.
+            int centre = (best_lo + best_hi + 1) / 2;
+            int left = centre - best_lo;
+            int right = best_hi - centre;
+            out->ok = true;
+            out->divisor = divisor;
+            out->rxdelay = centre;
+            out->window_lo = best_lo;
+            out->window_hi = best_hi;
+            out->margin = left < right ? left : right;
+            return;
+        }
+    }
+}
+
+size_t psram_cal_detect_size(const psram_cal_mem_t *mem, size_t window_bytes) {
+    mem->write(mem->ctx, 0, 0x51DE0000u);
+    if (mem->read(mem->ctx, 0) != 0x51DE0000u) return 0;
+    // A chip ignores the address bits above its size: a write one size up
+    // lands on word 0.
+    for (size_t size = 1024u * 1024u; size < window_bytes; size <<= 1) {
+        const uint32_t mark = 0x51DE0000u | (uint32_t)(size >> 20);
+        mem->write(mem->ctx, (uint32_t)(size / 4), mark);
+        if (mem->read(mem->ctx, 0) != 0x51DE0000u || mem->read(mem->ctx, (uint32_t)(size / 4)) != mark) {
+            return size;
+        }
+    }
+    return window_bytes;
+}
+
+static bool psram_cal_block(const psram_cal_mem_t *mem, uint32_t start, uint32_t words, uint32_t seed) {
+    for (uint32_t i = 0; i < words; ++i) {
+        mem->write(mem->ctx, start + i, (seed ^ (i * 0x9E3779B1u)) + i);
+    }
+    for (uint32_t i = 0; i < words; ++i) {
+        if (mem->read(mem->ctx, start + i) != ((seed ^ (i * 0x9E3779B1u)) + i)) return false;
+    }
+    return true;
+}
+
+bool psram_cal_pattern(const psram_cal_mem_t *mem, size_t chip_bytes, bool quick, uint32_t seed) {
+    const uint32_t words = (uint32_t)(chip_bytes / 4);
+
+    // Address lines: a distinct word at every power-of-two offset, checked
+    // after all are written (catches shorted/stuck lines).
+    mem->write(mem->ctx, 0, 0x5EED0000u);
+    for (uint32_t bit = 1, k = 1; bit < words; bit <<= 1, ++k) {
+        mem->write(mem->ctx, bit, 0x5EED0000u | k);
+    }
+    if (mem->read(mem->ctx, 0) != 0x5EED0000u) return false;
+    for (uint32_t bit = 1, k = 1; bit < words; bit <<= 1, ++k) {
+        if (mem->read(mem->ctx, bit) != (0x5EED0000u | k)) return false;
+    }
+
+    // Data lines: walking ones and zeros, alternating bits.
+    for (uint32_t b = 0; b < 32; ++b) {
+        mem->write(mem->ctx, b, 1u << b);
+        mem->write(mem->ctx, 32 + b, ~(1u << b));
+    }
+    mem->write(mem->ctx, 64, 0xAAAAAAAAu);
+    mem->write(mem->ctx, 65, 0x55555555u);
+    for (uint32_t b = 0; b < 32; ++b) {
+        if (mem->read(mem->ctx, b) != (1u << b) || mem->read(mem->ctx, 32 + b) != ~(1u << b)) return false;
+    }
+    if (mem->read(mem->ctx, 64) != 0xAAAAAAAAu || mem->read(mem->ctx, 65) != 0x55555555u) return false;
+
+    const uint32_t block = quick ? 64u : 4096u;
+    const uint32_t spots[3] = { 128u, words / 2, words - block };
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (!psram_cal_block(mem, spots[i], block, seed ^ i)) return false;
+    }
+    return true;
+}
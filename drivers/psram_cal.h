@@ -0,0 +1,54 @@
+#ifndef PSRAM_CAL_H
+#define PSRAM_CAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// PSRAM timing calibration search. Pure logic: the caller supplies a probe
+// that programs (divisor, rxdelay) and runs a pattern test, so the search
+// can be exercised on a host with a simulated pass/fail map. The pattern
+// test and the size detection reach the chip through word accessors, so
+// they run on a host against a simulated chip too.
+
+// QMI M1_TIMING.RXDELAY is a 3-bit field.
+#define PSRAM_CAL_RXDELAY_MAX 7
+
+typedef bool (*psram_cal_probe_fn)(void *ctx, int divisor, int rxdelay);
+
+typedef struct {
+    bool ok;         // a window of at least min_width settings was found
+    int divisor;     // chosen clock divisor
+    int rxdelay;     // chosen read delay (centre of the window)
+    int window_lo;   // passing rxdelay range at that divisor
+    int window_hi;
+    int margin;      // steps from rxdelay to the nearest edge of the window
+    int probes;      // probe calls made
+} psram_cal_result_t;
+
+// Sweep rxdelay 0..PSRAM_CAL_RXDELAY_MAX for each divisor from min_divisor
+// up to max_divisor (fastest first). The first divisor whose widest
+// contiguous passing run has at least min_width settings wins; rxdelay is
+// the centre of that run.
+void psram_cal_search(int min_divisor, int max_divisor, int min_width,
+                      psram_cal_probe_fn probe, void *ctx, psram_cal_result_t *out);
+
+// Word-addressed access to the chip window.
+typedef struct {
+    void (*write)(void *ctx, uint32_t word, uint32_t value);
+    uint32_t (*read)(void *ctx, uint32_t word);
+    void *ctx;
+} psram_cal_mem_t;
+
+// Chip size in bytes, found by where addresses wrap around (1 MB up to
+// window_bytes), or 0 when word 0 does not hold a value. Overwrites a few
+// words.
+size_t psram_cal_detect_size(const psram_cal_mem_t *mem, size_t window_bytes);
+
+// Destructive pattern test of the first chip_bytes (at least 1 MB) of the
+// window: address lines, data lines, and pseudo-random blocks at the start,
+// middle and end (16 KB each, 256 B in quick mode). Addresses past the chip
+// wrap around onto its start, so chip_bytes must be the detected size.
+bool psram_cal_pattern(const psram_cal_mem_t *mem, size_t chip_bytes, bool quick, uint32_t seed);
+
+#endif
@@ -1,6 +1,8 @@
 #include "psram_init.h"
+#include "psram_cal.h"
 #include "hardware/structs/qmi.h"
 #include "hardware/structs/xip_ctrl.h"
+#include "hardware/regs/addressmap.h"
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
 #include "pico/stdlib.h"
@@ -10,33 +12,24 @@
 #define PSRAM_MAX_FREQ_MHZ 133
 #endif
 
-void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
-    const int clock_hz = clock_get_hz(clk_sys); 
-
-    gpio_set_function(cs_pin, GPIO_FUNC_XIP_CS1);
-
-    qmi_hw->direct_csr = 10 << QMI_DIRECT_CSR_CLKDIV_LSB | 
-                        QMI_DIRECT_CSR_EN_BITS | 
-                        QMI_DIRECT_CSR_AUTO_CS1N_BITS;
-    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
-
-    const uint CMD_QPI_EN = 0x35; 
-    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | CMD_QPI_EN;
-    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
-
-
-    const int max_psram_freq = PSRAM_MAX_FREQ_MHZ * 1000000; 
-    
+// Helpers run while QMI is in direct mode (XIP stalled), so they live in RAM.
+static int __no_inline_not_in_flash_func(psram_default_divisor)(int clock_hz, int max_psram_freq) {
     int divisor = (clock_hz + max_psram_freq - 1) / max_psram_freq;
     if (divisor == 1 && clock_hz > 100000000) {
         divisor = 2;
     }
-    
+    return divisor;
+}
+
+static int __no_inline_not_in_flash_func(psram_default_rxdelay)(int clock_hz, int divisor) {
     int rxdelay = divisor;
     if (clock_hz / divisor > 100000000) {
         rxdelay += 1; 
     }
+    return rxdelay;
+}
 
+static void __no_inline_not_in_flash_func(psram_set_timing)(int clock_hz, int divisor, int rxdelay) {
     const int clock_period_fs = 1000000000000000ll / clock_hz;
     
     const int max_select_val = (125 * 1000000) / clock_period_fs;
@@ -50,6 +43,27 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
         min_deselect << QMI_M1_TIMING_MIN_DESELECT_LSB | 
         rxdelay << QMI_M1_TIMING_RXDELAY_LSB | 
         divisor << QMI_M1_TIMING_CLKDIV_LSB;
+}
+
+void __no_inline_not_in_flash_func(psram_init_freq)(uint cs_pin, int max_mhz) {
+    const int clock_hz = clock_get_hz(clk_sys); 
+
+    gpio_set_function(cs_pin, GPIO_FUNC_XIP_CS1);
+
+    qmi_hw->direct_csr = 10 << QMI_DIRECT_CSR_CLKDIV_LSB | 
+                        QMI_DIRECT_CSR_EN_BITS | 
+                        QMI_DIRECT_CSR_AUTO_CS1N_BITS;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    const uint CMD_QPI_EN = 0x35; 
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | CMD_QPI_EN;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+
+    const int max_psram_freq = max_mhz * 1000000; 
+    
+    int divisor = psram_default_divisor(clock_hz, max_psram_freq);
+    psram_set_timing(clock_hz, divisor, psram_default_rxdelay(clock_hz, divisor));
 
     qmi_hw->m[1].rfmt =
         QMI_M0_RFMT_PREFIX_WIDTH_VALUE_Q << QMI_M0_RFMT_PREFIX_WIDTH_LSB | 
@@ -76,3 +90,73 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
     
     hw_set_bits(&xip_ctrl_hw->ctrl, XIP_CTRL_WRITABLE_M1_BITS);
 }
+
+void psram_init(uint cs_pin) {
+    psram_init_freq(cs_pin, PSRAM_MAX_FREQ_MHZ);
+}
+
+// ----------------------------------------------------------------------------
+// Timing calibration
+// ----------------------------------------------------------------------------
+
+// Uncached, non-allocating alias of the CS1 window, so every access in the
+// pattern test really goes over the QMI bus.
+#define PSRAM_CAL_BASE (XIP_NOCACHE_NOALLOC_BASE + 0x01000000u)
+#define PSRAM_WINDOW_BYTES (16u * 1024u * 1024u)
+
+static void psram_mem_write(void *ctx, uint32_t word, uint32_t value) {
+    (void)ctx;
+    ((volatile uint32_t *)PSRAM_CAL_BASE)[word] = value;
+}
+
+static uint32_t psram_mem_read(void *ctx, uint32_t word) {
+    (void)ctx;
+    return ((volatile uint32_t *)PSRAM_CAL_BASE)[word];
+}
+
+static const psram_cal_mem_t psram_mem = { psram_mem_write, psram_mem_read, NULL };
+
+typedef struct {
+    int clock_hz;
+    size_t chip_bytes;
+    bool quick;
+} psram_cal_ctx_t;
+
+static bool psram_cal_probe(void *ctx_ptr, int divisor, int rxdelay) {
+    psram_cal_ctx_t *ctx = (psram_cal_ctx_t *)ctx_ptr;
+    psram_set_timing(ctx->clock_hz, divisor, rxdelay);
+    return psram_cal_pattern(&psram_mem, ctx->chip_bytes, ctx->quick, (uint32_t)(divisor << 8 | rxdelay));
+}
+
+void psram_calibrate(int max_mhz, size_t chip_bytes, bool quick, psram_cal_result_t *out) {
+    const int clock_hz = clock_get_hz(clk_sys);
+    const int fastest = psram_default_divisor(clock_hz, max_mhz * 1000000);
+    psram_cal_ctx_t ctx = { clock_hz, chip_bytes, quick };
+
+    psram_cal_search(fastest, fastest + PSRAM_CAL_EXTRA_DIVISORS, PSRAM_CAL_MIN_WINDOW,
+                     psram_cal_probe, &ctx, out);
+
+    if (out->ok) {
+        psram_set_timing(clock_hz, out->divisor, out->rxdelay);
+    } else {
+        // Nothing passed: keep the computed defaults rather than a random guess.
+        psram_set_timing(clock_hz, fastest, psram_default_rxdelay(clock_hz, fastest));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Size detection
+// ----------------------------------------------------------------------------
+
+size_t psram_detect_size(void) {
+    // At the slowest divisor calibration would try: the default timing may
+    // be one calibration rejects, and a misread looks like a wrap.
+    const uint32_t timing = qmi_hw->m[1].timing;
+    const int clock_hz = clock_get_hz(clk_sys);
+    const int divisor = (int)((timing & QMI_M1_TIMING_CLKDIV_BITS) >> QMI_M1_TIMING_CLKDIV_LSB) +
+                        PSRAM_CAL_EXTRA_DIVISORS;
+    psram_set_timing(clock_hz, divisor, psram_default_rxdelay(clock_hz, divisor));
+    const size_t size = psram_cal_detect_size(&psram_mem, PSRAM_WINDOW_BYTES);
+    qmi_hw->m[1].timing = timing;
+    return size;
+}
@@ -1,8 +1,32 @@
 #ifndef PSRAM_INIT_H
 #define PSRAM_INIT_H
 
+#include <stddef.h>
 #include "pico/stdlib.h"
+#include "psram_cal.h"
+
+// Calibration: divisors tried beyond the fastest allowed by max_mhz, and the
+// narrowest passing rxdelay window accepted at a divisor.
+#ifndef PSRAM_CAL_EXTRA_DIVISORS
+#define PSRAM_CAL_EXTRA_DIVISORS 2
+#endif
+#ifndef PSRAM_CAL_MIN_WINDOW
+#define PSRAM_CAL_MIN_WINDOW 2
+#endif
 
 void psram_init(uint cs_pin);
+// Same, with the PSRAM max frequency chosen at runtime (clock profiles).
+void psram_init_freq(uint cs_pin, int max_mhz);
+// After psram_init*: chip size in bytes, found by where addresses wrap
+// around (1..16 MB), or 0 when nothing answers on CS1. Runs at a slow,
+// safe timing and restores the current one. Overwrites a few words, so it
+// runs before anything is allocated in PSRAM.
+size_t psram_detect_size(void);
+// After psram_detect_size: pattern-test candidate (divisor, rxdelay)
+// timings over the chip_bytes it found and program the centre of the
+// widest passing window. Destroys PSRAM contents, so it must run before
+// anything is allocated there. Quick mode keeps the whole sweep well under
+// 200 ms.
+void psram_calibrate(int max_mhz, size_t chip_bytes, bool quick, psram_cal_result_t *out);
 
 #endif
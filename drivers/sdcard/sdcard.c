@@ -29,6 +29,7 @@
 #define CMD9	(9)			/* SEND_CSD */
 #define CMD10	(10)		/* SEND_CID */
 #define CMD12	(12)		/* STOP_TRANSMISSION */
+#define CMD13	(13)		/* SEND_STATUS */
 #define ACMD13	(0x80+13)	/* SD_STATUS (SDC) */
 #define CMD16	(16)		/* SET_BLOCKLEN */
 #define CMD17	(17)		/* READ_SINGLE_BLOCK */
@@ -608,6 +609,17 @@ DRESULT disk_ioctl (
 		}
 		break;
 
+	case MMC_GET_STATUS :	/* Card status (R2: 2 bytes). No response means the card was pulled */
+		n = send_cmd(CMD13, 0);
+		if (n & 0x80) {
+			Stat |= STA_NOINIT;	/* Force disk_initialize() (and a FatFs remount) on next access */
+		} else {
+			((BYTE*)buff)[0] = n;
+			((BYTE*)buff)[1] = xchg_spi(0xFF);
+			res = RES_OK;
+		}
+		break;
+
 	case CTRL_TRIM :	/* Erase a block of sectors (used when _USE_ERASE == 1) */
 		if (!(CardType & CT_SDC)) break;				/* Check if the card is SDC */
 		if (disk_ioctl(drv, MMC_GET_CSD, csd)) break;	/* Get CSD */
@@ -8,6 +8,8 @@
 
 #include "tusb.h"
 #include "usbhid.h"
+#include "hid_devices.h"
+#include "latency_probe.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -20,18 +22,16 @@
 
 #define MAX_REPORT 4
 
-// Per-device, per-instance HID info for generic report parsing
-// Index by dev_addr * CFG_TUH_HID + instance (simplified indexing)
+_Static_assert(HID_DEVICES_MAX >= CFG_TUH_HID, "one slot per HID interface");
+
+// Every mounted interface, by (dev_addr, instance)
+static hid_devices_t hid_devices;
+
+// Generic report parsing (mice), by slot in hid_devices
 static struct {
     uint8_t report_count;
     tuh_hid_report_info_t report_info[MAX_REPORT];
-} hid_info[CFG_TUH_HID];
-
-// Previous keyboard report for detecting key changes
-static hid_keyboard_report_t prev_kbd_report = { 0, 0, {0} };
-
-// Previous mouse report for detecting button changes  
-static hid_mouse_report_t prev_mouse_report = { 0 };
+} hid_info[HID_DEVICES_MAX];
 
 // Accumulated mouse movement
 static volatile int16_t cumulative_dx = 0;
@@ -40,10 +40,6 @@ static volatile int8_t cumulative_wheel = 0;
 static volatile uint8_t current_buttons = 0;
 static volatile int mouse_has_motion = 0;
 
-// Device connection state
-static volatile int keyboard_connected = 0;
-static volatile int mouse_connected = 0;
-
 // Key action queue (for detecting press/release)
 #define KEY_ACTION_QUEUE_SIZE 32
 typedef struct {
@@ -54,6 +50,8 @@ typedef struct {
 static key_action_t key_action_queue[KEY_ACTION_QUEUE_SIZE];
 static volatile int key_action_head = 0;
 static volatile int key_action_tail = 0;
+// Set when an action did not fit: the wrapper then resyncs from the report
+static volatile int key_actions_lost = 0;
 
 //--------------------------------------------------------------------
 // Internal functions
@@ -65,96 +63,47 @@ static void queue_key_action(uint8_t keycode, int down) {
         key_action_queue[key_action_head].keycode = keycode;
         key_action_queue[key_action_head].down = down;
         key_action_head = next_head;
+    } else {
+        key_actions_lost = 1;
     }
 }
 
-static int find_keycode_in_report(hid_keyboard_report_t const *report, uint8_t keycode) {
-    for (int i = 0; i < 6; i++) {
-        if (report->keycode[i] == keycode) return 1;
-    }
-    return 0;
+// Merged key changes of all keyboards
+static void kbd_key_changed(void *ctx, uint8_t usage, bool down) {
+    (void)ctx;
+    queue_key_action(usage, down ? 1 : 0);
 }
 
 // Forward declarations
-static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard_report_t const *prev_report);
-static void process_mouse_report(hid_mouse_report_t const *report);
-static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len);
-
-//--------------------------------------------------------------------
-// Process keyboard report
-//--------------------------------------------------------------------
-
-static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard_report_t const *prev_report) {
-    // Handle modifier changes
-    uint8_t released_mods = prev_report->modifier & ~(report->modifier);
-    uint8_t pressed_mods = report->modifier & ~(prev_report->modifier);
-    
-    // Map modifier bits to pseudo-keycodes (using high byte to distinguish)
-    // These will be translated in the wrapper
-    if (released_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
-        queue_key_action(0xE1, 0); // SHIFT released (HID Left Shift)
-    }
-    if (pressed_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
-        queue_key_action(0xE1, 1); // SHIFT pressed
-    }
-    if (released_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
-        queue_key_action(0xE0, 0); // CTRL released
-    }
-    if (pressed_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
-        queue_key_action(0xE0, 1); // CTRL pressed
-    }
-    if (released_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
-        queue_key_action(0xE2, 0); // ALT released
-    }
-    if (pressed_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
-        queue_key_action(0xE2, 1); // ALT pressed
-    }
-    
-    // Check for released keys
-    for (int i = 0; i < 6; i++) {
-        uint8_t keycode = prev_report->keycode[i];
-        if (keycode && !find_keycode_in_report(report, keycode)) {
-            queue_key_action(keycode, 0); // Key released
-        }
-    }
-    
-    // Check for pressed keys
-    for (int i = 0; i < 6; i++) {
-        uint8_t keycode = report->keycode[i];
-        if (keycode && !find_keycode_in_report(prev_report, keycode)) {
-            queue_key_action(keycode, 1); // Key pressed
-        }
-    }
-}
+static void process_mouse_report(hid_device_t *dev, hid_mouse_report_t const *report);
+static void process_generic_report(hid_device_t *dev, uint8_t const *report, uint16_t len);
 
 //--------------------------------------------------------------------
 // Process mouse report
 //--------------------------------------------------------------------
 
-static void process_mouse_report(hid_mouse_report_t const *report) {
-    // Standard boot protocol mouse report
+static void process_mouse_report(hid_device_t *dev, hid_mouse_report_t const *report) {
+    // Standard boot protocol mouse report; motion of all mice adds up
     // Note: Y axis inverted for DOOM (positive Y = forward in game)
     cumulative_dx += report->x;
     cumulative_dy += -report->y;  // Invert Y for correct forward/back
     cumulative_wheel += report->wheel;
-    current_buttons = report->buttons & 0x07;
+    dev->mouse_buttons = report->buttons & 0x07;
+    current_buttons = hid_devices_mouse_buttons(&hid_devices);
     
     if (report->x != 0 || report->y != 0) {
         mouse_has_motion = 1;
     }
-    
-    prev_mouse_report = *report;
 }
 
 //--------------------------------------------------------------------
 // Process generic HID report
 //--------------------------------------------------------------------
 
-static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
-    (void)dev_addr;
-    
-    uint8_t const rpt_count = hid_info[instance].report_count;
-    tuh_hid_report_info_t *rpt_info_arr = hid_info[instance].report_info;
+static void process_generic_report(hid_device_t *dev, uint8_t const *report, uint16_t len) {
+    int const slot = (int)(dev - hid_devices.slots);
+    uint8_t const rpt_count = hid_info[slot].report_count;
+    tuh_hid_report_info_t *rpt_info_arr = hid_info[slot].report_info;
     tuh_hid_report_info_t *rpt_info = NULL;
     
     if (rpt_count == 1 && rpt_info_arr[0].report_id == 0) {
@@ -179,12 +128,8 @@ static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t c
     
     if (rpt_info->usage_page == HID_USAGE_PAGE_DESKTOP) {
         switch (rpt_info->usage) {
-            case HID_USAGE_DESKTOP_KEYBOARD:
-                process_kbd_report((hid_keyboard_report_t const *)report, &prev_kbd_report);
-                prev_kbd_report = *(hid_keyboard_report_t const *)report;
-                break;
             case HID_USAGE_DESKTOP_MOUSE:
-                process_mouse_report((hid_mouse_report_t const *)report);
+                process_mouse_report(dev, (hid_mouse_report_t const *)report);
                 break;
             default:
                 break;
@@ -200,16 +145,44 @@ static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t c
 void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *desc_report, uint16_t desc_len) {
     uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
     
-    if (itf_protocol == HID_ITF_PROTOCOL_KEYBOARD) {
-        keyboard_connected = 1;
-    } else if (itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
-        mouse_connected = 1;
+    hid_device_t *dev = hid_devices_mount(&hid_devices, dev_addr, instance);
+    if (!dev) {
+        // Every slot taken: leave this interface alone
+        return;
     }
+    int const slot = (int)(dev - hid_devices.slots);
+    memset(&hid_info[slot], 0, sizeof(hid_info[slot]));
+    
+    bool const has_keys = hid_kbd_parse_descriptor(&dev->kbd, desc_report, desc_len);
+    bool const boot = tuh_hid_get_protocol(dev_addr, instance) == HID_PROTOCOL_BOOT;
     
-    // Parse generic report descriptor
-    if (itf_protocol == HID_ITF_PROTOCOL_NONE) {
-        hid_info[instance].report_count = tuh_hid_parse_report_descriptor(
-            hid_info[instance].report_info, MAX_REPORT, desc_report, desc_len);
+    if (itf_protocol == HID_ITF_PROTOCOL_KEYBOARD) {
+        dev->is_keyboard = 1;
+        if (!has_keys || boot) {
+            // Descriptor not understood: switch to the fixed boot report
+            hid_kbd_layout_boot(&dev->kbd);
+            if (!boot) {
+                dev->protocol_pending = tuh_hid_set_protocol(dev_addr, instance, HID_PROTOCOL_BOOT);
+            }
+        }
+    } else if (itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
+        dev->is_mouse = 1;
+        // process_mouse_report() reads the boot report
+        if (!boot) {
+            dev->protocol_pending = tuh_hid_set_protocol(dev_addr, instance, HID_PROTOCOL_BOOT);
+        }
+    } else {
+        // Parse generic report descriptor (mice); NKRO keyboards often
+        // put their bitmap report on an interface like this
+        hid_info[slot].report_count = tuh_hid_parse_report_descriptor(
+            hid_info[slot].report_info, MAX_REPORT, desc_report, desc_len);
+        for (uint8_t i = 0; i < hid_info[slot].report_count; i++) {
+            if (hid_info[slot].report_info[i].usage_page == HID_USAGE_PAGE_DESKTOP &&
+                hid_info[slot].report_info[i].usage == HID_USAGE_DESKTOP_MOUSE) {
+                dev->is_mouse = 1;
+            }
+        }
+        dev->is_keyboard = has_keys;
     }
     
     // Request to receive reports
@@ -218,34 +191,41 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *desc_re
     }
 }
 
+// Invoked when SET_PROTOCOL completes (whether or not the device took it)
+void tuh_hid_set_protocol_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t protocol) {
+    (void)protocol;
+    hid_device_t *dev = hid_devices_find(&hid_devices, dev_addr, instance);
+    if (dev) dev->protocol_pending = 0;
+}
+
 // Invoked when HID device is unmounted
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
-    uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
-    
-    if (itf_protocol == HID_ITF_PROTOCOL_KEYBOARD) {
-        keyboard_connected = 0;
-    } else if (itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
-        mouse_connected = 0;
-    }
+    // Releases the keys only this keyboard held
+    hid_devices_unmount(&hid_devices, dev_addr, instance);
+    current_buttons = hid_devices_mouse_buttons(&hid_devices);
+}
+
+// Invoked when a device is gone, after its interfaces: drop anything left
+void tuh_umount_cb(uint8_t dev_addr) {
+    hid_devices_unmount_all(&hid_devices, dev_addr);
+    current_buttons = hid_devices_mouse_buttons(&hid_devices);
 }
 
 // Invoked when report is received
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
     uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
+    hid_device_t *dev = hid_devices_find(&hid_devices, dev_addr, instance);
     
-    switch (itf_protocol) {
-        case HID_ITF_PROTOCOL_KEYBOARD:
-            process_kbd_report((hid_keyboard_report_t const *)report, &prev_kbd_report);
-            prev_kbd_report = *(hid_keyboard_report_t const *)report;
-            break;
-        
-        case HID_ITF_PROTOCOL_MOUSE:
-            process_mouse_report((hid_mouse_report_t const *)report);
-            break;
-        
-        default:
-            process_generic_report(dev_addr, instance, report, len);
-            break;
+    if (!dev || dev->protocol_pending) {
+        // Not ours, or still in the old protocol: the layout does not fit yet
+    } else if (dev->is_keyboard &&
+               hid_devices_keyboard_report(&hid_devices, dev, report, len) != HID_KBD_NOT_KEYBOARD) {
+        // Keys (or a rollover or short report, which change nothing)
+        latency_probe_input(KEY_SOURCE_USB);
+    } else if (itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
+        process_mouse_report(dev, (hid_mouse_report_t const *)report);
+    } else if (itf_protocol == HID_ITF_PROTOCOL_NONE) {
+        process_generic_report(dev, report, len);
     }
     
     // Continue receiving reports
@@ -259,12 +239,16 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t cons
 //--------------------------------------------------------------------
 
 void usbhid_init(void) {
+    // Keyboards report as their descriptor says (NKRO included); boot
+    // protocol is only asked for where the descriptor is not understood
+    tuh_hid_set_default_protocol(HID_PROTOCOL_REPORT);
+    
     // Initialize TinyUSB Host
     tuh_init(BOARD_TUH_RHPORT);
     
     // Clear state
-    memset(&prev_kbd_report, 0, sizeof(prev_kbd_report));
-    memset(&prev_mouse_report, 0, sizeof(prev_mouse_report));
+    hid_devices_init(&hid_devices, kbd_key_changed, NULL);
+    memset(hid_info, 0, sizeof(hid_info));
     cumulative_dx = 0;
     cumulative_dy = 0;
     cumulative_wheel = 0;
@@ -272,6 +256,7 @@ void usbhid_init(void) {
     mouse_has_motion = 0;
     key_action_head = 0;
     key_action_tail = 0;
+    key_actions_lost = 0;
 }
 
 void usbhid_task(void) {
@@ -280,17 +265,18 @@ void usbhid_task(void) {
 }
 
 int usbhid_keyboard_connected(void) {
-    return keyboard_connected;
+    return hid_devices_keyboard_count(&hid_devices);
 }
 
 int usbhid_mouse_connected(void) {
-    return mouse_connected;
+    return hid_devices_mouse_count(&hid_devices);
 }
 
 void usbhid_get_keyboard_state(usbhid_keyboard_state_t *state) {
     if (state) {
-        memcpy(state->keycode, prev_kbd_report.keycode, 6);
-        state->modifier = prev_kbd_report.modifier;
+        hid_kbd_keys_t keys;
+        hid_devices_held_keys(&hid_devices, &keys);
+        memcpy(state->held, keys.bits, sizeof(state->held));
         state->has_key = (key_action_head != key_action_tail);
     }
 }
@@ -311,6 +297,12 @@ void usbhid_get_mouse_state(usbhid_mouse_state_t *state) {
     }
 }
 
+int usbhid_take_key_actions_lost(void) {
+    if (!key_actions_lost) return 0;
+    key_actions_lost = 0;
+    return 1;
+}
+
 int usbhid_get_key_action(uint8_t *keycode, int *down) {
     if (key_action_head == key_action_tail) {
         return 0; // No actions queued
@@ -0,0 +1,101 @@
+/*
+ * USB HID device table
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "hid_devices.h"
+#include <string.h>
+
+void hid_devices_init(hid_devices_t *d, hid_kbd_change_cb key_cb, void *key_ctx) {
+    memset(d, 0, sizeof(*d));
+    d->key_cb = key_cb;
+    d->key_ctx = key_ctx;
+}
+
+// One keyboard's key changed: pass it on only if the merged state changes
+static void merge_key(void *ctx, uint8_t usage, bool down) {
+    hid_devices_t *d = (hid_devices_t *)ctx;
+    if (down) {
+        if (d->key_holders[usage]++ == 0) d->key_cb(d->key_ctx, usage, true);
+    } else if (d->key_holders[usage] > 0) {
+        if (--d->key_holders[usage] == 0) d->key_cb(d->key_ctx, usage, false);
+    }
+}
+
+static void release_slot(hid_devices_t *d, hid_device_t *dev) {
+    // An unplugged keyboard sends no releases: let go of its keys
+    if (dev->is_keyboard) hid_kbd_release_all(&dev->kbd_state, merge_key, d);
+    memset(dev, 0, sizeof(*dev));
+}
+
+hid_device_t *hid_devices_find(hid_devices_t *d, uint8_t dev_addr, uint8_t instance) {
+    for (int i = 0; i < HID_DEVICES_MAX; i++) {
+        hid_device_t *dev = &d->slots[i];
+        if (dev->used && dev->dev_addr == dev_addr && dev->instance == instance) return dev;
+    }
+    return NULL;
+}
+
+hid_device_t *hid_devices_mount(hid_devices_t *d, uint8_t dev_addr, uint8_t instance) {
+    // A missed unmount (address reused) must not leave keys down
+    hid_device_t *dev = hid_devices_find(d, dev_addr, instance);
+    if (dev) {
+        release_slot(d, dev);
+    } else {
+        for (int i = 0; i < HID_DEVICES_MAX && !dev; i++) {
+            if (!d->slots[i].used) dev = &d->slots[i];
+        }
+        if (!dev) return NULL;
+    }
+    memset(dev, 0, sizeof(*dev));
+    dev->used = 1;
+    dev->dev_addr = dev_addr;
+    dev->instance = instance;
+    return dev;
+}
+
+void hid_devices_unmount(hid_devices_t *d, uint8_t dev_addr, uint8_t instance) {
+    hid_device_t *dev = hid_devices_find(d, dev_addr, instance);
+    if (dev) release_slot(d, dev);
+}
+
+void hid_devices_unmount_all(hid_devices_t *d, uint8_t dev_addr) {
+    for (int i = 0; i < HID_DEVICES_MAX; i++) {
+        if (d->slots[i].used && d->slots[i].dev_addr == dev_addr) release_slot(d, &d->slots[i]);
+    }
+}
+
+hid_kbd_result_t hid_devices_keyboard_report(hid_devices_t *d, hid_device_t *dev,
+                                             const uint8_t *report, uint16_t len) {
+    return hid_kbd_apply(&dev->kbd, &dev->kbd_state, report, len, merge_key, d);
+}
+
+int hid_devices_keyboard_count(const hid_devices_t *d) {
+    int n = 0;
+    for (int i = 0; i < HID_DEVICES_MAX; i++) n += d->slots[i].used && d->slots[i].is_keyboard;
+    return n;
+}
+
+int hid_devices_mouse_count(const hid_devices_t *d) {
+    int n = 0;
+    for (int i = 0; i < HID_DEVICES_MAX; i++) n += d->slots[i].used && d->slots[i].is_mouse;
+    return n;
+}
+
+void hid_devices_held_keys(const hid_devices_t *d, hid_kbd_keys_t *keys) {
+    memset(keys, 0, sizeof(*keys));
+    for (int i = 0; i < HID_DEVICES_MAX; i++) {
+        const hid_device_t *dev = &d->slots[i];
+        if (!dev->used || !dev->is_keyboard) continue;
+        for (int w = 0; w < 8; w++) keys->bits[w] |= dev->kbd_state.held.bits[w];
+    }
+}
+
+uint8_t hid_devices_mouse_buttons(const hid_devices_t *d) {
+    uint8_t buttons = 0;
+    for (int i = 0; i < HID_DEVICES_MAX; i++) {
+        if (d->slots[i].used && d->slots[i].is_mouse) buttons |= d->slots[i].mouse_buttons;
+    }
+    return buttons;
+}
@@ -0,0 +1,100 @@
+/*
+ * USB HID device table
+ * Keeps the state of every mounted HID interface, keyed by device address
+ * and interface instance, and merges the keyboards into one key stream
+ *
+ * TinyUSB numbers HID instances per device, so with a hub two devices
+ * both have an instance 0. Each (dev_addr, instance) gets its own slot:
+ * its own keyboard layout and held keys, its own mouse buttons. A key is
+ * down while any keyboard holds it and up when the last one lets go, so
+ * unplugging one keyboard only releases the keys nobody else holds.
+ *
+ * Pure logic: no TinyUSB dependencies.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef HID_DEVICES_H
+#define HID_DEVICES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hid_kbd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HID_DEVICES_MAX 8       // CFG_TUH_HID
+
+typedef struct {
+    uint8_t used;
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t is_keyboard;
+    uint8_t is_mouse;
+    uint8_t protocol_pending;   // reports are ignored until SET_PROTOCOL is done
+    uint8_t mouse_buttons;
+    hid_kbd_layout_t kbd;
+    hid_kbd_state_t kbd_state;
+} hid_device_t;
+
+typedef struct {
+    hid_device_t slots[HID_DEVICES_MAX];
+    uint8_t key_holders[256];   // keyboards holding each HID usage
+    hid_kbd_change_cb key_cb;   // merged key changes
+    void *key_ctx;
+} hid_devices_t;
+
+/**
+ * Start empty; merged key changes go to key_cb
+ */
+void hid_devices_init(hid_devices_t *d, hid_kbd_change_cb key_cb, void *key_ctx);
+
+/**
+ * Slot for a newly mounted interface, cleared. A slot still held by the
+ * same (dev_addr, instance) is released first.
+ * @return NULL if every slot is taken
+ */
+hid_device_t *hid_devices_mount(hid_devices_t *d, uint8_t dev_addr, uint8_t instance);
+
+/**
+ * @return The interface's slot, or NULL if it is not mounted
+ */
+hid_device_t *hid_devices_find(hid_devices_t *d, uint8_t dev_addr, uint8_t instance);
+
+/**
+ * Free the interface's slot and release the keys only it held
+ */
+void hid_devices_unmount(hid_devices_t *d, uint8_t dev_addr, uint8_t instance);
+
+/**
+ * Free every slot of a device (all its instances)
+ */
+void hid_devices_unmount_all(hid_devices_t *d, uint8_t dev_addr);
+
+/**
+ * Apply a keyboard report from one slot
+ */
+hid_kbd_result_t hid_devices_keyboard_report(hid_devices_t *d, hid_device_t *dev,
+                                             const uint8_t *report, uint16_t len);
+
+int hid_devices_keyboard_count(const hid_devices_t *d);
+int hid_devices_mouse_count(const hid_devices_t *d);
+
+/**
+ * Keys held on any keyboard
+ */
+void hid_devices_held_keys(const hid_devices_t *d, hid_kbd_keys_t *keys);
+
+/**
+ * Buttons held on any mouse
+ */
+uint8_t hid_devices_mouse_buttons(const hid_devices_t *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HID_DEVICES_H */
@@ -0,0 +1,317 @@
+/*
+ * USB HID keyboard report parsing
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "hid_kbd.h"
+#include <string.h>
+
+// Item types and tags (HID 1.11, 6.2.2)
+#define ITEM_MAIN   0
+#define ITEM_GLOBAL 1
+#define ITEM_LOCAL  2
+#define ITEM_LONG   0xFE
+
+#define MAIN_INPUT           0x8
+#define GLOBAL_USAGE_PAGE    0x0
+#define GLOBAL_LOGICAL_MIN   0x1
+#define GLOBAL_LOGICAL_MAX   0x2
+#define GLOBAL_REPORT_SIZE   0x7
+#define GLOBAL_REPORT_ID     0x8
+#define GLOBAL_REPORT_COUNT  0x9
+#define GLOBAL_PUSH          0xA
+#define GLOBAL_POP           0xB
+#define LOCAL_USAGE          0x0
+#define LOCAL_USAGE_MIN      0x1
+#define LOCAL_USAGE_MAX      0x2
+
+#define INPUT_CONSTANT 0x01
+#define INPUT_VARIABLE 0x02
+
+#define USAGE_PAGE_KEYBOARD 0x07
+#define USAGE_FIRST_MODIFIER 0xE0
+
+// Report IDs whose input bit offsets are tracked; more are ignored
+#define MAX_REPORT_IDS 16
+#define MAX_PUSH 2
+
+typedef struct {
+    uint16_t usage_page;
+    int32_t logical_min;
+    int32_t logical_max;
+    uint32_t logical_max_raw;   // as unsigned, for descriptors that mean 255 by 0xFF
+    uint32_t report_size;
+    uint32_t report_count;
+    uint8_t report_id;
+} globals_t;
+
+typedef struct {
+    uint32_t usage_min;         // with the page in the high half if extended
+    uint32_t first_usage;
+    uint8_t have_min;
+    uint8_t usage_count;
+} locals_t;
+
+static uint32_t item_unsigned(const uint8_t *data, int size) {
+    uint32_t v = 0;
+    for (int i = 0; i < size; i++) v |= (uint32_t)data[i] << (8 * i);
+    return v;
+}
+
+static int32_t item_signed(const uint8_t *data, int size) {
+    uint32_t v = item_unsigned(data, size);
+    if (size > 0 && size < 4 && (v & (1u << (8 * size - 1)))) v |= ~0u << (8 * size);
+    return (int32_t)v;
+}
+
+static hid_kbd_report_layout_t *report_for(hid_kbd_layout_t *layout, uint8_t report_id) {
+    for (int i = 0; i < layout->report_count; i++) {
+        if (layout->reports[i].report_id == report_id) return &layout->reports[i];
+    }
+    if (layout->report_count >= HID_KBD_MAX_REPORTS) return NULL;
+    hid_kbd_report_layout_t *r = &layout->reports[layout->report_count++];
+    memset(r, 0, sizeof(*r));
+    r->report_id = report_id;
+    return r;
+}
+
+// Record one keyboard input item
+static void add_field(hid_kbd_layout_t *layout, const globals_t *g, const locals_t *l,
+                      uint8_t flags, uint32_t bit_offset) {
+    const int is_array = !(flags & INPUT_VARIABLE);
+    uint32_t usage_min = l->have_min ? l->usage_min : (l->usage_count && !is_array ? l->first_usage : 0);
+    usage_min &= 0xFFFF;
+    if (usage_min > 0xFF || g->report_size == 0 || g->report_size > 32 || g->report_count == 0) return;
+    if (g->report_count > 0xFF || bit_offset + g->report_size * g->report_count > 0xFFFF) return;
+
+    hid_kbd_report_layout_t *r = report_for(layout, g->report_id);
+    if (!r || r->field_count >= HID_KBD_MAX_FIELDS) return;
+    hid_kbd_field_t *f = &r->fields[r->field_count++];
+    f->bit_offset = (uint16_t)bit_offset;
+    f->bit_size = (uint8_t)g->report_size;
+    f->count = (uint8_t)g->report_count;
+    f->is_array = (uint8_t)is_array;
+    f->usage_min = (uint8_t)usage_min;
+    f->logical_min = g->logical_min;
+    f->logical_max = g->logical_max;
+    // Logical Maximum 0xFF in one byte is -1, but keyboards mean 255
+    if (f->logical_max < f->logical_min && f->logical_min >= 0) f->logical_max = (int32_t)g->logical_max_raw;
+
+    const uint32_t end = (bit_offset + g->report_size * g->report_count + 7) / 8;
+    if (end > r->min_len) r->min_len = (uint16_t)end;
+}
+
+static int field_has_keys(const hid_kbd_field_t *f) {
+    return f->is_array || f->usage_min < USAGE_FIRST_MODIFIER;
+}
+
+bool hid_kbd_parse_descriptor(hid_kbd_layout_t *layout, const uint8_t *desc, size_t len) {
+    memset(layout, 0, sizeof(*layout));
+
+    globals_t g;
+    memset(&g, 0, sizeof(g));
+    globals_t stack[MAX_PUSH];
+    int depth = 0;
+    locals_t l;
+    memset(&l, 0, sizeof(l));
+
+    struct { uint8_t id; uint32_t bits; } offsets[MAX_REPORT_IDS];
+    int offset_count = 0;
+
+    size_t pos = 0;
+    while (pos < len) {
+        const uint8_t prefix = desc[pos++];
+        if (prefix == ITEM_LONG) {
+            // Long item: size byte, tag byte, data
+            if (pos >= len) break;
+            pos += 2 + desc[pos];
+            continue;
+        }
+        int size = prefix & 3;
+        if (size == 3) size = 4;
+        if (pos + (size_t)size > len) break;
+        const uint8_t *data = desc + pos;
+        pos += size;
+        const int type = (prefix >> 2) & 3;
+        const int tag = prefix >> 4;
+
+        if (type == ITEM_GLOBAL) {
+            switch (tag) {
+                case GLOBAL_USAGE_PAGE: g.usage_page = (uint16_t)item_unsigned(data, size); break;
+                case GLOBAL_LOGICAL_MIN: g.logical_min = item_signed(data, size); break;
+                case GLOBAL_LOGICAL_MAX:
+                    g.logical_max = item_signed(data, size);
+                    g.logical_max_raw = item_unsigned(data, size);
+                    break;
+                case GLOBAL_REPORT_SIZE: g.report_size = item_unsigned(data, size); break;
+                case GLOBAL_REPORT_COUNT: g.report_count = item_unsigned(data, size); break;
+                case GLOBAL_REPORT_ID:
+                    g.report_id = (uint8_t)item_unsigned(data, size);
+                    layout->uses_report_ids = 1;
+                    break;
+                case GLOBAL_PUSH:
+                    if (depth < MAX_PUSH) stack[depth++] = g;
+                    break;
+                case GLOBAL_POP:
+                    if (depth > 0) g = stack[--depth];
+                    break;
+                default:
+                    break;
+            }
+        } else if (type == ITEM_LOCAL) {
+            // A 4-byte usage carries its own page in the high half
+            uint32_t usage = item_unsigned(data, size);
+            if (size < 4) usage |= (uint32_t)g.usage_page << 16;
+            switch (tag) {
+                case LOCAL_USAGE:
+                    if (l.usage_count++ == 0) l.first_usage = usage;
+                    break;
+                case LOCAL_USAGE_MIN:
+                    l.usage_min = usage;
+                    l.have_min = 1;
+                    break;
+                default:
+                    break;
+            }
+        } else if (type == ITEM_MAIN) {
+            if (tag == MAIN_INPUT) {
+                int slot = 0;
+                while (slot < offset_count && offsets[slot].id != g.report_id) slot++;
+                if (slot == offset_count && offset_count < MAX_REPORT_IDS) {
+                    offsets[offset_count].id = g.report_id;
+                    offsets[offset_count].bits = 0;
+                    offset_count++;
+                }
+                if (slot < offset_count) {
+                    const uint8_t flags = size ? data[0] : 0;
+                    const uint32_t page = l.have_min ? l.usage_min >> 16
+                                        : (l.usage_count ? l.first_usage >> 16 : g.usage_page);
+                    if (!(flags & INPUT_CONSTANT) && page == USAGE_PAGE_KEYBOARD) {
+                        add_field(layout, &g, &l, flags, offsets[slot].bits);
+                    }
+                    offsets[slot].bits += g.report_size * g.report_count;
+                }
+            }
+            // Locals only last until the next main item
+            memset(&l, 0, sizeof(l));
+        }
+    }
+
+    // Drop reports that ended up without fields (their slot was taken
+    // when a field did not fit) and see whether any carries real keys
+    int has_keys = 0;
+    int kept = 0;
+    for (int i = 0; i < layout->report_count; i++) {
+        const hid_kbd_report_layout_t *r = &layout->reports[i];
+        if (!r->field_count) continue;
+        for (int f = 0; f < r->field_count; f++) has_keys |= field_has_keys(&r->fields[f]);
+        layout->reports[kept++] = *r;
+    }
+    layout->report_count = (uint8_t)kept;
+    return has_keys != 0;
+}
+
+void hid_kbd_layout_boot(hid_kbd_layout_t *layout) {
+    memset(layout, 0, sizeof(*layout));
+    layout->report_count = 1;
+    hid_kbd_report_layout_t *r = &layout->reports[0];
+    r->field_count = 2;
+    r->min_len = 8;
+    r->fields[0] = (hid_kbd_field_t){ .bit_offset = 0, .bit_size = 1, .count = 8,
+                                      .usage_min = USAGE_FIRST_MODIFIER, .logical_max = 1 };
+    r->fields[1] = (hid_kbd_field_t){ .bit_offset = 16, .bit_size = 8, .count = 6, .is_array = 1,
+                                      .logical_max = 255 };
+}
+
+static uint32_t get_bits(const uint8_t *data, uint32_t offset, uint8_t size) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < size; i++, offset++) {
+        if ((data[offset >> 3] >> (offset & 7)) & 1) v |= 1u << i;
+    }
+    return v;
+}
+
+static void set_key(hid_kbd_keys_t *keys, uint32_t usage) {
+    if (usage <= 0xFF) keys->bits[usage >> 5] |= 1u << (usage & 31);
+}
+
+hid_kbd_result_t hid_kbd_decode(const hid_kbd_layout_t *layout, const uint8_t *report, size_t len,
+                                hid_kbd_keys_t *keys, int *report_index) {
+    uint8_t id = 0;
+    if (layout->uses_report_ids) {
+        if (len < 1) return HID_KBD_NOT_KEYBOARD;
+        id = report[0];
+        report++;
+        len--;
+    }
+    int index = 0;
+    while (index < layout->report_count && layout->reports[index].report_id != id) index++;
+    if (index == layout->report_count) return HID_KBD_NOT_KEYBOARD;
+    const hid_kbd_report_layout_t *r = &layout->reports[index];
+    if (len < r->min_len) return HID_KBD_SHORT;
+
+    memset(keys, 0, sizeof(*keys));
+    for (int fi = 0; fi < r->field_count; fi++) {
+        const hid_kbd_field_t *f = &r->fields[fi];
+        for (uint32_t i = 0; i < f->count; i++) {
+            uint32_t v = get_bits(report, f->bit_offset + i * f->bit_size, f->bit_size);
+            if (!f->is_array) {
+                if (v) set_key(keys, f->usage_min + i);
+                continue;
+            }
+            int32_t value = (int32_t)v;
+            if (f->logical_min < 0 && f->bit_size < 32 && (v & (1u << (f->bit_size - 1)))) {
+                value = (int32_t)(v | (~0u << f->bit_size));
+            }
+            if (value < f->logical_min || value > f->logical_max) continue;  // empty slot
+            const uint32_t usage = f->usage_min + (uint32_t)(value - f->logical_min);
+            if (usage == 0) continue;
+            // Every slot reads "rollover" while too many keys are down
+            if (usage <= HID_KBD_USAGE_UNDEFINED) return HID_KBD_ROLLOVER;
+            set_key(keys, usage);
+        }
+    }
+    *report_index = index;
+    return HID_KBD_CHANGED;
+}
+
+// Report what changed from old to now: releases first, then modifier
+// presses before key presses, so Ctrl+R arrives as Ctrl, then R
+static void report_changes(const hid_kbd_keys_t *old, const hid_kbd_keys_t *now,
+                           hid_kbd_change_cb cb, void *ctx) {
+    for (int usage = 0; usage <= 0xFF; usage++) {
+        if (hid_kbd_key_held(old, (uint8_t)usage) && !hid_kbd_key_held(now, (uint8_t)usage)) {
+            cb(ctx, (uint8_t)usage, false);
+        }
+    }
+    for (int n = 0; n <= 0xFF; n++) {
+        const uint8_t usage = (uint8_t)(n + USAGE_FIRST_MODIFIER);
+        if (!hid_kbd_key_held(old, usage) && hid_kbd_key_held(now, usage)) cb(ctx, usage, true);
+    }
+}
+
+hid_kbd_result_t hid_kbd_apply(const hid_kbd_layout_t *layout, hid_kbd_state_t *state,
+                               const uint8_t *report, size_t len, hid_kbd_change_cb cb, void *ctx) {
+    hid_kbd_keys_t keys;
+    int index = 0;
+    const hid_kbd_result_t result = hid_kbd_decode(layout, report, len, &keys, &index);
+    if (result != HID_KBD_CHANGED) return result;
+
+    state->per_report[index] = keys;
+    hid_kbd_keys_t held;
+    memset(&held, 0, sizeof(held));
+    for (int i = 0; i < layout->report_count; i++) {
+        for (int w = 0; w < 8; w++) held.bits[w] |= state->per_report[i].bits[w];
+    }
+    report_changes(&state->held, &held, cb, ctx);
+    state->held = held;
+    return HID_KBD_CHANGED;
+}
+
+void hid_kbd_release_all(hid_kbd_state_t *state, hid_kbd_change_cb cb, void *ctx) {
+    hid_kbd_keys_t none;
+    memset(&none, 0, sizeof(none));
+    report_changes(&state->held, &none, cb, ctx);
+    memset(state, 0, sizeof(*state));
+}
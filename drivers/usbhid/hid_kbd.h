@@ -0,0 +1,115 @@
+/*
+ * USB HID keyboard report parsing
+ * Reads the keyboard layout out of a HID report descriptor and turns
+ * reports into the set of held keys
+ *
+ * Covers what keyboards actually send: the 8-byte boot report, 6KRO
+ * array reports with or without report IDs, NKRO bitmap reports and
+ * composite interfaces that mix keyboard, consumer and mouse reports.
+ * A key set is a bitmap of HID keyboard usages 0x00-0xFF, modifiers as
+ * usages 0xE0-0xE7.
+ *
+ * Pure logic: no TinyUSB dependencies.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef HID_KBD_H
+#define HID_KBD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HID_KBD_MAX_REPORTS 4   // keyboard reports per interface
+#define HID_KBD_MAX_FIELDS  6   // keyboard input items per report
+
+// HID keyboard usages the report uses for errors instead of keys
+#define HID_KBD_USAGE_ROLLOVER  0x01
+#define HID_KBD_USAGE_UNDEFINED 0x03
+
+typedef struct {
+    uint16_t bit_offset;        // from the start of the report, past the ID
+    uint8_t bit_size;
+    uint8_t count;
+    uint8_t is_array;           // array: values are key indices; else one bit per key
+    uint8_t usage_min;
+    int32_t logical_min;        // array values outside these mean "no key"
+    int32_t logical_max;
+} hid_kbd_field_t;
+
+typedef struct {
+    uint8_t report_id;          // 0 without report IDs
+    uint8_t field_count;
+    uint16_t min_len;           // bytes needed for every field, past the ID
+    hid_kbd_field_t fields[HID_KBD_MAX_FIELDS];
+} hid_kbd_report_layout_t;
+
+typedef struct {
+    uint8_t report_count;
+    uint8_t uses_report_ids;    // every report starts with its ID
+    hid_kbd_report_layout_t reports[HID_KBD_MAX_REPORTS];
+} hid_kbd_layout_t;
+
+typedef struct {
+    uint32_t bits[8];
+} hid_kbd_keys_t;
+
+// Keys held according to each keyboard report, and all of them together
+typedef struct {
+    hid_kbd_keys_t per_report[HID_KBD_MAX_REPORTS];
+    hid_kbd_keys_t held;
+} hid_kbd_state_t;
+
+typedef enum {
+    HID_KBD_CHANGED = 0,        // applied (possibly without any change)
+    HID_KBD_NOT_KEYBOARD,       // a report ID without keys: mouse, consumer, ...
+    HID_KBD_ROLLOVER,           // too many keys down: state kept as it was
+    HID_KBD_SHORT,              // report shorter than its layout: ignored
+} hid_kbd_result_t;
+
+/**
+ * Find the keyboard reports in a report descriptor
+ * @return true if at least one report carries keys (not only modifiers)
+ */
+bool hid_kbd_parse_descriptor(hid_kbd_layout_t *layout, const uint8_t *desc, size_t len);
+
+/**
+ * The fixed boot protocol layout: modifiers, reserved byte, 6 key slots
+ */
+void hid_kbd_layout_boot(hid_kbd_layout_t *layout);
+
+/**
+ * Keys held according to one report
+ * @param report_index Set to the layout report it matched
+ */
+hid_kbd_result_t hid_kbd_decode(const hid_kbd_layout_t *layout, const uint8_t *report, size_t len,
+                                hid_kbd_keys_t *keys, int *report_index);
+
+typedef void (*hid_kbd_change_cb)(void *ctx, uint8_t usage, bool down);
+
+/**
+ * Apply a report to the state and report every key that changed,
+ * releases first
+ */
+hid_kbd_result_t hid_kbd_apply(const hid_kbd_layout_t *layout, hid_kbd_state_t *state,
+                               const uint8_t *report, size_t len, hid_kbd_change_cb cb, void *ctx);
+
+/**
+ * Release every held key (the keyboard went away)
+ */
+void hid_kbd_release_all(hid_kbd_state_t *state, hid_kbd_change_cb cb, void *ctx);
+
+static inline bool hid_kbd_key_held(const hid_kbd_keys_t *keys, uint8_t usage) {
+    return (keys->bits[usage >> 5] >> (usage & 31)) & 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HID_KBD_H */
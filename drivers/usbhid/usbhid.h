@@ -20,8 +20,7 @@ extern "C" {
 
 // USB keyboard state accessible from wrapper
 typedef struct {
-    uint8_t keycode[6];     // Currently pressed keys (HID keycodes)
-    uint8_t modifier;       // Modifier keys (shift, ctrl, alt, etc.)
+    uint32_t held[8];       // Held keys, bit n = HID usage n (modifiers 0xE0-0xE7)
     int has_key;            // Non-zero if a key event is pending
 } usbhid_keyboard_state_t;
 
@@ -82,6 +81,13 @@ void usbhid_get_mouse_state(usbhid_mouse_state_t *state);
  */
 int usbhid_get_key_action(uint8_t *keycode, int *down);
 
+/**
+ * Check (and clear) whether key actions were dropped on a full queue
+ * @return Non-zero if the keyboard state must be resynced from
+ *         usbhid_get_keyboard_state()
+ */
+int usbhid_take_key_actions_lost(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,15 +31,11 @@ static volatile int queue_tail = 0;
 static uint8_t key_state[256];
 
 // Track current modifier state
-static uint8_t current_modifiers = 0;
+static uint16_t current_modifiers = 0;
 
-//--------------------------------------------------------------------
-// HID Modifier pseudo-keycodes (from hid_app.c)
-//--------------------------------------------------------------------
-
-// hid_app.c uses these pseudo-keycodes for modifiers:
-// 0xE0 = CTRL, 0xE1 = SHIFT, 0xE2 = ALT
-// These match USB HID modifier usage codes
+// Set when an event did not fit in the queue (or hid_app.c dropped one):
+// key_state is then rebuilt from the keyboard's latest report
+static int resync_needed = 0;
 
 // SDL scancodes for modifiers
 #define SDL_SCANCODE_LCTRL  224
@@ -66,14 +62,16 @@ static uint8_t current_modifiers = 0;
 // Queue Management
 //--------------------------------------------------------------------
 
-static void queue_push(int pressed, int scancode, int modifier) {
+static int queue_push(int pressed, int scancode, int modifier) {
     int next = (queue_head + 1) % USBHID_EVENT_QUEUE_SIZE;
-    if (next != queue_tail) {
-        event_queue[queue_head].pressed = pressed;
-        event_queue[queue_head].scancode = scancode;
-        event_queue[queue_head].modifier = modifier;
-        queue_head = next;
+    if (next == queue_tail) {
+        return 0;  // Queue full
     }
+    event_queue[queue_head].pressed = pressed;
+    event_queue[queue_head].scancode = scancode;
+    event_queue[queue_head].modifier = modifier;
+    queue_head = next;
+    return 1;
 }
 
 static int queue_pop(int* pressed, int* scancode, int* modifier) {
@@ -92,53 +90,84 @@ static int queue_pop(int* pressed, int* scancode, int* modifier) {
 //--------------------------------------------------------------------
 
 static int hid_to_sdl_scancode(uint8_t hid_keycode) {
-    // Modifier pseudo-keycodes from hid_app.c
-    switch (hid_keycode) {
-        case 0xE0: return SDL_SCANCODE_LCTRL;   // CTRL
-        case 0xE1: return SDL_SCANCODE_LSHIFT;  // SHIFT
-        case 0xE2: return SDL_SCANCODE_LALT;    // ALT
-        case 0xE3: return SDL_SCANCODE_LGUI;    // GUI/Super
-        case 0xE4: return SDL_SCANCODE_RCTRL;   // Right CTRL
-        case 0xE5: return SDL_SCANCODE_RSHIFT;  // Right SHIFT
-        case 0xE6: return SDL_SCANCODE_RALT;    // Right ALT
-        case 0xE7: return SDL_SCANCODE_RGUI;    // Right GUI
-        default:
-            // Regular keycodes: HID and SDL use the same values
-            return hid_keycode;
-    }
+    // HID keyboard usages and SDL scancodes share values, modifiers
+    // included (0xE0 = SDL_SCANCODE_LCTRL ... 0xE7 = SDL_SCANCODE_RGUI)
+    return hid_keycode;
 }
 
 //--------------------------------------------------------------------
 // Process events from hid_app.c key action queue
 //--------------------------------------------------------------------
 
+static uint16_t modifier_bit(int scancode) {
+    switch (scancode) {
+        case SDL_SCANCODE_LCTRL: return KMOD_LCTRL;
+        case SDL_SCANCODE_LSHIFT: return KMOD_LSHIFT;
+        case SDL_SCANCODE_LALT: return KMOD_LALT;
+        case SDL_SCANCODE_RCTRL: return KMOD_RCTRL;
+        case SDL_SCANCODE_RSHIFT: return KMOD_RSHIFT;
+        case SDL_SCANCODE_RALT: return KMOD_RALT;
+        default: return 0;
+    }
+}
+
+// Queue one key change. key_state only follows events that were queued,
+// so a full queue is caught up by resync_key_state() later.
+static void apply_key_change(int scancode, int down) {
+    if (scancode < 0 || scancode >= 256) return;
+    if (key_state[scancode] == (down ? 1 : 0)) return;
+    
+    uint16_t modifiers = current_modifiers;
+    if (down) modifiers |= modifier_bit(scancode);
+    else modifiers &= ~modifier_bit(scancode);
+    
+    if (!queue_push(down, scancode, modifiers)) {
+        resync_needed = 1;
+        return;
+    }
+    current_modifiers = modifiers;
+    key_state[scancode] = down ? 1 : 0;
+}
+
+// Bring key_state in line with the keyboard's latest report (which already
+// includes every dropped action): release what is up, press what is down.
+static void resync_key_state(void) {
+    usbhid_keyboard_state_t kbd;
+    usbhid_get_keyboard_state(&kbd);
+
+    uint8_t want[256];
+    memset(want, 0, sizeof(want));
+    for (int usage = 1; usage < 256; usage++) {
+        if ((kbd.held[usage >> 5] >> (usage & 31)) & 1) want[hid_to_sdl_scancode((uint8_t)usage)] = 1;
+    }
+
+    resync_needed = 0;
+    // Releases first, so a full queue never leaves extra keys down
+    for (int sc = 0; sc < 256 && !resync_needed; sc++) {
+        if (key_state[sc] && !want[sc]) apply_key_change(sc, 0);
+    }
+    for (int sc = 0; sc < 256 && !resync_needed; sc++) {
+        if (!key_state[sc] && want[sc]) apply_key_change(sc, 1);
+    }
+}
+
 static void process_pending_key_actions(void) {
     uint8_t hid_keycode;
     int down;
     
+    if (usbhid_take_key_actions_lost()) {
+        resync_needed = 1;
+    }
+    if (resync_needed) {
+        // The report is newer than anything still queued in hid_app.c
+        while (usbhid_get_key_action(&hid_keycode, &down)) {}
+        resync_key_state();
+        return;
+    }
+    
     // Drain all pending key actions from hid_app.c
-    while (usbhid_get_key_action(&hid_keycode, &down)) {
-        int scancode = hid_to_sdl_scancode(hid_keycode);
-        
-        // Update modifier tracking
-        if (hid_keycode == 0xE1) {  // SHIFT
-            if (down) current_modifiers |= KMOD_LSHIFT;
-            else current_modifiers &= ~KMOD_LSHIFT;
-        } else if (hid_keycode == 0xE0) {  // CTRL
-            if (down) current_modifiers |= KMOD_LCTRL;
-            else current_modifiers &= ~KMOD_LCTRL;
-        } else if (hid_keycode == 0xE2) {  // ALT
-            if (down) current_modifiers |= KMOD_LALT;
-            else current_modifiers &= ~KMOD_LALT;
-        }
-        
-        // Update key state
-        if (scancode >= 0 && scancode < 256) {
-            key_state[scancode] = down ? 1 : 0;
-        }
-        
-        // Queue the event
-        queue_push(down, scancode, current_modifiers);
+    while (!resync_needed && usbhid_get_key_action(&hid_keycode, &down)) {
+        apply_key_change(hid_to_sdl_scancode(hid_keycode), down);
     }
 }
 
@@ -155,6 +184,7 @@ void usbhid_sdl_init(void) {
     queue_tail = 0;
     memset(key_state, 0, sizeof(key_state));
     current_modifiers = 0;
+    resync_needed = 0;
 }
 
 void usbhid_sdl_tick(void) {
@@ -190,6 +220,18 @@ int usbhid_sdl_keyboard_connected(void) {
     return usbhid_keyboard_connected();
 }
 
+int usbhid_sdl_get_mouse(int* dx, int* dy, int* buttons) {
+    *dx = *dy = *buttons = 0;
+    if (!usb_hid_initialized || !usbhid_mouse_connected()) return 0;
+    usbhid_mouse_state_t mouse;
+    usbhid_get_mouse_state(&mouse);
+    // hid_app.c turns Y around (up is positive); the screen's Y goes down
+    *dx = mouse.dx;
+    *dy = -mouse.dy;
+    *buttons = mouse.buttons;
+    return 1;
+}
+
 #else // !USB_HID_ENABLED
 
 // Stub implementations when USB HID is disabled
@@ -199,5 +241,6 @@ int usbhid_sdl_get_key(int* pressed, int* scancode, int* modifier) { return 0; }
 int usbhid_sdl_is_key_pressed(int scancode) { return 0; }
 int usbhid_sdl_events_pending(void) { return 0; }
 int usbhid_sdl_keyboard_connected(void) { return 0; }
+int usbhid_sdl_get_mouse(int* dx, int* dy, int* buttons) { *dx = *dy = *buttons = 0; return 0; }
 
 #endif // USB_HID_ENABLED
@@ -55,6 +55,15 @@ int usbhid_sdl_events_pending(void);
  */
 int usbhid_sdl_keyboard_connected(void);
 
+/**
+ * Take the mouse movement since the last call
+ * @param dx Output: pixels right
+ * @param dy Output: pixels down
+ * @param buttons Output: held buttons, bit 0 left, bit 1 right, bit 2 middle
+ * @return Non-zero if a mouse is connected
+ */
+int usbhid_sdl_get_mouse(int* dx, int* dy, int* buttons);
+
 #ifdef __cplusplus
 }
 #endif
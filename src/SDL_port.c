@@ -9,6 +9,14 @@
 #include "psram_allocator.h"
 #include "pop_fs.h"
 #include "ps2kbd/ps2kbd_wrapper.h"
+#include "key_state.h"
+#include "key_bindings.h"
+#include "log_sink.h"
+#include "serial_link.h"
+#include "latency_probe.h"
+#include "teardown.h"
+#include "crash_guard.h"
+#include "blit_core.h"
 
 // USB HID keyboard support (optional)
 #ifdef USB_HID_ENABLED
@@ -138,44 +146,32 @@ static SDL_Palette* get_screen_palette(void) {
     return NULL;
 }
 
+static blit_palette_t blit_palette(const SDL_Palette *palette) {
+    // HDMI scanout reserves 240..243 of the screen palette for control/sync patterns.
+    return (blit_palette_t){ (const blit_color_t *)palette->colors, palette->ncolors,
+                             palette == get_screen_palette() };
+}
+
 static Uint8 find_best_palette_index(const SDL_Color *src_color, const SDL_Palette *dst_palette) {
-    int best_distance = INT_MAX;
-    Uint8 best_index = 0;
     if (!dst_palette || dst_palette->ncolors <= 0) {
         return 0;
     }
-
-    const bool is_screen_palette = (dst_palette == get_screen_palette());
-
-    for (int i = 0; i < dst_palette->ncolors; ++i) {
-        // HDMI scanout reserves 240..243 for control/sync patterns.
-        if (is_screen_palette && i >= 240 && i <= 243) {
-            continue;
-        }
-        const SDL_Color *dst_color = &dst_palette->colors[i];
-        int dr = (int)src_color->r - (int)dst_color->r;
-        int dg = (int)src_color->g - (int)dst_color->g;
-        int db = (int)src_color->b - (int)dst_color->b;
-        int distance = dr * dr + dg * dg + db * db;
-        if (distance < best_distance) {
-            best_distance = distance;
-            best_index = (Uint8)i;
-            if (distance == 0) {
-                break;
-            }
-        }
-    }
-    return best_index;
+    const blit_palette_t pal = blit_palette(dst_palette);
+    return blit_core_nearest(&pal, src_color->r, src_color->g, src_color->b);
 }
 
 // Globals
 static SDL_Surface *screen_surface = NULL;
 static uint32_t start_time = 0;
 
+static void rp_sdl_teardown(void);
+static bool rp_sdl_teardown_check(void);
+
 int SDL_Init(Uint32 flags) {
     // HDMI and PS2 are initialized in main.c before calling pop_main
     // But if pop_main calls SDL_Init, we can just return success.
     start_time = time_us_32() / 1000;
+    teardown_register("rp_sdl", rp_sdl_teardown, rp_sdl_teardown_check);
     return 0;
 }
 
@@ -611,71 +607,64 @@ int SDL_BlitSurface(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst,
         blit_debug_count++;
     }
 
+    Uint8 *d_first = dst_pixels + d_rect.y * dst->pitch + d_rect.x * dst_bpp;
+    if (paletted_copy) {
+        // Mirrored view: logical column x is stored at physical column (w - 1 - x).
+        const bool mirrored = (src->flags & SDL_MIRROR_X) != 0;
+        const Uint8 *s_first = src_pixels + s_rect.y * src->pitch
+            + (mirrored ? src->w - 1 - s_rect.x : s_rect.x);
+        blit_core_key8(d_first, dst->pitch, s_first, src->pitch, mirrored ? -1 : 1, s_rect.w, s_rect.h,
+                       src->use_colorkey ? (Uint8)src->colorkey : BLIT_CORE_NO_KEY,
+                       use_palette_map ? palette_map : NULL);
+        return 0;
+    }
+
+    // 24/32bpp -> 8bpp: nearest colour in the destination palette
+    SDL_Palette *dst_pal = dst->format ? dst->format->palette : NULL;
+    if (!dst_pal) dst_pal = get_screen_palette();
+    const blit_palette_t pal = dst_pal ? blit_palette(dst_pal) : (blit_palette_t){ 0 };
+    const Uint8 *s_first = src_pixels + s_rect.y * src->pitch + s_rect.x * src_bpp;
+    const int32_t key24 = src->use_colorkey ? (int32_t)(src->colorkey & 0xFFFFFF) : BLIT_CORE_NO_KEY;
+    const bool do_blend = (src->blendMode == SDL_BLENDMODE_BLEND) || (src->alphaMod != 255);
+
+    if (src_bpp == 3 && dst_bpp == 1) {
+        // Used for fonts/images loaded as RGB; colorkey is packed RGB
+        blit_core_rgb24_to8(d_first, dst->pitch, s_first, src->pitch, s_rect.w, s_rect.h,
+                            key24, dst_pal ? &pal : NULL);
+        return 0;
+    }
+    if (src_bpp == 4 && dst_bpp == 1) {
+        // Debug: print once per blit
+        static int rgba_blit_count = 0;
+        if (rgba_blit_count < 10) {
+            DBG_PRINTF("[RGBA->8bpp] %dx%d dst_pal=%p ncolors=%d blend=%d alphaMod=%d\n",
+                   s_rect.w, s_rect.h, (void*)dst_pal, 
+                   dst_pal ? dst_pal->ncolors : 0,
+                   src->blendMode, src->alphaMod);
+            Uint32 pix = *(const Uint32 *)s_first;
+            DBG_PRINTF("[RGBA->8bpp] first pixel=0x%08lx (r=%d g=%d b=%d a=%d)\n",
+                   (unsigned long)pix, (int)(pix&0xFF), (int)((pix>>8)&0xFF),
+                   (int)((pix>>16)&0xFF), (int)((pix>>24)&0xFF));
+            rgba_blit_count++;
+        }
+        if (!do_blend) {
+            // stbi loads RGBA into memory; on little-endian, pixel is 0xAABBGGRR.
+            static const blit_rgba_format_t stbi_rgba = { 0x000000FFu, 0x0000FF00u, 0x00FF0000u, 0xFF000000u };
+            blit_core_rgba_to8(d_first, dst->pitch, (const uint32_t *)s_first, src->pitch, s_rect.w, s_rect.h,
+                               &stbi_rgba, key24, false, dst_pal ? &pal : NULL);
+            return 0;
+        }
+    }
+
     for (int y = 0; y < s_rect.h; y++) {
         Uint8 *s_row = src_pixels + (s_rect.y + y) * src->pitch + s_rect.x * src_bpp;
         Uint8 *d_row = dst_pixels + (d_rect.y + y) * dst->pitch + d_rect.x * dst_bpp;
         
-        if (paletted_copy) {
-            for (int x = 0; x < s_rect.w; ++x) {
-                Uint8 pixel = s_row[x];
-                if (src->use_colorkey && pixel == (Uint8)src->colorkey) {
-                    continue;
-                }
-                Uint8 mapped_pixel = use_palette_map ? palette_map[pixel] : pixel;
-                d_row[x] = mapped_pixel;
-            }
-        } else if (src_bpp == 3 && dst_bpp == 1) {
-            // 24bpp -> 8bpp conversion (No Alpha)
-            // Used for fonts/images loaded as RGB
-            SDL_Palette *dst_pal = dst->format->palette;
-            if (!dst_pal) dst_pal = get_screen_palette();
-
-            for (int x = 0; x < s_rect.w; ++x) {
-                Uint8 r = s_row[x * 3];
-                Uint8 g = s_row[x * 3 + 1];
-                Uint8 b = s_row[x * 3 + 2];
-
-                // Check colorkey if enabled
-                if (src->use_colorkey) {
-                    Uint32 pixel = (r << 16) | (g << 8) | b;
-                    // Colorkey for 24bpp is usually packed RGB
-                    if ((pixel & 0xFFFFFF) == (src->colorkey & 0xFFFFFF)) {
-                        continue; // Transparent
-                    }
-                }
-
-                if (dst_pal) {
-                    SDL_Color c = {r, g, b, 255};
-                    d_row[x] = find_best_palette_index(&c, dst_pal);
-                } else {
-                    d_row[x] = 15; // White fallback
-                }
-            }
-        } else if (src_bpp == 4 && dst_bpp == 1) {
-            // 32bpp -> 8bpp conversion
+        if (src_bpp == 4 && dst_bpp == 1) {
+            // 32bpp -> 8bpp with blending
             Uint32 *s_row_32 = (Uint32*)s_row;
-            SDL_Palette *dst_pal = dst->format->palette;
-            if (!dst_pal) dst_pal = get_screen_palette();
-
-            // Debug: print once per blit
-            static int rgba_blit_count = 0;
-            if (y == 0 && rgba_blit_count < 10) {
-                DBG_PRINTF("[RGBA->8bpp] %dx%d dst_pal=%p ncolors=%d blend=%d alphaMod=%d\n",
-                       s_rect.w, s_rect.h, (void*)dst_pal, 
-                       dst_pal ? dst_pal->ncolors : 0,
-                       src->blendMode, src->alphaMod);
-                if (s_rect.w > 0) {
-                    Uint32 pix = s_row_32[0];
-                    DBG_PRINTF("[RGBA->8bpp] first pixel=0x%08lx (r=%d g=%d b=%d a=%d)\n",
-                           (unsigned long)pix, (int)(pix&0xFF), (int)((pix>>8)&0xFF),
-                           (int)((pix>>16)&0xFF), (int)((pix>>24)&0xFF));
-                }
-                rgba_blit_count++;
-            }
-
             for (int x = 0; x < s_rect.w; ++x) {
                 Uint32 pixel = s_row_32[x];
-                // stbi loads RGBA into memory; on little-endian, pixel is 0xAABBGGRR.
                 const Uint8 r = (Uint8)(pixel & 0xFF);
                 const Uint8 g = (Uint8)((pixel >> 8) & 0xFF);
                 const Uint8 b = (Uint8)((pixel >> 16) & 0xFF);
@@ -687,18 +676,6 @@ int SDL_BlitSurface(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst,
                     }
                 }
 
-                const bool do_blend = (src->blendMode == SDL_BLENDMODE_BLEND) || (src->alphaMod != 255);
-
-                if (!do_blend) {
-                    if (dst_pal) {
-                        SDL_Color c = { r, g, b, 255 };
-                        d_row[x] = find_best_palette_index(&c, dst_pal);
-                    } else {
-                        d_row[x] = 15; // White fallback
-                    }
-                    continue;
-                }
-
                 // Effective alpha = src alpha * surface alphaMod.
                 Uint32 a_eff = (Uint32)a;
                 if (src->alphaMod != 255) {
@@ -810,11 +787,13 @@ int SDL_FillRect(SDL_Surface *dst, const SDL_Rect *rect, Uint32 color) {
 
     const int bpp = dst->format->BytesPerPixel ? dst->format->BytesPerPixel : 1;
     Uint8 *dst_pixels = (Uint8 *)dst->pixels;
+    if (bpp == 1) {
+        blit_core_fill8(dst_pixels + d_rect.y * dst->pitch + d_rect.x, dst->pitch, d_rect.w, d_rect.h, (Uint8)color);
+        return 0;
+    }
     for (int y = 0; y < d_rect.h; y++) {
         Uint8 *d_row = dst_pixels + (d_rect.y + y) * dst->pitch + d_rect.x * bpp;
-        if (bpp == 1) {
-            memset(d_row, (Uint8)color, (size_t)d_rect.w);
-        } else if (bpp == 4) {
+        if (bpp == 4) {
             Uint32 *d32 = (Uint32 *)d_row;
             for (int x = 0; x < d_rect.w; ++x) d32[x] = color;
         } else if (bpp == 3) {
@@ -932,6 +911,33 @@ int SDL_UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect, const void *pi
     // Debug/heartbeat
     static int frame_count = 0;
     static int last_pitch = -1;
+
+    if (rect) {
+        // Partial update (dirty-rect presentation, 8bpp indexed only).
+        // As in SDL, `pixels` points at the rect's top-left pixel.
+        int rx = rect->x, ry = rect->y, rw = rect->w, rh = rect->h;
+        if (rx < 0) { src -= rx; rw += rx; rx = 0; }
+        if (ry < 0) { src -= ry * pitch; rh += ry; ry = 0; }
+        if (rx + rw > w) rw = w - rx;
+        if (ry + rh > h) rh = h - ry;
+        if (!src || rw <= 0 || rh <= 0) {
+            return 0;
+        }
+        for (int y = 0; y < rh; y++) {
+            Uint8 *drow = dst + (ry + y + y_offset) * dst_pitch + rx;
+            memcpy(drow, src + y * pitch, rw);
+            // HDMI scanout reservation: indices 240..243 are control/sync codes.
+            for (int x = 0; x < rw; ++x) {
+                if (drow[x] >= 240 && drow[x] <= 243) drow[x] = 255;
+            }
+        }
+        // The game-area update (top-left origin) stands in for a frame for the heartbeat.
+        if (rx == 0 && ry == 0 && (++frame_count % 60) == 0) {
+            gpio_put(25, !gpio_get(25));
+        }
+        return 0;
+    }
+
     frame_count++;
 
     // If SDLPoP accidentally corrupts the onscreen surface's format fields (e.g. flips it to 32bpp),
@@ -1122,62 +1128,94 @@ Uint32 SDL_GetTicks(void) {
     return (time_us_32() / 1000) - start_time;
 }
 
-static Uint8 keyboard_state[SDL_NUM_SCANCODES];
+// Held keys per keyboard (PS/2, USB), combined over both.
+static key_state_t key_state;
+
+// The same keys after the bindings (key_bindings.h): what the game sees
+// and what SDL_GetKeyboardState returns. Several raw keys can stand for
+// one game key, so each counts its holders; pressed_as remembers what a
+// held raw key was handed over as (0 = swallowed), for its release.
+static Uint8 game_keys[SDL_NUM_SCANCODES];
+static Uint8 game_key_holders[SDL_NUM_SCANCODES];
+static Uint16 pressed_as[SDL_NUM_SCANCODES];
+static Uint16 pressed_mod[SDL_NUM_SCANCODES];
 
 // Buffered events for returning one at a time
 static SDL_Event pending_events[32];
 static int pending_event_count = 0;
 static int pending_event_index = 0;
 
-// Key timeout tracking to auto-release stuck keys
-// Only track movement keys (arrows) and shift - these are most likely to "stick"
-#define KEY_TIMEOUT_MS 500  // Auto-release after 500ms with no new press
-static Uint32 key_press_time[SDL_NUM_SCANCODES];
-
-// List of scancodes to apply timeout to (movement-critical keys)
-static const int timeout_scancodes[] = {
-    79,  // SDL_SCANCODE_RIGHT
-    80,  // SDL_SCANCODE_LEFT
-    81,  // SDL_SCANCODE_DOWN
-    82,  // SDL_SCANCODE_UP
-    225, // SDL_SCANCODE_LSHIFT
-    229, // SDL_SCANCODE_RSHIFT
-    -1   // Sentinel
-};
-
-static void check_key_timeouts(void) {
-    Uint32 now = (time_us_32() / 1000);
-    
-    for (int i = 0; timeout_scancodes[i] >= 0; i++) {
-        int sc = timeout_scancodes[i];
-        if (keyboard_state[sc] && key_press_time[sc] != 0) {
-            Uint32 elapsed = now - key_press_time[sc];
-            // Only timeout if the key has been held for a while AND neither
-            // PS/2 nor USB HID driver thinks it's pressed
-            int key_still_pressed = ps2kbd_is_key_pressed(sc);
-            #ifdef USB_HID_ENABLED
-            key_still_pressed = key_still_pressed || usbhid_sdl_is_key_pressed(sc);
-            #endif
-            if (elapsed > KEY_TIMEOUT_MS && !key_still_pressed) {
-                // Generate a synthetic release event
-                if (pending_event_count < 32) {
-                    keyboard_state[sc] = 0;
-                    key_press_time[sc] = 0;
-                    
-                    SDL_Event* ev = &pending_events[pending_event_count++];
-                    memset(ev, 0, sizeof(*ev));
-                    ev->type = SDL_KEYUP;
-                    ev->key.keysym.scancode = sc;
-                    ev->key.keysym.sym = sc;
-                    ev->key.keysym.mod = 0;
-                    ev->key.state = 0;
-                    ev->key.repeat = 0;
-                }
-            }
+// SDLPoP's sound switch (Ctrl+S), shown on the PS/2 Scroll Lock LED.
+extern unsigned char is_sound_on;
+
+// Modifiers from the game's view: Shift on one keyboard and an arrow
+// on the other still make Shift+arrow, and a key bound to shift counts.
+static int game_key_mod(void) {
+    const Uint8 *held = game_keys;
+    int mod = 0;
+    if (held[SDL_SCANCODE_LSHIFT] || held[SDL_SCANCODE_RSHIFT]) mod |= KMOD_SHIFT;
+    if (held[SDL_SCANCODE_LCTRL] || held[SDL_SCANCODE_RCTRL]) mod |= KMOD_CTRL;
+    if (held[SDL_SCANCODE_LALT] || held[SDL_SCANCODE_RALT]) mod |= KMOD_ALT;
+    return mod;
+}
+
+// Apply one keyboard event; buffer an SDL event only if the game key it
+// is bound to changed.
+static void buffer_key_event(key_source_t source, int pressed, int scancode) {
+    if (!key_state_update(&key_state, source, scancode, pressed != 0)) return;
+
+    int game_scancode, game_mod = 0;
+    if (pressed) {
+        if (!key_bindings_resolve(key_bindings_active(), scancode, game_key_mod(),
+                                  &game_scancode, &game_mod) ||
+            game_scancode <= 0 || game_scancode >= SDL_NUM_SCANCODES) {
+            return;
         }
+        pressed_as[scancode] = (Uint16)game_scancode;
+        pressed_mod[scancode] = (Uint16)game_mod;
+        if (game_key_holders[game_scancode]++ > 0) return;
+        game_keys[game_scancode] = 1;
+    } else {
+        game_scancode = pressed_as[scancode];
+        game_mod = pressed_mod[scancode];
+        pressed_as[scancode] = 0;
+        if (!game_scancode || game_key_holders[game_scancode] == 0) return;
+        if (--game_key_holders[game_scancode] > 0) return;
+        game_keys[game_scancode] = 0;
     }
+
+    SDL_Event* ev = &pending_events[pending_event_count++];
+    memset(ev, 0, sizeof(*ev));
+    ev->type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+    ev->key.keysym.scancode = game_scancode;
+    ev->key.keysym.sym = game_scancode;
+    ev->key.keysym.mod = game_key_mod() | game_mod;
+    ev->key.state = pressed ? 1 : 0;
+    ev->key.repeat = 0;
+    latency_probe_key(source, pressed != 0);
 }
 
+// USB mouse as a cursor on the 320x200 screen (SDL_GetMouseState)
+static int mouse_x = 160, mouse_y = 100;
+static Uint32 mouse_buttons;
+
+#ifdef USB_HID_ENABLED
+static void update_mouse(void) {
+    int dx, dy, buttons;
+    if (!usbhid_sdl_get_mouse(&dx, &dy, &buttons)) return;
+    mouse_x += dx;
+    mouse_y += dy;
+    if (mouse_x < 0) mouse_x = 0;
+    if (mouse_x > 319) mouse_x = 319;
+    if (mouse_y < 0) mouse_y = 0;
+    if (mouse_y > 199) mouse_y = 199;
+    mouse_buttons = 0;
+    if (buttons & 1) mouse_buttons |= SDL_BUTTON_LMASK;
+    if (buttons & 2) mouse_buttons |= SDL_BUTTON_RMASK;
+    if (buttons & 4) mouse_buttons |= SDL_BUTTON_MMASK;
+}
+#endif
+
 int SDL_PollEvent(SDL_Event *event) {
     // Pump audio buffers on every event poll
     #if RP_SDL_FEATURE_AUDIO
@@ -1186,64 +1224,47 @@ int SDL_PollEvent(SDL_Event *event) {
     
     // Poll PS/2 keyboard - process ALL pending PS/2 scancodes
     ps2kbd_tick();
+    ps2kbd_set_leds(is_sound_on ? PS2_LED_SCROLL : 0);
     
     // Poll USB HID keyboard
     #ifdef USB_HID_ENABLED
     usbhid_sdl_tick();
+    update_mouse();
     #endif
+
+    // SD log sink: a little of the log per frame
+    log_sink_pump();
+
+    // Serial test commands (no-op unless built in)
+    serial_link_poll();
+
+    // Latency measurement (no-op unless built in)
+    latency_probe_poll();
     
     // If we have no buffered events, drain all events from PS/2 and USB queues
     if (pending_event_index >= pending_event_count) {
         pending_event_count = 0;
         pending_event_index = 0;
         
-        Uint32 now = (time_us_32() / 1000);
         int pressed, scancode, modifier;
+        latency_probe_drain();
         
         // Drain PS/2 events
         while (pending_event_count < 32 && ps2kbd_get_key(&pressed, &scancode, &modifier)) {
-            // Update keyboard state immediately
-            if (scancode >= 0 && scancode < SDL_NUM_SCANCODES) {
-                keyboard_state[scancode] = pressed ? 1 : 0;
-                // Track press time for timeout
-                key_press_time[scancode] = pressed ? now : 0;
-            }
-            
-            // Buffer the event
-            SDL_Event* ev = &pending_events[pending_event_count++];
-            memset(ev, 0, sizeof(*ev));
-            ev->type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
-            ev->key.keysym.scancode = scancode;
-            ev->key.keysym.sym = scancode;
-            ev->key.keysym.mod = modifier;
-            ev->key.state = pressed ? 1 : 0;
-            ev->key.repeat = 0;
+            buffer_key_event(KEY_SOURCE_PS2, pressed, scancode);
         }
         
         // Drain USB HID events
         #ifdef USB_HID_ENABLED
         while (pending_event_count < 32 && usbhid_sdl_get_key(&pressed, &scancode, &modifier)) {
-            // Update keyboard state immediately
-            if (scancode >= 0 && scancode < SDL_NUM_SCANCODES) {
-                keyboard_state[scancode] = pressed ? 1 : 0;
-                // Track press time for timeout
-                key_press_time[scancode] = pressed ? now : 0;
-            }
-            
-            // Buffer the event
-            SDL_Event* ev = &pending_events[pending_event_count++];
-            memset(ev, 0, sizeof(*ev));
-            ev->type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
-            ev->key.keysym.scancode = scancode;
-            ev->key.keysym.sym = scancode;
-            ev->key.keysym.mod = modifier;
-            ev->key.state = pressed ? 1 : 0;
-            ev->key.repeat = 0;
+            buffer_key_event(KEY_SOURCE_USB, pressed, scancode);
         }
         #endif
-        
-        // Check for stuck keys and auto-release them
-        check_key_timeouts();
+
+        // Drain injected key events that are due
+        while (pending_event_count < 32 && serial_link_get_key(&pressed, &scancode)) {
+            buffer_key_event(KEY_SOURCE_SERIAL, pressed, scancode);
+        }
     }
     
     // Return next buffered event
@@ -1260,7 +1281,7 @@ int SDL_PollEvent(SDL_Event *event) {
 
 const Uint8 *SDL_GetKeyboardState(int *numkeys) {
     if (numkeys) *numkeys = SDL_NUM_SCANCODES;
-    return keyboard_state;
+    return game_keys;
 }
 
 // -----------------------------------------------------------------------------
@@ -1316,6 +1337,9 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained) {
     }
 
     g_audio_initialized = true;
+    if (audio_i2s_driver_runs_on_core1()) {
+        crash_guard_set_audio_probe(audio_i2s_driver_heartbeat);
+    }
     g_audio_paused = true;  // Start paused (SDL convention)
 
     DBG_PRINTF("SDL_OpenAudio: success\\n");
@@ -1343,6 +1367,7 @@ void SDL_PauseAudio(int pause_on) {
 void SDL_CloseAudio(void) {
     if (!g_audio_initialized) return;
     DBG_PRINTF("SDL_CloseAudio\\n");
+    crash_guard_set_audio_probe(NULL);
     audio_i2s_driver_shutdown();
     g_audio_initialized = false;
     g_audio_paused = true;
@@ -1368,6 +1393,10 @@ void SDL_AudioPump(void) {
     }
 }
 
+static bool rp_sdl_audio_is_open(void) {
+    return g_audio_initialized;
+}
+
 #else
 // Audio disabled - stub implementations
 int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained) {
@@ -1381,6 +1410,7 @@ void SDL_CloseAudio(void) {}
 void SDL_LockAudio(void) {}
 void SDL_UnlockAudio(void) {}
 void SDL_AudioPump(void) {}
+static bool rp_sdl_audio_is_open(void) { return false; }
 #endif
 
 // RWops implementation for memory
@@ -1466,7 +1496,45 @@ SDL_RWops *SDL_RWFromMem(void *mem, int size) {
     return SDL_RWFromConstMem(mem, size);
 }
 
+// RWops for writing: goes straight to pop_fs, so the file is only replaced
+// once SDL_RWclose() commits it (see pop_fs_close()).
+static size_t file_write(SDL_RWops *context, const void *ptr, size_t size, size_t num) {
+    return pop_fs_write(ptr, size, num, (FIL*)context->file);
+}
+
+static Sint32 file_seek(SDL_RWops *context, Sint32 offset, int whence) {
+    FIL* fil = (FIL*)context->file;
+    if (pop_fs_seek(fil, offset, whence) != 0) return -1;
+    return (Sint32)pop_fs_tell(fil);
+}
+
+static int file_close(SDL_RWops *context) {
+    int result = 0;
+    if (context) {
+        result = pop_fs_close((FIL*)context->file);
+        free(context);
+    }
+    return result;
+}
+
 SDL_RWops *SDL_RWFromFile(const char *file, const char *mode) {
+    if (mode && (strchr(mode, 'w') || strchr(mode, 'a'))) {
+        FIL* fil = pop_fs_open(file, mode);
+        if (!fil) return NULL;
+        SDL_RWops *rw = (SDL_RWops *)calloc(1, sizeof(SDL_RWops));
+        if (!rw) {
+            pop_fs_discard(fil);
+            return NULL;
+        }
+        rw->read = mem_read;  // base == stop: reads return nothing
+        rw->write = file_write;
+        rw->seek = file_seek;
+        rw->close = file_close;
+        rw->file = fil;
+        rw->type = 3;
+        return rw;
+    }
+
     static bool printed = false;
     const bool do_print = (!printed);
     if (do_print) {
@@ -1551,6 +1619,7 @@ Sint32 SDL_RWseek(SDL_RWops *context, Sint32 offset, int whence) {
 
 Sint32 SDL_RWtell(SDL_RWops *context) {
     if (context && (context->type == 1 || context->type == 2)) return mem_tell(context);
+    if (context && context->type == 3) return (Sint32)pop_fs_tell((FIL*)context->file);
     return -1;
 }
 
@@ -1638,9 +1707,9 @@ void SDL_RenderGetViewport(SDL_Renderer *renderer, SDL_Rect *rect) {
 }
 
 Uint32 SDL_GetMouseState(int *x, int *y) {
-    if (x) *x = 0;
-    if (y) *y = 0;
-    return 0;
+    if (x) *x = mouse_x;
+    if (y) *y = mouse_y;
+    return mouse_buttons;
 }
 
 int SDL_SetWindowFullscreen(SDL_Window *window, Uint32 flags) {
@@ -2116,3 +2185,32 @@ void debug_blink(int count) {
     }
     sleep_ms(1000); // Longer pause between codes
 }
+
+// Session teardown (see teardown.h): SDLPoP is re-entered after quit(), so
+// drop everything the shim keeps across calls.
+static void rp_sdl_teardown(void) {
+    SDL_CloseAudio();
+
+    pending_event_count = 0;
+    pending_event_index = 0;
+    key_state_init(&key_state);
+    memset(game_keys, 0, sizeof(game_keys));
+    memset(game_key_holders, 0, sizeof(game_key_holders));
+    memset(pressed_as, 0, sizeof(pressed_as));
+
+    // The screen palette (and everything else in PSRAM) is about to be reclaimed.
+    rp2350_rgb_to_idx_ready = false;
+    rp2350_rgb_to_idx_dirty = true;
+    screen_surface = NULL;
+#if RP2350_POP_ONSCREEN_PIXELS_IN_SRAM_TEST
+    g_pop_onscreen_pixels_in_use = false;
+#endif
+}
+
+static bool rp_sdl_teardown_check(void) {
+    if (rp_sdl_audio_is_open()) {
+        DBG_PRINTF("[rp_sdl] audio still open after teardown\n");
+        return false;
+    }
+    return true;
+}
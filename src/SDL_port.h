@@ -43,6 +43,7 @@ typedef int64_t Sint64;
 #define SDL_RENDERER_TARGETTEXTURE 0x00000008
 #define SDL_FORCE_FULL_PALETTE 0x80000000u
 #define SDL_NO_PALETTE 0x40000000u  // Skip palette allocation for surfaces that will adopt an existing palette
+#define SDL_MIRROR_X 0x20000000u    // Surface view whose columns are read right-to-left (8bpp blits only)
 
 #define SDL_HINT_WINDOWS_DISABLE_THREAD_NAMING "SDL_WINDOWS_DISABLE_THREAD_NAMING"
 #define SDL_HINT_RENDER_SCALE_QUALITY "SDL_RENDER_SCALE_QUALITY"
@@ -275,6 +276,10 @@ typedef int SDL_Scancode;
 #define SDL_BUTTON_LEFT 1
 #define SDL_BUTTON_RIGHT 3
 #define SDL_BUTTON_X1 4
+#define SDL_BUTTON(X) (1 << ((X) - 1))
+#define SDL_BUTTON_LMASK SDL_BUTTON(SDL_BUTTON_LEFT)
+#define SDL_BUTTON_MMASK SDL_BUTTON(2)
+#define SDL_BUTTON_RMASK SDL_BUTTON(SDL_BUTTON_RIGHT)
 
 #define KMOD_SHIFT 0x0003
 #define KMOD_CTRL 0x00C0
@@ -544,7 +549,8 @@ typedef struct SDL_RWops {
     const Uint8 *base;
     const Uint8 *here;
     const Uint8 *stop;
-    Uint32 type; // 0 = unknown, 1 = memory
+    Uint32 type; // 0 = unknown, 1 = memory, 2 = owned file buffer, 3 = file being written
+    void *file;  // type 3: FIL* from pop_fs_open()
 } SDL_RWops;
 
 SDL_RWops *SDL_RWFromFile(const char *file, const char *mode);
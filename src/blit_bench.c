@@ -0,0 +1,286 @@
+/*
+ * murmprince - Blitter micro-benchmark
+ *
+ * Each case blits a synthetic sprite (sizes taken from the real KID, GUARD,
+ * VPALACE and font chtabs) into a 320x200 8bpp target for enough iterations
+ * to run ~20 ms, and prints one CSV line per (case, size, src mem, dst mem):
+ *
+ *   BENCH,<case>,<sprite>,<w>,<h>,<src_mem>,<dst_mem>,<iters>,<total_us>,
+ *         <ns_per_px>,<bytes_per_iter>,<mb_per_s>
+ *
+ * bytes_per_iter counts source bytes read plus destination bytes written
+ * (destination reads for transparent/or/xor modes are not counted).
+ * Lines are stable and parseable so runs can be diffed across builds.
+ * tools/blit_bench.c runs the same cases on a host, through the pixel
+ * loops of src/blit_core.c.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "blit_bench.h"
+#include "common.h"
+#include "psram_allocator.h"
+#include "clock_select.h"
+#include "pico/stdlib.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if RP2350_BLIT_BENCH
+
+#define BENCH_TARGET_US 20000
+#define BENCH_MIN_ITERS 4
+#define BENCH_DST_W 320
+#define BENCH_DST_H 200
+
+#define BENCH_IS_PSRAM(ptr) ((uintptr_t)(ptr) >= 0x11000000 && (uintptr_t)(ptr) < 0x12000000)
+
+typedef enum {
+    BENCH_M6_NO_TRANSP,   // method_6, blitters_0_no_transp
+    BENCH_M6_TRANSP,      // method_6, blitters_10h_transp
+    BENCH_M6_OR,          // method_6, blitters_2_or
+    BENCH_M6_XOR,         // method_6, blitters_3_xor (shadow)
+    BENCH_M6_RGBA,        // method_6, 32bpp source -> indexed target (manual path)
+    BENCH_MONO,           // method_3_blit_mono (text glyphs, blitters_9_black)
+    BENCH_CONV_24_TO_8,   // SDL_BlitSurface 24bpp -> 8bpp
+    BENCH_CONV_32_TO_8,   // SDL_BlitSurface 32bpp -> 8bpp
+    BENCH_M1_RECT,        // method_1_blit_rect (room copies)
+    BENCH_FILL_RECT,      // SDL_FillRect
+    BENCH_CASE_COUNT
+} bench_case_t;
+
+static const char *const bench_case_names[BENCH_CASE_COUNT] = {
+    "m6_no_transp",
+    "m6_transp",
+    "m6_or",
+    "m6_xor",
+    "m6_rgba",
+    "mono",
+    "conv_24_to_8",
+    "conv_32_to_8",
+    "m1_rect",
+    "fill_rect",
+};
+
+typedef struct {
+    const char *name;
+    int w;
+    int h;
+} bench_size_t;
+
+// Representative image sizes from the shipped chtabs.
+static const bench_size_t sprite_sizes[] = {
+    { "font_glyph", 7, 8 },     // small font character
+    { "hp_cell", 7, 5 },        // HP triangle
+    { "kid_frame", 26, 44 },    // typical KID running frame
+    { "guard_frame", 36, 44 },  // guard swinging sword
+    { "tile_wall", 32, 63 },    // VPALACE wall piece
+};
+
+// method_1/FillRect operate on screen regions rather than sprites.
+static const bench_size_t rect_sizes[] = {
+    { "peel", 40, 64 },         // typical peel/drect
+    { "room_half", 320, 96 },   // half of rect_top
+};
+
+static SDL_Surface *bench_create_surface(int w, int h, int depth, bool in_sram, bool with_palette) {
+    // SRAM mode routes psram_malloc() to malloc(); temp mode keeps the PSRAM
+    // allocations out of the permanent bump area so they can be dropped.
+    psram_set_sram_mode(in_sram ? 1 : 0);
+    psram_set_temp_mode(in_sram ? 0 : 1);
+    Uint32 flags = with_palette ? 0 : SDL_NO_PALETTE;
+    SDL_Surface *s;
+    if (depth == 32) {
+        s = SDL_CreateRGBSurface(flags, w, h, 32, 0x000000ffu, 0x0000ff00u, 0x00ff0000u, 0xff000000u);
+    } else {
+        s = SDL_CreateRGBSurface(flags, w, h, depth, 0, 0, 0, 0);
+    }
+    psram_set_temp_mode(0);
+    psram_set_sram_mode(0);
+    return s;
+}
+
+static void bench_free_surface(SDL_Surface *s) {
+    // PSRAM pieces are reclaimed by psram_reset_temp(); SRAM pieces are freed here.
+    if (s) SDL_FreeSurface(s);
+}
+
+// Fill a source sprite with a deterministic pattern: ~1/4 transparent (0),
+// the rest spread over the palette (mono sources use 0/1 only).
+static void bench_fill_source(SDL_Surface *s, bool mono) {
+    uint32_t seed = 0x12345678u;
+    for (int y = 0; y < s->h; ++y) {
+        uint8_t *row = (uint8_t *)s->pixels + y * s->pitch;
+        for (int x = 0; x < s->w; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            const uint8_t v = (uint8_t)(seed >> 24);
+            const bool transparent = (v & 3) == 0;
+            if (s->format->BytesPerPixel == 1) {
+                row[x] = transparent ? 0 : (mono ? 1 : (uint8_t)(1 + (v % 200)));
+            } else if (s->format->BytesPerPixel == 3) {
+                row[x * 3 + 0] = transparent ? 0 : v;
+                row[x * 3 + 1] = (uint8_t)(v * 3);
+                row[x * 3 + 2] = (uint8_t)(v * 7);
+            } else {
+                uint32_t *row32 = (uint32_t *)row;
+                row32[x] = transparent ? 0 : (0xff000000u | (seed & 0x00ffffffu));
+            }
+        }
+    }
+}
+
+static void bench_fill_palette(SDL_Surface *dst) {
+    if (!dst->format->palette) return;
+    SDL_Color colors[256];
+    for (int i = 0; i < 256; ++i) {
+        colors[i].r = (Uint8)((i & 0xE0));
+        colors[i].g = (Uint8)((i & 0x1C) << 3);
+        colors[i].b = (Uint8)((i & 0x03) << 6);
+        colors[i].a = 255;
+    }
+    SDL_SetPaletteColors(dst->format->palette, colors, 0, 256);
+}
+
+static int bench_src_depth(bench_case_t c) {
+    switch (c) {
+        case BENCH_M6_RGBA:
+        case BENCH_CONV_32_TO_8:
+            return 32;
+        case BENCH_CONV_24_TO_8:
+            return 24;
+        default:
+            return 8;
+    }
+}
+
+// One call of the path under test. Positions walk across the target so
+// consecutive iterations don't hit the same cache lines.
+static void bench_blit_once(bench_case_t c, SDL_Surface *src, SDL_Surface *dst, int iter) {
+    const int max_x = dst->w - src->w;
+    const int max_y = dst->h - src->h;
+    const int x = max_x > 0 ? (iter * 37) % (max_x + 1) : 0;
+    const int y = max_y > 0 ? (iter * 13) % (max_y + 1) : 0;
+    SDL_Rect src_rect = { 0, 0, src->w, src->h };
+    SDL_Rect dst_rect = { x, y, src->w, src->h };
+
+    switch (c) {
+        case BENCH_M6_NO_TRANSP:
+            method_6_blit_img_to_scr(src, x, y, blitters_0_no_transp);
+            break;
+        case BENCH_M6_TRANSP:
+        case BENCH_M6_RGBA:
+            method_6_blit_img_to_scr(src, x, y, blitters_10h_transp);
+            break;
+        case BENCH_M6_OR:
+            method_6_blit_img_to_scr(src, x, y, blitters_2_or);
+            break;
+        case BENCH_M6_XOR:
+            method_6_blit_img_to_scr(src, x, y, blitters_3_xor);
+            break;
+        case BENCH_MONO:
+            method_3_blit_mono(src, x, y, blitters_9_black, 15);
+            break;
+        case BENCH_CONV_24_TO_8:
+        case BENCH_CONV_32_TO_8:
+            SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(src, &src_rect, dst, &dst_rect);
+            break;
+        case BENCH_M1_RECT: {
+            rect_type r = { (short)y, (short)x, (short)(y + src->h), (short)(x + src->w) };
+            rect_type sr = { 0, 0, (short)src->h, (short)src->w };
+            method_1_blit_rect(dst, src, &r, &sr, blitters_0_no_transp);
+            break;
+        }
+        case BENCH_FILL_RECT:
+            SDL_FillRect(dst, &dst_rect, (Uint32)(iter & 0xFF));
+            break;
+        default:
+            break;
+    }
+}
+
+static void bench_run_case(bench_case_t c, const bench_size_t *size, bool src_sram, bool dst_sram) {
+    const int depth = bench_src_depth(c);
+    SDL_Surface *dst = bench_create_surface(BENCH_DST_W, BENCH_DST_H, 8, dst_sram, true);
+    SDL_Surface *src = (c == BENCH_FILL_RECT) ? NULL
+        : bench_create_surface(size->w, size->h, depth, src_sram, false);
+    if (!dst || (c != BENCH_FILL_RECT && !src)) {
+        printf("BENCH_SKIP,%s,%s,alloc_failed\n", bench_case_names[c], size->name);
+        bench_free_surface(src);
+        bench_free_surface(dst);
+        return;
+    }
+    bench_fill_palette(dst);
+    if (src) bench_fill_source(src, c == BENCH_MONO);
+
+    // FillRect has no source; use a throwaway surface of the right size for positions.
+    SDL_Surface shape = { 0 };
+    shape.w = size->w;
+    shape.h = size->h;
+    SDL_Surface *geom = src ? src : &shape;
+
+    SDL_Surface *saved_target = current_target_surface;
+    current_target_surface = dst;
+
+    // Warm up (first-call debug output, palette caches), then calibrate.
+    bench_blit_once(c, geom, dst, 0);
+    uint64_t t0 = time_us_64();
+    bench_blit_once(c, geom, dst, 1);
+    uint64_t one = time_us_64() - t0;
+    int iters = one > 0 ? (int)(BENCH_TARGET_US / one) : 1000;
+    if (iters < BENCH_MIN_ITERS) iters = BENCH_MIN_ITERS;
+    if (iters > 20000) iters = 20000;
+
+    t0 = time_us_64();
+    for (int i = 0; i < iters; ++i) {
+        bench_blit_once(c, geom, dst, i);
+    }
+    const uint64_t total_us = time_us_64() - t0;
+
+    current_target_surface = saved_target;
+
+    const uint32_t pixels = (uint32_t)(size->w * size->h);
+    const uint32_t bytes_per_iter = pixels * (uint32_t)(src ? (depth / 8) : 0) + pixels;
+    const double ns_per_px = (double)total_us * 1000.0 / ((double)iters * (double)pixels);
+    const double mb_per_s = total_us ? ((double)bytes_per_iter * (double)iters) / (double)total_us : 0.0;
+
+    printf("BENCH,%s,%s,%d,%d,%s,%s,%d,%llu,%.3f,%lu,%.2f\n",
+           bench_case_names[c], size->name, size->w, size->h,
+           c == BENCH_FILL_RECT ? "none" : (BENCH_IS_PSRAM(src->pixels) ? "psram" : "sram"),
+           BENCH_IS_PSRAM(dst->pixels) ? "psram" : "sram",
+           iters, (unsigned long long)total_us, ns_per_px,
+           (unsigned long)bytes_per_iter, mb_per_s);
+
+    bench_free_surface(src);
+    bench_free_surface(dst);
+    psram_reset_temp();
+}
+
+void blit_bench_run(void) {
+    printf("BENCH_BEGIN,cpu_mhz=%u,psram_mhz=%u\n", clock_select_cpu_mhz(), clock_select_psram_mhz());
+    printf("BENCH_HEADER,case,sprite,w,h,src_mem,dst_mem,iters,total_us,ns_per_px,bytes_per_iter,mb_per_s\n");
+    for (int mem = 0; mem < 4; ++mem) {
+        const bool src_sram = (mem & 1) != 0;
+        const bool dst_sram = (mem & 2) != 0;
+        for (int c = 0; c < BENCH_CASE_COUNT; ++c) {
+            const bool rect_case = (c == BENCH_M1_RECT || c == BENCH_FILL_RECT);
+            // FillRect has no source; only vary the destination.
+            if (c == BENCH_FILL_RECT && src_sram) continue;
+            const bench_size_t *sizes = rect_case ? rect_sizes : sprite_sizes;
+            const int n_sizes = rect_case ? (int)COUNT(rect_sizes) : (int)COUNT(sprite_sizes);
+            for (int s = 0; s < n_sizes; ++s) {
+                // Glyph-sized mono sources are the only realistic mono case.
+                if (c == BENCH_MONO && sizes[s].w > 8) continue;
+                bench_run_case((bench_case_t)c, &sizes[s], src_sram, dst_sram);
+            }
+        }
+    }
+    printf("BENCH_END\n");
+    fflush(stdout);
+}
+
+#else
+
+void blit_bench_run(void) {}
+
+#endif // RP2350_BLIT_BENCH
@@ -0,0 +1,24 @@
+/*
+ * murmprince - Blitter micro-benchmark
+ *
+ * Times the SDLPoP blit paths (method_6 modes, mono text, 24/32->8
+ * conversion, method_1 rect copies, SDL_FillRect) on synthetic sprites
+ * with real chtab sizes, for every SRAM/PSRAM source/destination
+ * combination. Results go to stdio as CSV lines prefixed with "BENCH,".
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Run the whole suite once. Requires PSRAM, HDMI and the palette to be
+// initialized (it leaves the SDLPoP target surface and PSRAM temp area reset).
+void blit_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
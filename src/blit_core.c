@@ -0,0 +1,123 @@
+/*
+ * murmprince - 8bpp blitter inner loops
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "blit_core.h"
+
+#include <limits.h>
+#include <string.h>
+
+uint8_t blit_core_nearest(const blit_palette_t *pal, uint8_t r, uint8_t g, uint8_t b) {
+    int best_distance = INT_MAX;
+    uint8_t best_index = 0;
+    for (int i = 0; i < pal->ncolors; ++i) {
+        if (pal->skip_reserved && i >= 240 && i <= 243) continue;
+        const blit_color_t *c = &pal->colors[i];
+        const int dr = (int)r - (int)c->r;
+        const int dg = (int)g - (int)c->g;
+        const int db = (int)b - (int)c->b;
+        const int distance = dr * dr + dg * dg + db * db;
+        if (distance < best_distance) {
+            best_distance = distance;
+            best_index = (uint8_t)i;
+            if (distance == 0) break;
+        }
+    }
+    return best_index;
+}
+
+void blit_core_fill8(uint8_t *dst, int dst_pitch, int w, int h, uint8_t color) {
+    for (int y = 0; y < h; ++y, dst += dst_pitch) {
+        memset(dst, color, (size_t)w);
+    }
+}
+
+void blit_core_key8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                    int w, int h, int key, const uint8_t *map) {
+    for (int y = 0; y < h; ++y, dst += dst_pitch, src += src_pitch) {
+        if (key == BLIT_CORE_NO_KEY && !map && src_step == 1) {
+            memmove(dst, src, (size_t)w);
+            continue;
+        }
+        const uint8_t *s = src;
+        for (int x = 0; x < w; ++x, s += src_step) {
+            const uint8_t pixel = *s;
+            if (pixel == key) continue;
+            dst[x] = map ? map[pixel] : pixel;
+        }
+    }
+}
+
+void blit_core_xor8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                    int w, int h) {
+    for (int y = 0; y < h; ++y, dst += dst_pitch, src += src_pitch) {
+        const uint8_t *s = src;
+        for (int x = 0; x < w; ++x, s += src_step) {
+            if (*s) dst[x] ^= *s;
+        }
+    }
+}
+
+void blit_core_mono8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                     int w, int h, uint8_t color) {
+    for (int y = 0; y < h; ++y, dst += dst_pitch, src += src_pitch) {
+        const uint8_t *s = src;
+        for (int x = 0; x < w; ++x, s += src_step) {
+            if (*s) dst[x] = color;
+        }
+    }
+}
+
+void blit_core_rgb24_to8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch,
+                         int w, int h, int32_t key, const blit_palette_t *pal) {
+    for (int y = 0; y < h; ++y, dst += dst_pitch, src += src_pitch) {
+        for (int x = 0; x < w; ++x) {
+            const uint8_t r = src[x * 3];
+            const uint8_t g = src[x * 3 + 1];
+            const uint8_t b = src[x * 3 + 2];
+            if (key != BLIT_CORE_NO_KEY
+                && (((uint32_t)r << 16) | ((uint32_t)g << 8) | b) == ((uint32_t)key & 0xFFFFFFu)) {
+                continue;
+            }
+            dst[x] = pal ? blit_core_nearest(pal, r, g, b) : 15;
+        }
+    }
+}
+
+static int mask_shift(uint32_t mask) {
+    int shift = 0;
+    if (mask) {
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++shift;
+        }
+    }
+    return shift;
+}
+
+void blit_core_rgba_to8(uint8_t *dst, int dst_pitch, const uint32_t *src, int src_pitch,
+                        int w, int h, const blit_rgba_format_t *fmt, int32_t key, bool skip_clear,
+                        const blit_palette_t *pal) {
+    const int rshift = mask_shift(fmt->rmask);
+    const int gshift = mask_shift(fmt->gmask);
+    const int bshift = mask_shift(fmt->bmask);
+    const int ashift = mask_shift(fmt->amask);
+    for (int y = 0; y < h; ++y, dst += dst_pitch) {
+        const uint32_t *row = (const uint32_t *)((const uint8_t *)src + y * src_pitch);
+        for (int x = 0; x < w; ++x) {
+            const uint32_t pixel = row[x];
+            if (key != BLIT_CORE_NO_KEY && (pixel & 0xFFFFFFu) == ((uint32_t)key & 0xFFFFFFu)) continue;
+            if (skip_clear && (uint8_t)((pixel & fmt->amask) >> ashift) == 0) continue;
+            if (!pal) {
+                dst[x] = 15;
+                continue;
+            }
+            dst[x] = blit_core_nearest(pal,
+                                       (uint8_t)((pixel & fmt->rmask) >> rshift),
+                                       (uint8_t)((pixel & fmt->gmask) >> gshift),
+                                       (uint8_t)((pixel & fmt->bmask) >> bshift));
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * murmprince - 8bpp blitter inner loops
+ *
+ * The pixel loops behind the SDL shim's SDL_BlitSurface()/SDL_FillRect()
+ * and SDLPoP's xor, mono and RGBA->indexed blits. Callers clip first:
+ * every function writes exactly w x h destination pixels starting at dst.
+ * src_step is 1, or -1 for a mirrored view (SDL_MIRROR_X), in which case
+ * src points at the rightmost source pixel of the first row.
+ *
+ * Pure logic on plain buffers, so the same code runs on a host
+ * (tools/blit_bench.c, tests/test_blit_core.c).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLIT_CORE_NO_KEY (-1)
+
+// Same layout as SDL_Color.
+typedef struct {
+    uint8_t r, g, b, a;
+} blit_color_t;
+
+typedef struct {
+    const blit_color_t *colors;
+    int ncolors;
+    bool skip_reserved;     // never pick 240..243 (HDMI control indices)
+} blit_palette_t;
+
+// Channel masks of a 32bpp source; a zero alpha mask reads as alpha 0.
+typedef struct {
+    uint32_t rmask, gmask, bmask, amask;
+} blit_rgba_format_t;
+
+// Nearest colour by squared RGB distance; the first wins on ties.
+// 0 for an empty palette.
+uint8_t blit_core_nearest(const blit_palette_t *pal, uint8_t r, uint8_t g, uint8_t b);
+
+void blit_core_fill8(uint8_t *dst, int dst_pitch, int w, int h, uint8_t color);
+
+// Copy skipping pixels equal to key (or none with BLIT_CORE_NO_KEY),
+// through map when it is not NULL.
+void blit_core_key8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                    int w, int h, int key, const uint8_t *map);
+
+// dst ^= src for every non-zero source pixel (SDLPoP's shadow).
+void blit_core_xor8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                    int w, int h);
+
+// color for every non-zero source pixel (fonts).
+void blit_core_mono8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch, int src_step,
+                     int w, int h, uint8_t color);
+
+// Packed R, G, B bytes to the nearest palette index. key is compared
+// with 0xRRGGBB. Without a palette every drawn pixel becomes 15.
+void blit_core_rgb24_to8(uint8_t *dst, int dst_pitch, const uint8_t *src, int src_pitch,
+                         int w, int h, int32_t key, const blit_palette_t *pal);
+
+// 32bpp pixels to the nearest palette index. key is compared with the
+// pixel's low 24 bits; skip_clear leaves pixels with alpha 0 alone.
+// Without a palette every drawn pixel becomes 15.
+void blit_core_rgba_to8(uint8_t *dst, int dst_pitch, const uint32_t *src, int src_pitch,
+                        int w, int h, const blit_rgba_format_t *fmt, int32_t key, bool skip_clear,
+                        const blit_palette_t *pal);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * murmprince - Boot timeline
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "boot_timeline.h"
+#include "board_config.h"
+
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+// First-frame budget from a warm card, excluding time spent on the start screen.
+#ifndef RP2350_BOOT_TARGET_MS
+#define RP2350_BOOT_TARGET_MS 1000
+#endif
+
+#define BOOT_TIMELINE_MAX_STAGES 16
+
+typedef struct {
+    const char *name;
+    uint32_t start_us;
+    uint32_t end_us;
+    bool idle;
+    bool parallel;
+} boot_stage_t;
+
+static boot_stage_t g_stages[BOOT_TIMELINE_MAX_STAGES];
+static int g_stage_count = 0;
+static uint32_t g_last_mark_us = 0;
+static bool g_reported = false;
+
+static void boot_timeline_add(const char *stage, uint32_t start_us, uint32_t end_us, bool idle, bool parallel) {
+    if (g_reported || g_stage_count >= BOOT_TIMELINE_MAX_STAGES) return;
+    boot_stage_t *s = &g_stages[g_stage_count++];
+    s->name = stage;
+    s->start_us = start_us;
+    s->end_us = end_us;
+    s->idle = idle;
+    s->parallel = parallel;
+}
+
+void boot_timeline_mark(const char *stage) {
+    // time_us_32() counts from power-on, so the first stage starts at 0.
+    uint32_t now = time_us_32();
+    boot_timeline_add(stage, g_last_mark_us, now, false, false);
+    g_last_mark_us = now;
+}
+
+void boot_timeline_mark_idle(const char *stage) {
+    uint32_t now = time_us_32();
+    boot_timeline_add(stage, g_last_mark_us, now, true, false);
+    g_last_mark_us = now;
+}
+
+void boot_timeline_add_parallel(const char *stage, uint32_t start_us, uint32_t end_us) {
+    boot_timeline_add(stage, start_us, end_us, false, true);
+}
+
+void boot_timeline_report(void) {
+    if (g_reported) return;
+    g_reported = true;
+
+    uint32_t busy_us = 0;
+    DBG_PRINTF("BOOT stage                  start_ms  dur_ms\n");
+    for (int i = 0; i < g_stage_count; ++i) {
+        const boot_stage_t *s = &g_stages[i];
+        uint32_t dur = s->end_us - s->start_us;
+        DBG_PRINTF("BOOT %-22s %8lu %7lu%s\n", s->name,
+            (unsigned long)(s->start_us / 1000), (unsigned long)(dur / 1000),
+            s->idle ? " (idle)" : (s->parallel ? " (core1)" : ""));
+        if (!s->idle && !s->parallel) busy_us += dur;
+    }
+    uint32_t busy_ms = busy_us / 1000;
+    DBG_PRINTF("BOOT first frame: %lu ms excluding idle (target %u ms) %s\n",
+        (unsigned long)busy_ms, (unsigned)RP2350_BOOT_TARGET_MS,
+        busy_ms <= RP2350_BOOT_TARGET_MS ? "OK" : "OVER");
+}
@@ -0,0 +1,34 @@
+/*
+ * murmprince - Boot timeline
+ *
+ * Records time_us_32() at named boot stages (power-on to first game frame)
+ * and prints a per-stage table once the first frame is presented.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Close the current stage under the given name (core 0 only).
+void boot_timeline_mark(const char *stage);
+
+// Same, but the stage is time spent waiting for the user (start screen
+// keypress); it is shown but not counted against the boot budget.
+void boot_timeline_mark_idle(const char *stage);
+
+// Record a stage that ran concurrently on core 1 (start/end in time_us_32()).
+void boot_timeline_add_parallel(const char *stage, uint32_t start_us, uint32_t end_us);
+
+// Print the timeline once (first call only) and freeze it.
+void boot_timeline_report(void);
+
+#ifdef __cplusplus
+}
+#endif
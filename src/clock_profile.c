@@ -0,0 +1,132 @@
+/*
+ * murmprince - CPU clock profiles
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "clock_profile.h"
+
+#include <stddef.h>
+
+// Same presets as build.sh (CPU -> PSRAM) and CMakeLists.txt (CPU -> voltage).
+static const clock_profile_t g_clock_profiles[CLOCK_PROFILE_COUNT] = {
+    { 252, 0,    100 },
+    { 378, 1600, 133 },
+    { 504, 1650, 166 },
+};
+
+// Record: [0..1] magic, [2] active, [3] pending, [4] attempts,
+// [5] failed_mask, [6] ini_seen, [7] checksum.
+#define CLOCK_PROFILE_MAGIC0 0xC1u
+#define CLOCK_PROFILE_MAGIC1 0x0Cu
+
+const clock_profile_t *clock_profile_get(uint8_t id) {
+    if (id >= CLOCK_PROFILE_COUNT) return NULL;
+    return &g_clock_profiles[id];
+}
+
+uint8_t clock_profile_find_mhz(unsigned mhz) {
+    for (uint8_t i = 0; i < CLOCK_PROFILE_COUNT; ++i) {
+        if (g_clock_profiles[i].cpu_mhz == mhz) return i;
+    }
+    return CLOCK_PROFILE_NONE;
+}
+
+void clock_profile_state_init(clock_profile_state_t *st, uint8_t build_default) {
+    st->active = (build_default < CLOCK_PROFILE_COUNT) ? build_default : 0;
+    st->pending = CLOCK_PROFILE_NONE;
+    st->attempts = 0;
+    st->failed_mask = 0;
+    st->ini_seen = CLOCK_PROFILE_NONE;
+}
+
+static void clock_profile_drop_trial(clock_profile_state_t *st, bool failed) {
+    if (failed && st->pending < CLOCK_PROFILE_COUNT) {
+        st->failed_mask |= (uint8_t)(1u << st->pending);
+    }
+    st->pending = CLOCK_PROFILE_NONE;
+    st->attempts = 0;
+}
+
+uint8_t clock_profile_on_boot(clock_profile_state_t *st) {
+    if (st->pending == CLOCK_PROFILE_NONE) return st->active;
+    if (st->attempts >= CLOCK_PROFILE_MAX_ATTEMPTS) {
+        // The previous trial boot crashed, hung or lost power before the
+        // self-test reported: fall back to the committed profile.
+        clock_profile_drop_trial(st, true);
+        return st->active;
+    }
+    st->attempts++;
+    return st->pending;
+}
+
+void clock_profile_on_selftest(clock_profile_state_t *st, bool passed) {
+    if (st->pending == CLOCK_PROFILE_NONE) return;
+    if (passed) {
+        st->active = st->pending;
+        st->failed_mask &= (uint8_t)~(1u << st->active);
+    }
+    clock_profile_drop_trial(st, !passed);
+}
+
+bool clock_profile_request(clock_profile_state_t *st, uint8_t id) {
+    if (id >= CLOCK_PROFILE_COUNT) return false;
+    st->failed_mask &= (uint8_t)~(1u << id);
+    if (id == st->active) {
+        // Going back to the committed profile cancels any trial.
+        bool had_trial = (st->pending != CLOCK_PROFILE_NONE);
+        clock_profile_drop_trial(st, false);
+        return had_trial;
+    }
+    if (id == st->pending) return true;
+    st->pending = id;
+    st->attempts = 0;
+    return true;
+}
+
+bool clock_profile_request_ini(clock_profile_state_t *st, uint8_t id) {
+    if (id >= CLOCK_PROFILE_COUNT || id == st->ini_seen) return false;
+    st->ini_seen = id;
+    return clock_profile_request(st, id);
+}
+
+uint8_t clock_profile_next(const clock_profile_state_t *st, uint8_t id) {
+    for (uint8_t step = 1; step <= CLOCK_PROFILE_COUNT; ++step) {
+        uint8_t cand = (uint8_t)((id + step) % CLOCK_PROFILE_COUNT);
+        if (cand == st->active || !(st->failed_mask & (1u << cand))) return cand;
+    }
+    return st->active;
+}
+
+static uint8_t clock_profile_checksum(const uint8_t *bytes) {
+    uint8_t sum = 0xA5u; // seeded so an erased (all 0xFF) or zeroed page never checks out
+    for (int i = 0; i < CLOCK_PROFILE_RECORD_SIZE - 1; ++i) {
+        sum = (uint8_t)((sum << 1) | (sum >> 7));
+        sum ^= bytes[i];
+    }
+    return sum;
+}
+
+void clock_profile_encode(const clock_profile_state_t *st, uint8_t out[CLOCK_PROFILE_RECORD_SIZE]) {
+    out[0] = CLOCK_PROFILE_MAGIC0;
+    out[1] = CLOCK_PROFILE_MAGIC1;
+    out[2] = st->active;
+    out[3] = st->pending;
+    out[4] = st->attempts;
+    out[5] = st->failed_mask;
+    out[6] = st->ini_seen;
+    out[7] = clock_profile_checksum(out);
+}
+
+bool clock_profile_decode(const uint8_t in[CLOCK_PROFILE_RECORD_SIZE], clock_profile_state_t *st) {
+    if (in[0] != CLOCK_PROFILE_MAGIC0 || in[1] != CLOCK_PROFILE_MAGIC1) return false;
+    if (in[7] != clock_profile_checksum(in)) return false;
+    if (in[2] >= CLOCK_PROFILE_COUNT) return false;
+    if (in[3] != CLOCK_PROFILE_NONE && in[3] >= CLOCK_PROFILE_COUNT) return false;
+    st->active = in[2];
+    st->pending = in[3];
+    st->attempts = in[4];
+    st->failed_mask = in[5];
+    st->ini_seen = in[6];
+    return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * murmprince - CPU clock profiles
+ *
+ * The profile table and the selection state machine behind clock_select.c:
+ * a new profile is first run as a trial, committed only after the boot
+ * self-test passes, and dropped again when a trial boot fails or never
+ * reports back. The persisted state is a small checksummed record. No
+ * hardware access, so it builds on a host.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOCK_PROFILE_COUNT 3
+#define CLOCK_PROFILE_NONE 0xFFu
+#define CLOCK_PROFILE_RECORD_SIZE 8
+
+// Trial boots allowed before an unconfirmed profile is given up.
+#define CLOCK_PROFILE_MAX_ATTEMPTS 1
+
+typedef struct {
+    uint16_t cpu_mhz;
+    uint16_t vreg_mv;   // core voltage; 0 leaves the regulator at its default
+    uint16_t psram_mhz; // PSRAM max frequency passed to psram_init
+} clock_profile_t;
+
+typedef struct {
+    uint8_t active;      // committed (validated) profile
+    uint8_t pending;     // profile on trial, or CLOCK_PROFILE_NONE
+    uint8_t attempts;    // boots started with the pending profile
+    uint8_t failed_mask; // bit per profile that failed its trial
+    uint8_t ini_seen;    // last INI request acted on, or CLOCK_PROFILE_NONE
+} clock_profile_state_t;
+
+// Profile table entry (NULL if id is out of range).
+const clock_profile_t *clock_profile_get(uint8_t id);
+
+// Profile whose CPU clock matches mhz, or CLOCK_PROFILE_NONE.
+uint8_t clock_profile_find_mhz(unsigned mhz);
+
+// Fresh state with build_default committed.
+void clock_profile_state_init(clock_profile_state_t *st, uint8_t build_default);
+
+// Called once per boot before the clocks are set; returns the profile to run.
+// A trial that already used its attempts without a self-test result counts
+// as failed and the committed profile is used instead.
+uint8_t clock_profile_on_boot(clock_profile_state_t *st);
+
+// Self-test outcome for the boot in progress. Commits or drops a pending
+// trial; no effect when nothing is on trial.
+void clock_profile_on_selftest(clock_profile_state_t *st, bool passed);
+
+// Ask for a profile (start screen). Returns true when a reboot is needed to
+// try it. An explicit request clears that profile's failed bit.
+bool clock_profile_request(clock_profile_state_t *st, uint8_t id);
+
+// Same as clock_profile_request, but only when the INI value changed since
+// it was last acted on, so a failed INI choice is not retried every boot.
+bool clock_profile_request_ini(clock_profile_state_t *st, uint8_t id);
+
+// Next profile after id for the start-screen selector (skips failed ones
+// unless every other profile failed).
+uint8_t clock_profile_next(const clock_profile_state_t *st, uint8_t id);
+
+// Checksummed record kept in flash.
+void clock_profile_encode(const clock_profile_state_t *st, uint8_t out[CLOCK_PROFILE_RECORD_SIZE]);
+bool clock_profile_decode(const uint8_t in[CLOCK_PROFILE_RECORD_SIZE], clock_profile_state_t *st);
+
+#ifdef __cplusplus
+}
+#endif
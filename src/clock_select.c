@@ -0,0 +1,366 @@
+/*
+ * murmprince - Runtime CPU clock profile selection
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "clock_select.h"
+#include "board_config.h"
+#include "crash_guard.h"
+#include "psram_allocator.h"
+#include "pop_fs.h"
+#include "HDMI.h"
+#include "audio/audio_i2s_driver.h"
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/vreg.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/qmi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// Self-test sizes. PSRAM: enough to spill the 16 KB XIP cache many times over.
+#ifndef RP2350_CLOCK_TEST_PSRAM_BYTES
+#define RP2350_CLOCK_TEST_PSRAM_BYTES (1024 * 1024)
+#endif
+
+#ifndef RP2350_CLOCK_TEST_SD_BYTES
+#define RP2350_CLOCK_TEST_SD_BYTES (32 * 1024)
+#endif
+
+// Minimum scanout time covered by the HDMI check, and how many FIFO
+// underruns it tolerates in that window.
+#ifndef RP2350_CLOCK_TEST_HDMI_MS
+#define RP2350_CLOCK_TEST_HDMI_MS 250
+#endif
+
+#ifndef RP2350_CLOCK_TEST_MAX_UNDERRUNS
+#define RP2350_CLOCK_TEST_MAX_UNDERRUNS 2
+#endif
+
+// The profile state lives in the last 4 KB sector of the boot flash.
+#define CLOCK_SELECT_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+// Flash timing configuration for overclocking
+// Must be called BEFORE changing system clock
+#define FLASH_MAX_FREQ_MHZ 88
+
+// SDLPoP's INI parser (options.c)
+extern int ini_load(const char *filename,
+                    int (*report)(const char *section, const char *name, const char *value));
+
+static clock_profile_state_t g_state;
+static uint8_t g_build_default = 0;
+static uint8_t g_running = 0;
+static bool g_trial = false;
+static unsigned g_cpu_mhz = 252;
+static unsigned g_psram_mhz = PSRAM_MAX_FREQ_MHZ;
+static uint8_t g_ini_request = CLOCK_PROFILE_NONE;
+
+static void __no_inline_not_in_flash_func(set_flash_timings)(int cpu_mhz) {
+    const int clock_hz = cpu_mhz * 1000000;
+    const int max_flash_freq = FLASH_MAX_FREQ_MHZ * 1000000;
+
+    int divisor = (clock_hz + max_flash_freq - (max_flash_freq >> 4) - 1) / max_flash_freq;
+    if (divisor == 1 && clock_hz >= 166000000) {
+        divisor = 2;
+    }
+
+    int rxdelay = divisor;
+    if (clock_hz / divisor > 100000000 && clock_hz >= 166000000) {
+        rxdelay += 1;
+    }
+
+    qmi_hw->m[0].timing = 0x60007000 |
+                          rxdelay << QMI_M0_TIMING_RXDELAY_LSB |
+                          divisor << QMI_M0_TIMING_CLKDIV_LSB;
+}
+
+static enum vreg_voltage clock_select_vreg(unsigned mv) {
+    if (mv >= 1650) return VREG_VOLTAGE_1_65;
+    if (mv >= 1600) return VREG_VOLTAGE_1_60;
+    if (mv >= 1550) return VREG_VOLTAGE_1_55;
+    return VREG_VOLTAGE_1_50;
+}
+
+// ----------------------------------------------------------------------------
+// Flash persistence
+// ----------------------------------------------------------------------------
+
+static void clock_select_load(void) {
+    const uint8_t *rec = (const uint8_t *)(XIP_BASE + CLOCK_SELECT_FLASH_OFFSET);
+    if (!clock_profile_decode(rec, &g_state)) {
+        clock_profile_state_init(&g_state, g_build_default);
+    }
+}
+
+static void clock_select_store(void) {
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    clock_profile_encode(&g_state, page);
+
+    const uint8_t *cur = (const uint8_t *)(XIP_BASE + CLOCK_SELECT_FLASH_OFFSET);
+    if (memcmp(cur, page, CLOCK_PROFILE_RECORD_SIZE) == 0) return;
+
+    // Core 1 is idle whenever this runs (before the SD mount launch, after
+    // its join and reset, or on the start screen with audio on core 0), so
+    // interrupts off is enough. Audio on core 1 would run from flash during
+    // the erase; it would have to be locked out (flash_safe_execute) first.
+#if AUDIO_USE_CORE1
+#error "clock_select_store() writes flash with core 1 running: lock core 1 out first"
+#endif
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(CLOCK_SELECT_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(CLOCK_SELECT_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+}
+
+static void __attribute__((noreturn)) clock_select_reboot(void) {
+    watchdog_reboot(0, 0, 10);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+// Profile the next boot will run with the current state.
+static uint8_t clock_select_next_boot(void) {
+    return (g_state.pending != CLOCK_PROFILE_NONE) ? g_state.pending : g_state.active;
+}
+
+// ----------------------------------------------------------------------------
+// Boot
+// ----------------------------------------------------------------------------
+
+void clock_select_boot(bool safe_mode) {
+    g_build_default = clock_profile_find_mhz(CPU_CLOCK_MHZ);
+    if (g_build_default == CLOCK_PROFILE_NONE) g_build_default = 0;
+    clock_select_load();
+
+    uint8_t id = 0;
+    if (!safe_mode) {
+        uint8_t before[CLOCK_PROFILE_RECORD_SIZE];
+        uint8_t after[CLOCK_PROFILE_RECORD_SIZE];
+        clock_profile_encode(&g_state, before);
+        id = clock_profile_on_boot(&g_state);
+        g_trial = (g_state.pending != CLOCK_PROFILE_NONE);
+        clock_profile_encode(&g_state, after);
+        // Count the attempt before touching the clocks, so a hang at the new
+        // speed is seen as a failed trial on the next boot.
+        if (memcmp(before, after, sizeof(before)) != 0) clock_select_store();
+    }
+    g_running = id;
+
+    const clock_profile_t *p = clock_profile_get(id);
+    unsigned mhz = p->cpu_mhz;
+    unsigned vreg_mv = p->vreg_mv;
+    g_psram_mhz = p->psram_mhz;
+    if (id == g_build_default && !g_trial) {
+        // The build's own profile keeps its configured PSRAM speed.
+        g_psram_mhz = PSRAM_MAX_FREQ_MHZ;
+    }
+
+    if (mhz > 252) {
+        vreg_disable_voltage_limit();
+        vreg_set_voltage(clock_select_vreg(vreg_mv));
+        set_flash_timings((int)mhz);
+        sleep_ms(100);
+    }
+
+    if (mhz > 252 && !set_sys_clock_khz(mhz * 1000, false)) {
+        DBG_PRINTF("clock_select: %u MHz rejected, using 252 MHz\n", mhz);
+        if (g_trial) {
+            clock_profile_on_selftest(&g_state, false);
+            g_trial = false;
+            clock_select_store();
+        }
+        mhz = 252;
+        g_running = 0;
+        g_psram_mhz = clock_profile_get(0)->psram_mhz;
+    }
+    if (mhz <= 252) {
+        set_sys_clock_khz(252 * 1000, true);
+        mhz = 252;
+    }
+    g_cpu_mhz = mhz;
+
+    if (g_trial) {
+        // A trial must not be able to hang forever before it reports.
+        crash_guard_start_watchdog();
+        crash_guard_note("clock trial");
+    }
+}
+
+unsigned clock_select_cpu_mhz(void) {
+    return g_cpu_mhz;
+}
+
+unsigned clock_select_psram_mhz(void) {
+    return g_psram_mhz;
+}
+
+// ----------------------------------------------------------------------------
+// INI key
+// ----------------------------------------------------------------------------
+
+static int clock_select_ini_callback(const char *section, const char *name, const char *value) {
+    if (strcasecmp(section, "RP2350") != 0 || strcasecmp(name, "clock_profile") != 0) return 0;
+    unsigned mhz = 0;
+    if (sscanf(value, "%u", &mhz) == 1) {
+        g_ini_request = clock_profile_find_mhz(mhz);
+    }
+    if (g_ini_request == CLOCK_PROFILE_NONE) {
+        DBG_PRINTF("clock_select: ignoring clock_profile = %s\n", value);
+    }
+    return 0;
+}
+
+void clock_select_apply_ini(void) {
+    if (crash_guard_safe_mode()) return;
+    g_ini_request = CLOCK_PROFILE_NONE;
+    ini_load("SDLPoP.ini", clock_select_ini_callback);
+    if (g_ini_request == CLOCK_PROFILE_NONE) return;
+
+    if (!clock_profile_request_ini(&g_state, g_ini_request)) return;
+    clock_select_store();
+    if (clock_select_next_boot() != g_running) {
+        DBG_PRINTF("clock_select: SDLPoP.ini asks for %u MHz, rebooting\n",
+            (unsigned)clock_profile_get(g_ini_request)->cpu_mhz);
+        clock_select_reboot();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Self-test
+// ----------------------------------------------------------------------------
+
+static bool clock_select_test_psram(void) {
+    const size_t words = RP2350_CLOCK_TEST_PSRAM_BYTES / sizeof(uint32_t);
+    const size_t mark = psram_get_offset();
+    volatile uint32_t *buf = (volatile uint32_t *)psram_malloc(RP2350_CLOCK_TEST_PSRAM_BYTES);
+    if (!buf) return false;
+
+    static const uint32_t patterns[] = { 0x00000000u, 0xA5A5A5A5u, 0x5A5A5A5Au, 0xFFFFFFFFu };
+    bool ok = true;
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]) && ok; ++p) {
+        // Mix the address in so stuck or aliased address lines show up too.
+        for (size_t i = 0; i < words; ++i) {
+            buf[i] = patterns[p] ^ (uint32_t)(i * 0x9E3779B1u);
+        }
+        crash_guard_feed();
+        for (size_t i = 0; i < words; ++i) {
+            if (buf[i] != (patterns[p] ^ (uint32_t)(i * 0x9E3779B1u))) {
+                DBG_PRINTF("clock_select: PSRAM mismatch at word %u (pattern %u)\n",
+                    (unsigned)i, (unsigned)p);
+                ok = false;
+                break;
+            }
+        }
+        crash_guard_feed();
+    }
+
+    psram_set_offset(mark);
+    return ok;
+}
+
+static uint32_t clock_select_hash(const uint8_t *data, size_t len, uint32_t h) {
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static bool clock_select_hash_file(const char *path, uint32_t *out) {
+    FIL *f = pop_fs_open(path, "rb");
+    if (!f) return false;
+    static uint8_t chunk[4096];
+    uint32_t h = 2166136261u;
+    size_t left = RP2350_CLOCK_TEST_SD_BYTES;
+    while (left > 0) {
+        size_t want = left < sizeof(chunk) ? left : sizeof(chunk);
+        size_t got = pop_fs_read(chunk, 1, want, f);
+        h = clock_select_hash(chunk, got, h);
+        if (got < want) break;
+        left -= got;
+    }
+    pop_fs_close(f);
+    *out = h;
+    return true;
+}
+
+// Read the head of a game data file twice; both passes must agree.
+static bool clock_select_test_sd(void) {
+    static const char *const candidates[] = {
+        "PRINCE.DAT", "prince/PRINCE.DAT", "prince/GUARD.DAT",
+    };
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); ++i) {
+        uint32_t a, b;
+        if (!clock_select_hash_file(candidates[i], &a)) continue;
+        if (!clock_select_hash_file(candidates[i], &b)) return false;
+        if (a != b) {
+            DBG_PRINTF("clock_select: SD read-verify mismatch on %s\n", candidates[i]);
+            return false;
+        }
+        return true;
+    }
+    // No data file to read (the start screen reports that separately).
+    return true;
+}
+
+void clock_select_validate(void) {
+    if (!g_trial) return;
+    DBG_PRINTF("clock_select: self-test at %u MHz (PSRAM %u MHz)\n", g_cpu_mhz, g_psram_mhz);
+
+    // PSRAM and SD traffic run while HDMI scans out, so the underrun check
+    // covers the busiest case.
+    const uint32_t t0 = to_ms_since_boot(get_absolute_time());
+    const uint32_t irq0 = graphics_get_hdmi_irq_count();
+    const uint32_t underrun0 = graphics_get_hdmi_underrun_count();
+
+    bool psram_ok = clock_select_test_psram();
+    bool sd_ok = clock_select_test_sd();
+
+    while (to_ms_since_boot(get_absolute_time()) - t0 < RP2350_CLOCK_TEST_HDMI_MS) {
+        sleep_ms(10);
+    }
+    const uint32_t irqs = graphics_get_hdmi_irq_count() - irq0;
+    const uint32_t underruns = graphics_get_hdmi_underrun_count() - underrun0;
+    bool hdmi_ok = irqs > 0 && underruns <= RP2350_CLOCK_TEST_MAX_UNDERRUNS;
+
+    bool passed = psram_ok && sd_ok && hdmi_ok;
+    DBG_PRINTF("clock_select: psram=%d sd=%d hdmi=%d (irqs=%lu underruns=%lu) -> %s\n",
+        psram_ok, sd_ok, hdmi_ok, (unsigned long)irqs, (unsigned long)underruns,
+        passed ? "commit" : "fall back");
+
+    clock_profile_on_selftest(&g_state, passed);
+    g_trial = false;
+    clock_select_store();
+    if (!passed) {
+        clock_select_reboot();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Start screen
+// ----------------------------------------------------------------------------
+
+uint8_t clock_select_current(void) {
+    return g_running;
+}
+
+uint8_t clock_select_next(uint8_t id) {
+    return clock_profile_next(&g_state, id);
+}
+
+void clock_select_request(uint8_t id) {
+    if (crash_guard_safe_mode()) return;
+    clock_profile_request(&g_state, id);
+    clock_select_store();
+    if (clock_select_next_boot() != g_running) {
+        clock_select_reboot();
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * murmprince - Runtime CPU clock profile selection
+ *
+ * Picks the clock profile at boot from a record in the last flash sector
+ * (falling back to the build's CPU_SPEED), applies voltage, flash timings
+ * and the system clock, and validates a newly chosen profile with a short
+ * self-test (PSRAM pattern, HDMI underruns, SD read-verify) before it is
+ * committed. A trial boot that fails or never reports back drops the
+ * profile again. New profiles come from the start screen or from
+ * "clock_profile = 252|378|504" in the [RP2350] section of SDLPoP.ini.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "clock_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Right after crash_guard_boot(), before anything depends on clk_sys.
+// Safe mode runs at 252 MHz and leaves the stored state untouched.
+void clock_select_boot(bool safe_mode);
+
+// Clocks actually in use this boot.
+unsigned clock_select_cpu_mhz(void);
+unsigned clock_select_psram_mhz(void);
+
+// After the SD card is mounted: act on the SDLPoP.ini key. Reboots when it
+// starts a trial.
+void clock_select_apply_ini(void);
+
+// After PSRAM, HDMI and SD are up: on a trial boot, run the self-test and
+// commit the profile, or record the failure and reboot into the old one.
+void clock_select_validate(void);
+
+// Start-screen selector.
+uint8_t clock_select_current(void);
+uint8_t clock_select_next(uint8_t id);
+// Persist a request and reboot into it if needed; returns if nothing changes.
+void clock_select_request(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
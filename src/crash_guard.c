@@ -0,0 +1,175 @@
+/*
+ * murmprince - Watchdog, HardFault capture and safe mode
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "crash_guard.h"
+#include "board_config.h"
+
+#include "pico/stdlib.h"
+#include "hardware/exception.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Long enough for the slowest legitimate stall (MIDI cache rendering feeds
+// from pop_fs writes; level loads feed from pop_fs reads).
+#ifndef RP2350_WATCHDOG_MS
+#define RP2350_WATCHDOG_MS 8000
+#endif
+
+#ifndef RP2350_AUDIO_STALL_MS
+#define RP2350_AUDIO_STALL_MS 2000
+#endif
+
+#define CRASH_GUARD_SAFE_MODE_MAGIC 0x5AFE0DE5u
+
+// Cortex-M33 Configurable Fault Status Register
+#define CRASH_GUARD_CFSR (*(volatile uint32_t *)0xE000ED28u)
+
+// Survive a watchdog reset (not a power cycle).
+static crash_tail_t __uninitialized_ram(g_crash_tail);
+static uint32_t __uninitialized_ram(g_safe_mode_request);
+
+static crash_info_t g_last_crash;
+static bool g_have_crash = false;
+static bool g_safe_mode = false;
+static bool g_watchdog_on = false;
+
+static uint32_t (*volatile g_audio_probe)(void) = NULL;
+static uint32_t g_audio_last_value = 0;
+static uint32_t g_audio_last_change_ms = 0;
+static bool g_audio_stall_recorded = false;
+
+static void crash_guard_write_record(const crash_info_t *info) {
+    uint32_t words[CRASH_RECORD_WORDS];
+    crash_record_encode(info, words);
+    for (int i = 0; i < CRASH_RECORD_WORDS; ++i) {
+        watchdog_hw->scratch[i] = words[i];
+    }
+}
+
+void __attribute__((used, noreturn)) crash_guard_hardfault_c(const uint32_t *frame) {
+    crash_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.reason = CRASH_REASON_HARDFAULT;
+    info.core = (uint8_t)get_core_num();
+    // Exception frame: r0 r1 r2 r3 r12 lr pc xpsr
+    info.pc = frame[6];
+    info.lr = frame[5];
+    info.sp = (uint32_t)(uintptr_t)(frame + 8);
+    crash_guard_write_record(&info);
+    g_crash_tail.cfsr = CRASH_GUARD_CFSR;
+    watchdog_reboot(0, 0, 10);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+// Pick the stack the faulting code was using (EXC_RETURN bit 2) and hand the
+// exception frame to the C handler.
+static void __attribute__((naked)) crash_guard_hardfault_isr(void) {
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b crash_guard_hardfault_c\n");
+}
+
+void crash_guard_boot(void) {
+    g_safe_mode = (g_safe_mode_request == CRASH_GUARD_SAFE_MODE_MAGIC);
+    g_safe_mode_request = 0;
+
+    uint32_t words[CRASH_RECORD_WORDS];
+    for (int i = 0; i < CRASH_RECORD_WORDS; ++i) {
+        words[i] = watchdog_hw->scratch[i];
+        watchdog_hw->scratch[i] = 0;
+    }
+    if (crash_record_decode(words, &g_last_crash)) {
+        g_have_crash = true;
+    } else if (watchdog_enable_caused_reboot()) {
+        // The watchdog bit and nobody left a record: core 0 was stuck.
+        memset(&g_last_crash, 0, sizeof(g_last_crash));
+        g_last_crash.reason = CRASH_REASON_WATCHDOG;
+        g_have_crash = true;
+    }
+    if (g_have_crash && crash_tail_read(&g_crash_tail, g_last_crash.tail, sizeof(g_last_crash.tail))) {
+        g_last_crash.cfsr = g_crash_tail.cfsr;
+        g_last_crash.last_feed_ms = g_crash_tail.last_feed_ms;
+    }
+
+    crash_tail_reset(&g_crash_tail);
+    crash_tail_append(&g_crash_tail, g_safe_mode ? "boot safe" : "boot");
+    exception_set_exclusive_handler(HARDFAULT_EXCEPTION, crash_guard_hardfault_isr);
+}
+
+void crash_guard_start_watchdog(void) {
+    if (g_watchdog_on) return;
+    // pause_on_debug: don't reset while halted in a debugger
+    watchdog_enable(RP2350_WATCHDOG_MS, true);
+    g_watchdog_on = true;
+}
+
+void crash_guard_feed(void) {
+    if (!g_watchdog_on || get_core_num() != 0) return;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    uint32_t (*probe)(void) = g_audio_probe;
+    if (probe) {
+        uint32_t value = probe();
+        if (value != g_audio_last_value) {
+            g_audio_last_value = value;
+            g_audio_last_change_ms = now_ms;
+        } else if (now_ms - g_audio_last_change_ms > RP2350_AUDIO_STALL_MS) {
+            if (!g_audio_stall_recorded) {
+                crash_info_t info;
+                memset(&info, 0, sizeof(info));
+                info.reason = CRASH_REASON_AUDIO_STALL;
+                info.core = 1;
+                crash_guard_write_record(&info);
+                crash_guard_note("audio stall");
+                g_audio_stall_recorded = true;
+            }
+            return; // let the watchdog bite
+        }
+    }
+
+    g_crash_tail.last_feed_ms = now_ms;
+    watchdog_update();
+}
+
+void crash_guard_set_audio_probe(uint32_t (*probe)(void)) {
+    g_audio_last_value = probe ? probe() : 0;
+    g_audio_last_change_ms = to_ms_since_boot(get_absolute_time());
+    g_audio_probe = probe;
+}
+
+void crash_guard_note(const char *text) {
+    crash_tail_append(&g_crash_tail, text);
+}
+
+bool crash_guard_last_crash(crash_info_t *out) {
+    if (!g_have_crash) return false;
+    if (out) *out = g_last_crash;
+    return true;
+}
+
+void crash_guard_dismiss_crash(void) {
+    g_have_crash = false;
+}
+
+bool crash_guard_safe_mode(void) {
+    return g_safe_mode;
+}
+
+void crash_guard_request_safe_mode(void) {
+    g_safe_mode_request = CRASH_GUARD_SAFE_MODE_MAGIC;
+    watchdog_reboot(0, 0, 10);
+    while (true) {
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * murmprince - Watchdog, HardFault capture and safe mode
+ *
+ * A HardFault stores PC/LR/SP in the watchdog scratch registers and reboots;
+ * a hang lets the watchdog bite. Either way the next boot finds the record
+ * (plus a short breadcrumb tail kept in uninitialised RAM), the start screen
+ * shows it, and the user can reboot into safe mode (no overclock, lighting
+ * or MIDI cache).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "crash_record.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// First thing in main(): pick up the previous crash record / safe-mode
+// request and install the HardFault handler. Does not start the watchdog.
+void crash_guard_boot(void);
+
+// Arm the watchdog; from here on core 0 must call crash_guard_feed() regularly.
+void crash_guard_start_watchdog(void);
+
+// Feed the watchdog (core 0 only; ignored on core 1). While an audio probe is
+// set, feeding stops once the probe value has not changed for a while, so a
+// hung audio core also ends in a reset.
+void crash_guard_feed(void);
+
+// probe returns a counter the audio core bumps every loop; NULL when audio closes.
+void crash_guard_set_audio_probe(uint32_t (*probe)(void));
+
+// Add a breadcrumb to the crash tail (core 0 only).
+void crash_guard_note(const char *text);
+
+// Crash left by the previous boot (false if none, or already dismissed).
+bool crash_guard_last_crash(crash_info_t *out);
+void crash_guard_dismiss_crash(void);
+
+// True when this boot was requested as safe mode.
+bool crash_guard_safe_mode(void);
+
+// Reboot into safe mode. Does not return.
+void crash_guard_request_safe_mode(void);
+
+#ifdef __cplusplus
+}
+#endif
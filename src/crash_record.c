@@ -0,0 +1,129 @@
+/*
+ * murmprince - Crash record encoding
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "crash_record.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Word 0: [31:16] magic, [15:12] reason, [11] core, [7:0] checksum of words 0..3.
+#define CRASH_RECORD_MAGIC 0xC4A5u
+#define CRASH_TAIL_MAGIC 0x7A11C0DEu
+
+_Static_assert(CRASH_RECORD_WORDS <= CRASH_RECORD_SCRATCH_FREE, "the record must fit the free scratch registers");
+
+static uint8_t fold8(uint32_t x) {
+    return (uint8_t)(x ^ (x >> 8) ^ (x >> 16) ^ (x >> 24));
+}
+
+static uint8_t crash_record_checksum(uint32_t w0_without_sum, uint32_t pc, uint32_t lr, uint32_t sp) {
+    // Seeded so an all-zero record never checks out
+    return (uint8_t)(fold8(w0_without_sum) ^ fold8(pc) ^ fold8(lr) ^ fold8(sp) ^ 0x5Au);
+}
+
+void crash_record_encode(const crash_info_t *info, uint32_t out[CRASH_RECORD_WORDS]) {
+    uint32_t w0 = (CRASH_RECORD_MAGIC << 16) |
+                  (((uint32_t)info->reason & 0xFu) << 12) |
+                  (((uint32_t)info->core & 1u) << 11);
+    w0 |= crash_record_checksum(w0, info->pc, info->lr, info->sp);
+    out[0] = w0;
+    out[1] = info->pc;
+    out[2] = info->lr;
+    out[3] = info->sp;
+}
+
+bool crash_record_decode(const uint32_t in[CRASH_RECORD_WORDS], crash_info_t *info) {
+    uint32_t w0 = in[0];
+    if ((w0 >> 16) != CRASH_RECORD_MAGIC) return false;
+    uint32_t w0_without_sum = w0 & ~0xFFu;
+    if ((w0 & 0xFFu) != crash_record_checksum(w0_without_sum, in[1], in[2], in[3])) return false;
+    uint32_t reason = (w0 >> 12) & 0xFu;
+    if (reason == CRASH_REASON_NONE || reason > CRASH_REASON_AUDIO_STALL) return false;
+
+    memset(info, 0, sizeof(*info));
+    info->reason = (crash_reason_t)reason;
+    info->core = (uint8_t)((w0 >> 11) & 1u);
+    info->pc = in[1];
+    info->lr = in[2];
+    info->sp = in[3];
+    return true;
+}
+
+static uint32_t crash_tail_checksum(const crash_tail_t *tail) {
+    // FNV-1a over the fields that describe the ring
+    uint32_t h = 2166136261u;
+    const uint8_t *p = (const uint8_t *)tail->buf;
+    for (size_t i = 0; i < CRASH_TAIL_SIZE; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    h = (h ^ tail->head) * 16777619u;
+    return h ^ tail->magic;
+}
+
+void crash_tail_reset(crash_tail_t *tail) {
+    memset(tail, 0, sizeof(*tail));
+    tail->magic = CRASH_TAIL_MAGIC;
+    tail->check = crash_tail_checksum(tail);
+}
+
+void crash_tail_append(crash_tail_t *tail, const char *text) {
+    uint32_t head = tail->head % CRASH_TAIL_SIZE;
+    for (const char *p = text; *p; ++p) {
+        tail->buf[head] = *p;
+        head = (head + 1) % CRASH_TAIL_SIZE;
+    }
+    tail->buf[head] = ',';
+    tail->head = (head + 1) % CRASH_TAIL_SIZE;
+    tail->check = crash_tail_checksum(tail);
+}
+
+bool crash_tail_read(const crash_tail_t *tail, char *out, size_t out_size) {
+    if (out_size == 0) return false;
+    out[0] = '\0';
+    if (tail->magic != CRASH_TAIL_MAGIC || tail->head >= CRASH_TAIL_SIZE) return false;
+    if (tail->check != crash_tail_checksum(tail)) return false;
+
+    size_t n = 0;
+    for (uint32_t i = 0; i < CRASH_TAIL_SIZE && n + 1 < out_size; ++i) {
+        char c = tail->buf[(tail->head + i) % CRASH_TAIL_SIZE];
+        if (c == '\0') continue; // never-written part of the ring
+        out[n++] = c;
+    }
+    // Drop the trailing separator
+    if (n > 0 && out[n - 1] == ',') --n;
+    out[n] = '\0';
+    return true;
+}
+
+void crash_info_format(const crash_info_t *info, char *line1, char *line2, size_t size) {
+    switch (info->reason) {
+        case CRASH_REASON_HARDFAULT:
+            snprintf(line1, size, "CRASH: HardFault core %u PC %08lX LR %08lX",
+                (unsigned)info->core, (unsigned long)info->pc, (unsigned long)info->lr);
+            break;
+        case CRASH_REASON_AUDIO_STALL:
+            snprintf(line1, size, "CRASH: audio core stopped responding");
+            break;
+        case CRASH_REASON_WATCHDOG:
+            if (info->last_feed_ms) {
+                snprintf(line1, size, "CRASH: hang at %lu.%lus (watchdog reset)",
+                    (unsigned long)(info->last_feed_ms / 1000), (unsigned long)(info->last_feed_ms % 1000 / 100));
+            } else {
+                snprintf(line1, size, "CRASH: hang (watchdog reset)");
+            }
+            break;
+        default:
+            snprintf(line1, size, "CRASH: unknown");
+            break;
+    }
+
+    // Show the most recent breadcrumbs that fit
+    size_t len = strlen(info->tail);
+    const char *prefix = "Last: ";
+    size_t room = size > strlen(prefix) + 1 ? size - strlen(prefix) - 1 : 0;
+    const char *start = len > room ? info->tail + (len - room) : info->tail;
+    snprintf(line2, size, "%s%s", prefix, start);
+}
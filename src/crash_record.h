@@ -0,0 +1,76 @@
+/*
+ * murmprince - Crash record encoding
+ *
+ * Pure data handling for crash_guard.c: the compact record kept in the four
+ * watchdog scratch registers, and the short log tail kept in RAM that
+ * survives a watchdog reset. No hardware access, so it builds on a host.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRASH_RECORD_WORDS 4
+// Watchdog scratch registers 0..3 are free for the application; the boot ROM
+// takes 4..7 for watchdog_reboot().
+#define CRASH_RECORD_SCRATCH_FREE 4
+#define CRASH_TAIL_SIZE 96
+
+typedef enum {
+    CRASH_REASON_NONE = 0,
+    CRASH_REASON_HARDFAULT = 1,   // fault handler ran; pc/lr/sp are valid
+    CRASH_REASON_WATCHDOG = 2,    // watchdog bit with no record: core 0 hung
+    CRASH_REASON_AUDIO_STALL = 3, // core 0 stopped feeding because core 1 hung
+} crash_reason_t;
+
+typedef struct {
+    crash_reason_t reason;
+    uint8_t core;
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t sp;
+    uint32_t cfsr;         // from the tail; 0 if unknown
+    uint32_t last_feed_ms; // from the tail; 0 if unknown
+    char tail[CRASH_TAIL_SIZE + 1];
+} crash_info_t;
+
+// Pack reason/core/pc/lr/sp into CRASH_RECORD_WORDS words (magic + checksum in word 0).
+void crash_record_encode(const crash_info_t *info, uint32_t out[CRASH_RECORD_WORDS]);
+
+// Unpack a record; false (and info untouched) if the magic or checksum is wrong,
+// e.g. after a power-on reset where the scratch registers read back as zero.
+bool crash_record_decode(const uint32_t in[CRASH_RECORD_WORDS], crash_info_t *info);
+
+// Ring of recent breadcrumbs ("boot,start,level 3,...") in uninitialised RAM.
+typedef struct {
+    uint32_t magic;
+    uint32_t head;          // next write position in buf
+    uint32_t check;         // covers magic, head and buf
+    uint32_t cfsr;
+    uint32_t last_feed_ms;
+    char buf[CRASH_TAIL_SIZE];
+} crash_tail_t;
+
+void crash_tail_reset(crash_tail_t *tail);
+
+// Append text plus a ',' separator, overwriting the oldest bytes when full.
+void crash_tail_append(crash_tail_t *tail, const char *text);
+
+// Copy the tail oldest-first into out (NUL-terminated); false if the tail
+// does not hold a valid ring (power-on garbage).
+bool crash_tail_read(const crash_tail_t *tail, char *out, size_t out_size);
+
+// Two short screen lines describing a crash (each NUL-terminated, <= size-1 chars).
+void crash_info_format(const crash_info_t *info, char *line1, char *line2, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
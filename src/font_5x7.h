@@ -0,0 +1,26 @@
+/*
+ * murmprince - 5x7 bitmap font
+ *
+ * Letters, digits and a little punctuation for text drawn straight into
+ * 8bpp buffers (start screen, debug overlay). A glyph is 7 rows of 5
+ * bits, bit 4 the leftmost pixel; text advances 6 pixels per character.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FONT_5X7_ADVANCE 6
+
+// Rows of the glyph for ch; unknown characters are blank.
+const uint8_t *font_5x7_glyph(char ch);
+
+#ifdef __cplusplus
+}
+#endif
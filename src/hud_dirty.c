@@ -0,0 +1,93 @@
+/*
+ * murmprince - HUD strip dirty tracking
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "hud_dirty.h"
+
+#include <string.h>
+
+void hud_dirty_init(hud_dirty_t *hud) {
+    memset(hud, 0, sizeof(*hud));
+    hud->all = true;
+}
+
+// Forget every cell that overlaps columns [left, right).
+static void hud_dirty_forget_cells(hud_dirty_t *hud, int left, int right) {
+    if (!hud->cells_used) return;
+    int from = left - HUD_DIRTY_MAX_CELL_W + 1;
+    if (from < 0) from = 0;
+    if (right > HUD_DIRTY_WIDTH) right = HUD_DIRTY_WIDTH;
+    for (int x = from; x < right; ++x) {
+        if (x + hud->cells[x].w > left) hud->cells[x].image = NULL;
+    }
+}
+
+// Record the strip part of a rect as needing presentation.
+static void hud_dirty_mark(hud_dirty_t *hud, int x, int y, int w, int h) {
+    if (y < HUD_DIRTY_TOP) {
+        h -= HUD_DIRTY_TOP - y;
+        y = HUD_DIRTY_TOP;
+    }
+    if (y + h > HUD_DIRTY_BOTTOM) h = HUD_DIRTY_BOTTOM - y;
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (x + w > HUD_DIRTY_WIDTH) w = HUD_DIRTY_WIDTH - x;
+    if (w <= 0 || h <= 0 || hud->all) return;
+    // Merge with an overlapping or touching rect; text and adjacent cells coalesce this way.
+    for (int i = 0; i < hud->count; ++i) {
+        hud_dirty_rect_t *r = &hud->rects[i];
+        if (x <= r->x + r->w && r->x <= x + w && y <= r->y + r->h && r->y <= y + h) {
+            const int right = r->x + r->w > x + w ? r->x + r->w : x + w;
+            const int bottom = r->y + r->h > y + h ? r->y + r->h : y + h;
+            if (x < r->x) r->x = x;
+            if (y < r->y) r->y = y;
+            r->w = right - r->x;
+            r->h = bottom - r->y;
+            return;
+        }
+    }
+    if (hud->count >= HUD_DIRTY_MAX_RECTS) {
+        hud->all = true;
+        return;
+    }
+    hud->rects[hud->count++] = (hud_dirty_rect_t){ x, y, w, h };
+}
+
+void hud_dirty_track(hud_dirty_t *hud, int x, int y, int w, int h) {
+    if (y + h <= HUD_DIRTY_TOP) return;
+    hud_dirty_forget_cells(hud, x, x + w);
+    hud_dirty_mark(hud, x, y, w, h);
+}
+
+bool hud_dirty_cell_unchanged(hud_dirty_t *hud, const void *image, int x, int y, int w, int h,
+                              uint8_t blit) {
+    hud_dirty_cell_t *cell = &hud->cells[x];
+    if (cell->image == image && cell->y == y && cell->blit == blit) {
+        ++hud->cells_skipped;
+        return true;
+    }
+    hud_dirty_forget_cells(hud, x, x + w);
+    cell->image = image;
+    cell->y = (short)y;
+    cell->w = (uint8_t)w;
+    cell->blit = blit;
+    hud->cells_used = true;
+    ++hud->cells_drawn;
+    hud_dirty_mark(hud, x, y, w, h);
+    return false;
+}
+
+void hud_dirty_reset_cells(hud_dirty_t *hud) {
+    if (!hud->cells_used) return;
+    memset(hud->cells, 0, sizeof(hud->cells));
+    hud->cells_used = false;
+}
+
+void hud_dirty_frame_done(hud_dirty_t *hud) {
+    hud->count = 0;
+    hud->all = false;
+}
@@ -0,0 +1,81 @@
+/*
+ * murmprince - HUD strip dirty tracking
+ *
+ * Rows 192..199 of SDLPoP's 320x200 onscreen surface (HP triangles, bottom
+ * text) are kept out of the game's dirty rects, so seg009.c tracks them
+ * here: every write that reaches the strip is recorded as a rect, merged
+ * with any rect it overlaps or touches, and during gameplay only those
+ * rects are presented. Past HUD_DIRTY_MAX_RECTS rects the whole strip is
+ * presented instead.
+ *
+ * Small HUD cells (the HP triangles) also keep a shadow of what was last
+ * drawn with its left edge at each x. Drawing the same image with the same
+ * blitter at the same place again leaves the same pixels, for an opaque
+ * copy and a masked one alike, as long as nothing else wrote there in
+ * between; every other tracked write forgets the cells it overlaps. Such a
+ * cell is neither redrawn nor presented.
+ *
+ * Pure logic: runs on a host (tests/test_hud_dirty.c).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUD_DIRTY_TOP 192
+#define HUD_DIRTY_BOTTOM 200
+#define HUD_DIRTY_WIDTH 320
+#define HUD_DIRTY_MAX_RECTS 16
+#define HUD_DIRTY_MAX_CELL_W 16
+
+typedef struct {
+    int x, y, w, h;
+} hud_dirty_rect_t;
+
+typedef struct {
+    const void *image;              // NULL: nothing known at this x
+    short y;
+    uint8_t w;
+    uint8_t blit;
+} hud_dirty_cell_t;
+
+typedef struct {
+    hud_dirty_rect_t rects[HUD_DIRTY_MAX_RECTS];
+    int count;
+    bool all;                       // present the whole strip
+    bool cells_used;
+    hud_dirty_cell_t cells[HUD_DIRTY_WIDTH];
+    uint32_t cells_drawn;
+    uint32_t cells_skipped;
+} hud_dirty_t;
+
+// Everything dirty, no cells known.
+void hud_dirty_init(hud_dirty_t *hud);
+
+// A write to the onscreen surface at (x, y, w, h) that is not a HUD cell.
+// Writes above the strip are ignored.
+void hud_dirty_track(hud_dirty_t *hud, int x, int y, int w, int h);
+
+// A HUD cell about to be drawn with its left edge at x. True if the same
+// cell is already on screen and the draw can be skipped; otherwise the
+// cell is recorded and marked dirty. The caller checks the cell qualifies
+// (inside the strip, at most HUD_DIRTY_MAX_CELL_W wide, a stable image).
+bool hud_dirty_cell_unchanged(hud_dirty_t *hud, const void *image, int x, int y, int w, int h,
+                              uint8_t blit);
+
+// Forget every cell (images about to be freed, untracked writers).
+void hud_dirty_reset_cells(hud_dirty_t *hud);
+
+// The frame was presented: start an empty list.
+void hud_dirty_frame_done(hud_dirty_t *hud);
+
+#ifdef __cplusplus
+}
+#endif
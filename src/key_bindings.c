@@ -0,0 +1,373 @@
+/*
+ * murmprince - key bindings
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "key_bindings.h"
+#include "pop_fs.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// SDL scancodes (see SDL_port.h); this file stays free of SDL headers.
+#define SC_R 21
+#define SC_ESCAPE 41
+#define SC_RIGHT 79
+#define SC_LEFT 80
+#define SC_DOWN 81
+#define SC_UP 82
+#define SC_KP_2 90
+#define SC_KP_4 92
+#define SC_KP_5 93
+#define SC_KP_6 94
+#define SC_KP_8 96
+#define SC_CLEAR 100
+#define SC_LCTRL 224
+#define SC_LSHIFT 225
+#define SC_LALT 226
+#define SC_RCTRL 228
+#define SC_RSHIFT 229
+#define SC_RALT 230
+#define SC_LIMIT 512 // SDL_NUM_SCANCODES
+
+#define MOD_LCTRL 0x0040 // KMOD_LCTRL
+#define MOD_CTRL 0x00C0  // KMOD_CTRL
+#define MOD_ALT 0x0300   // KMOD_ALT
+
+typedef struct {
+    const char *name;
+    uint16_t scancode; // what the game is handed
+    uint16_t mod;
+    // Stock keys SDLPoP checks for this action itself. Unless bound, they
+    // are swallowed, so moving an action off them really frees them. The
+    // diagonal keys (Home, PgUp, KP 7/9) are jumps and stay as they are.
+    // Esc and Ctrl+R keep working regardless: menus depend on them.
+    uint16_t stock[4];
+} action_info_t;
+
+static const action_info_t actions[KEY_ACTION_COUNT] = {
+    [KEY_ACTION_LEFT] = {"left", SC_LEFT, 0, {SC_LEFT, SC_KP_4}},
+    [KEY_ACTION_RIGHT] = {"right", SC_RIGHT, 0, {SC_RIGHT, SC_KP_6}},
+    [KEY_ACTION_UP] = {"up", SC_UP, 0, {SC_UP, SC_KP_8}},
+    [KEY_ACTION_DOWN] = {"down", SC_DOWN, 0, {SC_DOWN, SC_KP_2, SC_KP_5, SC_CLEAR}},
+    [KEY_ACTION_SHIFT] = {"shift", SC_LSHIFT, 0, {SC_LSHIFT, SC_RSHIFT}},
+    [KEY_ACTION_RESTART] = {"restart", SC_R, MOD_LCTRL, {0}},
+    [KEY_ACTION_PAUSE] = {"pause", SC_ESCAPE, 0, {0}},
+};
+
+typedef struct {
+    uint16_t scancode;
+    const char *name;
+} key_name_t;
+
+// Letters, digits and F-keys are generated; everything else is listed.
+// Names stick to characters the start screen font can draw.
+static const key_name_t key_names[] = {
+    {40, "Enter"},     {41, "Esc"},       {42, "Backspace"}, {43, "Tab"},
+    {44, "Space"},     {45, "Minus"},     {46, "Equals"},    {47, "LBracket"},
+    {48, "RBracket"},  {49, "Backslash"}, {51, "Semicolon"}, {52, "Quote"},
+    {53, "Grave"},     {54, "Comma"},     {55, "Period"},    {56, "Slash"},
+    {57, "CapsLock"},  {73, "Insert"},    {74, "Home"},      {75, "PgUp"},
+    {76, "Delete"},    {77, "End"},       {78, "PgDn"},      {79, "Right"},
+    {80, "Left"},      {81, "Down"},      {82, "Up"},        {84, "KPDiv"},
+    {85, "KPMul"},     {86, "KPMinus"},   {87, "KPPlus"},    {88, "KPEnter"},
+    {89, "KP1"},       {90, "KP2"},       {91, "KP3"},       {92, "KP4"},
+    {93, "KP5"},       {94, "KP6"},       {95, "KP7"},       {96, "KP8"},
+    {97, "KP9"},       {98, "KP0"},       {99, "KPDot"},     {100, "Clear"},
+    {224, "LCtrl"},    {225, "LShift"},   {226, "LAlt"},     {227, "LGui"},
+    {228, "RCtrl"},    {229, "RShift"},   {230, "RAlt"},     {231, "RGui"},
+};
+
+void key_bindings_default(key_bindings_t *kb) {
+    memset(kb, 0, sizeof(*kb));
+    kb->keys[KEY_ACTION_LEFT][0] = SC_LEFT;
+    kb->keys[KEY_ACTION_RIGHT][0] = SC_RIGHT;
+    kb->keys[KEY_ACTION_UP][0] = SC_UP;
+    kb->keys[KEY_ACTION_DOWN][0] = SC_DOWN;
+    kb->keys[KEY_ACTION_SHIFT][0] = SC_LSHIFT;
+    kb->keys[KEY_ACTION_SHIFT][1] = SC_RSHIFT;
+    kb->keys[KEY_ACTION_PAUSE][0] = SC_ESCAPE;
+}
+
+int key_bindings_count(const key_bindings_t *kb, key_action_t action) {
+    int n = 0;
+    while (n < KEY_BINDINGS_PER_ACTION && kb->keys[action][n]) ++n;
+    return n;
+}
+
+bool key_bindings_bindable(key_action_t action, int scancode) {
+    switch (scancode) {
+        case SC_LCTRL:
+        case SC_RCTRL:
+        case SC_LALT:
+        case SC_RALT:
+            return false;
+        case SC_ESCAPE:
+            return action == KEY_ACTION_PAUSE;
+        default:
+            return true;
+    }
+}
+
+bool key_bindings_add(key_bindings_t *kb, key_action_t action, int scancode) {
+    if (action < 0 || action >= KEY_ACTION_COUNT) return false;
+    if (scancode <= 0 || scancode >= SC_LIMIT) return false;
+    if (!key_bindings_bindable(action, scancode)) return false;
+    const int n = key_bindings_count(kb, action);
+    for (int i = 0; i < n; ++i) {
+        if (kb->keys[action][i] == scancode) return false;
+    }
+    if (n == KEY_BINDINGS_PER_ACTION) return false;
+    kb->keys[action][n] = (uint16_t)scancode;
+    return true;
+}
+
+void key_bindings_remove(key_bindings_t *kb, int action, int scancode) {
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        if (action >= 0 && a != action) continue;
+        // Keep each list packed: entries after a hole move up.
+        int out = 0;
+        for (int i = 0; i < KEY_BINDINGS_PER_ACTION; ++i) {
+            const uint16_t sc = kb->keys[a][i];
+            if (sc && sc != scancode) kb->keys[a][out++] = sc;
+        }
+        while (out < KEY_BINDINGS_PER_ACTION) kb->keys[a][out++] = 0;
+    }
+}
+
+bool key_bindings_remove_last(key_bindings_t *kb, key_action_t action) {
+    const int n = key_bindings_count(kb, action);
+    if (n == 0) return false;
+    kb->keys[action][n - 1] = 0;
+    return true;
+}
+
+int key_bindings_action_of(const key_bindings_t *kb, int scancode) {
+    if (scancode <= 0) return -1;
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        for (int i = 0; i < KEY_BINDINGS_PER_ACTION; ++i) {
+            if (kb->keys[a][i] == scancode) return a;
+        }
+    }
+    return -1;
+}
+
+bool key_bindings_find_conflict(const key_bindings_t *kb, int *scancode,
+                                int *action_a, int *action_b) {
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        for (int i = 0; i < KEY_BINDINGS_PER_ACTION; ++i) {
+            const uint16_t sc = kb->keys[a][i];
+            if (!sc) continue;
+            for (int b = a + 1; b < KEY_ACTION_COUNT; ++b) {
+                for (int j = 0; j < KEY_BINDINGS_PER_ACTION; ++j) {
+                    if (kb->keys[b][j] != sc) continue;
+                    if (scancode) *scancode = sc;
+                    if (action_a) *action_a = a;
+                    if (action_b) *action_b = b;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool key_bindings_resolve(const key_bindings_t *kb, int scancode, int held_mod,
+                          int *game_scancode, int *game_mod) {
+    // Shortcuts: Ctrl+A is Ctrl+A whatever A is bound to
+    if (held_mod & (MOD_CTRL | MOD_ALT)) {
+        *game_scancode = scancode;
+        *game_mod = 0;
+        return true;
+    }
+    const int action = key_bindings_action_of(kb, scancode);
+    if (action >= 0) {
+        *game_scancode = actions[action].scancode;
+        *game_mod = actions[action].mod;
+        return true;
+    }
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        for (int i = 0; i < 4 && actions[a].stock[i]; ++i) {
+            if (actions[a].stock[i] == scancode) return false;
+        }
+    }
+    *game_scancode = scancode;
+    *game_mod = 0;
+    return true;
+}
+
+const char *key_bindings_action_name(key_action_t action) {
+    if (action < 0 || action >= KEY_ACTION_COUNT) return "?";
+    return actions[action].name;
+}
+
+void key_bindings_key_name(int scancode, char *buf, size_t buf_size) {
+    if (buf_size == 0) return;
+    if (scancode >= 4 && scancode <= 29) {
+        snprintf(buf, buf_size, "%c", 'A' + (scancode - 4));
+        return;
+    }
+    if (scancode >= 30 && scancode <= 39) {
+        snprintf(buf, buf_size, "%c", scancode == 39 ? '0' : '1' + (scancode - 30));
+        return;
+    }
+    if (scancode >= 58 && scancode <= 69) {
+        snprintf(buf, buf_size, "F%d", scancode - 57);
+        return;
+    }
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); ++i) {
+        if (key_names[i].scancode == scancode) {
+            snprintf(buf, buf_size, "%s", key_names[i].name);
+            return;
+        }
+    }
+    snprintf(buf, buf_size, "Key%d", scancode);
+}
+
+int key_bindings_key_from_name(const char *name) {
+    const size_t len = strlen(name);
+    if (len == 1) {
+        const char c = (char)toupper((unsigned char)name[0]);
+        if (c >= 'A' && c <= 'Z') return 4 + (c - 'A');
+        if (c >= '1' && c <= '9') return 30 + (c - '1');
+        if (c == '0') return 39;
+    }
+    if (len >= 2 && (name[0] == 'F' || name[0] == 'f') && isdigit((unsigned char)name[1])) {
+        int n = 0;
+        for (const char *p = name + 1; *p; ++p) {
+            if (!isdigit((unsigned char)*p)) return 0;
+            n = n * 10 + (*p - '0');
+        }
+        return (n >= 1 && n <= 12) ? 57 + n : 0;
+    }
+    if (len > 3 && strncasecmp(name, "Key", 3) == 0) {
+        int n = 0;
+        for (const char *p = name + 3; *p; ++p) {
+            if (!isdigit((unsigned char)*p) || n >= SC_LIMIT) return 0;
+            n = n * 10 + (*p - '0');
+        }
+        return (n > 0 && n < SC_LIMIT) ? n : 0;
+    }
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); ++i) {
+        if (strcasecmp(key_names[i].name, name) == 0) return key_names[i].scancode;
+    }
+    return 0;
+}
+
+// Copy [start, end) into buf without surrounding blanks.
+static void trimmed(const char *start, const char *end, char *buf, size_t buf_size) {
+    while (start < end && isspace((unsigned char)*start)) ++start;
+    while (end > start && isspace((unsigned char)end[-1])) --end;
+    size_t n = (size_t)(end - start);
+    if (n >= buf_size) n = buf_size - 1;
+    memcpy(buf, start, n);
+    buf[n] = '\0';
+}
+
+static int action_from_name(const char *name) {
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        if (strcasecmp(actions[a].name, name) == 0) return a;
+    }
+    return -1;
+}
+
+// One "action = key, key" line; false if it names no action or holds a
+// key that cannot be used.
+static bool parse_line(key_bindings_t *kb, const char *line, const char *end) {
+    const char *eq = memchr(line, '=', (size_t)(end - line));
+    if (!eq) return false;
+    char word[16];
+    trimmed(line, eq, word, sizeof(word));
+    const int action = action_from_name(word);
+    if (action < 0) return false;
+
+    // The line replaces the action's defaults, even when it is empty.
+    memset(kb->keys[action], 0, sizeof(kb->keys[action]));
+    bool ok = true;
+    for (const char *p = eq + 1; p < end;) {
+        const char *comma = memchr(p, ',', (size_t)(end - p));
+        const char *stop = comma ? comma : end;
+        trimmed(p, stop, word, sizeof(word));
+        if (word[0]) {
+            const int sc = key_bindings_key_from_name(word);
+            if (!sc || !key_bindings_add(kb, (key_action_t)action, sc)) ok = false;
+        }
+        p = comma ? comma + 1 : end;
+    }
+    return ok;
+}
+
+int key_bindings_parse(key_bindings_t *kb, const char *text) {
+    key_bindings_default(kb);
+    int bad = 0;
+    for (const char *line = text; *line;) {
+        const char *end = strchr(line, '\n');
+        if (!end) end = line + strlen(line);
+        const char *p = line;
+        while (p < end && isspace((unsigned char)*p)) ++p;
+        if (p < end && *p != '#' && *p != ';' && !parse_line(kb, p, end)) ++bad;
+        line = *end ? end + 1 : end;
+    }
+    return bad;
+}
+
+size_t key_bindings_format(const key_bindings_t *kb, char *buf, size_t buf_size) {
+    if (buf_size == 0) return 0;
+    size_t len = 0;
+    int n = snprintf(buf, buf_size, "# murmprince key bindings: action = key, key ...\n");
+    len = (n > 0) ? (size_t)n : 0;
+    for (int a = 0; a < KEY_ACTION_COUNT && len < buf_size; ++a) {
+        n = snprintf(buf + len, buf_size - len, "%s =", actions[a].name);
+        len += (n > 0) ? (size_t)n : 0;
+        for (int i = 0; i < KEY_BINDINGS_PER_ACTION && kb->keys[a][i] && len < buf_size; ++i) {
+            char name[16];
+            key_bindings_key_name(kb->keys[a][i], name, sizeof(name));
+            n = snprintf(buf + len, buf_size - len, "%s %s", i ? "," : "", name);
+            len += (n > 0) ? (size_t)n : 0;
+        }
+        if (len < buf_size) {
+            n = snprintf(buf + len, buf_size - len, "\n");
+            len += (n > 0) ? (size_t)n : 0;
+        }
+    }
+    return len < buf_size ? len : buf_size - 1;
+}
+
+bool key_bindings_load(key_bindings_t *kb) {
+    key_bindings_default(kb);
+    if (!pop_fs_exists(KEY_BINDINGS_FILE)) return true;
+    FIL *f = pop_fs_open(KEY_BINDINGS_FILE, "rb");
+    if (!f) return false;
+    char text[KEY_BINDINGS_FILE_MAX + 1];
+    const size_t n = pop_fs_read(text, 1, KEY_BINDINGS_FILE_MAX, f);
+    pop_fs_close(f);
+    text[n] = '\0';
+    key_bindings_parse(kb, text);
+    return true;
+}
+
+bool key_bindings_save(const key_bindings_t *kb) {
+    char text[KEY_BINDINGS_FILE_MAX];
+    const size_t len = key_bindings_format(kb, text, sizeof(text));
+    // "wb" is committed by rename: a cut leaves the old file.
+    FIL *f = pop_fs_open(KEY_BINDINGS_FILE, "wb");
+    if (!f) return false;
+    if (pop_fs_write(text, 1, len, f) != len) {
+        pop_fs_discard(f);
+        return false;
+    }
+    return pop_fs_close(f) == 0;
+}
+
+key_bindings_t *key_bindings_active(void) {
+    static key_bindings_t active;
+    static bool ready;
+    if (!ready) {
+        key_bindings_default(&active);
+        ready = true;
+    }
+    return &active;
+}
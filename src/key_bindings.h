@@ -0,0 +1,113 @@
+/*
+ * murmprince - key bindings
+ *
+ * A layer between the keys the keyboards report and the keys SDLPoP looks
+ * for. Each game action (left, right, up, down, shift, restart, pause) has
+ * up to KEY_BINDINGS_PER_ACTION keys. A bound key is handed to the game as
+ * the action's own key (restart as Ctrl+R, pause as Esc); an unbound key
+ * that is an action's own key is swallowed, so the bindings are the whole
+ * truth for those actions. All other keys pass through untouched, and so
+ * does every key while Ctrl or Alt is held: SDLPoP's shortcuts (Ctrl+A,
+ * Ctrl+R, Alt+Enter) mean the keys as printed. For the same reason Ctrl
+ * and Alt cannot be bound, and Esc only to pause.
+ *
+ * The bindings live in KEYS.CFG on the card, one "action = key, key" line
+ * per action, and are edited on the start screen. A key bound to two
+ * actions is a conflict: resolution then takes the first action, and the
+ * start screen points it out.
+ *
+ * Parsing, formatting and resolution are pure; file access goes through
+ * pop_fs.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KEY_BINDINGS_FILE "KEYS.CFG"
+#define KEY_BINDINGS_PER_ACTION 4
+#define KEY_BINDINGS_FILE_MAX 1024
+
+typedef enum {
+    KEY_ACTION_LEFT = 0,
+    KEY_ACTION_RIGHT,
+    KEY_ACTION_UP,
+    KEY_ACTION_DOWN,
+    KEY_ACTION_SHIFT,
+    KEY_ACTION_RESTART,
+    KEY_ACTION_PAUSE,
+    KEY_ACTION_COUNT
+} key_action_t;
+
+typedef struct {
+    uint16_t keys[KEY_ACTION_COUNT][KEY_BINDINGS_PER_ACTION]; // SDL scancodes, 0 = unused
+} key_bindings_t;
+
+// Stock keys: arrows, both Shifts, Esc; restart stays on Ctrl+R only.
+void key_bindings_default(key_bindings_t *kb);
+
+// Whether a key may be bound to an action: not Ctrl or Alt, and Esc only
+// to pause.
+bool key_bindings_bindable(key_action_t action, int scancode);
+
+// Bind a key to an action. False if it already is, cannot be (see
+// key_bindings_bindable), or the action is full.
+bool key_bindings_add(key_bindings_t *kb, key_action_t action, int scancode);
+
+// Remove a key from one action (or from all with action < 0).
+void key_bindings_remove(key_bindings_t *kb, int action, int scancode);
+
+// Drop the most recently added key of an action; false if it had none.
+bool key_bindings_remove_last(key_bindings_t *kb, key_action_t action);
+
+int key_bindings_count(const key_bindings_t *kb, key_action_t action);
+
+// First action the key is bound to, or -1.
+int key_bindings_action_of(const key_bindings_t *kb, int scancode);
+
+// A key bound to more than one action: true and the first such key and
+// its first two actions (any pointer may be NULL).
+bool key_bindings_find_conflict(const key_bindings_t *kb, int *scancode,
+                                int *action_a, int *action_b);
+
+// What the game gets for a key pressed while held_mod (SDL modifiers) is
+// down: true and the scancode plus SDL modifiers to report, or false if
+// the key is swallowed.
+bool key_bindings_resolve(const key_bindings_t *kb, int scancode, int held_mod,
+                          int *game_scancode, int *game_mod);
+
+// Lower-case action name as used in the file ("left", "restart").
+const char *key_bindings_action_name(key_action_t action);
+
+// Key name as used in the file and on screen ("A", "Left", "F5"); keys
+// without a name are written "Key<scancode>".
+void key_bindings_key_name(int scancode, char *buf, size_t buf_size);
+// Inverse of key_bindings_key_name (case-insensitive); 0 if unknown.
+int key_bindings_key_from_name(const char *name);
+
+// Text form. parse starts from the defaults, so actions missing from the
+// text keep them; unknown actions and keys are skipped. Returns the number
+// of lines that could not be used.
+int key_bindings_parse(key_bindings_t *kb, const char *text);
+// Returns the length written (truncated to buf_size - 1).
+size_t key_bindings_format(const key_bindings_t *kb, char *buf, size_t buf_size);
+
+// KEYS.CFG on the card. load falls back to the defaults when the file is
+// missing or unreadable (and returns false only in the latter case).
+bool key_bindings_load(key_bindings_t *kb);
+bool key_bindings_save(const key_bindings_t *kb);
+
+// The set SDL_port.c applies to keyboard events.
+key_bindings_t *key_bindings_active(void);
+
+#ifdef __cplusplus
+}
+#endif
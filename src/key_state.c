@@ -0,0 +1,33 @@
+/*
+ * murmprince - combined key state of several keyboards
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "key_state.h"
+
+#include <string.h>
+
+void key_state_init(key_state_t *ks) {
+    memset(ks, 0, sizeof(*ks));
+}
+
+bool key_state_held_by(const key_state_t *ks, key_source_t source, int scancode) {
+    if (scancode < 0 || scancode >= KEY_STATE_SCANCODES) return false;
+    return (ks->held[source][scancode >> 5] >> (scancode & 31)) & 1u;
+}
+
+bool key_state_update(key_state_t *ks, key_source_t source, int scancode, bool down) {
+    if (scancode < 0 || scancode >= KEY_STATE_SCANCODES) return false;
+    const uint32_t bit = 1u << (scancode & 31);
+    uint32_t *word = &ks->held[source][scancode >> 5];
+    *word = down ? (*word | bit) : (*word & ~bit);
+
+    uint8_t any = 0;
+    for (int s = 0; s < KEY_SOURCE_COUNT; ++s) {
+        if (ks->held[s][scancode >> 5] & bit) any = 1;
+    }
+    if (ks->combined[scancode] == any) return false;
+    ks->combined[scancode] = any;
+    return true;
+}
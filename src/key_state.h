@@ -0,0 +1,50 @@
+/*
+ * murmprince - combined key state of several keyboards
+ *
+ * The PS/2 and USB keyboards each report their own presses and releases.
+ * Every source keeps its own bitmap of held keys; the state the game sees
+ * is their OR. A key goes down when the first source presses it and up
+ * only when the last source lets go, so a release on one keyboard does
+ * not drop a key still held on the other. Only changes of the combined
+ * state become SDL key events.
+ *
+ * Pure logic: no driver or SDL dependencies.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KEY_STATE_SCANCODES 512 // SDL_NUM_SCANCODES
+
+typedef enum {
+    KEY_SOURCE_PS2 = 0,
+    KEY_SOURCE_USB,
+    KEY_SOURCE_SERIAL,  // injected by the serial test link
+    KEY_SOURCE_COUNT,
+} key_source_t;
+
+typedef struct {
+    uint32_t held[KEY_SOURCE_COUNT][KEY_STATE_SCANCODES / 32];
+    uint8_t combined[KEY_STATE_SCANCODES]; // 1 while any source holds the key
+} key_state_t;
+
+void key_state_init(key_state_t *ks);
+
+// Record a press or release from one source. Returns true if the combined
+// state of the key changed, i.e. an SDL event is due. Out-of-range
+// scancodes are ignored.
+bool key_state_update(key_state_t *ks, key_source_t source, int scancode, bool down);
+
+bool key_state_held_by(const key_state_t *ks, key_source_t source, int scancode);
+
+#ifdef __cplusplus
+}
+#endif
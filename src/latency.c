@@ -0,0 +1,153 @@
+/*
+ * murmprince - input latency tracker
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "latency.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const span_names[LATENCY_SPAN_COUNT] = {
+    "input>event",
+    "event>tick",
+    "tick>present",
+    "present>scan",
+    "total",
+};
+
+void latency_init(latency_t *l) {
+    memset(l, 0, sizeof(*l));
+}
+
+void latency_hist_add(latency_hist_t *h, uint32_t us) {
+    uint32_t bucket = us / LATENCY_BUCKET_US;
+    if (bucket < LATENCY_BUCKETS) {
+        if (h->counts[bucket] < UINT16_MAX) h->counts[bucket]++;
+    } else {
+        h->over++;
+    }
+    if (h->n == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->n++;
+    h->sum_us += us;
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *h, unsigned percent) {
+    if (h->n == 0) return 0;
+    uint32_t target = (uint32_t)(((uint64_t)h->n * percent + 99) / 100);
+    if (target == 0) target = 1;
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            uint32_t us = (uint32_t)i * LATENCY_BUCKET_US + LATENCY_BUCKET_US / 2;
+            if (us < h->min_us) us = h->min_us;
+            if (us > h->max_us) us = h->max_us;
+            return us;
+        }
+    }
+    return h->max_us;
+}
+
+bool latency_event(latency_t *l, uint32_t input_us, uint32_t event_us) {
+    if (l->phase != LATENCY_IDLE) {
+        l->skipped++;
+        return false;
+    }
+    // A stamp from after the event is from the next press: not this one's
+    if ((int32_t)(event_us - input_us) < 0) input_us = event_us;
+    l->input_us = input_us;
+    l->event_us = event_us;
+    l->phase = LATENCY_WAIT_TICK;
+    return true;
+}
+
+void latency_tick(latency_t *l, uint32_t now_us) {
+    l->ticks++;
+    if (l->phase != LATENCY_WAIT_TICK) return;
+    l->tick_us = now_us;
+    l->tick = l->ticks;
+    l->phase = LATENCY_WAIT_PRESENT;
+}
+
+void latency_present(latency_t *l, uint32_t now_us, uint32_t vsync_count) {
+    if (l->phase != LATENCY_WAIT_PRESENT) return;
+    l->present_us = now_us;
+    l->present_vsync = vsync_count;
+    l->phase = LATENCY_WAIT_SCANOUT;
+}
+
+bool latency_poll(latency_t *l, uint32_t now_us, uint32_t vsync_count,
+                  uint32_t vsync_us, uint32_t frame_us) {
+    if (l->phase == LATENCY_IDLE) return false;
+    if (l->phase != LATENCY_WAIT_SCANOUT || vsync_count == l->present_vsync) {
+        if (now_us - l->event_us > LATENCY_TIMEOUT_US) {
+            l->timeouts++;
+            l->phase = LATENCY_IDLE;
+        }
+        return false;
+    }
+
+    // The first vsync after the copy, dated back if more have passed since
+    uint32_t scan_us = vsync_us - (vsync_count - l->present_vsync - 1) * frame_us;
+    if ((int32_t)(scan_us - l->present_us) < 0) scan_us = l->present_us;
+
+    l->last[LATENCY_INPUT_EVENT] = l->event_us - l->input_us;
+    l->last[LATENCY_EVENT_TICK] = l->tick_us - l->event_us;
+    l->last[LATENCY_TICK_PRESENT] = l->present_us - l->tick_us;
+    l->last[LATENCY_PRESENT_SCANOUT] = scan_us - l->present_us;
+    l->last[LATENCY_TOTAL] = scan_us - l->input_us;
+    for (int i = 0; i < LATENCY_SPAN_COUNT; i++) latency_hist_add(&l->hist[i], l->last[i]);
+    l->phase = LATENCY_IDLE;
+    return true;
+}
+
+const char *latency_span_name(latency_span_t span) {
+    return (unsigned)span < LATENCY_SPAN_COUNT ? span_names[span] : "?";
+}
+
+// Microseconds as milliseconds with one decimal
+static void format_ms(char *buf, size_t size, uint32_t us) {
+    snprintf(buf, size, "%lu.%lu", (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 100));
+}
+
+int latency_format_span(const latency_t *l, latency_span_t span, char *buf, size_t size) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) span = LATENCY_TOTAL;
+    const latency_hist_t *h = &l->hist[span];
+    if (h->n == 0) {
+        return snprintf(buf, size, "%-12s n 0", latency_span_name(span));
+    }
+    char min[12], med[12], p95[12], max[12], mean[12];
+    format_ms(min, sizeof(min), h->min_us);
+    format_ms(med, sizeof(med), latency_hist_percentile(h, 50));
+    format_ms(p95, sizeof(p95), latency_hist_percentile(h, 95));
+    format_ms(max, sizeof(max), h->max_us);
+    format_ms(mean, sizeof(mean), (uint32_t)(h->sum_us / h->n));
+    return snprintf(buf, size, "%-12s n %lu  min %s  med %s  p95 %s  max %s  mean %s ms",
+                    latency_span_name(span), (unsigned long)h->n, min, med, p95, max, mean);
+}
+
+int latency_format_hist(const latency_hist_t *h, unsigned bin_ms, char *buf, size_t size) {
+    if (size == 0) return 0;
+    buf[0] = '\0';
+    unsigned per_bin = bin_ms * 1000u / LATENCY_BUCKET_US;
+    if (per_bin == 0) per_bin = 1;
+    size_t len = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKETS && len < size; i += per_bin) {
+        uint32_t count = 0;
+        for (unsigned j = i; j < i + per_bin && j < LATENCY_BUCKETS; j++) count += h->counts[j];
+        if (count == 0) continue;
+        int n = snprintf(buf + len, size - len, "%s%u:%lu", len ? " " : "",
+                         i * LATENCY_BUCKET_US / 1000, (unsigned long)count);
+        if (n < 0) break;
+        len += (size_t)n;
+    }
+    if (h->over && len < size) {
+        int n = snprintf(buf + len, size - len, "%s%u+:%lu", len ? " " : "",
+                         LATENCY_BUCKETS * LATENCY_BUCKET_US / 1000, (unsigned long)h->over);
+        if (n > 0) len += (size_t)n;
+    }
+    return (int)(len < size ? len : size - 1);
+}
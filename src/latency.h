@@ -0,0 +1,112 @@
+/*
+ * murmprince - input latency tracker
+ *
+ * Follows one key press at a time through the pipeline and keeps a
+ * histogram per stage:
+ *
+ *   input    keyboard IRQ (PS/2) or report callback (USB)
+ *   event    SDL_PollEvent buffers the key event for the game
+ *   tick     read_user_control() of the next game tick takes it
+ *   present  update_screen() has copied that tick's frame to the
+ *            scanout buffer
+ *   scanout  start of the first HDMI frame that begins after the copy
+ *
+ * Presses that arrive while one is being followed are counted as skipped,
+ * and a press no tick or frame follows within LATENCY_TIMEOUT_US (menus,
+ * pause) is dropped. The scanout buffer is read directly, without page
+ * flipping, so rows below the beam may show up to a frame earlier than
+ * "scanout"; it is the time the whole picture is on screen.
+ *
+ * Pure logic: the caller passes every timestamp (microseconds, wrapping),
+ * so the same code runs on a host (tools/latency_sim.c).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_BUCKET_US 1000      // histogram resolution
+#define LATENCY_BUCKETS 250         // longer spans go to "over"
+#define LATENCY_TIMEOUT_US 2000000
+
+typedef enum {
+    LATENCY_INPUT_EVENT = 0,
+    LATENCY_EVENT_TICK,
+    LATENCY_TICK_PRESENT,
+    LATENCY_PRESENT_SCANOUT,
+    LATENCY_TOTAL,              // input to scanout
+    LATENCY_SPAN_COUNT,
+} latency_span_t;
+
+typedef struct {
+    uint16_t counts[LATENCY_BUCKETS];
+    uint32_t over;
+    uint32_t n;
+    uint32_t min_us, max_us;
+    uint64_t sum_us;
+} latency_hist_t;
+
+typedef enum {
+    LATENCY_IDLE = 0,
+    LATENCY_WAIT_TICK,
+    LATENCY_WAIT_PRESENT,
+    LATENCY_WAIT_SCANOUT,
+} latency_phase_t;
+
+typedef struct {
+    latency_phase_t phase;
+    uint32_t input_us, event_us, tick_us, present_us;
+    uint32_t present_vsync;     // vsync count when the frame was copied
+    uint32_t ticks;             // game ticks seen
+    uint32_t tick;              // the tick that took the press
+    latency_hist_t hist[LATENCY_SPAN_COUNT];
+    uint32_t last[LATENCY_SPAN_COUNT];  // spans of the last sample
+    uint32_t skipped;           // presses while one was followed
+    uint32_t timeouts;          // presses nothing followed
+} latency_t;
+
+void latency_init(latency_t *l);
+
+// A key press reached the game's event queue. input_us is its IRQ or
+// callback time (event_us if there is none). Returns true if it is now
+// followed.
+bool latency_event(latency_t *l, uint32_t input_us, uint32_t event_us);
+
+// read_user_control() ran.
+void latency_tick(latency_t *l, uint32_t now_us);
+
+// update_screen() finished copying a frame; vsync_count as read after
+// the copy.
+void latency_present(latency_t *l, uint32_t now_us, uint32_t vsync_count);
+
+// Latest vsync: its count and time, and the frame period to date any
+// vsyncs passed in between. Also drops a press that timed out. Returns
+// true when a sample completed (l->last holds it).
+bool latency_poll(latency_t *l, uint32_t now_us, uint32_t vsync_count,
+                  uint32_t vsync_us, uint32_t frame_us);
+
+void latency_hist_add(latency_hist_t *h, uint32_t us);
+
+// Value below which percent of the samples lie, to the bucket; 0 if empty.
+uint32_t latency_hist_percentile(const latency_hist_t *h, unsigned percent);
+
+const char *latency_span_name(latency_span_t span);
+
+// "<name> n <n> min .. med .. p95 .. max .. mean .. ms" for one span.
+int latency_format_span(const latency_t *l, latency_span_t span, char *buf, size_t size);
+
+// Non-empty bins of bin_ms, "<from ms>:<count>" separated by spaces;
+// "<limit>+:<count>" for the overflow. Truncated to size.
+int latency_format_hist(const latency_hist_t *h, unsigned bin_ms, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * murmprince - input latency measurement
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "latency_probe.h"
+
+#include "pico/stdlib.h"
+
+#ifndef RP2350_LATENCY
+#define RP2350_LATENCY 0
+#endif
+
+#if RP2350_LATENCY
+
+#include "HDMI.h"
+#include "latency.h"
+#include "log_sink.h"
+#include "hardware/sync.h"
+
+#include <stdio.h>
+
+static latency_t tracker;
+static uint32_t samples;
+
+// Input stamps by source: set by the drivers, taken at each drain
+static volatile uint32_t stamp[KEY_SOURCE_COUNT];
+static uint32_t taken[KEY_SOURCE_COUNT];
+
+void latency_probe_input(key_source_t source) {
+    if ((unsigned)source >= KEY_SOURCE_COUNT) return;
+    // 0 means "none": one microsecond early is close enough
+    if (!stamp[source]) stamp[source] = time_us_32() | 1;
+}
+
+void latency_probe_drain(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < KEY_SOURCE_COUNT; i++) {
+        taken[i] = stamp[i];
+        stamp[i] = 0;
+    }
+    restore_interrupts(irq);
+}
+
+void latency_probe_key(key_source_t source, bool down) {
+    if ((unsigned)source >= KEY_SOURCE_COUNT) return;
+    uint32_t now = time_us_32();
+    uint32_t input = taken[source] ? taken[source] : now;
+    // The stamp is for the first event of the drain; later ones have none
+    taken[source] = 0;
+    if (down) latency_event(&tracker, input, now);
+}
+
+void latency_probe_tick(void) {
+    latency_tick(&tracker, time_us_32());
+}
+
+void latency_probe_present(void) {
+    latency_present(&tracker, time_us_32(), graphics_get_vsync_count());
+}
+
+static void report(void) {
+    char line[128];
+    log_printf(LOG_INFO, "latency: %lu samples, %lu skipped, %lu timed out",
+               (unsigned long)samples, (unsigned long)tracker.skipped,
+               (unsigned long)tracker.timeouts);
+    for (int i = 0; i < LATENCY_SPAN_COUNT; i++) {
+        latency_format_span(&tracker, (latency_span_t)i, line, sizeof(line));
+        log_printf(LOG_INFO, "latency: %s", line);
+    }
+    latency_format_hist(&tracker.hist[LATENCY_TOTAL], 4, line, sizeof(line));
+    log_printf(LOG_INFO, "latency: total by 4 ms: %s", line);
+}
+
+void latency_probe_poll(void) {
+    uint32_t count, time;
+    do {
+        count = graphics_get_vsync_count();
+        time = graphics_get_vsync_time_us();
+    } while (count != graphics_get_vsync_count());
+
+    if (!latency_poll(&tracker, time_us_32(), count, time, LATENCY_PROBE_FRAME_US)) return;
+    samples++;
+    log_printf(LOG_DEBUG, "latency #%lu tick %lu: %lu %lu %lu %lu = %lu us",
+               (unsigned long)samples, (unsigned long)tracker.tick,
+               (unsigned long)tracker.last[LATENCY_INPUT_EVENT],
+               (unsigned long)tracker.last[LATENCY_EVENT_TICK],
+               (unsigned long)tracker.last[LATENCY_TICK_PRESENT],
+               (unsigned long)tracker.last[LATENCY_PRESENT_SCANOUT],
+               (unsigned long)tracker.last[LATENCY_TOTAL]);
+    if (samples % LATENCY_PROBE_REPORT == 0) report();
+}
+
+#else
+
+void latency_probe_input(key_source_t source) { (void)source; }
+void latency_probe_drain(void) {}
+void latency_probe_key(key_source_t source, bool down) { (void)source; (void)down; }
+void latency_probe_tick(void) {}
+void latency_probe_present(void) {}
+void latency_probe_poll(void) {}
+
+#endif // RP2350_LATENCY
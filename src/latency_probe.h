@@ -0,0 +1,57 @@
+/*
+ * murmprince - input latency measurement
+ *
+ * Built in with RP2350_LATENCY=1; otherwise every call here does nothing,
+ * so the drivers and SDL_port.c call them unconditionally. Feeds the
+ * latency.h tracker from the real pipeline:
+ *
+ *   input    PS/2 RX interrupt, USB HID report callback (the host's
+ *            polling interval comes before it and is not seen)
+ *   event    SDL_PollEvent, when it buffers the key event
+ *   tick     read_user_control()
+ *   present  update_screen(), after the copy to the scanout buffer
+ *   scanout  HDMI vsync_handler()
+ *
+ * Every LATENCY_PROBE_REPORT samples the distributions go to the log
+ * (LOG_INFO), which reaches the serial console with RP2350_LOG_SINK=2 or
+ * USB CDC; one line per sample at LOG_DEBUG. Press keys one at a time:
+ * a press while another is followed is skipped.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "key_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_PROBE_REPORT 16
+#define LATENCY_PROBE_FRAME_US 16683    // 800 x 525 at 25.175 MHz
+
+// Keyboard input arrived. Any context, interrupts included; the earliest
+// stamp since the last drain is kept.
+void latency_probe_input(key_source_t source);
+
+// SDL_PollEvent is about to drain the keyboard queues: take the stamps.
+void latency_probe_drain(void);
+
+// A key event from source was buffered for the game.
+void latency_probe_key(key_source_t source, bool down);
+
+// The game took its controls (read_user_control).
+void latency_probe_tick(void);
+
+// update_screen() copied the frame.
+void latency_probe_present(void);
+
+// Once per SDL_PollEvent, core 0: completes samples and logs reports.
+void latency_probe_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+/*
+ * murmprince - log ring buffer and line formatting
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "log_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void log_ring_init(log_ring_t *r, char *buf, uint32_t size, bool overwrite) {
+    memset(r, 0, sizeof(*r));
+    r->buf = buf;
+    r->size = size;
+    r->overwrite = overwrite;
+}
+
+uint32_t log_ring_used(const log_ring_t *r) {
+    return r->head - r->tail;
+}
+
+size_t log_ring_write(log_ring_t *r, const char *data, size_t len) {
+    if (len == 0) return 0;
+    const size_t stored = len;
+    if (len > r->size) {
+        if (!r->overwrite) {
+            r->dropped += (uint32_t)len;
+            return 0;
+        }
+        // Only the tail of the chunk can survive anyway.
+        r->dropped += (uint32_t)(len - r->size);
+        data += len - r->size;
+        len = r->size;
+    }
+    const uint32_t free_bytes = r->size - log_ring_used(r);
+    if (len > free_bytes) {
+        if (!r->overwrite) {
+            r->dropped += (uint32_t)len;
+            return 0;
+        }
+        const uint32_t evict = (uint32_t)len - free_bytes;
+        r->tail += evict;
+        r->dropped += evict;
+    }
+    const uint32_t at = r->head & (r->size - 1);
+    const size_t first = (len < r->size - at) ? len : r->size - at;
+    memcpy(r->buf + at, data, first);
+    memcpy(r->buf, data + first, len - first);
+    r->head += (uint32_t)len;
+    return stored;
+}
+
+size_t log_ring_peek(const log_ring_t *r, const char **data) {
+    const uint32_t used = log_ring_used(r);
+    const uint32_t at = r->tail & (r->size - 1);
+    *data = r->buf + at;
+    return (used < r->size - at) ? used : r->size - at;
+}
+
+void log_ring_consume(log_ring_t *r, size_t n) {
+    const uint32_t used = log_ring_used(r);
+    r->tail += (n < used) ? (uint32_t)n : used;
+}
+
+size_t log_ring_copy(const log_ring_t *r, char *dst, size_t dst_size) {
+    size_t n = log_ring_used(r);
+    if (n > dst_size) n = dst_size;
+    const uint32_t at = r->tail & (r->size - 1);
+    const size_t first = (n < r->size - at) ? n : r->size - at;
+    memcpy(dst, r->buf + at, first);
+    memcpy(dst + first, r->buf, n - first);
+    return n;
+}
+
+size_t log_format_line(char *buf, size_t size, log_level_t level, uint32_t ms,
+                       const char *fmt, va_list ap) {
+    static const char tags[] = "EWID";
+    if (size < 2) {
+        if (size) buf[0] = '\0';
+        return 0;
+    }
+    int n = snprintf(buf, size, "%lu.%03lu %c ", (unsigned long)(ms / 1000),
+                     (unsigned long)(ms % 1000), level <= LOG_DEBUG ? tags[level] : '?');
+    size_t len = (n < 0) ? 0 : ((size_t)n < size - 1 ? (size_t)n : size - 2);
+    n = vsnprintf(buf + len, size - 1 - len, fmt, ap);
+    if (n > 0) len += ((size_t)n < size - 1 - len) ? (size_t)n : size - 2 - len;
+    // One trailing newline, whatever the message brought.
+    while (len > 0 && buf[len - 1] == '\n') --len;
+    buf[len++] = '\n';
+    buf[len] = '\0';
+    return len;
+}
@@ -0,0 +1,67 @@
+/*
+ * murmprince - log ring buffer and line formatting
+ *
+ * The log keeps everything printed in a byte ring in RAM. A sink drains it
+ * (UART, SD file), or nothing does and the ring is a flight recorder read
+ * over SWD. Writers never wait: in drain mode a chunk that does not fit is
+ * dropped whole, in overwrite mode the oldest bytes make room. Both are
+ * counted.
+ *
+ * Pure logic: no locking, no hardware. log_sink.c serialises access.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LOG_ERROR = 0,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG,
+} log_level_t;
+
+typedef struct {
+    char *buf;
+    uint32_t size;             // power of two
+    uint32_t head;             // bytes ever written (wraps)
+    uint32_t tail;             // bytes ever consumed or overwritten (wraps)
+    uint32_t dropped;          // bytes refused (drain mode) or overwritten
+    bool overwrite;
+} log_ring_t;
+
+// size must be a power of two.
+void log_ring_init(log_ring_t *r, char *buf, uint32_t size, bool overwrite);
+
+uint32_t log_ring_used(const log_ring_t *r);
+
+// Store a chunk. Returns the bytes stored: len, or 0 when a drain-mode ring
+// lacks room. An overwrite-mode ring keeps the last size bytes of a chunk
+// larger than itself.
+size_t log_ring_write(log_ring_t *r, const char *data, size_t len);
+
+// Oldest unread bytes that are contiguous in the ring; 0 if empty.
+size_t log_ring_peek(const log_ring_t *r, const char **data);
+void log_ring_consume(log_ring_t *r, size_t n);
+
+// Copy the unread bytes, oldest first, without consuming them. Returns the
+// number copied (the newest ones are cut when dst is short).
+size_t log_ring_copy(const log_ring_t *r, char *dst, size_t dst_size);
+
+// One log line: "<s>.<ms> <E|W|I|D> <message>\n". The message is cut to
+// fit, and always ends in exactly one newline. Returns the length (< size).
+size_t log_format_line(char *buf, size_t size, log_level_t level, uint32_t ms,
+                       const char *fmt, va_list ap);
+
+#ifdef __cplusplus
+}
+#endif
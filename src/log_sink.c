@@ -0,0 +1,317 @@
+/*
+ * murmprince - log sink
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "log_sink.h"
+#include "board_config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "hardware/sync.h"
+
+#ifndef RP2350_LOG_SINK
+#define RP2350_LOG_SINK LOG_SINK_OFF
+#endif
+
+#ifndef RP2350_LOG_LEVEL
+#if MURMPRINCE_DEBUG
+#define RP2350_LOG_LEVEL LOG_DEBUG
+#else
+#define RP2350_LOG_LEVEL LOG_INFO
+#endif
+#endif
+
+// Power of two.
+#ifndef RP2350_LOG_RING_SIZE
+#define RP2350_LOG_RING_SIZE 8192
+#endif
+
+#ifndef RP2350_LOG_UART
+#define RP2350_LOG_UART 1
+#endif
+#ifndef RP2350_LOG_UART_TX
+#define RP2350_LOG_UART_TX 20  // free on both M1 and M2
+#endif
+#ifndef RP2350_LOG_UART_RX
+#define RP2350_LOG_UART_RX 21
+#endif
+#ifndef RP2350_SERIAL_CMDS
+#define RP2350_SERIAL_CMDS 0
+#endif
+#define LOG_UART_BAUD 115200
+
+#if RP2350_LOG_SINK == LOG_SINK_UART
+#include "hardware/irq.h"
+#include "hardware/uart.h"
+#endif
+
+#if RP2350_LOG_SINK == LOG_SINK_SD
+#include "ff.h"
+#include "pop_fs.h"
+#endif
+
+// SD sink: write when a sector's worth is waiting or the oldest text is
+// this old; sync the file this often; after a failure wait this long.
+#define LOG_SD_CHUNK 512
+#define LOG_SD_WRITE_MS 1000
+#define LOG_SD_SYNC_MS 3000
+#define LOG_SD_RETRY_MS 5000
+
+// Longest line log_printf() formats; longer ones are cut.
+#define LOG_LINE_MAX 160
+
+static log_level_t log_level = RP2350_LOG_LEVEL;
+
+#if RP2350_LOG_SINK != LOG_SINK_OFF
+
+// Not static: a debugger finds the ring by name.
+log_ring_t murmprince_log;
+char murmprince_log_text[RP2350_LOG_RING_SIZE];
+
+static spin_lock_t *log_lock;
+static log_sink_stats_t log_stats;
+
+// log_printf() in progress on a core: its line passes the printf filter.
+static volatile bool log_forced[2];
+
+#if RP2350_LOG_SINK == LOG_SINK_UART
+#define LOG_UART_HW (RP2350_LOG_UART ? uart1 : uart0)
+
+// log_sink_uart_write() owns the TX FIFO.
+static bool log_uart_paused;
+
+// Move what fits into the TX FIFO; keep the interrupt on while text waits.
+// Caller holds log_lock.
+static void log_uart_fill(void) {
+    const char *data;
+    size_t n;
+    if (log_uart_paused) {
+        uart_set_irq_enables(LOG_UART_HW, false, false);
+        return;
+    }
+    while (uart_is_writable(LOG_UART_HW) && (n = log_ring_peek(&murmprince_log, &data)) > 0) {
+        size_t k = 0;
+        while (k < n && uart_is_writable(LOG_UART_HW)) uart_putc_raw(LOG_UART_HW, data[k++]);
+        log_ring_consume(&murmprince_log, k);
+        log_stats.sent += (uint32_t)k;
+    }
+    uart_set_irq_enables(LOG_UART_HW, false, log_ring_used(&murmprince_log) != 0);
+}
+
+static void log_uart_irq(void) {
+    const uint32_t save = spin_lock_blocking(log_lock);
+    log_uart_fill();
+    spin_unlock(log_lock, save);
+}
+#endif
+
+static void log_sink_out_chars(const char *buf, int len) {
+    if (len <= 0) return;
+    if (log_level < LOG_INFO && !log_forced[get_core_num()]) return;
+    const uint32_t save = spin_lock_blocking(log_lock);
+    log_stats.written += (uint32_t)log_ring_write(&murmprince_log, buf, (size_t)len);
+    log_stats.dropped = murmprince_log.dropped;
+#if RP2350_LOG_SINK == LOG_SINK_UART
+    // The TX interrupt only fires on the FIFO draining past its level, so
+    // an idle UART has to be started by hand.
+    log_uart_fill();
+#endif
+    spin_unlock(log_lock, save);
+}
+
+static stdio_driver_t log_stdio = {
+    .out_chars = log_sink_out_chars,
+};
+
+#endif // RP2350_LOG_SINK != LOG_SINK_OFF
+
+void log_sink_init(void) {
+#if RP2350_LOG_SINK != LOG_SINK_OFF
+    log_lock = spin_lock_init(spin_lock_claim_unused(true));
+    // Nothing drains the RAM-only ring: keep the newest text.
+    log_ring_init(&murmprince_log, murmprince_log_text, sizeof(murmprince_log_text),
+                  RP2350_LOG_SINK == LOG_SINK_RAM);
+#if RP2350_LOG_SINK == LOG_SINK_UART
+    uart_init(LOG_UART_HW, LOG_UART_BAUD);
+    gpio_set_function(RP2350_LOG_UART_TX, GPIO_FUNC_UART);
+#if RP2350_SERIAL_CMDS
+    gpio_set_function(RP2350_LOG_UART_RX, GPIO_FUNC_UART);
+#endif
+    const uint irq = RP2350_LOG_UART ? UART1_IRQ : UART0_IRQ;
+    irq_set_exclusive_handler(irq, log_uart_irq);
+    irq_set_enabled(irq, true);
+#endif
+    stdio_set_driver_enabled(&log_stdio, true);
+#endif
+}
+
+void log_set_level(log_level_t level) {
+    log_level = level;
+}
+
+log_level_t log_get_level(void) {
+    return log_level;
+}
+
+void log_printf(log_level_t level, const char *fmt, ...) {
+    if (level > log_level) return;
+    char line[LOG_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    log_format_line(line, sizeof(line), level, to_ms_since_boot(get_absolute_time()), fmt, ap);
+    va_end(ap);
+#if RP2350_LOG_SINK != LOG_SINK_OFF
+    const uint core = get_core_num();
+    log_forced[core] = true;
+    fputs(line, stdout);
+    fflush(stdout);
+    log_forced[core] = false;
+#else
+    fputs(line, stdout);
+#endif
+}
+
+#if RP2350_LOG_SINK == LOG_SINK_SD
+static FIL log_file;
+static bool log_file_open;
+static uint16_t log_file_mount;
+static bool log_unsynced;
+static uint32_t log_last_write_ms;
+static uint32_t log_last_sync_ms;
+static bool log_failed;
+static uint32_t log_failed_ms;
+
+static bool log_sd_open(uint32_t now_ms) {
+    // A remount (card swapped or pop_fs_reset) invalidates the old handle.
+    if (log_file_open && log_file_mount == pop_fs_mount_id()) return true;
+    log_file_open = false;
+    if (log_failed && now_ms - log_failed_ms < LOG_SD_RETRY_MS) return false;
+    char path[32];
+    pop_fs_make_path(path, sizeof(path), LOG_SINK_FILE);
+    if (f_open(&log_file, path, FA_WRITE | FA_OPEN_APPEND) != FR_OK) {
+        log_stats.sink_errors++;
+        log_failed = true;
+        log_failed_ms = now_ms;
+        return false;
+    }
+    log_failed = false;
+    log_file_open = true;
+    log_file_mount = pop_fs_mount_id();
+    return true;
+}
+#endif
+
+void log_sink_pump(void) {
+#if RP2350_LOG_SINK == LOG_SINK_SD
+    if (!log_lock || !pop_fs_card_present()) return;
+    const uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    uint32_t save = spin_lock_blocking(log_lock);
+    const uint32_t used = log_ring_used(&murmprince_log);
+    spin_unlock(log_lock, save);
+
+    if (used == 0 || (used < LOG_SD_CHUNK && now_ms - log_last_write_ms < LOG_SD_WRITE_MS)) {
+        if (log_unsynced && log_file_open && now_ms - log_last_sync_ms >= LOG_SD_SYNC_MS) {
+            (void)f_sync(&log_file);
+            log_unsynced = false;
+            log_last_sync_ms = now_ms;
+        }
+        return;
+    }
+    if (!log_sd_open(now_ms)) return;
+
+    // Copy out under the lock, write without it: the card is slow, the
+    // writers must not wait for it. In drain mode nobody else consumes.
+    char chunk[LOG_SD_CHUNK];
+    const char *data;
+    save = spin_lock_blocking(log_lock);
+    size_t n = log_ring_peek(&murmprince_log, &data);
+    if (n > sizeof(chunk)) n = sizeof(chunk);
+    memcpy(chunk, data, n);
+    spin_unlock(log_lock, save);
+
+    UINT done = 0;
+    if (f_write(&log_file, chunk, (UINT)n, &done) != FR_OK || done != n) {
+        log_stats.sink_errors++;
+        (void)f_close(&log_file);
+        log_file_open = false;
+        log_failed = true;
+        log_failed_ms = now_ms;
+        return;
+    }
+    save = spin_lock_blocking(log_lock);
+    log_ring_consume(&murmprince_log, n);
+    log_stats.sent += (uint32_t)n;
+    spin_unlock(log_lock, save);
+    log_last_write_ms = now_ms;
+    if (!log_unsynced) log_last_sync_ms = now_ms;
+    log_unsynced = true;
+#endif
+}
+
+uint32_t log_sink_snapshot(char *dst, uint32_t dst_size) {
+#if RP2350_LOG_SINK != LOG_SINK_OFF
+    if (!log_lock) return 0;
+    const uint32_t save = spin_lock_blocking(log_lock);
+    const size_t n = log_ring_copy(&murmprince_log, dst, dst_size);
+    spin_unlock(log_lock, save);
+    return (uint32_t)n;
+#else
+    (void)dst;
+    (void)dst_size;
+    return 0;
+#endif
+}
+
+void log_sink_get_stats(log_sink_stats_t *stats) {
+#if RP2350_LOG_SINK != LOG_SINK_OFF
+    if (!log_lock) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    const uint32_t save = spin_lock_blocking(log_lock);
+    *stats = log_stats;
+    spin_unlock(log_lock, save);
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+bool log_sink_uart_getc(uint8_t *c) {
+#if RP2350_LOG_SINK == LOG_SINK_UART
+    if (!log_lock || !uart_is_readable(LOG_UART_HW)) return false;
+    *c = (uint8_t)uart_getc(LOG_UART_HW);
+    return true;
+#else
+    (void)c;
+    return false;
+#endif
+}
+
+void log_sink_uart_pause(bool pause) {
+#if RP2350_LOG_SINK == LOG_SINK_UART
+    if (!log_lock) return;
+    const uint32_t save = spin_lock_blocking(log_lock);
+    log_uart_paused = pause;
+    log_uart_fill();
+    spin_unlock(log_lock, save);
+#else
+    (void)pause;
+#endif
+}
+
+void log_sink_uart_write(const uint8_t *data, size_t len) {
+#if RP2350_LOG_SINK == LOG_SINK_UART
+    // Without the lock: a screen dump takes seconds at 115200 and the
+    // writers must not spin on it. Log text collects in the ring meanwhile.
+    if (log_lock && log_uart_paused) uart_write_blocking(LOG_UART_HW, data, len);
+#else
+    (void)data;
+    (void)len;
+#endif
+}
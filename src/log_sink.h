@@ -0,0 +1,82 @@
+/*
+ * murmprince - log sink
+ *
+ * With a USB keyboard the USB port is the HID host, so there is no USB
+ * console. The log sink takes everything printed (printf, DBG_PRINTF,
+ * log_printf) into a RAM ring (log_ring.h) and hands it to the sink chosen
+ * at build time with RP2350_LOG_SINK:
+ *
+ *   0  off: printing goes to the stdio drivers only, as before
+ *   1  RAM ring only, overwriting the oldest text; read it over SWD
+ *      (symbols murmprince_log and murmprince_log_text)
+ *   2  UART (RP2350_LOG_UART_TX, 115200 8N1), drained by the TX interrupt;
+ *      RX (RP2350_LOG_UART_RX) carries the serial test link if built in
+ *   3  PRINCE.LOG at the SD root, appended from log_sink_pump()
+ *
+ * Nothing ever waits for the sink: text that does not fit is dropped and
+ * counted. Lines above the run-time level (RP2350_LOG_LEVEL at boot) are
+ * not formatted at all; plain printf output counts as LOG_INFO.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_SINK_OFF  0
+#define LOG_SINK_RAM  1
+#define LOG_SINK_UART 2
+#define LOG_SINK_SD   3
+
+#define LOG_SINK_FILE "PRINCE.LOG"
+
+typedef struct {
+    uint32_t written;          // bytes taken into the ring
+    uint32_t dropped;          // bytes lost to a full ring (or overwritten)
+    uint32_t sent;             // bytes handed to the UART or the file
+    uint32_t sink_errors;      // failed file opens and writes
+} log_sink_stats_t;
+
+// Register with stdio. Call right after stdio_init_all(), on core 0.
+void log_sink_init(void);
+
+// printf with a level and a "<s>.<ms> <level>" prefix; dropped above the
+// run-time level. Either core, but not from interrupts (it goes through
+// stdio like printf).
+void log_printf(log_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+void log_set_level(log_level_t level);
+log_level_t log_get_level(void);
+
+// SD sink: write out a little of the ring (at most one sector per call,
+// synced every few seconds). Core 0, from the main loop; the other sinks
+// need no pumping and ignore it.
+void log_sink_pump(void);
+
+// Oldest unread text, oldest first, without consuming it. Returns the
+// number of bytes copied.
+uint32_t log_sink_snapshot(char *dst, uint32_t dst_size);
+
+void log_sink_get_stats(log_sink_stats_t *stats);
+
+// UART sink: the serial test link (serial_link.h) shares the UART. Next
+// received byte, false if none. While paused the log text stays in the
+// ring (it may stop and resume in the middle of a line) and
+// log_sink_uart_write() sends raw bytes. Core 0 only; no-ops with the
+// other sinks.
+bool log_sink_uart_getc(uint8_t *c);
+void log_sink_uart_pause(bool pause);
+void log_sink_uart_write(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
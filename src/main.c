@@ -5,8 +5,7 @@
 
 #include "pico/stdlib.h"
 #include "hardware/clocks.h"
-#include "hardware/vreg.h"
-#include "hardware/structs/qmi.h"
+#include "pico/multicore.h"
 #ifndef USB_HID_ENABLED
 #include "pico/stdio_usb.h"
 #endif
@@ -20,6 +19,12 @@
 #include "pop_fs.h"
 #include "ps2kbd/ps2kbd_wrapper.h"
 #include "start_screen.h"
+#include "blit_bench.h"
+#include "boot_timeline.h"
+#include "teardown.h"
+#include "crash_guard.h"
+#include "clock_select.h"
+#include "log_sink.h"
 
 // USB HID keyboard support (optional)
 #ifdef USB_HID_ENABLED
@@ -45,6 +50,30 @@
 #define RP2350_BOOT_TEST_PATTERN_MODE 0
 #endif
 
+// Run the blitter micro-benchmark (src/blit_bench.c) before the start screen.
+#ifndef RP2350_BLIT_BENCH
+#define RP2350_BLIT_BENCH 0
+#endif
+
+#ifndef MURMPRINCE_VERSION
+#define MURMPRINCE_VERSION "?"
+#endif
+
+// PSRAM timing calibration right after psram init: 0 off, 1 quick, 2 full.
+#ifndef RP2350_PSRAM_CALIBRATE
+#define RP2350_PSRAM_CALIBRATE 0
+#endif
+
+// How long to wait for a USB CDC host to open the port before printing.
+// Release builds print nothing at boot, so they don't wait at all.
+#ifndef RP2350_CDC_WAIT_MS
+#if MURMPRINCE_DEBUG
+#define RP2350_CDC_WAIT_MS 1500
+#else
+#define RP2350_CDC_WAIT_MS 0
+#endif
+#endif
+
 // HDMI scanout reads this buffer in a tight per-line ISR.
 // Keep it in SRAM for reliable, fast reads (PSRAM can cause visible artifacts).
 static uint8_t graphics_buffer_storage[FRAME_W * FRAME_H];
@@ -54,29 +83,9 @@ uint8_t *graphics_buffer = graphics_buffer_storage;
 
 // SDLPoP entrypoint (renamed from main via build defines)
 extern int sdlpop_entry(int argc, char *argv[]);
-
-// Flash timing configuration for overclocking
-// Must be called BEFORE changing system clock
-#define FLASH_MAX_FREQ_MHZ 88
-
-static void __no_inline_not_in_flash_func(set_flash_timings)(int cpu_mhz) {
-    const int clock_hz = cpu_mhz * 1000000;
-    const int max_flash_freq = FLASH_MAX_FREQ_MHZ * 1000000;
-
-    int divisor = (clock_hz + max_flash_freq - (max_flash_freq >> 4) - 1) / max_flash_freq;
-    if (divisor == 1 && clock_hz >= 166000000) {
-        divisor = 2;
-    }
-
-    int rxdelay = divisor;
-    if (clock_hz / divisor > 100000000 && clock_hz >= 166000000) {
-        rxdelay += 1;
-    }
-
-    qmi_hw->m[0].timing = 0x60007000 |
-                          rxdelay << QMI_M0_TIMING_RXDELAY_LSB |
-                          divisor << QMI_M0_TIMING_CLKDIV_LSB;
-}
+extern bool midi_cache_file_ok(FIL* f, FSIZE_t size);  // midi.c
+extern void midi_cache_hold(bool hold);                 // midi.c
+extern void rp2350_peel_pool_init(void);                // seg009.c
 
 static void setup_basic_palette(void) {
     // Avoid 240-243 (HDMI control), set 0..15 and background 255.
@@ -127,36 +136,109 @@ static void rp2350_draw_boot_test_pattern(uint8_t *fb, int w, int h) {
     }
 }
 
-int main(void) {
-#if CPU_CLOCK_MHZ > 252
-    vreg_disable_voltage_limit();
-    vreg_set_voltage(CPU_VOLTAGE);
-    set_flash_timings(CPU_CLOCK_MHZ);
-    sleep_ms(100);
-#endif
+// SD mount runs on core 1 while core 0 brings up PSRAM, HDMI and input.
+// Core 1 is otherwise idle at boot; it is reset once the mount is joined.
+static volatile bool g_boot_sd_done = false;
+static volatile bool g_boot_sd_ok = false;
+static uint32_t g_boot_sd_start_us;
+static uint32_t g_boot_sd_end_us;
+
+static void boot_sd_mount_core1(void) {
+    g_boot_sd_start_us = time_us_32();
+    g_boot_sd_ok = pop_fs_init();
+    g_boot_sd_end_us = time_us_32();
+    __dmb();
+    g_boot_sd_done = true;
+}
 
-    if (!set_sys_clock_khz(CPU_CLOCK_MHZ * 1000, false)) {
-        set_sys_clock_khz(252 * 1000, true);
+static void boot_sd_mount_join(void) {
+    while (!g_boot_sd_done) {
+        tight_loop_contents();
     }
+    multicore_reset_core1();
+    boot_timeline_add_parallel("sd_mount", g_boot_sd_start_us, g_boot_sd_end_us);
+    if (!g_boot_sd_ok) {
+        DBG_PRINTF("SD mount on core 1 failed; retrying from the start screen check\n");
+    }
+}
 
-    stdio_init_all();
+// Card pulled during a load: music streamed from the card stops touching
+// it while the prompt is up and core 0 remounts.
+static void sd_wait_hook(bool waiting) {
+    if (waiting) midi_cache_hold(true);
+    start_screen_sd_prompt(waiting);
+    if (!waiting) midi_cache_hold(false);
+}
+
+int main(void) {
+    crash_guard_boot();
+    // Safe mode (chosen on the start screen after a crash) runs at stock 252 MHz.
+    clock_select_boot(crash_guard_safe_mode());
+
+    boot_timeline_mark("clocks");
 
-    // USB CDC enumerates when stdio_usb is initialized. Delay *output* for 3 seconds.
-    // This keeps the serial device available while avoiding early console chatter.
-    sleep_ms(3000);
+    stdio_init_all();
+    log_sink_init();
+
+#if !defined(USB_HID_ENABLED) && RP2350_CDC_WAIT_MS > 0
+    // USB CDC enumerates when stdio_usb is initialized. Hold early output until a
+    // host opens the port, but don't stall boot when nothing is listening.
+    absolute_time_t cdc_deadline = make_timeout_time_ms(RP2350_CDC_WAIT_MS);
+    while (!stdio_usb_connected() && !time_reached(cdc_deadline)) {
+        sleep_ms(10);
+    }
+#endif
+    boot_timeline_mark("stdio");
+    log_printf(LOG_INFO, "murmprince %s, CPU %lu MHz", MURMPRINCE_VERSION,
+               (unsigned long)(clock_get_hz(clk_sys) / 1000000));
 
     DBG_PRINTF("murmprince - RP2350 SDLPoP bootstrap\n");
-    DBG_PRINTF("System Clock: %lu MHz\n", clock_get_hz(clk_sys) / 1000000);
+    DBG_PRINTF("System Clock: %lu MHz (PSRAM %u MHz)\n", clock_get_hz(clk_sys) / 1000000, clock_select_psram_mhz());
 #if MURMPRINCE_DEBUG
     DBG_PRINTF("Build flags: RP2350_BOOT_TEST_PATTERN=%d RP2350_BOOT_TEST_PATTERN_HALT=%d\n",
         (int)RP2350_BOOT_TEST_PATTERN, (int)RP2350_BOOT_TEST_PATTERN_HALT);
     DBG_PRINTF("Build flags: RP2350_BOOT_TEST_PATTERN_MODE=%d\n", (int)RP2350_BOOT_TEST_PATTERN_MODE);
+    DBG_PRINTF("Build flags: RP2350_BLIT_BENCH=%d\n", (int)RP2350_BLIT_BENCH);
+    DBG_PRINTF("Build flags: RP2350_PSRAM_CALIBRATE=%d\n", (int)RP2350_PSRAM_CALIBRATE);
 #endif
 
     // PSRAM init (CS1)
     uint psram_pin = get_psram_pin();
-    psram_init(psram_pin);
+    psram_init_freq(psram_pin, (int)clock_select_psram_mhz());
+    // Size first: the calibration walks the address lines of the chip
+    // that is there, and a smaller one wraps around onto its start.
+    const size_t psram_bytes = psram_detect_size();
+    if (psram_bytes) {
+        psram_set_size(psram_bytes);
+        DBG_PRINTF("PSRAM: %u MB\n", (unsigned)(psram_bytes >> 20));
+    } else {
+        DBG_PRINTF("PSRAM: no chip answers on CS%u\n", psram_pin);
+    }
+#if RP2350_PSRAM_CALIBRATE
+    if (psram_bytes) {
+        // Nothing lives in PSRAM yet, so the destructive pattern test is safe here.
+        const uint32_t cal_t0 = time_us_32();
+        psram_cal_result_t cal;
+        psram_calibrate((int)clock_select_psram_mhz(), psram_bytes, RP2350_PSRAM_CALIBRATE == 1, &cal);
+        const uint32_t cal_us = time_us_32() - cal_t0;
+        if (cal.ok) {
+            DBG_PRINTF("PSRAM cal: div %d rxdelay %d, window %d..%d, margin %d (%d probes, %lu us)\n",
+                cal.divisor, cal.rxdelay, cal.window_lo, cal.window_hi, cal.margin,
+                cal.probes, (unsigned long)cal_us);
+        } else {
+            DBG_PRINTF("PSRAM cal: no passing window, keeping default timing (%d probes, %lu us)\n",
+                cal.probes, (unsigned long)cal_us);
+        }
+        boot_timeline_mark("psram_cal");
+    }
+#endif
     psram_set_sram_mode(0);
+    boot_timeline_mark("psram");
+
+    // Mount the card on core 1 while HDMI and input come up. Not earlier:
+    // PSRAM init and calibration retime the QMI, which stalls XIP, and the
+    // mount code runs from flash.
+    multicore_launch_core1(boot_sd_mount_core1);
 
     memset(graphics_buffer, 0, FRAME_W * FRAME_H);
 
@@ -166,6 +248,7 @@ int main(void) {
     graphics_set_buffer(graphics_buffer);
 
     setup_basic_palette();
+    boot_timeline_mark("hdmi");
 
 #if RP2350_BOOT_TEST_PATTERN
     if (RP2350_BOOT_TEST_PATTERN_MODE == 1) {
@@ -191,19 +274,55 @@ int main(void) {
     DBG_PRINTF("Initializing USB HID keyboard...\n");
     usbhid_sdl_init();
 #endif
+    boot_timeline_mark("input");
+
+#if RP2350_BLIT_BENCH
+    // Blitter micro-benchmark: CSV results on stdio, then continue booting.
+    blit_bench_run();
+#endif
+
+    boot_sd_mount_join();
+    boot_timeline_mark("sd_join");
+
+    // Clean up after a power cut during a write (saves, config, MIDI cache).
+    if (g_boot_sd_ok) {
+        int fixed = pop_fs_recover_dir("", NULL) +
+                    pop_fs_recover_dir("prince", NULL) +
+                    pop_fs_recover_dir("prince/midi_cache", midi_cache_file_ok);
+        if (fixed) DBG_PRINTF("SD recovery: %d file(s) fixed\n", fixed);
+        boot_timeline_mark("sd_recover");
+    }
+
+    // A clock profile picked in SDLPoP.ini, or on trial since the last
+    // reboot, is settled here (may reboot).
+    clock_select_apply_ini();
+    clock_select_validate();
+
+    // Loads that lose the card block behind an on-screen prompt until it is back.
+    pop_fs_set_wait_hook(sd_wait_hook);
+
+    // Peel slots live for the whole run: allocate them before the first
+    // session so teardown never sees them as session SRAM growth.
+    rp2350_peel_pool_init();
+
+    // From here on the start screen and the game loop feed the watchdog.
+    crash_guard_start_watchdog();
 
     // Main loop: show start screen, run game, repeat on quit
     while (true) {
         // Check SD card and data directory
         DBG_PRINTF("Checking SD card and game data...\n");
+        crash_guard_note("start");
         start_error_t err = start_screen_check_requirements();
+        boot_timeline_mark("data_check");
         
         // Show start screen (waits for keypress if no error)
         DBG_PRINTF("Showing start screen...\n");
         start_screen_show(err, NULL);
+        boot_timeline_mark_idle("start_screen");
         
-        // If there was an error, the start screen loops forever
-        // (user must fix and reset), so we only get here if OK
+        // If there was an error, the start screen keeps re-checking the
+        // card and only returns once the requirements are met
         
         // Reset palette for game
         setup_basic_palette();
@@ -212,12 +331,17 @@ int main(void) {
         memset(graphics_buffer, 0, FRAME_W * FRAME_H);
         
         DBG_PRINTF("Starting SDLPoP...\n");
-        char *argv[] = {"prince", NULL};
-        int rc = sdlpop_entry(1, argv);
+        crash_guard_note("sdlpop");
+        char *argv[12];
+        int argc = start_screen_game_args(argv, 12);
+        teardown_begin_session();
+        int rc = sdlpop_entry(argc, argv);
         
         DBG_PRINTF("SDLPoP exited (rc=%d). Returning to start screen...\n", rc);
+        teardown_end_session();
         
         // Brief delay before showing start screen again
+        crash_guard_feed();
         sleep_ms(500);
     }
     
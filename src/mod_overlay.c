@@ -0,0 +1,186 @@
+/*
+ * murmprince - data file index for the base game and the selected mod
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "mod_overlay.h"
+
+#include "ff.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define MOD_OVERLAY_INITIAL_SLOTS 256
+#define MOD_OVERLAY_PATH_MAX 256
+
+// The game writes the MIDI cache itself; it is never looked up through here.
+#define MOD_OVERLAY_SKIP_DIR "prince/midi_cache"
+
+static char fold(char c) {
+    if (c == '\\') return '/';
+    if (c >= 'A' && c <= 'Z') return (char)(c - 'A' + 'a');
+    return c;
+}
+
+// Strip "./", a drive prefix and leading slashes: all name the SD root.
+static const char *skip_prefix(const char *path) {
+    if (path[0] != '\0' && path[1] == ':') path += 2;
+    for (;;) {
+        if (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) path += 2;
+        else if (path[0] == '/' || path[0] == '\\') path += 1;
+        else return path;
+    }
+}
+
+// FNV-1a over the case-folded path; 0 marks an empty slot.
+static uint32_t hash_path(const char *path) {
+    uint32_t h = 2166136261u;
+    for (; *path; ++path) {
+        h ^= (uint8_t)fold(*path);
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static bool has_hash(const mod_overlay_t *ov, uint32_t h) {
+    for (uint32_t i = h & ov->mask;; i = (i + 1) & ov->mask) {
+        if (ov->slots[i] == h) return true;
+        if (ov->slots[i] == 0) return false;
+    }
+}
+
+static void put_hash(uint32_t *slots, uint32_t mask, uint32_t h) {
+    uint32_t i = h & mask;
+    while (slots[i] != 0) i = (i + 1) & mask;
+    slots[i] = h;
+}
+
+static bool insert(mod_overlay_t *ov, const char *path) {
+    const uint32_t h = hash_path(path);
+    if (has_hash(ov, h)) return true;
+
+    // Keep the load factor at or below one half.
+    if ((ov->count + 1) * 2 > ov->mask + 1) {
+        const uint32_t new_mask = ov->mask * 2 + 1;
+        uint32_t *slots = (uint32_t *)calloc(new_mask + 1, sizeof(uint32_t));
+        if (!slots) return false;
+        for (uint32_t i = 0; i <= ov->mask; ++i) {
+            if (ov->slots[i]) put_hash(slots, new_mask, ov->slots[i]);
+        }
+        free(ov->slots);
+        ov->slots = slots;
+        ov->mask = new_mask;
+    }
+    put_hash(ov->slots, ov->mask, h);
+    ov->count++;
+    return true;
+}
+
+static bool append(char *path, size_t len, const char *name) {
+    const size_t name_len = strlen(name);
+    if (len + 1 + name_len >= MOD_OVERLAY_PATH_MAX) return false;
+    path[len] = '/';
+    memcpy(path + len + 1, name, name_len + 1);
+    return true;
+}
+
+// path holds "/dir/sub" ("" for the root); keys are stored without the
+// leading slash. Returns false if any entry could not be recorded.
+static bool scan_dir(mod_overlay_t *ov, char *path, int depth, bool recurse) {
+    const size_t len = strlen(path);
+    DIR dir;
+    FRESULT fr = f_opendir(&dir, len ? path : "/");
+    if (fr == FR_NO_PATH || fr == FR_NO_FILE) return true; // nothing to index
+    if (fr != FR_OK) return false;
+
+    bool ok = true;
+    FILINFO fno;
+    while (ok && f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+        if (!append(path, len, fno.fname)) {
+            ok = false;
+            break;
+        }
+        if (fno.fattrib & AM_DIR) {
+            if (recurse && strcasecmp(path + 1, MOD_OVERLAY_SKIP_DIR) != 0) {
+                ok = depth < MOD_OVERLAY_MAX_DEPTH && scan_dir(ov, path, depth + 1, true);
+            }
+        } else {
+            ok = insert(ov, path + 1);
+            // FatFS also opens a file by its 8.3 alias.
+            if (ok && fno.altname[0] != '\0' && strcasecmp(fno.altname, fno.fname) != 0) {
+                path[len] = '\0';
+                ok = append(path, len, fno.altname) && insert(ov, path + 1);
+            }
+        }
+        path[len] = '\0';
+    }
+    f_closedir(&dir);
+    return ok;
+}
+
+bool mod_overlay_build(mod_overlay_t *ov, const char *mod_dir) {
+    mod_overlay_free(ov);
+    if (mod_dir == NULL) mod_dir = "";
+    mod_dir = skip_prefix(mod_dir);
+
+    size_t n = strlen(mod_dir);
+    while (n > 0 && (mod_dir[n - 1] == '/' || mod_dir[n - 1] == '\\')) --n;
+    if (n >= sizeof(ov->mod_dir)) return false;
+    for (size_t i = 0; i < n; ++i) ov->mod_dir[i] = fold(mod_dir[i]);
+    ov->mod_dir[n] = '\0';
+
+    ov->slots = (uint32_t *)calloc(MOD_OVERLAY_INITIAL_SLOTS, sizeof(uint32_t));
+    if (!ov->slots) return false;
+    ov->mask = MOD_OVERLAY_INITIAL_SLOTS - 1;
+
+    char path[MOD_OVERLAY_PATH_MAX] = "";
+    bool ok = scan_dir(ov, path, 0, false);
+    strcpy(path, "/prince");
+    ok = ok && scan_dir(ov, path, 0, true);
+    if (ok && ov->mod_dir[0] != '\0') {
+        path[0] = '/';
+        strcpy(path + 1, ov->mod_dir);
+        ok = scan_dir(ov, path, 0, true);
+    }
+    if (!ok) {
+        mod_overlay_free(ov);
+        return false;
+    }
+    ov->valid = true;
+    return true;
+}
+
+void mod_overlay_free(mod_overlay_t *ov) {
+    free(ov->slots);
+    memset(ov, 0, sizeof(*ov));
+}
+
+// Whether a normalised path lies in a tree the index has listed.
+static bool covered(const mod_overlay_t *ov, const char *path) {
+    char head[MOD_OVERLAY_DIR_MAX + 1];
+    size_t n = 0;
+    bool in_dir = false;
+    for (const char *p = path; *p; ++p) {
+        const char c = fold(*p);
+        if ((uint8_t)c >= 0x80) return false; // FatFS folds these by code page
+        if (c == '/') in_dir = true;
+        if (n < sizeof(head) - 1) head[n++] = c;
+    }
+    head[n] = '\0';
+
+    if (!in_dir) return true; // a file in the root
+    if (strncmp(head, "prince/", 7) == 0) {
+        return strncmp(head, MOD_OVERLAY_SKIP_DIR "/", sizeof(MOD_OVERLAY_SKIP_DIR)) != 0;
+    }
+    const size_t mod_len = strlen(ov->mod_dir);
+    return mod_len > 0 && strncmp(head, ov->mod_dir, mod_len) == 0 && head[mod_len] == '/';
+}
+
+bool mod_overlay_may_exist(const mod_overlay_t *ov, const char *path) {
+    if (!ov->valid || path == NULL) return true;
+    path = skip_prefix(path);
+    if (!covered(ov, path)) return true;
+    return has_hash(ov, hash_path(path));
+}
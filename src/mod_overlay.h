@@ -0,0 +1,57 @@
+/*
+ * murmprince - data file index for the base game and the selected mod
+ *
+ * SDLPoP looks for every resource in the mod folder first, then in the SD
+ * root, then in prince/ (DAT files, res<id>.png directories, music), so most
+ * lookups end in an f_open that fails after a directory walk on the card.
+ * This index lists the files of those trees once per game session: the SD
+ * root (files only), prince/ (recursively, without the MIDI cache the game
+ * writes itself) and mods/<name>/ (recursively). A lookup is a hash probe,
+ * and a path the index does not know is never opened.
+ *
+ * Only existence is recorded (a 32-bit hash of the case-folded path). A hash
+ * collision can only report a missing file as present, which costs the
+ * same failed f_open as without the index. Paths outside the indexed trees,
+ * or any path when the build did not complete, are reported as present.
+ *
+ * Uses FatFS and malloc only, so it builds on a host against a RAM disk.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOD_OVERLAY_DIR_MAX 64      // "mods/<name>"
+#define MOD_OVERLAY_MAX_DEPTH 4     // directory levels below an indexed tree
+
+typedef struct {
+    uint32_t *slots;                // open addressing, 0 = empty
+    uint32_t mask;                  // slot count - 1 (power of two)
+    uint32_t count;
+    bool valid;                     // build completed
+    char mod_dir[MOD_OVERLAY_DIR_MAX]; // indexed mod folder, "" for none
+} mod_overlay_t;
+
+// Scan the base game and, if mod_dir is non-empty, the mod folder (as given
+// to SDLPoP in mod_data_path, e.g. "mods/MyMod"). Replaces any previous
+// contents. Returns false (and leaves the index invalid, i.e. every lookup
+// answers "maybe") when the card could not be read or memory ran out.
+bool mod_overlay_build(mod_overlay_t *ov, const char *mod_dir);
+
+void mod_overlay_free(mod_overlay_t *ov);
+
+// False only if path ("PRINCE.DAT", "prince/KID/res400.png",
+// "mods/MyMod/prince/KID/res400.png", ...) lies in an indexed tree and is
+// known to be absent.
+bool mod_overlay_may_exist(const mod_overlay_t *ov, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
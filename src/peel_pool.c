@@ -0,0 +1,59 @@
+/*
+ * murmprince - peel slot pool
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "peel_pool.h"
+
+#include <string.h>
+
+// 10240 + 18432 + 16384 = 45056 bytes of SRAM
+const peel_pool_class_t peel_pool_default_classes[PEEL_POOL_DEFAULT_CLASSES] = {
+    {  640, 16 },   // swords, potions, loose floor debris
+    { 3072,  6 },   // kid / guard / shadow frames
+    { 8192,  2 },   // tall frames, large composite objects
+};
+
+int peel_pool_init(peel_pool_t *pool, const peel_pool_class_t *classes, int n) {
+    memset(pool, 0, sizeof(*pool));
+    for (int c = 0; c < n; ++c) {
+        for (int i = 0; i < classes[c].count && pool->slot_count < PEEL_POOL_MAX_SLOTS; ++i) {
+            pool->capacity[pool->slot_count++] = classes[c].capacity;
+        }
+    }
+    return pool->slot_count;
+}
+
+uint32_t peel_pool_bytes(const peel_pool_class_t *classes, int n) {
+    uint32_t bytes = 0;
+    for (int c = 0; c < n; ++c) bytes += (uint32_t)classes[c].capacity * (uint32_t)classes[c].count;
+    return bytes;
+}
+
+int peel_pool_acquire(peel_pool_t *pool, int pixels) {
+    int best = -1;
+    for (int i = 0; i < pool->slot_count; ++i) {
+        if (pool->in_use[i] || pool->capacity[i] < pixels) continue;
+        if (best < 0 || pool->capacity[i] < pool->capacity[best]) best = i;
+    }
+    if (best < 0) {
+        ++pool->misses;
+        return -1;
+    }
+    pool->in_use[best] = true;
+    ++pool->hits;
+    pool->bytes_in_use += (uint32_t)pool->capacity[best];
+    if (pool->bytes_in_use > pool->peak_bytes) pool->peak_bytes = pool->bytes_in_use;
+    return best;
+}
+
+void peel_pool_release(peel_pool_t *pool, int slot) {
+    if (slot < 0 || slot >= pool->slot_count || !pool->in_use[slot]) return;
+    pool->in_use[slot] = false;
+    pool->bytes_in_use -= (uint32_t)pool->capacity[slot];
+}
+
+void peel_pool_release_all(peel_pool_t *pool) {
+    for (int i = 0; i < pool->slot_count; ++i) peel_pool_release(pool, i);
+}
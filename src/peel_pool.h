@@ -0,0 +1,73 @@
+/*
+ * murmprince - peel slot pool
+ *
+ * Moving objects save the background under them every frame ("peels", see
+ * read_peel_from_screen() in seg009.c) and give it back on the next one.
+ * The port serves those peels from a fixed set of preallocated SRAM
+ * surfaces instead of a calloc + SDL_CreateRGBSurface pair per object.
+ * This file is the slot bookkeeping: size classes, best-fit lookup and
+ * hit/miss/peak accounting. The surfaces behind the slots belong to the
+ * caller, indexed by slot number.
+ *
+ * The default classes are sized from the peels one frame keeps alive: at
+ * most three characters (kid, guard, shadow) of up to 48x64 after
+ * add_peel() rounds the sides to 8 pixels, their swords, and a few small
+ * objects. Six character slots double that, two 8 KB slots take the tall
+ * frames (climbing, falling debris rows) and everything else falls back to
+ * the heap. tools/peel_replay.c replays scenes or device traces
+ * (RP2350_TRACE_PEEL=1) against a class table to check it.
+ *
+ * Pure logic: runs on a host.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PEEL_POOL_MAX_SLOTS 32
+
+typedef struct {
+    int capacity;                   // pixels (bytes at 8bpp)
+    int count;
+} peel_pool_class_t;
+
+#define PEEL_POOL_DEFAULT_CLASSES 3
+extern const peel_pool_class_t peel_pool_default_classes[PEEL_POOL_DEFAULT_CLASSES];
+
+typedef struct {
+    int slot_count;                 // slots are grouped by class, smallest first
+    int capacity[PEEL_POOL_MAX_SLOTS];
+    bool in_use[PEEL_POOL_MAX_SLOTS];
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t bytes_in_use;
+    uint32_t peak_bytes;
+} peel_pool_t;
+
+// Lay out the slots of classes[0..n-1] (at most PEEL_POOL_MAX_SLOTS) and
+// clear the counters. Returns the slot count. A caller whose backing
+// allocation fails part way may lower slot_count afterwards.
+int peel_pool_init(peel_pool_t *pool, const peel_pool_class_t *classes, int n);
+
+// Total capacity of a class table, in bytes.
+uint32_t peel_pool_bytes(const peel_pool_class_t *classes, int n);
+
+// Smallest free slot that holds pixels, marked in use; -1 on a miss.
+int peel_pool_acquire(peel_pool_t *pool, int pixels);
+
+// Give a slot back. Out of range or already free slots are ignored.
+void peel_pool_release(peel_pool_t *pool, int slot);
+
+// Free every slot (session teardown); the counters are kept.
+void peel_pool_release_all(peel_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
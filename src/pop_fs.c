@@ -6,6 +6,11 @@
 
 #include "diskio.h"
 #include "pico/stdlib.h"  // For sleep_us
+#include "hardware/sync.h"
+#include "board_config.h"
+#include "teardown.h"
+#include "crash_guard.h"
+#include "sd_hotplug.h"
 
 // Chunk size for yielding file reads (512 bytes = 1 SD sector)
 // This allows HDMI DMA to access memory between SD reads
@@ -14,6 +19,194 @@
 static FATFS g_fs;
 static bool g_mounted = false;
 
+// Files opened with "w" are written under a temporary name and renamed over
+// the original on close. A ".new~" file is complete (the commit point); a
+// ".tmp~" file may be torn and is deleted by the recovery scan.
+#define POP_FS_TMP_SUFFIX ".tmp~"
+#define POP_FS_NEW_SUFFIX ".new~"
+
+// Remount retry interval while the card is out.
+#ifndef POP_FS_REMOUNT_RETRY_MS
+#define POP_FS_REMOUNT_RETRY_MS 500
+#endif
+
+// Every FIL handed out by pop_fs_open(), so a session that quits with files
+// still open can be cleaned up (and reported) by the teardown hook, and so
+// files can be reopened at the same position after the card was reinserted.
+#define POP_FS_MAX_OPEN 16
+typedef struct {
+    FIL* fil;
+    char* path;          // FatFS path, malloc'd
+    char* final_path;    // for "w": the file replaced on close, malloc'd
+    BYTE mode;           // FatFS open mode
+    bool wait;           // block (with the prompt) while the card is out
+    bool failed;         // opened for writing on an earlier mount: lost
+} pop_fs_handle_t;
+static pop_fs_handle_t g_open_files[POP_FS_MAX_OPEN];
+static int g_leaked_files = 0;
+
+static sd_hotplug_t g_hotplug;
+static void (*g_wait_hook)(bool waiting) = NULL;
+
+// False when the table is full or out of memory: the caller must not hand
+// the file out, since an untracked "w" file would never be committed.
+static bool pop_fs_track(FIL* fil, const char* path, const char* final_path, BYTE mode) {
+    for (int i = 0; i < POP_FS_MAX_OPEN; ++i) {
+        if (g_open_files[i].fil != NULL) continue;
+        pop_fs_handle_t* h = &g_open_files[i];
+        h->path = strdup(path);
+        h->final_path = final_path ? strdup(final_path) : NULL;
+        if (!h->path || (final_path && !h->final_path)) {
+            free(h->path);
+            free(h->final_path);
+            memset(h, 0, sizeof(*h));
+            return false;
+        }
+        h->fil = fil;
+        h->mode = mode;
+        h->wait = true;
+        return true;
+    }
+    return false;
+}
+
+static pop_fs_handle_t* pop_fs_handle(FIL* fil) {
+    for (int i = 0; i < POP_FS_MAX_OPEN; ++i) {
+        if (g_open_files[i].fil == fil) return &g_open_files[i];
+    }
+    return NULL;
+}
+
+static void pop_fs_untrack(FIL* fil) {
+    pop_fs_handle_t* h = pop_fs_handle(fil);
+    if (!h) return;
+    free(h->path);
+    free(h->final_path);
+    memset(h, 0, sizeof(*h));
+}
+
+// ----------------------------------------------------------------------------
+// Card removal / reinsertion
+// ----------------------------------------------------------------------------
+
+static bool pop_fs_card_ok(void* ctx) {
+    (void)ctx;
+    BYTE r2[2];
+    return disk_ioctl(0, MMC_GET_STATUS, r2) == RES_OK;
+}
+
+static bool pop_fs_remount(void* ctx) {
+    (void)ctx;
+    DSTATUS ds = disk_initialize(0);
+    if (ds & STA_NOINIT) return false;
+    if (f_mount(&g_fs, "0:", 1) != FR_OK) return false;
+    f_chdir("/");
+    DBG_PRINTF("[pop_fs] SD card reinserted, remounted\n");
+    return true;
+}
+
+// Reopen a FIL from an earlier mount at its old position. Only files opened
+// for reading: what a writer had in the FatFS buffers (data, size, FAT
+// chain) went with the card, so the file on it cannot be trusted. Writers
+// are marked failed instead; every later call on them fails and the close
+// discards the temporary and reports the error.
+static bool pop_fs_reopen(pop_fs_handle_t* h) {
+    if (!h->path || h->failed) return false;
+    if (h->mode & FA_WRITE) {
+        h->failed = true;
+        DBG_PRINTF("[pop_fs] %s was open for writing across a remount, dropped\n", h->path);
+        return false;
+    }
+    FSIZE_t pos = f_tell(h->fil);
+    if (f_open(h->fil, h->path, h->mode) != FR_OK) return false;
+    return f_lseek(h->fil, pos) == FR_OK;
+}
+
+// Block until the card is back (core 0 only), with the on-screen prompt up.
+// Returns false if this caller must not wait.
+static bool pop_fs_wait_for_card(void) {
+    if (sd_hotplug_present(&g_hotplug)) return true;
+    if (get_core_num() != 0) return false;
+
+    DBG_PRINTF("[pop_fs] SD card removed, waiting for reinsertion\n");
+    if (g_wait_hook) g_wait_hook(true);
+    while (!sd_hotplug_poll(&g_hotplug, to_ms_since_boot(get_absolute_time()))) {
+        crash_guard_feed();
+        sleep_ms(20);
+    }
+    // Non-waiting (audio) files cannot recover themselves: reopen them here,
+    // while the hook still holds their reader. Writers are failed now.
+    for (int i = 0; i < POP_FS_MAX_OPEN; ++i) {
+        pop_fs_handle_t* h = &g_open_files[i];
+        if (h->fil && (h->mode & FA_WRITE)) h->failed = true;
+        if (h->fil && !h->wait && !pop_fs_reopen(h)) {
+            DBG_PRINTF("[pop_fs] could not reopen %s\n", h->path);
+        }
+    }
+    if (g_wait_hook) g_wait_hook(false);
+    return true;
+}
+
+// An operation on h failed. Returns true when the caller should retry with
+// the (reopened) file.
+static bool pop_fs_recover(FIL* fil) {
+    pop_fs_handle_t* h = pop_fs_handle(fil);
+    if (!h || !g_mounted) return false;
+    // Non-waiting (audio) reads never touch the card from the error path.
+    if (!h->wait || get_core_num() != 0) return false;
+    if (sd_hotplug_on_io_error(&g_hotplug, to_ms_since_boot(get_absolute_time()))) {
+        // Card still there: a real error, unless the FIL is from an earlier
+        // mount (FatFS gives every mount a new id).
+        if (fil->obj.id == g_fs.id) return false;
+    }
+    if (!pop_fs_wait_for_card()) return false;
+    return pop_fs_reopen(h);
+}
+
+// A writer whose FIL is from an earlier mount (the card was remounted
+// while it was open, whichever handle noticed) has lost data.
+static bool pop_fs_write_lost(pop_fs_handle_t* h) {
+    if (h && (h->mode & FA_WRITE) && g_mounted && h->fil->obj.id != g_fs.id) h->failed = true;
+    return h && h->failed;
+}
+
+void pop_fs_set_wait_hook(void (*hook)(bool waiting)) {
+    g_wait_hook = hook;
+}
+
+void pop_fs_set_blocking(FIL* fil, bool wait_for_card) {
+    pop_fs_handle_t* h = pop_fs_handle(fil);
+    if (h) h->wait = wait_for_card;
+}
+
+bool pop_fs_card_present(void) {
+    return sd_hotplug_present(&g_hotplug);
+}
+
+uint16_t pop_fs_mount_id(void) {
+    return g_mounted ? g_fs.id : 0;
+}
+
+// Teardown hook: subsystems close their own files first; anything left is a leak.
+static void pop_fs_teardown(void) {
+    g_leaked_files = 0;
+    for (int i = 0; i < POP_FS_MAX_OPEN; ++i) {
+        if (g_open_files[i].fil != NULL) {
+            // A write cut short by quit must not replace the original.
+            if (g_open_files[i].final_path) pop_fs_discard(g_open_files[i].fil);
+            else pop_fs_close(g_open_files[i].fil);
+            ++g_leaked_files;
+        }
+    }
+}
+
+static bool pop_fs_teardown_check(void) {
+    if (g_leaked_files != 0) {
+        DBG_PRINTF("[pop_fs] %d file(s) were still open at quit\n", g_leaked_files);
+    }
+    return g_leaked_files == 0;
+}
+
 // Reset mounted state (call before start screen check on re-entry)
 void pop_fs_reset(void) {
     g_mounted = false;
@@ -39,6 +232,9 @@ bool pop_fs_init(void) {
     f_chdir("/");
     
     g_mounted = true;
+    static const sd_hotplug_ops_t ops = { pop_fs_card_ok, pop_fs_remount, NULL };
+    sd_hotplug_init(&g_hotplug, &ops, POP_FS_REMOUNT_RETRY_MS);
+    teardown_register("pop_fs", pop_fs_teardown, pop_fs_teardown_check);
     return true;
 }
 
@@ -96,14 +292,38 @@ FIL* pop_fs_open(const char* pop_path, const char* mode) {
     char full[256];
     pop_fs_make_path(full, sizeof(full), pop_path);
 
+    // Plain "w": write to a temporary and replace the file on close.
+    char tmp[sizeof(full) + sizeof(POP_FS_TMP_SUFFIX)];
+    const bool atomic = mode && strchr(mode, 'w') && !strchr(mode, '+');
+    const char* open_path = full;
+    if (atomic) {
+        snprintf(tmp, sizeof(tmp), "%s" POP_FS_TMP_SUFFIX, full);
+        open_path = tmp;
+    }
+
     FIL* fil = (FIL*)calloc(1, sizeof(FIL));
     if (!fil) return NULL;
 
-    FRESULT fr = f_open(fil, full, fatfs_mode_from_stdio(mode));
+    const BYTE fmode = fatfs_mode_from_stdio(mode);
+    FRESULT fr = f_open(fil, open_path, fmode);
+    if ((fr == FR_NOT_READY || fr == FR_DISK_ERR) && get_core_num() == 0) {
+        // Card pulled since the last access: wait for it, then try once more.
+        if (!sd_hotplug_on_io_error(&g_hotplug, to_ms_since_boot(get_absolute_time())) &&
+            pop_fs_wait_for_card()) {
+            fr = f_open(fil, open_path, fmode);
+        }
+    }
     if (fr != FR_OK) {
         free(fil);
         return NULL;
     }
+    if (!pop_fs_track(fil, open_path, atomic ? full : NULL, fmode)) {
+        DBG_PRINTF("[pop_fs] too many open files, not opening %s\n", full);
+        f_close(fil);
+        if (atomic) f_unlink(tmp);
+        free(fil);
+        return NULL;
+    }
     return fil;
 }
 
@@ -122,19 +342,25 @@ size_t pop_fs_read(void* ptr, size_t size, size_t nmemb, FIL* fil) {
         UINT br = 0;
         
         FRESULT fr = f_read(fil, dst, chunk, &br);
-        if (fr != FR_OK) break;
         
         total_read += br;
         dst += br;
         total_bytes -= br;
         
+        if (fr != FR_OK) {
+            // Card pulled: wait for it, reopen at the same position, go on.
+            if (pop_fs_recover(fil)) continue;
+            break;
+        }
+        
         // If we read less than requested, we hit EOF
         if (br < chunk) break;
         
         // Yield between chunks: memory barrier + brief pause for HDMI DMA
-        __asm volatile ("dsb" ::: "memory");
-        __asm volatile ("isb");
+        __dsb();
+        __isb();
         sleep_us(10);  // 10us pause allows ~3-4 HDMI scanlines worth of DMA
+        crash_guard_feed();  // long loads must not trip the watchdog
     }
     
     return (size > 0) ? (total_read / (UINT)size) : 0;
@@ -145,8 +371,13 @@ size_t pop_fs_write(const void* ptr, size_t size, size_t nmemb, FIL* fil) {
     UINT bw = 0;
     UINT to_write = (UINT)(size * nmemb);
     if (to_write == 0) return 0;
+    if (pop_fs_write_lost(pop_fs_handle(fil))) return 0;
 
     FRESULT fr = f_write(fil, ptr, to_write, &bw);
+    if (fr != FR_OK && bw == 0 && pop_fs_recover(fil)) {
+        fr = f_write(fil, ptr, to_write, &bw);
+    }
+    crash_guard_feed();
     if (fr != FR_OK) return 0;
     return (size > 0) ? (bw / (UINT)size) : 0;
 }
@@ -167,6 +398,9 @@ int pop_fs_seek(FIL* fil, long offset, int whence) {
 
     FSIZE_t target = base + (FSIZE_t)offset;
     FRESULT fr = f_lseek(fil, target);
+    if (fr != FR_OK && pop_fs_recover(fil)) {
+        fr = f_lseek(fil, target);
+    }
     return (fr == FR_OK) ? 0 : -1;
 }
 
@@ -175,11 +409,158 @@ long pop_fs_tell(FIL* fil) {
     return (long)f_tell(fil);
 }
 
+// Replace final_path with the finished temporary tmp_path. Every step leaves
+// either the old or the new contents reachable for pop_fs_recover_dir().
+static bool pop_fs_commit(const char* tmp_path, const char* final_path) {
+    char new_path[256 + sizeof(POP_FS_NEW_SUFFIX)];
+    snprintf(new_path, sizeof(new_path), "%s" POP_FS_NEW_SUFFIX, final_path);
+
+    (void)f_unlink(new_path);  // leftover from an earlier failed commit
+    if (f_rename(tmp_path, new_path) != FR_OK) return false;
+    FRESULT fr = f_unlink(final_path);
+    if (fr != FR_OK && fr != FR_NO_FILE) return false;
+    return f_rename(new_path, final_path) == FR_OK;
+}
+
 int pop_fs_close(FIL* fil) {
     if (!fil) return 0;
+    pop_fs_handle_t* h = pop_fs_handle(fil);
+    const bool lost = pop_fs_write_lost(h);
+    char* tmp_path = NULL;
+    char* final_path = NULL;
+    if (h && h->final_path) {
+        // Take the paths over before untracking frees them.
+        tmp_path = h->path;
+        final_path = h->final_path;
+        h->path = NULL;
+        h->final_path = NULL;
+    }
+    pop_fs_untrack(fil);
+
+    int result = 0;
+    if (lost) {
+        // Never synced to the new mount: drop the temporary, keep the original.
+        (void)f_close(fil);
+        if (tmp_path) (void)f_unlink(tmp_path);
+        result = -1;
+    } else if (final_path) {
+        // Data and directory entry must be on the card before the rename.
+        FRESULT fr = f_sync(fil);
+        if (f_close(fil) != FR_OK) fr = FR_DISK_ERR;
+        if (fr != FR_OK || !pop_fs_commit(tmp_path, final_path)) {
+            DBG_PRINTF("[pop_fs] commit of %s failed\n", final_path);
+            (void)f_unlink(tmp_path);
+            result = -1;
+        }
+        crash_guard_feed();
+    } else {
+        (void)f_close(fil);
+    }
+    free(tmp_path);
+    free(final_path);
+    free(fil);
+    return result;
+}
+
+void pop_fs_discard(FIL* fil) {
+    if (!fil) return;
+    pop_fs_handle_t* h = pop_fs_handle(fil);
+    char* tmp_path = (h && h->final_path) ? h->path : NULL;
+    if (tmp_path) h->path = NULL;
+    pop_fs_untrack(fil);
     (void)f_close(fil);
+    if (tmp_path) (void)f_unlink(tmp_path);
+    free(tmp_path);
     free(fil);
-    return 0;
+}
+
+static bool pop_fs_has_suffix(const char* name, const char* suffix) {
+    size_t n = strlen(name), s = strlen(suffix);
+    return n > s && strcmp(name + n - s, suffix) == 0;
+}
+
+int pop_fs_recover_dir(const char* pop_dir, pop_fs_check_fn check) {
+    if (!g_mounted && !pop_fs_init()) return 0;
+
+    char dir[256];
+    pop_fs_make_path(dir, sizeof(dir), pop_dir);
+    size_t dir_len = strlen(dir);
+    if (dir_len > 0 && dir[dir_len - 1] == '/') dir[--dir_len] = '\0';
+
+    enum { FIX_NONE, FIX_TMP, FIX_NEW, FIX_INVALID };
+    int fixed = 0;
+    for (;;) {
+        // Find one file that needs attention, then deal with it with the
+        // directory closed: renames and deletes may reorder the entries.
+        DIR d;
+        FILINFO fno;
+        char path[256 + FF_LFN_BUF + 2];
+        int fix = FIX_NONE;
+        if (f_opendir(&d, dir) != FR_OK) break;
+        while (fix == FIX_NONE && f_readdir(&d, &fno) == FR_OK && fno.fname[0]) {
+            if (fno.fattrib & AM_DIR) continue;
+            snprintf(path, sizeof(path), "%s/%s", dir, fno.fname);
+            if (pop_fs_has_suffix(fno.fname, POP_FS_TMP_SUFFIX)) {
+                fix = FIX_TMP;
+            } else if (pop_fs_has_suffix(fno.fname, POP_FS_NEW_SUFFIX)) {
+                fix = FIX_NEW;
+            } else if (check) {
+                FIL f;
+                if (f_open(&f, path, FA_READ) == FR_OK) {
+                    if (!check(&f, f_size(&f))) fix = FIX_INVALID;
+                    f_close(&f);
+                }
+            }
+        }
+        f_closedir(&d);
+        if (fix == FIX_NONE) break;
+
+        bool ok;
+        if (fix == FIX_NEW) {
+            // Interrupted after the commit point: finish replacing the file.
+            char final_path[sizeof(path)];
+            snprintf(final_path, sizeof(final_path), "%.*s",
+                     (int)(strlen(path) - strlen(POP_FS_NEW_SUFFIX)), path);
+            FRESULT fr = f_unlink(final_path);
+            ok = (fr == FR_OK || fr == FR_NO_FILE) && f_rename(path, final_path) == FR_OK;
+            DBG_PRINTF("[pop_fs] recover: completed %s\n", final_path);
+        } else {
+            // Torn temporary, or a file that fails its check.
+            ok = f_unlink(path) == FR_OK;
+            DBG_PRINTF("[pop_fs] recover: removed %s\n", path);
+        }
+        if (!ok) break;  // read-only or damaged card: don't spin
+        ++fixed;
+        crash_guard_feed();
+    }
+    return fixed;
+}
+
+bool pop_fs_get_info(pop_fs_info_t* info) {
+    memset(info, 0, sizeof(*info));
+    info->card_kind = "?";
+    info->free_mb = UINT32_MAX;
+    if (!g_mounted) return false;
+
+    LBA_t sectors = 0;
+    if (disk_ioctl(0, GET_SECTOR_COUNT, &sectors) == RES_OK) {
+        info->size_mb = (uint32_t)(sectors / 2048);
+    }
+    BYTE type = 0;
+    if (disk_ioctl(0, MMC_GET_TYPE, &type) == RES_OK) {
+        // CT_* flags from drivers/sdcard/sdcard.c
+        if (type & 0x08) info->card_kind = "SDHC";
+        else if (type & 0x06) info->card_kind = "SDSC";
+        else if (type & 0x01) info->card_kind = "MMC";
+    }
+    info->fs_type = g_fs.fs_type;
+    // Only a count FatFS already has (FSInfo or an earlier f_getfree): a full
+    // FAT scan can take seconds on a large card.
+    if (g_fs.free_clst <= g_fs.n_fatent - 2) {
+        info->free_mb = (uint32_t)(((uint64_t)g_fs.free_clst * g_fs.csize) / 2048);
+    }
+    info->removals = g_hotplug.removals;
+    return true;
 }
 
 bool pop_fs_exists(const char* pop_path) {
@@ -2,6 +2,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "ff.h"
 
@@ -27,6 +28,44 @@ int pop_fs_seek(FIL* fil, long offset, int whence);
 long pop_fs_tell(FIL* fil);
 int pop_fs_close(FIL* fil);
 
+// Power-loss safety: a file opened with "w"/"wb" is written to
+// "<name>.tmp~" and only replaces <name> in pop_fs_close(), after an f_sync.
+// Until then the old contents stay intact. pop_fs_close() returns -1 if the
+// new contents could not be committed.
+// pop_fs_discard() drops such a file without touching the original.
+void pop_fs_discard(FIL* fil);
+
+// Boot-time cleanup of one directory after a power cut: deletes torn
+// temporaries, finishes interrupted commits and, if check is given, deletes
+// files it rejects (e.g. caches whose size disagrees with their header).
+// Returns the number of files fixed.
+typedef bool (*pop_fs_check_fn)(FIL* fil, FSIZE_t size);
+int pop_fs_recover_dir(const char* pop_dir, pop_fs_check_fn check);
+
+// Card removal: reads, writes and seeks on a pulled card block (core 0 only)
+// until it is reinserted, then a file open for reading is reopened at the
+// same position. A file open for writing is not: its calls fail from then
+// on, and pop_fs_close() drops it (a "w" file keeps the original) and
+// returns -1.
+// The hook is called with true before waiting and false after the remount.
+void pop_fs_set_wait_hook(void (*hook)(bool waiting));
+// Files read from the audio path opt out, so they fail fast instead (silence).
+void pop_fs_set_blocking(FIL* fil, bool wait_for_card);
+bool pop_fs_card_present(void);
+// Changes on every mount (FatFS volume id), so caches of directory contents
+// can tell the card may have been swapped. 0 while unmounted.
+uint16_t pop_fs_mount_id(void);
+
+// Card and filesystem facts for the start screen diagnostics page.
+typedef struct {
+    const char* card_kind;  // "SDHC", "SDSC", "MMC" or "?"
+    uint32_t size_mb;
+    uint8_t fs_type;        // FS_FAT12 / FS_FAT16 / FS_FAT32 / FS_EXFAT
+    uint32_t free_mb;       // UINT32_MAX until FatFS has counted free clusters
+    uint32_t removals;      // card pulls seen since boot
+} pop_fs_info_t;
+bool pop_fs_get_info(pop_fs_info_t* info);
+
 bool pop_fs_exists(const char* pop_path);
 bool pop_fs_mkdir(const char* pop_path);
 bool pop_fs_delete(const char* pop_path);
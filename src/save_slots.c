@@ -0,0 +1,208 @@
+/*
+ * murmprince - save game slots
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "save_slots.h"
+#include "pop_fs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Record layout (little endian):
+//   0  magic "PSLT"       4  version        5  slot index   6  reserved
+//   8  save counter      12  level         14  minutes left
+//  16  ticks left        18  hit points    20  levelset name (32 bytes)
+// 508  CRC-32 of bytes 0..507
+#define SAVE_SLOT_MAGIC "PSLT"
+#define SAVE_SLOT_VERSION 1
+#define SAVE_SLOT_CRC_OFS (SAVE_SLOTS_RECORD_SIZE - 4)
+
+static uint32_t crc32_bytes(const uint8_t *p, size_t n) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (n--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+void save_slot_encode(const save_slot_t *slot, int index, uint8_t rec[SAVE_SLOTS_RECORD_SIZE]) {
+    memset(rec, 0, SAVE_SLOTS_RECORD_SIZE);
+    memcpy(rec, SAVE_SLOT_MAGIC, 4);
+    rec[4] = SAVE_SLOT_VERSION;
+    rec[5] = (uint8_t)index;
+    put32(rec + 8, slot->seq);
+    put16(rec + 12, slot->level);
+    put16(rec + 14, slot->rem_min);
+    put16(rec + 16, slot->rem_tick);
+    put16(rec + 18, slot->hitp);
+    size_t name_len = 0;
+    while (name_len < SAVE_SLOTS_LEVELSET_NAME - 1 && slot->levelset[name_len]) ++name_len;
+    memcpy(rec + 20, slot->levelset, name_len);
+    put32(rec + SAVE_SLOT_CRC_OFS, crc32_bytes(rec, SAVE_SLOT_CRC_OFS));
+}
+
+save_slot_status_t save_slot_decode(const uint8_t rec[SAVE_SLOTS_RECORD_SIZE], int index,
+                                    save_slot_t *slot) {
+    memset(slot, 0, sizeof(*slot));
+    bool blank = true;
+    for (int i = 0; i < SAVE_SLOTS_RECORD_SIZE && blank; ++i) blank = rec[i] == 0;
+    if (blank) {
+        slot->status = SAVE_SLOT_EMPTY;
+    } else if (memcmp(rec, SAVE_SLOT_MAGIC, 4) != 0 || rec[4] != SAVE_SLOT_VERSION ||
+               rec[5] != (uint8_t)index ||
+               get32(rec + SAVE_SLOT_CRC_OFS) != crc32_bytes(rec, SAVE_SLOT_CRC_OFS) ||
+               rec[20 + SAVE_SLOTS_LEVELSET_NAME - 1] != 0) {
+        slot->status = SAVE_SLOT_DAMAGED;
+    } else {
+        slot->status = SAVE_SLOT_OK;
+        slot->seq = get32(rec + 8);
+        slot->level = get16(rec + 12);
+        slot->rem_min = get16(rec + 14);
+        slot->rem_tick = get16(rec + 16);
+        slot->hitp = get16(rec + 18);
+        memcpy(slot->levelset, rec + 20, SAVE_SLOTS_LEVELSET_NAME);
+    }
+    return slot->status;
+}
+
+bool save_slot_from_legacy(const uint8_t data[SAVE_SLOTS_LEGACY_SIZE], const char *levelset,
+                           save_slot_t *slot) {
+    memset(slot, 0, sizeof(*slot));
+    slot->rem_min = get16(data);
+    slot->rem_tick = get16(data + 2);
+    slot->level = get16(data + 4);
+    slot->hitp = get16(data + 6);
+    // Levels 1..15 (15 is the potions level of some mods); time may be
+    // anything a mod allows, but not negative.
+    if (slot->level < 1 || slot->level > 15 || slot->hitp < 1 || slot->hitp > 15 ||
+        (slot->rem_min & 0x8000) || (slot->rem_tick & 0x8000)) {
+        return false;
+    }
+    snprintf(slot->levelset, sizeof(slot->levelset), "%s", levelset ? levelset : "");
+    slot->status = SAVE_SLOT_OK;
+    return true;
+}
+
+bool save_slots_read_all(save_slot_t slots[SAVE_SLOTS_COUNT]) {
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+        memset(&slots[i], 0, sizeof(slots[i]));
+    }
+    if (!pop_fs_exists(SAVE_SLOTS_FILE)) return true;
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "rb");
+    if (!f) return false;
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+        // A short file (cut while being created) leaves the tail empty.
+        if (pop_fs_read(rec, SAVE_SLOTS_RECORD_SIZE, 1, f) != 1) break;
+        save_slot_decode(rec, i, &slots[i]);
+    }
+    pop_fs_close(f);
+    return true;
+}
+
+bool save_slots_read(int index, save_slot_t *slot) {
+    memset(slot, 0, sizeof(*slot));
+    if (index < 0 || index >= SAVE_SLOTS_COUNT) return false;
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "rb");
+    if (!f) return false;
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    bool ok = pop_fs_seek(f, (long)index * SAVE_SLOTS_RECORD_SIZE, SEEK_SET) == 0 &&
+              pop_fs_read(rec, SAVE_SLOTS_RECORD_SIZE, 1, f) == 1 &&
+              save_slot_decode(rec, index, slot) == SAVE_SLOT_OK;
+    pop_fs_close(f);
+    return ok;
+}
+
+// First save: write the whole file of empty records. pop_fs commits "wb"
+// files by rename, so a cut leaves either no file or a complete one.
+static bool save_slots_create(void) {
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "wb");
+    if (!f) return false;
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    memset(rec, 0, sizeof(rec));
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+        if (pop_fs_write(rec, SAVE_SLOTS_RECORD_SIZE, 1, f) != 1) {
+            pop_fs_discard(f);
+            return false;
+        }
+    }
+    return pop_fs_close(f) == 0;
+}
+
+int save_slots_latest(const save_slot_t slots[SAVE_SLOTS_COUNT]) {
+    int latest = -1;
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+        if (slots[i].status != SAVE_SLOT_OK) continue;
+        if (latest < 0 || slots[i].seq > slots[latest].seq) latest = i;
+    }
+    return latest;
+}
+
+bool save_slots_write(int index, save_slot_t *slot) {
+    if (index < 0 || index >= SAVE_SLOTS_COUNT) return false;
+
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    if (!save_slots_read_all(slots)) return false;
+    const int latest = save_slots_latest(slots);
+    slot->seq = latest < 0 ? 1 : slots[latest].seq + 1;
+    slot->status = SAVE_SLOT_OK;
+
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "r+b");
+    if (!f || f_size(f) < (FSIZE_t)SAVE_SLOTS_COUNT * SAVE_SLOTS_RECORD_SIZE) {
+        if (f) pop_fs_close(f);
+        if (!save_slots_create()) return false;
+        f = pop_fs_open(SAVE_SLOTS_FILE, "r+b");
+        if (!f) return false;
+    }
+
+    // Sector-aligned full-sector write: FatFS hands it to the card directly.
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    save_slot_encode(slot, index, rec);
+    bool ok = pop_fs_seek(f, (long)index * SAVE_SLOTS_RECORD_SIZE, SEEK_SET) == 0 &&
+              pop_fs_write(rec, SAVE_SLOTS_RECORD_SIZE, 1, f) == 1;
+    if (pop_fs_close(f) != 0) ok = false;
+    return ok;
+}
+
+int save_slots_import_legacy(const char *path, const char *levelset) {
+    if (!pop_fs_exists(path)) return -1;
+    FIL *f = pop_fs_open(path, "rb");
+    if (!f) return -1;
+    uint8_t data[SAVE_SLOTS_LEGACY_SIZE];
+    const bool read = pop_fs_read(data, SAVE_SLOTS_LEGACY_SIZE, 1, f) == 1;
+    pop_fs_close(f);
+    save_slot_t slot;
+    if (!read || !save_slot_from_legacy(data, levelset, &slot)) return -1;
+
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    if (!save_slots_read_all(slots)) return -1;
+    int index = -1;
+    for (int i = 0; i < SAVE_SLOTS_COUNT && index < 0; ++i) {
+        if (slots[i].status == SAVE_SLOT_EMPTY) index = i;
+    }
+    if (index < 0 || !save_slots_write(index, &slot)) return -1;
+    // The slot holds all of it now; a second import would duplicate it.
+    pop_fs_delete(path);
+    return index;
+}
@@ -0,0 +1,90 @@
+/*
+ * murmprince - save game slots
+ *
+ * SDLPoP keeps one PRINCE.SAV (level, time left, hit points). On the device
+ * the saves live in PRINCE.SLT instead: a file of SAVE_SLOTS_COUNT records,
+ * each exactly one 512-byte sector, created once at full size. A save
+ * rewrites a single record in place with one aligned sector write, so the
+ * file never changes size or cluster chain, and a power cut leaves the old
+ * record or the new one. Each record is checked by magic, slot number and
+ * CRC-32, so a torn or foreign sector reads back as damaged, not as a
+ * bogus level.
+ *
+ * The boards have no real-time clock: records carry a save counter instead
+ * of a timestamp, which orders them for "most recent".
+ *
+ * A PRINCE.SAV left by earlier firmware (in the card root, or in a
+ * levelset's mod folder) is moved into the first empty slot when the
+ * start screen finds it.
+ *
+ * The record codec is pure; file access goes through pop_fs.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SAVE_SLOTS_FILE "PRINCE.SLT"
+#define SAVE_SLOTS_COUNT 8
+#define SAVE_SLOTS_RECORD_SIZE 512
+#define SAVE_SLOTS_LEVELSET_NAME 32
+#define SAVE_SLOTS_LEGACY_FILE "PRINCE.SAV"
+#define SAVE_SLOTS_LEGACY_SIZE 8
+
+typedef enum {
+    SAVE_SLOT_EMPTY = 0,
+    SAVE_SLOT_OK,
+    SAVE_SLOT_DAMAGED,
+} save_slot_status_t;
+
+typedef struct {
+    save_slot_status_t status;
+    uint32_t seq;              // save counter, highest = most recent
+    uint16_t level;
+    uint16_t rem_min;          // SDLPoP time left
+    uint16_t rem_tick;
+    uint16_t hitp;             // hit points at level start
+    char levelset[SAVE_SLOTS_LEVELSET_NAME]; // mod name, "" for the original levels
+} save_slot_t;
+
+// Record codec. decode reports an all-zero record as empty and anything
+// that fails the checks as damaged.
+void save_slot_encode(const save_slot_t *slot, int index, uint8_t rec[SAVE_SLOTS_RECORD_SIZE]);
+save_slot_status_t save_slot_decode(const uint8_t rec[SAVE_SLOTS_RECORD_SIZE], int index,
+                                    save_slot_t *slot);
+
+// SDLPoP's PRINCE.SAV: minutes left, ticks left, level, hit points, each
+// 16-bit little endian. False if it does not look like a save.
+bool save_slot_from_legacy(const uint8_t data[SAVE_SLOTS_LEGACY_SIZE], const char *levelset,
+                           save_slot_t *slot);
+
+// Read all slots. A missing file reads as all empty. Returns false if the
+// file exists but could not be read.
+bool save_slots_read_all(save_slot_t slots[SAVE_SLOTS_COUNT]);
+
+// Read one slot; true only if it holds a valid save.
+bool save_slots_read(int index, save_slot_t *slot);
+
+// Write slot index (creating the file on first use). slot->seq is set to
+// one past the highest counter on the card. Returns false on any error;
+// the previous contents of the slot are then still intact.
+bool save_slots_write(int index, save_slot_t *slot);
+
+// Index of the most recent valid save, or -1.
+int save_slots_latest(const save_slot_t slots[SAVE_SLOTS_COUNT]);
+
+// Move the PRINCE.SAV at path (levelset "" for the original levels) into
+// the first empty slot and delete it. Returns the slot, or -1 if there is
+// no such file, it is not a save, or no slot is free (it then stays).
+int save_slots_import_legacy(const char *path, const char *levelset);
+
+#ifdef __cplusplus
+}
+#endif
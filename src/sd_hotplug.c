@@ -0,0 +1,37 @@
+/*
+ * murmprince - SD card removal / reinsertion tracking
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "sd_hotplug.h"
+
+#include <string.h>
+
+void sd_hotplug_init(sd_hotplug_t *hp, const sd_hotplug_ops_t *ops, uint32_t retry_ms) {
+    memset(hp, 0, sizeof(*hp));
+    hp->ops = *ops;
+    hp->present = true;
+    hp->retry_ms = retry_ms;
+}
+
+bool sd_hotplug_on_io_error(sd_hotplug_t *hp, uint32_t now_ms) {
+    if (!hp->present) return false;
+    if (hp->ops.card_ok(hp->ops.ctx)) return true;
+    hp->present = false;
+    hp->removals++;
+    // First remount attempt waits a full interval: contacts bounce on insertion.
+    hp->last_try_ms = now_ms;
+    return false;
+}
+
+bool sd_hotplug_poll(sd_hotplug_t *hp, uint32_t now_ms) {
+    if (hp->present) return true;
+    if (now_ms - hp->last_try_ms < hp->retry_ms) return false;
+    hp->last_try_ms = now_ms;
+    if (!hp->ops.remount(hp->ops.ctx)) return false;
+    hp->present = true;
+    hp->generation++;
+    hp->remounts++;
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+ * murmprince - SD card removal / reinsertion tracking
+ *
+ * The boards have no card-detect pin, so presence is checked on demand:
+ * after an I/O error the card is asked for its status (CMD13), and while it
+ * is gone a remount is retried at a fixed interval. A generation counter
+ * bumps on every successful remount so open files can tell they need to be
+ * reopened. The card is reached only through the two callbacks, so this
+ * builds on a host against a simulated block device.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    bool (*card_ok)(void *ctx); // status query on the mounted card
+    bool (*remount)(void *ctx); // re-initialise the card and the filesystem
+    void *ctx;
+} sd_hotplug_ops_t;
+
+typedef struct {
+    sd_hotplug_ops_t ops;
+    bool present;
+    uint32_t generation;       // bumps on every remount after a removal
+    uint32_t retry_ms;         // remount retry interval while removed
+    uint32_t last_try_ms;
+    uint32_t removals;         // statistics
+    uint32_t remounts;
+} sd_hotplug_t;
+
+void sd_hotplug_init(sd_hotplug_t *hp, const sd_hotplug_ops_t *ops, uint32_t retry_ms);
+
+// An access failed: ask the card whether it is still there. Returns true if
+// it is (the error was something else); otherwise the card is marked removed.
+bool sd_hotplug_on_io_error(sd_hotplug_t *hp, uint32_t now_ms);
+
+// While removed, try to remount at most once per retry interval. Returns
+// true when the card is (again) present.
+bool sd_hotplug_poll(sd_hotplug_t *hp, uint32_t now_ms);
+
+static inline bool sd_hotplug_present(const sd_hotplug_t *hp) {
+    return hp->present;
+}
+
+#ifdef __cplusplus
+}
+#endif
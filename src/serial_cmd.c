@@ -0,0 +1,284 @@
+/*
+ * murmprince - serial test commands
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "serial_cmd.h"
+
+#include <string.h>
+
+enum {
+    RX_SYNC0 = 0,
+    RX_SYNC1,
+    RX_TYPE,
+    RX_SEQ,
+    RX_LEN0,
+    RX_LEN1,
+    RX_PAYLOAD,
+    RX_CRC0,
+    RX_CRC1,
+};
+
+#define KEY_MASK (SERIAL_CMD_KEY_QUEUE - 1)
+
+void serial_cmd_init(serial_cmd_t *c, const serial_cmd_host_t *host) {
+    memset(c, 0, sizeof(*c));
+    c->host = host;
+}
+
+uint16_t serial_cmd_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++ << 8);
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+size_t serial_cmd_encode(uint8_t *buf, size_t size, uint8_t type, uint8_t seq,
+                         const void *payload, size_t len) {
+    if (len > 0xFFFF || size < len + 8) return 0;
+    buf[0] = SERIAL_CMD_SYNC0;
+    buf[1] = SERIAL_CMD_SYNC1;
+    buf[2] = type;
+    buf[3] = seq;
+    put16(buf + 4, (uint16_t)len);
+    if (len) memcpy(buf + 6, payload, len);
+    put16(buf + 6 + len, serial_cmd_crc16(0xFFFF, buf + 2, len + 4));
+    return len + 8;
+}
+
+// Send a frame whose payload is head followed by body, without building it
+// in one piece (a screen band is several KB).
+static void send(serial_cmd_t *c, uint8_t type, uint8_t seq, const uint8_t *head, size_t head_len,
+                 const uint8_t *body, size_t body_len) {
+    const serial_cmd_host_t *h = c->host;
+    uint8_t hdr[6] = {SERIAL_CMD_SYNC0, SERIAL_CMD_SYNC1, type, seq};
+    put16(hdr + 4, (uint16_t)(head_len + body_len));
+    uint16_t crc = serial_cmd_crc16(0xFFFF, hdr + 2, 4);
+    crc = serial_cmd_crc16(crc, head, head_len);
+    crc = serial_cmd_crc16(crc, body, body_len);
+    uint8_t tail[2];
+    put16(tail, crc);
+    h->write(h->ctx, hdr, sizeof(hdr));
+    if (head_len) h->write(h->ctx, head, head_len);
+    if (body_len) h->write(h->ctx, body, body_len);
+    h->write(h->ctx, tail, sizeof(tail));
+}
+
+static void reply(serial_cmd_t *c, uint8_t status, const uint8_t *data, size_t len) {
+    uint8_t head[1 + 32];
+    head[0] = status;
+    if (len > sizeof(head) - 1) len = sizeof(head) - 1;
+    if (len) memcpy(head + 1, data, len);
+    send(c, (uint8_t)(c->type | SERIAL_CMD_REPLY), c->seq, head, 1 + len, NULL, 0);
+}
+
+static void cmd_key(serial_cmd_t *c, uint32_t now_ms) {
+    if (c->len % SERIAL_CMD_KEY_SIZE != 0) {
+        reply(c, SERIAL_CMD_BAD_LENGTH, NULL, 0);
+        return;
+    }
+    uint8_t queued = 0;
+    uint8_t status = SERIAL_CMD_OK;
+    for (uint16_t at = 0; at < c->len; at += SERIAL_CMD_KEY_SIZE) {
+        if (c->key_head - c->key_tail >= SERIAL_CMD_KEY_QUEUE) {
+            status = SERIAL_CMD_QUEUE_FULL;
+            break;
+        }
+        serial_cmd_key_t *k = &c->keys[c->key_head++ & KEY_MASK];
+        const uint32_t t = get32(c->payload + at);
+        k->at_ms = t ? t : now_ms;
+        k->scancode = get16(c->payload + at + 4);
+        k->down = c->payload[at + 6] ? 1 : 0;
+        ++queued;
+    }
+    reply(c, status, &queued, 1);
+}
+
+static void cmd_screen(serial_cmd_t *c) {
+    const serial_cmd_host_t *h = c->host;
+    int w = 0, hgt = 0;
+    const uint8_t *pixels = h->screen ? h->screen(h->ctx, &w, &hgt) : NULL;
+    if (!pixels || w <= 0 || hgt <= 0 || !h->palette) {
+        reply(c, SERIAL_CMD_REFUSED, NULL, 0);
+        return;
+    }
+    uint8_t size[4];
+    put16(size, (uint16_t)w);
+    put16(size + 2, (uint16_t)hgt);
+    reply(c, SERIAL_CMD_OK, size, sizeof(size));
+
+    uint8_t pal[256 * 3];
+    for (int i = 0; i < 256; ++i) {
+        const uint32_t rgb = h->palette(h->ctx, (uint8_t)i);
+        pal[i * 3 + 0] = (uint8_t)(rgb >> 16);
+        pal[i * 3 + 1] = (uint8_t)(rgb >> 8);
+        pal[i * 3 + 2] = (uint8_t)rgb;
+    }
+    send(c, SERIAL_CMD_PALETTE, c->seq, pal, sizeof(pal), NULL, 0);
+
+    for (int y = 0; y < hgt; y += SERIAL_CMD_SCREEN_ROWS) {
+        const int rows = (hgt - y < SERIAL_CMD_SCREEN_ROWS) ? hgt - y : SERIAL_CMD_SCREEN_ROWS;
+        uint8_t band[3];
+        put16(band, (uint16_t)y);
+        band[2] = (uint8_t)rows;
+        send(c, SERIAL_CMD_ROWS, c->seq, band, sizeof(band), pixels + (size_t)y * w, (size_t)rows * w);
+    }
+}
+
+static void cmd_state(serial_cmd_t *c) {
+    const serial_cmd_host_t *h = c->host;
+    serial_game_state_t s;
+    memset(&s, 0, sizeof(s));
+    if (!h->game_state || !h->game_state(h->ctx, &s)) {
+        reply(c, SERIAL_CMD_REFUSED, NULL, 0);
+        return;
+    }
+    uint8_t p[SERIAL_CMD_STATE_SIZE];
+    p[0] = s.level;
+    p[1] = s.room;
+    put16(p + 2, s.rem_min);
+    put16(p + 4, s.rem_tick);
+    p[6] = s.kid_room;
+    p[7] = s.kid_x;
+    p[8] = s.kid_y;
+    p[9] = s.kid_dir;
+    p[10] = s.kid_frame;
+    p[11] = s.kid_action;
+    p[12] = (uint8_t)s.kid_alive;
+    p[13] = s.kid_hp;
+    p[14] = s.kid_max_hp;
+    p[15] = s.guard_room;
+    p[16] = s.guard_x;
+    p[17] = s.guard_y;
+    p[18] = s.guard_dir;
+    p[19] = s.guard_hp;
+    reply(c, SERIAL_CMD_OK, p, sizeof(p));
+}
+
+static void dispatch(serial_cmd_t *c, uint32_t now_ms) {
+    const serial_cmd_host_t *h = c->host;
+    switch (c->type) {
+        case SERIAL_CMD_PING: {
+            uint8_t p[5];
+            p[0] = SERIAL_CMD_VERSION;
+            put32(p + 1, now_ms);
+            reply(c, SERIAL_CMD_OK, p, sizeof(p));
+            break;
+        }
+        case SERIAL_CMD_KEY:
+            cmd_key(c, now_ms);
+            break;
+        case SERIAL_CMD_SCREEN:
+            cmd_screen(c);
+            break;
+        case SERIAL_CMD_STATE:
+            cmd_state(c);
+            break;
+        case SERIAL_CMD_LEVEL:
+            if (c->len != 1) {
+                reply(c, SERIAL_CMD_BAD_LENGTH, NULL, 0);
+            } else {
+                const bool ok = h->request_level && h->request_level(h->ctx, c->payload[0]);
+                reply(c, ok ? SERIAL_CMD_OK : SERIAL_CMD_REFUSED, NULL, 0);
+            }
+            break;
+        default:
+            reply(c, SERIAL_CMD_UNKNOWN, NULL, 0);
+            break;
+    }
+}
+
+void serial_cmd_feed(serial_cmd_t *c, const uint8_t *data, size_t len, uint32_t now_ms) {
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t b = data[i];
+        switch (c->state) {
+            case RX_SYNC0:
+                if (b == SERIAL_CMD_SYNC0) c->state = RX_SYNC1;
+                break;
+            case RX_SYNC1:
+                // A5 A5 5A: the second A5 may be the real start.
+                c->state = (b == SERIAL_CMD_SYNC1) ? RX_TYPE : (b == SERIAL_CMD_SYNC0 ? RX_SYNC1 : RX_SYNC0);
+                break;
+            case RX_TYPE:
+                c->type = b;
+                c->crc = serial_cmd_crc16(0xFFFF, &b, 1);
+                c->state = RX_SEQ;
+                break;
+            case RX_SEQ:
+                c->seq = b;
+                c->crc = serial_cmd_crc16(c->crc, &b, 1);
+                c->state = RX_LEN0;
+                break;
+            case RX_LEN0:
+                c->len = b;
+                c->crc = serial_cmd_crc16(c->crc, &b, 1);
+                c->state = RX_LEN1;
+                break;
+            case RX_LEN1:
+                c->len |= (uint16_t)(b << 8);
+                c->crc = serial_cmd_crc16(c->crc, &b, 1);
+                c->pos = 0;
+                if (c->len > SERIAL_CMD_MAX_PAYLOAD) {
+                    // Commands are short; this is noise or a stray reply.
+                    c->oversized++;
+                    c->state = RX_SYNC0;
+                } else {
+                    c->state = c->len ? RX_PAYLOAD : RX_CRC0;
+                }
+                break;
+            case RX_PAYLOAD:
+                c->payload[c->pos++] = b;
+                c->crc = serial_cmd_crc16(c->crc, &b, 1);
+                if (c->pos == c->len) c->state = RX_CRC0;
+                break;
+            case RX_CRC0:
+                c->crc ^= b;
+                c->state = RX_CRC1;
+                break;
+            case RX_CRC1:
+                c->state = RX_SYNC0;
+                if ((c->crc ^ (uint16_t)(b << 8)) != 0) {
+                    c->crc_errors++;
+                    break;
+                }
+                c->frames++;
+                dispatch(c, now_ms);
+                break;
+            default:
+                c->state = RX_SYNC0;
+                break;
+        }
+    }
+}
+
+bool serial_cmd_next_key(serial_cmd_t *c, uint32_t now_ms, int *scancode, bool *down) {
+    if (c->key_head == c->key_tail) return false;
+    const serial_cmd_key_t *k = &c->keys[c->key_tail & KEY_MASK];
+    if ((int32_t)(now_ms - k->at_ms) < 0) return false;
+    *scancode = k->scancode;
+    *down = k->down != 0;
+    c->key_tail++;
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+ * murmprince - serial test commands
+ *
+ * A small binary protocol on the debug console, so a test host can drive
+ * the game: inject key presses at given times, read the screen and the
+ * palette, query the Kid, the guard and the level, and jump to a level.
+ *
+ * Every message in both directions is a frame:
+ *
+ *   A5 5A  type  seq  len(u16 LE)  payload[len]  crc(u16 LE)
+ *
+ * crc is CRC-16/CCITT-FALSE over type, seq, len and payload. Anything that
+ * is not a valid frame (log text, line noise) is skipped. A reply has the
+ * command's type | 0x80 and echoes its seq; its payload starts with a
+ * status byte. Multi-byte fields are little-endian.
+ *
+ *   PING   01  -                       -> 81 status, version, now_ms(u32)
+ *   KEY    02  n x {at_ms(u32), scancode(u16), down(u8)}
+ *                                      -> 82 status, queued(u8)
+ *              at_ms is on the PING clock; 0 = at once. Events are played
+ *              in the order sent, each no earlier than its time.
+ *   SCREEN 03  -                       -> 83 status, width(u16), height(u16)
+ *                                         90 palette: 256 x RGB
+ *                                         91 rows: y(u16), count(u8), pixels
+ *   STATE  04  -                       -> 84 status, serial_game_state_t fields
+ *   LEVEL  05  level(u8)               -> 85 status
+ *
+ * Pure logic: the caller feeds received bytes and supplies the hooks that
+ * send bytes and reach the game, so it runs on a host as well.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERIAL_CMD_VERSION 1
+#define SERIAL_CMD_SYNC0 0xA5
+#define SERIAL_CMD_SYNC1 0x5A
+#define SERIAL_CMD_MAX_PAYLOAD 70  // ten key events
+#define SERIAL_CMD_KEY_QUEUE 64    // power of two
+#define SERIAL_CMD_KEY_SIZE 7
+#define SERIAL_CMD_SCREEN_ROWS 16  // rows per 91 frame
+
+typedef enum {
+    SERIAL_CMD_PING = 0x01,
+    SERIAL_CMD_KEY = 0x02,
+    SERIAL_CMD_SCREEN = 0x03,
+    SERIAL_CMD_STATE = 0x04,
+    SERIAL_CMD_LEVEL = 0x05,
+    SERIAL_CMD_REPLY = 0x80,
+    SERIAL_CMD_PALETTE = 0x90,
+    SERIAL_CMD_ROWS = 0x91,
+} serial_cmd_type_t;
+
+typedef enum {
+    SERIAL_CMD_OK = 0,
+    SERIAL_CMD_BAD_LENGTH,
+    SERIAL_CMD_UNKNOWN,
+    SERIAL_CMD_QUEUE_FULL,     // some key events were not queued
+    SERIAL_CMD_REFUSED,        // the game cannot do it now
+} serial_cmd_status_t;
+
+// What STATE reports; sent field by field in this order.
+typedef struct {
+    uint8_t level;             // current level, 0 = demo
+    uint8_t room;              // room on screen
+    uint16_t rem_min;          // minutes left
+    uint16_t rem_tick;
+    uint8_t kid_room, kid_x, kid_y, kid_dir;  // dir: 0 right, 0xFF left
+    uint8_t kid_frame, kid_action;
+    int8_t kid_alive;          // < 0 alive
+    uint8_t kid_hp, kid_max_hp;
+    uint8_t guard_room, guard_x, guard_y, guard_dir;
+    uint8_t guard_hp;          // 0 without a guard in the room
+} serial_game_state_t;
+
+#define SERIAL_CMD_STATE_SIZE 20
+
+typedef struct {
+    void *ctx;
+    // Send bytes. A frame may come in several calls; nothing else is sent
+    // in between.
+    void (*write)(void *ctx, const uint8_t *data, size_t len);
+    // Fill in the game state; false when no level is being played.
+    bool (*game_state)(void *ctx, serial_game_state_t *state);
+    // Ask the game to go to a level; false if it will not.
+    bool (*request_level)(void *ctx, int level);
+    // The 8-bit screen, or NULL.
+    const uint8_t *(*screen)(void *ctx, int *width, int *height);
+    uint32_t (*palette)(void *ctx, uint8_t index);  // RGB888
+} serial_cmd_host_t;
+
+typedef struct {
+    uint32_t at_ms;
+    uint16_t scancode;
+    uint8_t down;
+} serial_cmd_key_t;
+
+typedef struct {
+    const serial_cmd_host_t *host;
+
+    // Frame being received.
+    uint8_t state;
+    uint8_t type, seq;
+    uint16_t len, pos;
+    uint16_t crc;
+    uint8_t payload[SERIAL_CMD_MAX_PAYLOAD];
+
+    serial_cmd_key_t keys[SERIAL_CMD_KEY_QUEUE];
+    uint32_t key_head, key_tail;
+
+    uint32_t frames;           // valid frames received
+    uint32_t crc_errors;
+    uint32_t oversized;        // frames longer than SERIAL_CMD_MAX_PAYLOAD
+} serial_cmd_t;
+
+void serial_cmd_init(serial_cmd_t *c, const serial_cmd_host_t *host);
+
+// Received bytes; complete commands are answered through the hooks.
+void serial_cmd_feed(serial_cmd_t *c, const uint8_t *data, size_t len, uint32_t now_ms);
+
+// Next injected key event that is due; false if none (yet).
+bool serial_cmd_next_key(serial_cmd_t *c, uint32_t now_ms, int *scancode, bool *down);
+
+uint16_t serial_cmd_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+// Encode a whole frame into buf (for hosts and tests). Returns its length,
+// or 0 if buf is too small.
+size_t serial_cmd_encode(uint8_t *buf, size_t size, uint8_t type, uint8_t seq,
+                         const void *payload, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
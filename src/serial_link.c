@@ -0,0 +1,146 @@
+/*
+ * murmprince - serial test link
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "serial_link.h"
+#include "HDMI.h"
+#include "crash_guard.h"
+#include "log_sink.h"
+
+#include "pico/stdlib.h"
+
+#ifndef RP2350_SERIAL_CMDS
+#define RP2350_SERIAL_CMDS 0
+#endif
+#ifndef RP2350_LOG_SINK
+#define RP2350_LOG_SINK LOG_SINK_OFF
+#endif
+
+#if RP2350_SERIAL_CMDS && RP2350_LOG_SINK == LOG_SINK_UART
+#define SERIAL_LINK_UART 1
+#elif RP2350_SERIAL_CMDS && !defined(USB_HID_ENABLED)
+#define SERIAL_LINK_USB 1
+#include "pico/stdio_usb.h"
+#endif
+
+#if defined(SERIAL_LINK_UART) || defined(SERIAL_LINK_USB)
+
+extern uint8_t *graphics_buffer;
+
+// Bytes read per poll: a command or two, so a flood cannot stall a frame.
+#define SERIAL_LINK_READ_MAX 128
+
+static serial_cmd_t link_cmd;
+static bool link_ready;
+static volatile int link_level = -1;
+
+static uint32_t link_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void link_write(void *ctx, const uint8_t *data, size_t len) {
+    (void)ctx;
+    // A screen dump holds the game loop for seconds on the UART.
+    crash_guard_feed();
+#ifdef SERIAL_LINK_UART
+    log_sink_uart_write(data, len);
+#else
+    // Straight to the driver: stdio would turn 0x0A into CR LF.
+    stdio_usb.out_chars((const char *)data, (int)len);
+#endif
+}
+
+static bool link_read(uint8_t *c) {
+#ifdef SERIAL_LINK_UART
+    return log_sink_uart_getc(c);
+#else
+    return stdio_usb.in_chars((char *)c, 1) == 1;
+#endif
+}
+
+static bool link_game_state(void *ctx, serial_game_state_t *state) {
+    (void)ctx;
+    return sdlpop_serial_state(state);
+}
+
+static bool link_request_level(void *ctx, int level) {
+    (void)ctx;
+    // The levels Shift+L walks through.
+    if (level < 1 || level > 14) return false;
+    serial_game_state_t state;
+    if (!sdlpop_serial_state(&state)) return false;
+    link_level = level;
+    return true;
+}
+
+static const uint8_t *link_screen(void *ctx, int *width, int *height) {
+    (void)ctx;
+    *width = 320;
+    *height = 240;
+    return graphics_buffer;
+}
+
+static uint32_t link_palette(void *ctx, uint8_t index) {
+    (void)ctx;
+    return graphics_get_palette(index);
+}
+
+static const serial_cmd_host_t link_host = {
+    .write = link_write,
+    .game_state = link_game_state,
+    .request_level = link_request_level,
+    .screen = link_screen,
+    .palette = link_palette,
+};
+
+void serial_link_poll(void) {
+    if (!link_ready) {
+        serial_cmd_init(&link_cmd, &link_host);
+        link_ready = true;
+    }
+    uint8_t buf[SERIAL_LINK_READ_MAX];
+    size_t n = 0;
+    while (n < sizeof(buf) && link_read(&buf[n])) ++n;
+    if (n == 0) return;
+#ifdef SERIAL_LINK_UART
+    // Keep log text out of the replies.
+    log_sink_uart_pause(true);
+    serial_cmd_feed(&link_cmd, buf, n, link_now_ms());
+    log_sink_uart_pause(false);
+#else
+    serial_cmd_feed(&link_cmd, buf, n, link_now_ms());
+#endif
+}
+
+bool serial_link_get_key(int *pressed, int *scancode) {
+    if (!link_ready) return false;
+    bool down;
+    if (!serial_cmd_next_key(&link_cmd, link_now_ms(), scancode, &down)) return false;
+    *pressed = down ? 1 : 0;
+    return true;
+}
+
+int serial_link_take_level(void) {
+    const int level = link_level;
+    link_level = -1;
+    return level;
+}
+
+#else
+
+void serial_link_poll(void) {
+}
+
+bool serial_link_get_key(int *pressed, int *scancode) {
+    (void)pressed;
+    (void)scancode;
+    return false;
+}
+
+int serial_link_take_level(void) {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * murmprince - serial test link
+ *
+ * Runs the serial_cmd.h protocol on the debug console when the build sets
+ * RP2350_SERIAL_CMDS=1: on the log UART when RP2350_LOG_SINK=2 (RX on
+ * RP2350_LOG_UART_RX), otherwise on USB CDC in builds without USB HID.
+ * Frames share the wire with log text; the host skips everything that
+ * is not a frame. Without a transport every call here does nothing.
+ *
+ * Injected keys go through the same path as the keyboards (their own
+ * key_state source, then the key bindings), so scripted runs see exactly
+ * what a player would.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "serial_cmd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read and answer commands. Core 0, once per frame (SDL_PollEvent).
+void serial_link_poll(void);
+
+// Next injected key event that is due; false if none.
+bool serial_link_get_key(int *pressed, int *scancode);
+
+// Level asked for by LEVEL, or -1. Taken by the game loop, once.
+int serial_link_take_level(void);
+
+// Game state for STATE; implemented next to the game (seg000.c).
+bool sdlpop_serial_state(serial_game_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
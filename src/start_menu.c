@@ -0,0 +1,294 @@
+/*
+ * murmprince - start screen menu
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "start_menu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void start_menu_init(start_menu_t *m, int clock_running, int num_clocks) {
+    memset(m, 0, sizeof(*m));
+    m->cursor = START_MENU_ITEM_START;
+    m->levelset = -1;
+    m->music = true;
+    m->clock = clock_running;
+    m->clock_running = clock_running;
+    m->num_clocks = num_clocks;
+    key_bindings_default(&m->bindings);
+}
+
+bool start_menu_add_levelset(start_menu_t *m, const char *name) {
+    if (m->num_levelsets >= START_MENU_MAX_LEVELSETS) return false;
+    if (strlen(name) >= START_MENU_LEVELSET_NAME) return false;
+    strcpy(m->levelsets[m->num_levelsets++], name);
+    return true;
+}
+
+bool start_menu_item_visible(const start_menu_t *m, int item) {
+    switch (item) {
+        case START_MENU_ITEM_START:
+        case START_MENU_ITEM_SLOT:
+            return m->can_start;
+        case START_MENU_ITEM_LEVELSET:
+            return m->num_levelsets > 0;
+        case START_MENU_ITEM_CLOCK:
+            return m->num_clocks > 1;
+        default:
+            return item >= 0 && item < START_MENU_ITEM_COUNT;
+    }
+}
+
+// Next visible item in direction dir (wraps); stays put if none.
+static int start_menu_step(const start_menu_t *m, int from, int dir) {
+    int item = from;
+    for (int i = 0; i < START_MENU_ITEM_COUNT; ++i) {
+        item = (item + dir + START_MENU_ITEM_COUNT) % START_MENU_ITEM_COUNT;
+        if (start_menu_item_visible(m, item)) return item;
+    }
+    return from;
+}
+
+static int start_menu_wrap(int value, int lo, int hi) {
+    if (value < lo) return hi;
+    if (value > hi) return lo;
+    return value;
+}
+
+// Left/right on the selected item.
+static void start_menu_change(start_menu_t *m, int dir) {
+    switch (m->cursor) {
+        case START_MENU_ITEM_SLOT:
+            m->slot = start_menu_wrap(m->slot + dir, 0, SAVE_SLOTS_COUNT - 1);
+            break;
+        case START_MENU_ITEM_LEVEL:
+            m->level = start_menu_wrap(m->level + dir, 0, START_MENU_MAX_LEVEL);
+            break;
+        case START_MENU_ITEM_LEVELSET:
+            m->levelset = start_menu_wrap(m->levelset + dir, -1, m->num_levelsets - 1);
+            break;
+        case START_MENU_ITEM_LIGHTING:
+            m->lighting = !m->lighting;
+            m->lighting_changed = true;
+            break;
+        case START_MENU_ITEM_MUSIC:
+            m->music = !m->music;
+            break;
+        case START_MENU_ITEM_CLOCK:
+            for (int i = 0; i < m->num_clocks; ++i) {
+                m->clock = start_menu_wrap(m->clock + dir, 0, m->num_clocks - 1);
+                if (!(m->clock_skip & (1u << m->clock))) break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+#define START_MENU_KEY_ESCAPE 41 // SDL_SCANCODE_ESCAPE
+
+void start_menu_capture(start_menu_t *m, int scancode) {
+    if (!m->capturing) return;
+    m->capturing = false;
+    if (scancode == START_MENU_KEY_ESCAPE) return;
+    const key_action_t action = (key_action_t)m->binding;
+    if (!key_bindings_bindable(action, scancode)) return;
+    key_bindings_t edited = m->bindings;
+    key_bindings_remove(&edited, -1, scancode);
+    if (!key_bindings_add(&edited, action, scancode)) return; // action full
+    m->bindings = edited;
+    m->bindings_changed = true;
+}
+
+static start_menu_action_t start_menu_controls_key(start_menu_t *m, start_menu_key_t key) {
+    switch (key) {
+        case START_MENU_KEY_UP:
+            m->binding = start_menu_wrap(m->binding - 1, 0, KEY_ACTION_COUNT - 1);
+            break;
+        case START_MENU_KEY_DOWN:
+            m->binding = start_menu_wrap(m->binding + 1, 0, KEY_ACTION_COUNT - 1);
+            break;
+        case START_MENU_KEY_ENTER:
+        case START_MENU_KEY_RIGHT:
+            m->capturing = true;
+            break;
+        case START_MENU_KEY_LEFT:
+            if (key_bindings_remove_last(&m->bindings, (key_action_t)m->binding)) {
+                m->bindings_changed = true;
+            }
+            break;
+        case START_MENU_KEY_BACK:
+            m->controls = false;
+            if (m->bindings_changed) {
+                m->bindings_changed = false;
+                return START_MENU_SAVE_BINDINGS;
+            }
+            break;
+        default:
+            break;
+    }
+    return START_MENU_NONE;
+}
+
+start_menu_action_t start_menu_key(start_menu_t *m, start_menu_key_t key) {
+    if (!start_menu_item_visible(m, m->cursor)) {
+        m->cursor = start_menu_step(m, m->cursor, 1);
+    }
+
+    if (m->controls) {
+        return start_menu_controls_key(m, key);
+    }
+
+    if (m->diagnostics) {
+        // Any of these leaves the diagnostics page.
+        if (key == START_MENU_KEY_ENTER || key == START_MENU_KEY_BACK ||
+            key == START_MENU_KEY_LEFT) {
+            m->diagnostics = false;
+        }
+        return START_MENU_NONE;
+    }
+
+    switch (key) {
+        case START_MENU_KEY_UP:
+            m->cursor = start_menu_step(m, m->cursor, -1);
+            break;
+        case START_MENU_KEY_DOWN:
+            m->cursor = start_menu_step(m, m->cursor, 1);
+            break;
+        case START_MENU_KEY_LEFT:
+            start_menu_change(m, -1);
+            break;
+        case START_MENU_KEY_RIGHT:
+            start_menu_change(m, 1);
+            break;
+        case START_MENU_KEY_ENTER:
+            switch (m->cursor) {
+                case START_MENU_ITEM_START:
+                    m->load = false;
+                    return m->can_start ? START_MENU_START : START_MENU_NONE;
+                case START_MENU_ITEM_SLOT:
+                    if (!m->can_start || m->slots[m->slot].status != SAVE_SLOT_OK) break;
+                    m->load = true;
+                    return START_MENU_LOAD;
+                case START_MENU_ITEM_CLOCK:
+                    return m->clock != m->clock_running ? START_MENU_APPLY_CLOCK : START_MENU_NONE;
+                case START_MENU_ITEM_CONTROLS:
+                    m->controls = true;
+                    m->capturing = false;
+                    m->binding = KEY_ACTION_LEFT;
+                    break;
+                case START_MENU_ITEM_DIAGNOSTICS:
+                    m->diagnostics = true;
+                    break;
+                default:
+                    // Enter on a value item cycles it, like right.
+                    start_menu_change(m, 1);
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+    return START_MENU_NONE;
+}
+
+void start_menu_binding_label(const start_menu_t *m, int action, char *buf, size_t buf_size) {
+    if (buf_size == 0) return;
+    const char *name = key_bindings_action_name((key_action_t)action);
+    int len = snprintf(buf, buf_size, "%c%s:", name[0] - 'a' + 'A', name + 1);
+    const int count = key_bindings_count(&m->bindings, (key_action_t)action);
+    if (count == 0 && len >= 0 && (size_t)len < buf_size) {
+        snprintf(buf + len, buf_size - len, " none");
+    }
+    for (int i = 0; i < count && len >= 0 && (size_t)len < buf_size; ++i) {
+        char key[16];
+        key_bindings_key_name(m->bindings.keys[action][i], key, sizeof(key));
+        len += snprintf(buf + len, buf_size - len, "%s %s", i ? "," : "", key);
+    }
+}
+
+void start_menu_item_label(const start_menu_t *m, int item, unsigned clock_mhz,
+                           char *buf, size_t buf_size) {
+    switch (item) {
+        case START_MENU_ITEM_START:
+            snprintf(buf, buf_size, "Start game");
+            break;
+        case START_MENU_ITEM_SLOT: {
+            const save_slot_t *s = &m->slots[m->slot];
+            if (s->status == SAVE_SLOT_EMPTY) {
+                snprintf(buf, buf_size, "Slot %d: empty", m->slot + 1);
+            } else if (s->status != SAVE_SLOT_OK) {
+                snprintf(buf, buf_size, "Slot %d: damaged", m->slot + 1);
+            } else if (s->levelset[0]) {
+                snprintf(buf, buf_size, "Slot %d: level %u, %u min (%.14s)", m->slot + 1,
+                         (unsigned)s->level, (unsigned)s->rem_min, s->levelset);
+            } else {
+                snprintf(buf, buf_size, "Slot %d: level %u, %u min", m->slot + 1,
+                         (unsigned)s->level, (unsigned)s->rem_min);
+            }
+            break;
+        }
+        case START_MENU_ITEM_LEVEL:
+            if (m->level == 0) snprintf(buf, buf_size, "Level: default");
+            else snprintf(buf, buf_size, "Level: %d", m->level);
+            break;
+        case START_MENU_ITEM_LEVELSET:
+            snprintf(buf, buf_size, "Levels: %s",
+                     m->levelset < 0 ? "original" : m->levelsets[m->levelset]);
+            break;
+        case START_MENU_ITEM_LIGHTING:
+            snprintf(buf, buf_size, "Lighting: %s", m->lighting ? "on" : "off");
+            break;
+        case START_MENU_ITEM_MUSIC:
+            snprintf(buf, buf_size, "Music: %s", m->music ? "on" : "off");
+            break;
+        case START_MENU_ITEM_CLOCK:
+            if (m->clock == m->clock_running) snprintf(buf, buf_size, "CPU clock: %u MHz", clock_mhz);
+            else snprintf(buf, buf_size, "CPU clock: %u MHz (Enter to test)", clock_mhz);
+            break;
+        case START_MENU_ITEM_CONTROLS:
+            snprintf(buf, buf_size, "Controls");
+            break;
+        case START_MENU_ITEM_DIAGNOSTICS:
+            snprintf(buf, buf_size, "Diagnostics");
+            break;
+        default:
+            if (buf_size) buf[0] = '\0';
+            break;
+    }
+}
+
+int start_menu_build_args(const start_menu_t *m, char *argv[], int max_args,
+                          char *buf, size_t buf_size) {
+    int argc = 0;
+#define START_MENU_ARG(s) do { if (argc < max_args - 1) argv[argc++] = (char *)(s); } while (0)
+    START_MENU_ARG("prince");
+    // A loaded save brings its own levelset and level.
+    const char *levelset = NULL;
+    if (m->load) {
+        if (m->slots[m->slot].levelset[0]) levelset = m->slots[m->slot].levelset;
+    } else if (m->levelset >= 0) {
+        levelset = m->levelsets[m->levelset];
+    }
+    if (levelset && argc + 2 < max_args) {
+        START_MENU_ARG("mod");
+        START_MENU_ARG(levelset);
+    }
+    // Numeric arguments are packed one after another into buf.
+    int n = snprintf(buf, buf_size, "slot=%d", m->slot + 1) + 1;
+    START_MENU_ARG(buf);
+    if (m->load) {
+        START_MENU_ARG("loadslot");
+    } else if (m->level > 0 && (size_t)n < buf_size) {
+        snprintf(buf + n, buf_size - n, "level=%d", m->level);
+        START_MENU_ARG(buf + n);
+    }
+    // Unchanged: SDLPoP.ini decides
+    if (m->lighting_changed) START_MENU_ARG(m->lighting ? "lighting=1" : "lighting=0");
+    START_MENU_ARG(m->music ? "music=1" : "music=0");
+#undef START_MENU_ARG
+    argv[argc] = NULL;
+    return argc;
+}
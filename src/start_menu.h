@@ -0,0 +1,129 @@
+/*
+ * murmprince - start screen menu
+ *
+ * Menu state and key handling for the start screen: save slot, start level,
+ * levelset, lighting, music, CPU clock profile, key bindings and a
+ * diagnostics page. Pure logic (no drawing, no hardware): start_screen.c
+ * feeds it keys and renders the labels, so it also builds on a host and can
+ * be driven by scripted keys.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "key_bindings.h"
+#include "save_slots.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define START_MENU_MAX_LEVELSETS 16
+#define START_MENU_LEVELSET_NAME 32
+#define START_MENU_MAX_LEVEL 14  // level 0 is the demo, 15 the potions level
+
+typedef enum {
+    START_MENU_KEY_NONE = 0,
+    START_MENU_KEY_UP,
+    START_MENU_KEY_DOWN,
+    START_MENU_KEY_LEFT,
+    START_MENU_KEY_RIGHT,
+    START_MENU_KEY_ENTER,
+    START_MENU_KEY_BACK,
+} start_menu_key_t;
+
+typedef enum {
+    START_MENU_ITEM_START = 0,
+    START_MENU_ITEM_SLOT,
+    START_MENU_ITEM_LEVEL,
+    START_MENU_ITEM_LEVELSET,
+    START_MENU_ITEM_LIGHTING,
+    START_MENU_ITEM_MUSIC,
+    START_MENU_ITEM_CLOCK,
+    START_MENU_ITEM_CONTROLS,
+    START_MENU_ITEM_DIAGNOSTICS,
+    START_MENU_ITEM_COUNT
+} start_menu_item_t;
+
+typedef enum {
+    START_MENU_NONE = 0,       // nothing for the caller to do
+    START_MENU_START,          // launch the game with start_menu_build_args()
+    START_MENU_LOAD,           // the same, continuing from the selected slot
+    START_MENU_APPLY_CLOCK,    // reboot into a trial of the selected clock profile
+    START_MENU_SAVE_BINDINGS,  // controls page left with changes: store m->bindings
+} start_menu_action_t;
+
+typedef struct {
+    int cursor;                // selected item
+    bool diagnostics;          // diagnostics page shown instead of the menu
+    bool controls;             // key bindings page shown instead of the menu
+    bool can_start;            // SD card and game data present
+    bool load;                 // last launch continues from the slot
+
+    int slot;                  // save slot for the game, 0-based
+    save_slot_t slots[SAVE_SLOTS_COUNT]; // contents, for the labels
+
+    int level;                 // 0 = game default, else 1..START_MENU_MAX_LEVEL
+    int levelset;              // -1 = original levels, else index into names
+    int num_levelsets;
+    char levelsets[START_MENU_MAX_LEVELSETS][START_MENU_LEVELSET_NAME];
+    bool lighting;             // as in SDLPoP.ini until changed here
+    bool lighting_changed;     // only then does the game get "lighting="
+    bool music;
+
+    int clock;                 // selected clock profile index
+    int clock_running;         // profile the system runs at
+    int num_clocks;            // 0 hides the item (e.g. safe mode)
+    uint32_t clock_skip;       // bit per profile that must not be offered
+
+    key_bindings_t bindings;   // edited on the controls page
+    int binding;               // selected action there
+    bool capturing;            // waiting for the key to bind to it
+    bool bindings_changed;
+} start_menu_t;
+
+// Defaults: cursor on "Start", game default level, original levels,
+// lighting off (the caller may show SDLPoP.ini's), music on, clock = running profile.
+void start_menu_init(start_menu_t *m, int clock_running, int num_clocks);
+
+// Register a levelset (mod directory name). Returns false when full or the
+// name does not fit.
+bool start_menu_add_levelset(start_menu_t *m, const char *name);
+
+start_menu_action_t start_menu_key(start_menu_t *m, start_menu_key_t key);
+
+// Controls page: Up/Down pick an action, Enter waits for a key, Left drops
+// the action's last key, Back leaves. While m->capturing the caller hands
+// the next pressed key (SDL scancode) here instead of to start_menu_key():
+// it is bound to the selected action and taken off any other one, so edits
+// never create conflicts. Esc cancels the capture; Ctrl and Alt are ignored
+// (key_bindings_bindable).
+void start_menu_capture(start_menu_t *m, int scancode);
+
+// Whether an item is shown (and reachable with up/down).
+bool start_menu_item_visible(const start_menu_t *m, int item);
+
+// Line for an action on the controls page, e.g. "Left: Left, A".
+void start_menu_binding_label(const start_menu_t *m, int action, char *buf, size_t buf_size);
+
+// Label for an item, e.g. "Level: 3" or "Music: on". clock_mhz gives the
+// CPU clock of the selected profile for the clock item.
+void start_menu_item_label(const start_menu_t *m, int item, unsigned clock_mhz,
+                           char *buf, size_t buf_size);
+
+// Fill argv for sdlpop_entry() ("prince", then "mod <name>", "level=N",
+// "slot=N", "lighting=0|1" if changed, "music=0|1" as chosen; after START_MENU_LOAD
+// "loadslot" and the slot's levelset instead of level and levelset).
+// Strings point into m, into buf (numeric arguments) or into static
+// literals. Returns argc (at most max_args - 1; argv is NULL-terminated).
+int start_menu_build_args(const start_menu_t *m, char *argv[], int max_args,
+                          char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
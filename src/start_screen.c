@@ -5,15 +5,24 @@
  */
 
 #include "start_screen.h"
+#include "font_5x7.h"
 #include "board_config.h"
 #include "HDMI.h"
 #include "pop_fs.h"
 #include "ps2kbd/ps2kbd_wrapper.h"
+#include "crash_guard.h"
+#include "clock_select.h"
+#include "start_menu.h"
+#include "key_bindings.h"
+#include "log_sink.h"
+#include "save_slots.h"
+#include "psram_allocator.h"
 #include "hardware/clocks.h"
 #include "pico/stdlib.h"
 
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 
 #include "ff.h"  // Direct FatFS access
 
@@ -31,6 +40,10 @@ extern uint8_t *graphics_buffer;
 // Local back buffer to avoid flicker (draw here, then copy to graphics_buffer)
 static uint8_t back_buffer[SCREEN_W * SCREEN_H];
 
+// Where fill_rect/draw_text_5x7 draw (the SD prompt draws straight onto the
+// game frame and parks a copy of it in back_buffer).
+static uint8_t *draw_target = back_buffer;
+
 // Version from build system
 #ifndef MURMPRINCE_VERSION
 #define MURMPRINCE_VERSION "?"
@@ -49,171 +62,12 @@ static void fill_rect(int x, int y, int w, int h, uint8_t color) {
     if (w <= 0 || h <= 0) return;
 
     for (int yy = y; yy < y + h; ++yy) {
-        memset(&back_buffer[yy * SCREEN_W + x], color, (size_t)w);
-    }
-}
-
-// ============================================================================
-// 5x7 Font Glyphs (copied from murmdoom doomgeneric_rp2350.c)
-// ============================================================================
-
-static const uint8_t *glyph_5x7(char ch) {
-    static const uint8_t glyph_space[7] = {0, 0, 0, 0, 0, 0, 0};
-    static const uint8_t glyph_dot[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C};
-    static const uint8_t glyph_comma[7] = {0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x08};
-    static const uint8_t glyph_colon[7] = {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00};
-    static const uint8_t glyph_hyphen[7] = {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00};
-    static const uint8_t glyph_lparen[7] = {0x04, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04};
-    static const uint8_t glyph_rparen[7] = {0x04, 0x02, 0x02, 0x02, 0x02, 0x02, 0x04};
-    static const uint8_t glyph_slash[7] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00};
-
-    static const uint8_t glyph_0[7] = {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E};
-    static const uint8_t glyph_1[7] = {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E};
-    static const uint8_t glyph_2[7] = {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F};
-    static const uint8_t glyph_3[7] = {0x1E, 0x01, 0x01, 0x0E, 0x01, 0x01, 0x1E};
-    static const uint8_t glyph_4[7] = {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02};
-    static const uint8_t glyph_5[7] = {0x1F, 0x10, 0x10, 0x1E, 0x01, 0x01, 0x1E};
-    static const uint8_t glyph_6[7] = {0x0E, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_7[7] = {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08};
-    static const uint8_t glyph_8[7] = {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_9[7] = {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x0E};
-
-    static const uint8_t glyph_a[7] = {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F};
-    static const uint8_t glyph_b[7] = {0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x1E};
-    static const uint8_t glyph_c[7] = {0x00, 0x00, 0x0E, 0x11, 0x10, 0x11, 0x0E};
-    static const uint8_t glyph_d[7] = {0x01, 0x01, 0x0D, 0x13, 0x11, 0x13, 0x0D};
-    static const uint8_t glyph_e[7] = {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0F};
-    static const uint8_t glyph_f[7] = {0x06, 0x08, 0x1E, 0x08, 0x08, 0x08, 0x08};
-    static const uint8_t glyph_g[7] = {0x00, 0x00, 0x0F, 0x11, 0x0F, 0x01, 0x0E};
-    static const uint8_t glyph_h[7] = {0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_i[7] = {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E};
-    static const uint8_t glyph_j[7] = {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C};
-    static const uint8_t glyph_k[7] = {0x10, 0x10, 0x11, 0x12, 0x1C, 0x12, 0x11};
-    static const uint8_t glyph_l[7] = {0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x06};
-    static const uint8_t glyph_m[7] = {0x00, 0x00, 0x1A, 0x15, 0x15, 0x15, 0x15};
-    static const uint8_t glyph_n[7] = {0x00, 0x00, 0x1E, 0x11, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_o[7] = {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_p[7] = {0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10};
-    static const uint8_t glyph_q[7] = {0x00, 0x00, 0x0D, 0x13, 0x13, 0x0D, 0x01};
-    static const uint8_t glyph_r[7] = {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10};
-    static const uint8_t glyph_s[7] = {0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E};
-    static const uint8_t glyph_t[7] = {0x04, 0x04, 0x1F, 0x04, 0x04, 0x04, 0x03};
-    static const uint8_t glyph_u[7] = {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D};
-    static const uint8_t glyph_v[7] = {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04};
-    static const uint8_t glyph_w[7] = {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A};
-    static const uint8_t glyph_x[7] = {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11};
-    static const uint8_t glyph_y[7] = {0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E};
-    static const uint8_t glyph_z[7] = {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F};
-
-    static const uint8_t glyph_A[7] = {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_B[7] = {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E};
-    static const uint8_t glyph_C[7] = {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E};
-    static const uint8_t glyph_D[7] = {0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E};
-    static const uint8_t glyph_E[7] = {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F};
-    static const uint8_t glyph_F[7] = {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10};
-    static const uint8_t glyph_G[7] = {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_H[7] = {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_I[7] = {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x1F};
-    static const uint8_t glyph_J[7] = {0x07, 0x02, 0x02, 0x02, 0x12, 0x12, 0x0C};
-    static const uint8_t glyph_K[7] = {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11};
-    static const uint8_t glyph_L[7] = {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F};
-    static const uint8_t glyph_M[7] = {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_N[7] = {0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x11};
-    static const uint8_t glyph_O[7] = {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_P[7] = {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10};
-    static const uint8_t glyph_Q[7] = {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D};
-    static const uint8_t glyph_R[7] = {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11};
-    static const uint8_t glyph_S[7] = {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E};
-    static const uint8_t glyph_T[7] = {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04};
-    static const uint8_t glyph_U[7] = {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E};
-    static const uint8_t glyph_V[7] = {0x11, 0x11, 0x11, 0x11, 0x0A, 0x0A, 0x04};
-    static const uint8_t glyph_W[7] = {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A};
-    static const uint8_t glyph_X[7] = {0x11, 0x0A, 0x04, 0x04, 0x04, 0x0A, 0x11};
-    static const uint8_t glyph_Y[7] = {0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x04};
-    static const uint8_t glyph_Z[7] = {0x1F, 0x02, 0x04, 0x08, 0x10, 0x10, 0x1F};
-
-    int c = (unsigned char)ch;
-    switch (c) {
-        case ' ': return glyph_space;
-        case '.': return glyph_dot;
-        case ',': return glyph_comma;
-        case ':': return glyph_colon;
-        case '-': return glyph_hyphen;
-        case '(': return glyph_lparen;
-        case ')': return glyph_rparen;
-        case '/': return glyph_slash;
-
-        case '0': return glyph_0;
-        case '1': return glyph_1;
-        case '2': return glyph_2;
-        case '3': return glyph_3;
-        case '4': return glyph_4;
-        case '5': return glyph_5;
-        case '6': return glyph_6;
-        case '7': return glyph_7;
-        case '8': return glyph_8;
-        case '9': return glyph_9;
-
-        case 'a': return glyph_a;
-        case 'b': return glyph_b;
-        case 'c': return glyph_c;
-        case 'd': return glyph_d;
-        case 'e': return glyph_e;
-        case 'f': return glyph_f;
-        case 'g': return glyph_g;
-        case 'h': return glyph_h;
-        case 'i': return glyph_i;
-        case 'j': return glyph_j;
-        case 'k': return glyph_k;
-        case 'l': return glyph_l;
-        case 'm': return glyph_m;
-        case 'n': return glyph_n;
-        case 'o': return glyph_o;
-        case 'p': return glyph_p;
-        case 'q': return glyph_q;
-        case 'r': return glyph_r;
-        case 's': return glyph_s;
-        case 't': return glyph_t;
-        case 'u': return glyph_u;
-        case 'v': return glyph_v;
-        case 'w': return glyph_w;
-        case 'x': return glyph_x;
-        case 'y': return glyph_y;
-        case 'z': return glyph_z;
-
-        case 'A': return glyph_A;
-        case 'B': return glyph_B;
-        case 'C': return glyph_C;
-        case 'D': return glyph_D;
-        case 'E': return glyph_E;
-        case 'F': return glyph_F;
-        case 'G': return glyph_G;
-        case 'H': return glyph_H;
-        case 'I': return glyph_I;
-        case 'J': return glyph_J;
-        case 'K': return glyph_K;
-        case 'L': return glyph_L;
-        case 'M': return glyph_M;
-        case 'N': return glyph_N;
-        case 'O': return glyph_O;
-        case 'P': return glyph_P;
-        case 'Q': return glyph_Q;
-        case 'R': return glyph_R;
-        case 'S': return glyph_S;
-        case 'T': return glyph_T;
-        case 'U': return glyph_U;
-        case 'V': return glyph_V;
-        case 'W': return glyph_W;
-        case 'X': return glyph_X;
-        case 'Y': return glyph_Y;
-        case 'Z': return glyph_Z;
-
-        default: return glyph_space;
+        memset(&draw_target[yy * SCREEN_W + x], color, (size_t)w);
     }
 }
 
 static void draw_char_5x7(int x, int y, char ch, uint8_t color) {
-    const uint8_t *rows = glyph_5x7(ch);
+    const uint8_t *rows = font_5x7_glyph(ch);
     for (int row = 0; row < 7; ++row) {
         int yy = y + row;
         if (yy < 0 || yy >= SCREEN_H) continue;
@@ -222,7 +76,7 @@ static void draw_char_5x7(int x, int y, char ch, uint8_t color) {
             int xx = x + col;
             if (xx < 0 || xx >= SCREEN_W) continue;
             if (bits & (1u << (4 - col))) {
-                back_buffer[yy * SCREEN_W + xx] = color;
+                draw_target[yy * SCREEN_W + xx] = color;
             }
         }
     }
@@ -308,7 +162,14 @@ static void draw_animated_background_border(uint32_t t_ms,
 // Poll for Any Keypress
 // ============================================================================
 
-static bool poll_any_key(void) {
+// How often a missing card / data directory is looked for again.
+#define START_RECHECK_MS 1000
+
+// SDL scancode of the safe-mode key offered after a crash.
+#define START_KEY_SAFE_MODE 22  // SDL_SCANCODE_S
+
+// Returns the SDL scancode of a newly pressed key, or -1 if none.
+static int poll_any_key(void) {
     // Poll PS/2 keyboard
     ps2kbd_tick();
     
@@ -318,7 +179,7 @@ static bool poll_any_key(void) {
     int modifier;
     if (ps2kbd_get_key(&pressed, &scancode, &modifier)) {
         if (pressed) {
-            return true;
+            return scancode;
         }
     }
     
@@ -328,35 +189,311 @@ static bool poll_any_key(void) {
     int usb_pressed, usb_scancode, usb_modifier;
     if (usbhid_sdl_get_key(&usb_pressed, &usb_scancode, &usb_modifier)) {
         if (usb_pressed) {
-            return true;
+            return usb_scancode;
         }
     }
 #endif
     
-    return false;
+    return -1;
+}
+
+// ============================================================================
+// Menu
+// ============================================================================
+
+// Levelsets are the directories in the SDLPoP mods folder.
+#define START_MODS_DIR "mods"
+
+static start_menu_t g_menu;
+static bool g_menu_ready = false;
+static bool g_lighting_read = false;
+static char g_arg_buf[32];
+
+// SDLPoP's INI parser (options.c)
+extern int ini_load(const char *filename,
+                    int (*report)(const char *section, const char *name, const char *value));
+
+static int lighting_ini_callback(const char *section, const char *name, const char *value) {
+    if (strcasecmp(section, "AdditionalFeatures") == 0 && strcasecmp(name, "enable_lighting") == 0) {
+        g_menu.lighting = strcasecmp(value, "true") == 0;
+    }
+    return 0;
+}
+
+static start_menu_key_t menu_key_from_scancode(int scancode) {
+    switch (scancode) {
+        case 82: return START_MENU_KEY_UP;       // SDL_SCANCODE_UP
+        case 81: return START_MENU_KEY_DOWN;     // SDL_SCANCODE_DOWN
+        case 80: return START_MENU_KEY_LEFT;     // SDL_SCANCODE_LEFT
+        case 79: return START_MENU_KEY_RIGHT;    // SDL_SCANCODE_RIGHT
+        case 40:                                 // SDL_SCANCODE_RETURN
+        case 88:                                 // SDL_SCANCODE_KP_ENTER
+        case 44: return START_MENU_KEY_ENTER;    // SDL_SCANCODE_SPACE
+        case 41:                                 // SDL_SCANCODE_ESCAPE
+        case 42: return START_MENU_KEY_BACK;     // SDL_SCANCODE_BACKSPACE
+        default: return START_MENU_KEY_NONE;
+    }
+}
+
+// (Re)build the menu for this visit: first time defaults, then keep the
+// choices and rescan the levelsets and save slots (the card may have changed).
+static void start_menu_refresh(bool can_start) {
+    const int running = clock_select_current();
+    const bool first = !g_menu_ready;
+    if (first) {
+        // Safe mode pins the build default clock: no selector.
+        start_menu_init(&g_menu, running, crash_guard_safe_mode() ? 0 : CLOCK_PROFILE_COUNT);
+        g_menu_ready = true;
+    }
+    // Show SDLPoP.ini's lighting until the user changes it here; the game
+    // only gets "lighting=" after that.
+    if (can_start && !g_lighting_read && !g_menu.lighting_changed) {
+        ini_load("SDLPoP.ini", lighting_ini_callback);
+        g_lighting_read = true;
+    }
+    g_menu.can_start = can_start;
+    g_menu.diagnostics = false;
+    g_menu.controls = false;
+    g_menu.capturing = false;
+    g_menu.clock = g_menu.clock_running = running;
+
+    // Profiles that failed their trial are skipped by clock_select_next().
+    g_menu.clock_skip = 0;
+    for (int i = 0; i < CLOCK_PROFILE_COUNT; ++i) g_menu.clock_skip |= 1u << i;
+    uint8_t id = (uint8_t)running;
+    for (int i = 0; i < CLOCK_PROFILE_COUNT; ++i) {
+        g_menu.clock_skip &= ~(1u << id);
+        id = clock_select_next(id);
+    }
+
+    char selected[START_MENU_LEVELSET_NAME] = "";
+    if (g_menu.levelset >= 0) strcpy(selected, g_menu.levelsets[g_menu.levelset]);
+    g_menu.num_levelsets = 0;
+    g_menu.levelset = -1;
+    if (!can_start) return;
+
+    // KEYS.CFG may have been edited on another machine.
+    key_bindings_load(key_bindings_active());
+    g_menu.bindings = *key_bindings_active();
+    g_menu.bindings_changed = false;
+
+    DIR dir;
+    FILINFO fno;
+    if (f_opendir(&dir, START_MODS_DIR) == FR_OK) {
+        while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0]) {
+            if (!(fno.fattrib & AM_DIR) || fno.fname[0] == '.') continue;
+            // SDLPoP's check_param() ignores arguments containing a dot.
+            if (strchr(fno.fname, '.')) continue;
+            if (!start_menu_add_levelset(&g_menu, fno.fname)) continue;
+            if (strcmp(fno.fname, selected) == 0) g_menu.levelset = g_menu.num_levelsets - 1;
+        }
+        f_closedir(&dir);
+    }
+
+    // PRINCE.SAV from earlier firmware moves into a slot.
+    save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, "");
+    for (int i = 0; i < g_menu.num_levelsets; ++i) {
+        char path[64];
+        snprintf(path, sizeof(path), START_MODS_DIR "/%s/" SAVE_SLOTS_LEGACY_FILE, g_menu.levelsets[i]);
+        save_slots_import_legacy(path, g_menu.levelsets[i]);
+    }
+
+    // The game may have saved since the last visit. First visit: offer the
+    // most recent save.
+    save_slots_read_all(g_menu.slots);
+    if (first) {
+        const int latest = save_slots_latest(g_menu.slots);
+        if (latest >= 0) g_menu.slot = latest;
+    }
+}
+
+static void draw_menu(int y) {
+    char label[48];
+    for (int item = 0; item < START_MENU_ITEM_COUNT; ++item) {
+        if (!start_menu_item_visible(&g_menu, item)) continue;
+        const unsigned mhz = clock_profile_get((uint8_t)g_menu.clock)->cpu_mhz;
+        start_menu_item_label(&g_menu, item, mhz, label, sizeof(label));
+        const int w = text_width_5x7(label);
+        const int x = (SCREEN_W - w) / 2;
+        if (item == g_menu.cursor) {
+            fill_rect(x - 3, y - 1, w + 6, 7 + 2, 18);
+            draw_text_5x7(x, y, label, 21);
+        } else {
+            draw_text_5x7(x, y, label, 1);
+        }
+        y += 8;
+    }
+}
+
+// Controls page: one line per action, the selected one highlighted.
+static void draw_controls(int y) {
+    char label[48];
+    for (int action = 0; action < KEY_ACTION_COUNT; ++action) {
+        start_menu_binding_label(&g_menu, action, label, sizeof(label));
+        const int w = text_width_5x7(label);
+        const int x = (SCREEN_W - w) / 2;
+        if (action == g_menu.binding) {
+            fill_rect(x - 3, y - 2, w + 6, 7 + 3, 18);
+            draw_text_5x7(x, y, label, 21);
+        } else {
+            draw_text_5x7(x, y, label, 1);
+        }
+        y += 9;
+    }
+}
+
+// Line above the controls page: what to do, or what is wrong.
+static void controls_hint(char *buf, size_t buf_size, uint8_t *color) {
+    int scancode, a, b;
+    *color = 1;
+    if (g_menu.capturing) {
+        snprintf(buf, buf_size, "Press a key for %s (Esc: cancel)",
+                 key_bindings_action_name((key_action_t)g_menu.binding));
+    } else if (key_bindings_find_conflict(&g_menu.bindings, &scancode, &a, &b)) {
+        char key[16];
+        key_bindings_key_name(scancode, key, sizeof(key));
+        snprintf(buf, buf_size, "%s is bound to %s and %s", key,
+                 key_bindings_action_name((key_action_t)a), key_bindings_action_name((key_action_t)b));
+        *color = 19;
+    } else {
+        snprintf(buf, buf_size, "Enter: add key, Left: remove, Esc: done");
+    }
+}
+
+// Count of rendered MIDI cache files (prince/midi_cache/*.pcm).
+static int count_midi_cache_files(void) {
+    DIR dir;
+    FILINFO fno;
+    int count = 0;
+    if (f_opendir(&dir, "prince/midi_cache") != FR_OK) return 0;
+    while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0]) {
+        const size_t n = strlen(fno.fname);
+        if (!(fno.fattrib & AM_DIR) && n > 4 && strcmp(fno.fname + n - 4, ".pcm") == 0) ++count;
+    }
+    f_closedir(&dir);
+    return count;
+}
+
+static void draw_diagnostics(int y, const char *crash1, const char *crash2) {
+    // Collected once per visit to the page: directory scans are not free.
+    static bool cached = false;
+    static char lines[6][48];
+    if (!g_menu.diagnostics) {
+        cached = false;
+        return;
+    }
+    if (!cached) {
+        snprintf(lines[0], sizeof(lines[0]), "CPU %u MHz, PSRAM %u MHz, CS %u",
+                 clock_select_cpu_mhz(), clock_select_psram_mhz(), (unsigned)get_psram_pin());
+        snprintf(lines[1], sizeof(lines[1]), "PSRAM %u MB, %u KB in use",
+                 (unsigned)(psram_get_size() >> 20), (unsigned)(psram_get_offset() / 1024));
+        pop_fs_info_t info;
+        if (pop_fs_get_info(&info)) {
+            static const char *const fs_names[] = { "?", "FAT12", "FAT16", "FAT32", "exFAT" };
+            snprintf(lines[2], sizeof(lines[2]), "SD: %s %lu MB, %s", info.card_kind,
+                     (unsigned long)info.size_mb, fs_names[info.fs_type <= FS_EXFAT ? info.fs_type : 0]);
+            if (info.free_mb != UINT32_MAX) {
+                snprintf(lines[3], sizeof(lines[3]), "SD free: %lu MB, removals: %lu",
+                         (unsigned long)info.free_mb, (unsigned long)info.removals);
+            } else {
+                snprintf(lines[3], sizeof(lines[3]), "SD removals: %lu", (unsigned long)info.removals);
+            }
+        } else {
+            snprintf(lines[2], sizeof(lines[2]), "SD: not mounted");
+            lines[3][0] = '\0';
+        }
+        snprintf(lines[4], sizeof(lines[4]), "MIDI cache: %d file(s)", count_midi_cache_files());
+        ps2_rx_stats_t kbd;
+        ps2kbd_get_stats(&kbd);
+        snprintf(lines[5], sizeof(lines[5]), "Levelsets: %d, PS/2 errors: %lu", g_menu.num_levelsets,
+                 (unsigned long)(kbd.parity_errors + kbd.framing_errors + kbd.ring_overflows));
+        cached = true;
+    }
+    for (int i = 0; i < 6; ++i, y += 10) {
+        draw_text_5x7((SCREEN_W - text_width_5x7(lines[i])) / 2, y, lines[i], 1);
+    }
+    if (crash1) {
+        draw_text_5x7((SCREEN_W - text_width_5x7(crash1)) / 2, y, crash1, 19);
+        draw_text_5x7((SCREEN_W - text_width_5x7(crash2)) / 2, y + 10, crash2, 1);
+    } else {
+        const char *none = "No crash recorded";
+        draw_text_5x7((SCREEN_W - text_width_5x7(none)) / 2, y, none, 1);
+    }
 }
 
 // ============================================================================
 // Public Functions
 // ============================================================================
 
+int start_screen_game_args(char *argv[], int max_args) {
+    if (!g_menu_ready) {
+        start_menu_init(&g_menu, clock_select_current(), 0);
+        g_menu_ready = true;
+    }
+    return start_menu_build_args(&g_menu, argv, max_args, g_arg_buf, sizeof(g_arg_buf));
+}
+
+void start_screen_sd_prompt(bool show) {
+    // Palette slots borrowed for the box and the text while the prompt is up.
+    enum { PROMPT_BG = 0, PROMPT_FG = 1 };
+    static uint32_t saved_bg, saved_fg;
+    static uint8_t saved_fade;
+    static bool saved_loading;
+
+    if (show) {
+        memcpy(back_buffer, graphics_buffer, SCREEN_W * SCREEN_H);
+        saved_bg = graphics_get_palette(PROMPT_BG);
+        saved_fg = graphics_get_palette(PROMPT_FG);
+        saved_fade = graphics_get_fade_level();
+        saved_loading = graphics_get_loading_mode();
+        // Loading mode / fades would hide the prompt.
+        if (saved_loading) graphics_set_loading_mode(false);
+        if (saved_fade) graphics_set_fade_level(0, 0);
+        graphics_set_palette(PROMPT_BG, 0x000000);
+        graphics_set_palette(PROMPT_FG, 0xFFFFFF);
+
+        const char *line1 = "SD card removed.";
+        const char *line2 = "Reinsert it to continue.";
+        const int box_w = text_width_5x7(line2) + 16;
+        const int box_h = 30;
+        const int box_x = (SCREEN_W - box_w) / 2;
+        const int box_y = (SCREEN_H - box_h) / 2;
+        draw_target = graphics_buffer;
+        fill_rect(box_x - 1, box_y - 1, box_w + 2, box_h + 2, PROMPT_FG);
+        fill_rect(box_x, box_y, box_w, box_h, PROMPT_BG);
+        draw_text_5x7((SCREEN_W - text_width_5x7(line1)) / 2, box_y + 6, line1, PROMPT_FG);
+        draw_text_5x7((SCREEN_W - text_width_5x7(line2)) / 2, box_y + 17, line2, PROMPT_FG);
+        draw_target = back_buffer;
+    } else {
+        memcpy(graphics_buffer, back_buffer, SCREEN_W * SCREEN_H);
+        graphics_set_palette(PROMPT_BG, saved_bg);
+        graphics_set_palette(PROMPT_FG, saved_fg);
+        if (saved_fade) graphics_set_fade_level(saved_fade, 0);
+        if (saved_loading) graphics_set_loading_mode(true);
+    }
+}
+
 start_error_t start_screen_check_requirements(void) {
-    // Small delay to let SD card settle after power-up
-    sleep_ms(100);
-    
-    // Try to init filesystem
+    // Try to init filesystem (normally already mounted by core 1 during boot)
     DBG_PRINTF("[start_screen] Initializing filesystem...\n");
     if (!pop_fs_init()) {
-        DBG_PRINTF("[start_screen] pop_fs_init() FAILED\n");
-        return START_ERROR_NO_SD;
+        // Give a card that was still powering up one more chance
+        sleep_ms(100);
+        if (!pop_fs_init()) {
+            DBG_PRINTF("[start_screen] pop_fs_init() FAILED\n");
+            return START_ERROR_NO_SD;
+        }
     }
     DBG_PRINTF("[start_screen] Filesystem mounted OK\n");
     
+    FILINFO fno;
+    FRESULT fr;
+
+#if MURMPRINCE_DEBUG
     // Debug: list root directory contents
     DBG_PRINTF("[start_screen] Listing root directory:\n");
     DIR dir;
-    FILINFO fno;
-    FRESULT fr = f_opendir(&dir, "/");
+    fr = f_opendir(&dir, "/");
     if (fr != FR_OK) {
         DBG_PRINTF("[start_screen] f_opendir('/') failed: %d\n", (int)fr);
     } else {
@@ -387,6 +524,7 @@ start_error_t start_screen_check_requirements(void) {
         f_closedir(&dir);
         DBG_PRINTF("[start_screen] Found %d entries in prince/\n", count);
     }
+#endif
     
     // Try to find game data files
     // Check for PRINCE.DAT first, but also check for GUARD.DAT (always present)
@@ -496,16 +634,10 @@ void start_screen_show(start_error_t error, const char* error_msg) {
 #else
 #define DBOARD_VARIANT "M1"
 #endif
-#endif
-#ifndef DPSRAM_SPEED
-#define DPSRAM_SPEED PSRAM_MAX_FREQ_MHZ
-#endif
-#ifndef DCPU_SPEED
-#define DCPU_SPEED CPU_CLOCK_MHZ
 #endif
 
     const char *cfg = DBOARD_VARIANT;
-    const uint32_t cpu_mhz = (uint32_t)DCPU_SPEED;
+    const uint32_t cpu_mhz = clock_select_cpu_mhz();
     const uint32_t psram_cs = get_psram_pin();
     
     char status1[96];
@@ -513,11 +645,26 @@ void start_screen_show(start_error_t error, const char* error_msg) {
     snprintf(status1, sizeof(status1), "%s, FREQ: %lu MHz, PSRAM: %d MHz, CS: %lu",
              cfg,
              (unsigned long)cpu_mhz,
-             (int)DPSRAM_SPEED,
+             (int)clock_select_psram_mhz(),
              (unsigned long)psram_cs);
     
     const char *status3 = "github.com/rh1tech/murmprince";
     
+    // Crash left by the previous boot (watchdog / HardFault)
+    crash_info_t crash;
+    const bool show_crash = crash_guard_last_crash(&crash);
+    char crash1[46];
+    char crash2[46];
+    if (show_crash) {
+        crash_info_format(&crash, crash1, crash2, sizeof(crash1));
+    }
+    const char *safe_hint = crash_guard_safe_mode()
+        ? "SAFE MODE: no overclock, lighting, MIDI cache"
+        : "Crash on last boot, S: safe mode";
+    
+    // Menu state survives returning from the game; levelsets are rescanned.
+    start_menu_refresh(error == START_OK);
+    
     // Error messages
     const char *err_line = NULL;
     if (error != START_OK) {
@@ -536,16 +683,30 @@ void start_screen_show(start_error_t error, const char* error_msg) {
                     break;
             }
         }
-        snprintf(status2, sizeof(status2), "Insert SD card and reset.");
+        snprintf(status2, sizeof(status2), "Insert SD card...");
     } else {
-        snprintf(status2, sizeof(status2), "Press any key to start...");
+        snprintf(status2, sizeof(status2), "Arrows: select/change, Enter: OK");
     }
 
     // Main loop
     bool waiting = true;
+    uint32_t last_recheck_ms = to_ms_since_boot(get_absolute_time());
     while (waiting) {
         const uint32_t now_ms = to_ms_since_boot(get_absolute_time());
         
+        // Card missing or without data: keep checking so a (re)inserted card
+        // is picked up without a reset.
+        if (error != START_OK && !error_msg && now_ms - last_recheck_ms >= START_RECHECK_MS) {
+            last_recheck_ms = now_ms;
+            pop_fs_reset();
+            if (start_screen_check_requirements() == START_OK) {
+                error = START_OK;
+                err_line = NULL;
+                start_menu_refresh(true);
+                snprintf(status2, sizeof(status2), "Arrows: select/change, Enter: OK");
+            }
+        }
+        
         // Draw animated background border
         draw_animated_background_border(now_ms, panel_x, panel_y, panel_w, panel_h);
         
@@ -560,16 +721,30 @@ void start_screen_show(start_error_t error, const char* error_msg) {
         // Game name
         const char *game_name = "PRINCE OF PERSIA";
         int game_name_w = text_width_5x7(game_name);
-        draw_text_5x7((SCREEN_W - game_name_w) / 2, panel_y + 30, game_name, 1);
-
-        // Error or success message
-        if (err_line) {
+        draw_text_5x7((SCREEN_W - game_name_w) / 2, panel_y + 22, game_name, 1);
+
+        // Error, crash notice or success message
+        if (g_menu.controls) {
+            char hint[48];
+            uint8_t color;
+            controls_hint(hint, sizeof(hint), &color);
+            draw_text_5x7((SCREEN_W - text_width_5x7(hint)) / 2, panel_y + 34, hint, color);
+        } else if (err_line) {
             int err_w = text_width_5x7(err_line);
-            draw_text_5x7((SCREEN_W - err_w) / 2, panel_y + 60, err_line, 19);
+            draw_text_5x7((SCREEN_W - err_w) / 2, panel_y + 34, err_line, 19);
+        } else if (show_crash || crash_guard_safe_mode()) {
+            draw_text_5x7((SCREEN_W - text_width_5x7(safe_hint)) / 2, panel_y + 34, safe_hint, 19);
         } else {
             const char *ok_msg = "SD card OK";
             int ok_w = text_width_5x7(ok_msg);
-            draw_text_5x7((SCREEN_W - ok_w) / 2, panel_y + 60, ok_msg, 1);
+            draw_text_5x7((SCREEN_W - ok_w) / 2, panel_y + 34, ok_msg, 1);
+        }
+
+        draw_diagnostics(panel_y + 48, show_crash ? crash1 : NULL, show_crash ? crash2 : NULL);
+        if (g_menu.controls) {
+            draw_controls(panel_y + 48);
+        } else if (!g_menu.diagnostics) {
+            draw_menu(panel_y + 48);
         }
 
         // Status lines at bottom (centered)
@@ -577,15 +752,8 @@ void start_screen_show(start_error_t error, const char* error_msg) {
         int status1_w = text_width_5x7(status1);
         draw_text_5x7((SCREEN_W - status1_w) / 2, bottom_y0 + 0, status1, 1);
         
-        // Blink "Press any key" if no error
         int status2_w = text_width_5x7(status2);
-        if (error == START_OK) {
-            if ((now_ms / 500) % 2 == 0) {
-                draw_text_5x7((SCREEN_W - status2_w) / 2, bottom_y0 + 10, status2, 1);
-            }
-        } else {
-            draw_text_5x7((SCREEN_W - status2_w) / 2, bottom_y0 + 10, status2, 1);
-        }
+        draw_text_5x7((SCREEN_W - status2_w) / 2, bottom_y0 + 10, status2, 1);
         
         int status3_w = text_width_5x7(status3);
         draw_text_5x7((SCREEN_W - status3_w) / 2, bottom_y0 + 20, status3, 1);
@@ -593,13 +761,40 @@ void start_screen_show(start_error_t error, const char* error_msg) {
         // Copy back buffer to graphics buffer atomically to prevent flicker
         memcpy(graphics_buffer, back_buffer, SCREEN_W * SCREEN_H);
 
+        crash_guard_feed();
+        log_sink_pump();
         sleep_ms(33);  // ~30 FPS
         
-        // Check for keypress (allow start even with error to diagnose)
-        if (poll_any_key()) {
-            waiting = false;
+        int key = poll_any_key();
+        if (key == START_KEY_SAFE_MODE && show_crash && !crash_guard_safe_mode()) {
+            crash_guard_request_safe_mode();  // reboots
+        }
+        if (g_menu.capturing) {
+            // Any key, modifiers included, is the new binding.
+            if (key > 0) start_menu_capture(&g_menu, key);
+            continue;
+        }
+        switch (start_menu_key(&g_menu, menu_key_from_scancode(key))) {
+            case START_MENU_START:
+            case START_MENU_LOAD:
+                waiting = false;
+                break;
+            case START_MENU_APPLY_CLOCK:
+                // Persists the choice and reboots into a trial of it.
+                clock_select_request((uint8_t)g_menu.clock);
+                break;
+            case START_MENU_SAVE_BINDINGS:
+                // Applies to this session even if the card refuses the file.
+                *key_bindings_active() = g_menu.bindings;
+                if (!key_bindings_save(&g_menu.bindings)) {
+                    snprintf(status2, sizeof(status2), "Could not save " KEY_BINDINGS_FILE);
+                }
+                break;
+            default:
+                break;
         }
     }
+    crash_guard_dismiss_crash();
     
     // Clear screen before starting game
     memset(graphics_buffer, 0, SCREEN_W * SCREEN_H);
@@ -18,17 +18,30 @@ typedef enum {
 } start_error_t;
 
 /**
- * Show the start screen with system info.
- * Waits for any keypress to continue.
+ * Show the start screen with system info and the start menu.
+ * Returns when "Start game" is chosen.
  * @param error Error code to display (START_OK for no error)
  * @param error_msg Optional custom error message (NULL for default)
  */
 void start_screen_show(start_error_t error, const char* error_msg);
 
+/**
+ * Command line for sdlpop_entry() from the start menu choices (start level,
+ * levelset, lighting, music). argv is NULL-terminated; returns argc.
+ */
+int start_screen_game_args(char *argv[], int max_args);
+
 /**
  * Check if SD card and data directory are available.
  * @return START_OK if all good, error code otherwise
  */
 start_error_t start_screen_check_requirements(void);
 
+/**
+ * Show (true) or take down (false) the "SD card removed" prompt over the
+ * current game frame. Used as the pop_fs wait hook; restores the frame and
+ * the borrowed palette entries afterwards.
+ */
+void start_screen_sd_prompt(bool show);
+
 #endif // START_SCREEN_H
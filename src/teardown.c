@@ -0,0 +1,111 @@
+/*
+ * murmprince - Session teardown registry
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "teardown.h"
+#include "board_config.h"
+#include "psram_allocator.h"
+
+#include <malloc.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define TEARDOWN_MAX_HOOKS 8
+
+typedef struct {
+    const char *name;
+    teardown_hook_t reset;
+    teardown_check_t check;
+} teardown_entry_t;
+
+static teardown_entry_t g_hooks[TEARDOWN_MAX_HOOKS];
+static int g_hook_count = 0;
+
+static size_t g_session_psram_offset = 0;
+static size_t g_steady_sram_used = 0;
+static size_t g_pinned_sram = 0;
+static bool g_have_steady_sram = false;
+static unsigned g_session_count = 0;
+
+static size_t teardown_heap_used(void) {
+    struct mallinfo mi = mallinfo();
+    return (size_t)mi.uordblks;
+}
+
+// Heap in use, less what subsystems pinned for the whole run.
+static size_t teardown_sram_used(void) {
+    size_t used = teardown_heap_used();
+    return used > g_pinned_sram ? used - g_pinned_sram : 0;
+}
+
+void teardown_register(const char *name, teardown_hook_t reset, teardown_check_t check) {
+    for (int i = 0; i < g_hook_count; ++i) {
+        if (g_hooks[i].reset == reset) return;
+    }
+    if (g_hook_count >= TEARDOWN_MAX_HOOKS) {
+        DBG_PRINTF("[teardown] too many hooks, dropping %s\n", name);
+        return;
+    }
+    g_hooks[g_hook_count].name = name;
+    g_hooks[g_hook_count].reset = reset;
+    g_hooks[g_hook_count].check = check;
+    ++g_hook_count;
+}
+
+size_t teardown_pin_begin(void) {
+    return teardown_heap_used();
+}
+
+void teardown_pin_end(const char *name, size_t mark) {
+    (void)name;
+    size_t used = teardown_heap_used();
+    if (used <= mark) return;
+    g_pinned_sram += used - mark;
+    DBG_PRINTF("[teardown] %s pinned %u bytes of SRAM (%u total)\n", name, (unsigned)(used - mark),
+        (unsigned)g_pinned_sram);
+}
+
+void teardown_begin_session(void) {
+    g_session_psram_offset = psram_get_offset();
+}
+
+bool teardown_end_session(void) {
+    bool ok = true;
+    ++g_session_count;
+
+    for (int i = g_hook_count - 1; i >= 0; --i) {
+        g_hooks[i].reset();
+    }
+
+    // Everything the session put in PSRAM is unreachable now (PSRAM is a bump
+    // allocator, psram_free() is a no-op), so drop it wholesale.
+    psram_set_offset(g_session_psram_offset);
+    psram_reset_temp();
+
+    for (int i = 0; i < g_hook_count; ++i) {
+        if (g_hooks[i].check && !g_hooks[i].check()) {
+            DBG_PRINTF("[teardown] session %u: %s did not reset cleanly\n", g_session_count, g_hooks[i].name);
+            ok = false;
+        }
+    }
+
+    // The first session may allocate one-time SRAM state (SDL, drivers);
+    // after that the heap must come back to the same watermark every time,
+    // apart from pinned caches.
+    size_t sram_used = teardown_sram_used();
+    if (g_have_steady_sram && sram_used > g_steady_sram_used) {
+        DBG_PRINTF("[teardown] session %u: SRAM heap grew %u -> %u bytes\n", g_session_count,
+            (unsigned)g_steady_sram_used, (unsigned)sram_used);
+        ok = false;
+    }
+    if (!g_have_steady_sram) {
+        g_steady_sram_used = sram_used;
+        g_have_steady_sram = true;
+    }
+
+    DBG_PRINTF("[teardown] session %u: %s (sram=%u psram=%u hooks=%d)\n", g_session_count,
+        ok ? "clean" : "LEAKED", (unsigned)sram_used, (unsigned)g_session_psram_offset, g_hook_count);
+    return ok;
+}
@@ -0,0 +1,47 @@
+/*
+ * murmprince - Session teardown registry
+ *
+ * quit() longjmps out of SDLPoP back to the start screen, so nothing on the
+ * normal exit path releases per-session state. Subsystems register a reset
+ * hook (and optionally a self-check) once; main.c brackets every
+ * sdlpop_entry() call with teardown_begin_session()/teardown_end_session().
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*teardown_hook_t)(void);
+typedef bool (*teardown_check_t)(void);
+
+// Register a subsystem. Registering the same reset hook again is a no-op,
+// so it is safe to call from init paths that run every session.
+// check may be NULL; it returns false if the subsystem did not reset cleanly.
+void teardown_register(const char *name, teardown_hook_t reset, teardown_check_t check);
+
+// Bracket SRAM a subsystem keeps for the rest of the run (a cache
+// allocated on first use): whatever the heap grew by between the two calls
+// is not reported as session growth. Allocations made before the first
+// session need no pin.
+size_t teardown_pin_begin(void);
+void teardown_pin_end(const char *name, size_t mark);
+
+// Record the PSRAM/SRAM heap watermarks before a game session.
+void teardown_begin_session(void);
+
+// Run all reset hooks (latest registered first), roll PSRAM back to the
+// session-start watermark, then run the self-checks. Returns true if every
+// check passed and the SRAM heap, less pinned bytes, did not grow past the
+// first session's watermark.
+bool teardown_end_session(void);
+
+#ifdef __cplusplus
+}
+#endif
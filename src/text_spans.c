@@ -0,0 +1,71 @@
+/*
+ * murmprince - span layout for batched text lines
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "text_spans.h"
+
+#include <string.h>
+
+bool text_spans_layout(text_spans_line_t *line, const text_spans_glyph_t *glyphs, int count, int space) {
+    int pen_x = 0;
+    int n_spans = 0;
+    int bbox_w = 0;
+    int bbox_h = 0;
+    for (int i = 0; i < count; ++i) {
+        const text_spans_glyph_t *g = &glyphs[i];
+        for (int y = 0; y < g->h; ++y) {
+            const uint8_t *row = g->pixels + y * g->pitch;
+            int x = 0;
+            while (x < g->w) {
+                while (x < g->w && row[x] == 0) ++x;
+                if (x >= g->w) break;
+                const int start = x;
+                while (x < g->w && row[x] != 0) ++x;
+                if (n_spans >= TEXT_SPANS_MAX) return false;
+                line->spans[n_spans].x = (short)(pen_x + start);
+                line->spans[n_spans].y = (short)y;
+                line->spans[n_spans].len = (short)(x - start);
+                ++n_spans;
+            }
+        }
+        if (pen_x + g->w > bbox_w) bbox_w = pen_x + g->w;
+        if (g->h > bbox_h) bbox_h = g->h;
+        pen_x += space + g->w;
+    }
+    line->n_spans = (short)n_spans;
+    line->width = (short)pen_x;
+    line->bbox_w = (short)bbox_w;
+    line->bbox_h = (short)bbox_h;
+    return true;
+}
+
+void text_spans_emit(const text_spans_line_t *line, uint8_t *dst, int dst_pitch,
+                     const text_spans_clip_t *clip, int x, int y, uint8_t color) {
+    const int clip_right = clip->x + clip->w;
+    const int clip_bottom = clip->y + clip->h;
+    const text_span_t *span = line->spans;
+    const text_span_t *span_end = span + line->n_spans;
+    if (x >= clip->x && y >= clip->y && x + line->bbox_w <= clip_right && y + line->bbox_h <= clip_bottom) {
+        // Fully visible: no per-span clipping.
+        uint8_t *origin = dst + y * dst_pitch + x;
+        for (; span < span_end; ++span) {
+            memset(origin + span->y * dst_pitch + span->x, color, (size_t)span->len);
+        }
+        return;
+    }
+    if (x >= clip_right || y >= clip_bottom || x + line->bbox_w <= clip->x || y + line->bbox_h <= clip->y) {
+        return;
+    }
+    for (; span < span_end; ++span) {
+        const int dy = y + span->y;
+        if (dy < clip->y || dy >= clip_bottom) continue;
+        int x0 = x + span->x;
+        int x1 = x0 + span->len;
+        if (x0 < clip->x) x0 = clip->x;
+        if (x1 > clip_right) x1 = clip_right;
+        if (x1 <= x0) continue;
+        memset(dst + dy * dst_pitch + x0, color, (size_t)(x1 - x0));
+    }
+}
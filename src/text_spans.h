@@ -0,0 +1,58 @@
+/*
+ * murmprince - span layout for batched text lines
+ *
+ * HUD strings ("N MINUTES LEFT", "LEVEL N", bottom messages) are redrawn
+ * every frame while they are shown. Instead of blitting them glyph by
+ * glyph, seg009.c lays a line out once into horizontal runs of
+ * foreground pixels relative to the line's top-left corner, caches it,
+ * and fills the runs with one clip test per line.
+ *
+ * Glyphs are 8bpp images, 0 transparent and anything else foreground.
+ * Pure logic on plain buffers, so the same code runs on a host
+ * (tools/text_bench.c, tests/test_text_spans.c).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TEXT_SPANS_MAX 320
+
+typedef struct {
+    const uint8_t *pixels;
+    int w, h, pitch;
+} text_spans_glyph_t;
+
+typedef struct {
+    short x, y, len;
+} text_span_t;
+
+typedef struct {
+    short width;                    // pen advance: glyph widths plus spacing
+    short bbox_w, bbox_h;           // pixels the line can touch
+    short n_spans;
+    text_span_t spans[TEXT_SPANS_MAX];
+} text_spans_line_t;
+
+typedef struct {
+    int x, y, w, h;
+} text_spans_clip_t;
+
+// Lay out count glyphs, space pixels apart. False if the line needs more
+// than TEXT_SPANS_MAX spans.
+bool text_spans_layout(text_spans_line_t *line, const text_spans_glyph_t *glyphs, int count, int space);
+
+// Fill the spans with color at (x, y), clipped to clip.
+void text_spans_emit(const text_spans_line_t *line, uint8_t *dst, int dst_pitch,
+                     const text_spans_clip_t *clip, int x, int y, uint8_t color);
+
+#ifdef __cplusplus
+}
+#endif
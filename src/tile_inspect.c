@@ -0,0 +1,202 @@
+/*
+ * murmprince - tile inspector for the debug overlay
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "tile_inspect.h"
+#include "font_5x7.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TILES_PER_ROOM (TILE_INSPECT_COLS * TILE_INSPECT_ROWS)
+
+static const char *const type_names[] = {
+    "empty", "floor", "spike", "pillar", "gate", "stuck", "closer", "doortop floor",
+    "bigpillar bottom", "bigpillar top", "potion", "loose", "doortop", "mirror", "debris",
+    "opener", "exit left", "exit right", "chomper", "torch", "wall", "skeleton", "sword",
+    "balcony left", "balcony right", "lattice pillar", "lattice down", "lattice small",
+    "lattice left", "lattice right", "torch debris",
+};
+
+// Arrow, tip at the top left: '#' color, 'o' outline
+static const char *const cursor_rows[] = {
+    "o",
+    "oo",
+    "o#o",
+    "o##o",
+    "o###o",
+    "o####o",
+    "o#####o",
+    "o###ooo",
+    "o#o#o",
+    "oo o#o",
+    "    oo",
+};
+
+bool tile_inspect_at(int x, int y, int *col, int *row) {
+    if (x < 0 || x >= TILE_INSPECT_ROOM_W || y < 0 || y >= TILE_INSPECT_ROOM_H) return false;
+    int r = (y - TILE_INSPECT_TOP) / TILE_INSPECT_TILE_H;
+    // Below the last floor line is still the bottom row's floor
+    if (r >= TILE_INSPECT_ROWS) r = TILE_INSPECT_ROWS - 1;
+    *col = x / TILE_INSPECT_TILE_W;
+    *row = r;
+    return true;
+}
+
+// Room of a doorlink entry (SDLPoP get_doorlink_room)
+static int link_room(const tile_inspect_level_t *level, int index) {
+    return ((level->doorlinks1[index] & 0x60) >> 5) + ((level->doorlinks2[index] & 0xE0) >> 3);
+}
+
+static void add_link(tile_inspect_link_t *links, uint8_t *count, bool *more, int room, int tile) {
+    if (*count < TILE_INSPECT_LINKS) {
+        links[*count].room = (uint8_t)room;
+        links[*count].tile = (uint8_t)tile;
+        (*count)++;
+    } else {
+        *more = true;
+    }
+}
+
+// Walk a button's trigger list; stops at the end marker or after 256 entries
+static void trigger_list(const tile_inspect_level_t *level, int index,
+                         void (*visit)(void *ctx, int room, int tile), void *ctx) {
+    for (int n = 0; n < 256 && index < 256; n++, index++) {
+        visit(ctx, link_room(level, index), level->doorlinks1[index] & 0x1F);
+        if (level->doorlinks1[index] & 0x80) break;
+    }
+}
+
+static void add_target(void *ctx, int room, int tile) {
+    tile_inspect_info_t *info = (tile_inspect_info_t *)ctx;
+    add_link(info->targets, &info->target_count, &info->targets_more, room, tile);
+}
+
+typedef struct {
+    int room, tile;
+    bool hit;
+} find_ctx_t;
+
+static void find_target(void *ctx, int room, int tile) {
+    find_ctx_t *f = (find_ctx_t *)ctx;
+    if (room == f->room && tile == f->tile) f->hit = true;
+}
+
+static bool is_button(int type) {
+    return type == TILE_INSPECT_CLOSER || type == TILE_INSPECT_OPENER;
+}
+
+bool tile_inspect_lookup(const tile_inspect_level_t *level, int room, int col, int row,
+                         tile_inspect_info_t *info) {
+    memset(info, 0, sizeof(*info));
+    if (room < 1 || room > TILE_INSPECT_ROOMS || col < 0 || col >= TILE_INSPECT_COLS ||
+        row < 0 || row >= TILE_INSPECT_ROWS) {
+        return false;
+    }
+    const int tile = row * TILE_INSPECT_COLS + col;
+    const int pos = (room - 1) * TILES_PER_ROOM + tile;
+    info->room = (uint8_t)room;
+    info->col = (uint8_t)col;
+    info->row = (uint8_t)row;
+    info->tile = (uint8_t)tile;
+    info->type = level->fg[pos] & 0x1F;
+    info->modif = level->bg[pos];
+
+    if (is_button(info->type)) trigger_list(level, info->modif, add_target, info);
+
+    // Buttons anywhere in the level whose list holds this tile
+    for (int r = 1; r <= TILE_INSPECT_ROOMS; r++) {
+        for (int t = 0; t < TILES_PER_ROOM; t++) {
+            const int p = (r - 1) * TILES_PER_ROOM + t;
+            if (!is_button(level->fg[p] & 0x1F)) continue;
+            find_ctx_t f = { room, tile, false };
+            trigger_list(level, level->bg[p], find_target, &f);
+            if (f.hit) add_link(info->triggers, &info->trigger_count, &info->triggers_more, r, t);
+        }
+    }
+
+    if (level->guards_tile[room - 1] == tile) {
+        info->guard = true;
+        info->guard_skill = level->guards_skill[room - 1];
+    }
+    return true;
+}
+
+const char *tile_inspect_type_name(int type) {
+    if (type < 0 || type >= (int)(sizeof(type_names) / sizeof(type_names[0]))) return "?";
+    return type_names[type];
+}
+
+static void format_links(char *line, const char *label, const tile_inspect_link_t *links,
+                         int count, bool more) {
+    size_t len = (size_t)snprintf(line, TILE_INSPECT_LINE, "%s", label);
+    for (int i = 0; i < count && len < TILE_INSPECT_LINE; i++) {
+        len += (size_t)snprintf(line + len, TILE_INSPECT_LINE - len, " %u:%u",
+                                links[i].room, links[i].tile);
+    }
+    if (more && len < TILE_INSPECT_LINE) snprintf(line + len, TILE_INSPECT_LINE - len, " ..");
+}
+
+int tile_inspect_format(const tile_inspect_info_t *info,
+                        char lines[TILE_INSPECT_LINES][TILE_INSPECT_LINE]) {
+    int n = 0;
+    snprintf(lines[n++], TILE_INSPECT_LINE, "room %u tile %u (%u,%u)",
+             info->room, info->tile, info->col, info->row);
+    if (info->guard) {
+        snprintf(lines[n++], TILE_INSPECT_LINE, "%s mod %u guard %u",
+                 tile_inspect_type_name(info->type), info->modif, info->guard_skill);
+    } else {
+        snprintf(lines[n++], TILE_INSPECT_LINE, "%s mod %u",
+                 tile_inspect_type_name(info->type), info->modif);
+    }
+    if (info->target_count) {
+        format_links(lines[n++], info->type == TILE_INSPECT_OPENER ? "opens" : "closes",
+                     info->targets, info->target_count, info->targets_more);
+    }
+    if (info->trigger_count) {
+        format_links(lines[n++], "by", info->triggers, info->trigger_count, info->triggers_more);
+    }
+    return n;
+}
+
+void tile_inspect_fill(uint8_t *buf, int width, int height, int x, int y, int w, int h,
+                       uint8_t color) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > width) w = width - x;
+    if (y + h > height) h = height - y;
+    if (w <= 0 || h <= 0) return;
+    for (int yy = y; yy < y + h; yy++) memset(buf + yy * width + x, color, (size_t)w);
+}
+
+void tile_inspect_text(uint8_t *buf, int width, int height, int x, int y, const char *text,
+                       uint8_t color) {
+    for (const char *p = text; *p; p++, x += FONT_5X7_ADVANCE) {
+        const uint8_t *rows = font_5x7_glyph(*p);
+        for (int row = 0; row < 7; row++) {
+            const int yy = y + row;
+            if (yy < 0 || yy >= height) continue;
+            for (int col = 0; col < 5; col++) {
+                const int xx = x + col;
+                if (xx < 0 || xx >= width) continue;
+                if (rows[row] & (1u << (4 - col))) buf[yy * width + xx] = color;
+            }
+        }
+    }
+}
+
+void tile_inspect_cursor(uint8_t *buf, int width, int height, int x, int y, uint8_t color,
+                         uint8_t outline) {
+    for (int row = 0; row < (int)(sizeof(cursor_rows) / sizeof(cursor_rows[0])); row++) {
+        const int yy = y + row;
+        if (yy < 0 || yy >= height) continue;
+        for (int col = 0; cursor_rows[row][col]; col++) {
+            const int xx = x + col;
+            const char c = cursor_rows[row][col];
+            if (xx < 0 || xx >= width || c == ' ') continue;
+            buf[yy * width + xx] = c == '#' ? color : outline;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * murmprince - tile inspector for the debug overlay
+ *
+ * With debug cheats on ("debug" on the command line) a USB mouse moves a
+ * cursor over the room, and the overlay shows what is under it: room,
+ * tile position, tile type and modifier, the doors a button triggers and
+ * the buttons that trigger a tile, and the room's guard if it stands on
+ * the tile. This file maps screen pixels to tiles, reads the level, and
+ * draws the cursor and text into an 8bpp buffer.
+ *
+ * Screen geometry is SDLPoP's: ten 32-pixel columns and three rows whose
+ * floors are at y_land[] = 55, 118, 181. The room is drawn above
+ * TILE_INSPECT_ROOM_H; the status strip below it is not inspected.
+ *
+ * Pure logic: the level is passed as pointers to its arrays (the live
+ * ones curr_room_tiles/curr_room_modif point into), so it runs on a host.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILE_INSPECT_ROOMS 24
+#define TILE_INSPECT_COLS 10
+#define TILE_INSPECT_ROWS 3
+#define TILE_INSPECT_TILE_W 32
+#define TILE_INSPECT_TILE_H 63
+#define TILE_INSPECT_TOP (-8)       // y_land[0]
+#define TILE_INSPECT_ROOM_W 320
+#define TILE_INSPECT_ROOM_H 192     // RP2350_HUD_TOP
+#define TILE_INSPECT_LINKS 6
+#define TILE_INSPECT_LINE 48
+#define TILE_INSPECT_LINES 4
+
+// Tile types that matter here (SDLPoP enum tiletypes)
+#define TILE_INSPECT_GATE 4
+#define TILE_INSPECT_CLOSER 6
+#define TILE_INSPECT_OPENER 15
+#define TILE_INSPECT_EXIT_LEFT 16
+
+typedef struct {
+    const uint8_t *fg;              // level.fg: tile type (low 5 bits)
+    const uint8_t *bg;              // level.bg: modifier
+    const uint8_t *doorlinks1;
+    const uint8_t *doorlinks2;
+    const uint8_t *guards_tile;     // >= 30: no guard
+    const uint8_t *guards_skill;
+} tile_inspect_level_t;
+
+typedef struct {
+    uint8_t room;                   // 1..24
+    uint8_t tile;                   // 0..29
+} tile_inspect_link_t;
+
+typedef struct {
+    uint8_t room, col, row, tile;
+    uint8_t type, modif;
+    uint8_t target_count;           // a button: tiles it triggers
+    uint8_t trigger_count;          // buttons that trigger this tile
+    bool targets_more, triggers_more;  // lists cut at TILE_INSPECT_LINKS
+    tile_inspect_link_t targets[TILE_INSPECT_LINKS];
+    tile_inspect_link_t triggers[TILE_INSPECT_LINKS];
+    bool guard;
+    uint8_t guard_skill;
+} tile_inspect_info_t;
+
+// Room pixel to tile column and row; false outside the room area.
+bool tile_inspect_at(int x, int y, int *col, int *row);
+
+// What is at (col, row) of room. False for a room outside 1..24.
+bool tile_inspect_lookup(const tile_inspect_level_t *level, int room, int col, int row,
+                         tile_inspect_info_t *info);
+
+const char *tile_inspect_type_name(int type);
+
+// Overlay text, one line per entry; returns the number of lines.
+int tile_inspect_format(const tile_inspect_info_t *info,
+                        char lines[TILE_INSPECT_LINES][TILE_INSPECT_LINE]);
+
+// Into an 8bpp buffer of width x height (pitch = width): a filled box,
+// 5x7 text, and an arrow cursor with its tip at (x, y). Clipped.
+void tile_inspect_fill(uint8_t *buf, int width, int height, int x, int y, int w, int h,
+                       uint8_t color);
+void tile_inspect_text(uint8_t *buf, int width, int height, int x, int y, const char *text,
+                       uint8_t color);
+void tile_inspect_cursor(uint8_t *buf, int width, int height, int x, int y, uint8_t color,
+                         uint8_t outline);
+
+#ifdef __cplusplus
+}
+#endif
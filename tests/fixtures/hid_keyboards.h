@@ -0,0 +1,108 @@
+/*
+ * murmprince - USB keyboard report descriptors for the host tests
+ *
+ * The boot keyboard is the example from the HID 1.11 specification
+ * (appendix E.6). The others are written out by hand after the layouts
+ * keyboards commonly use; they are not dumps of particular products.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Boot protocol keyboard: modifiers, reserved byte, 6 key slots, LEDs out
+static const uint8_t hid_desc_boot[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,         // Generic Desktop, Keyboard, Application
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,         //   Keyboard page, usages E0-E7
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+    0x81, 0x02,                                 //   Input (Var): modifiers
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x01,         //   Input (Const): reserved
+    0x95, 0x05, 0x75, 0x01, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05,
+    0x91, 0x02,                                 //   Output: LEDs
+    0x95, 0x01, 0x75, 0x03, 0x91, 0x01,         //   Output: padding
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x25, 0x65,
+    0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+    0x81, 0x00,                                 //   Input (Array): keys
+    0xC0,
+};
+
+// Boot layout as many cheap keyboards write it: Logical Maximum 0xFF in
+// one byte (strictly -1) and the usage range up to 0xFF
+static const uint8_t hid_desc_boot_ff[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+    0x81, 0x02,
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x03,
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x25, 0xFF,
+    0x05, 0x07, 0x19, 0x00, 0x29, 0xFF,
+    0x81, 0x00,
+    0xC0,
+};
+
+// Composite interface with report IDs: keyboard (1), consumer control (2),
+// system control (3)
+static const uint8_t hid_desc_composite[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x85, 0x01,                                 //   Report ID 1
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+    0x81, 0x02,
+    0x75, 0x08, 0x95, 0x01, 0x81, 0x01,
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x26, 0xFF, 0x00,
+    0x05, 0x07, 0x19, 0x00, 0x2A, 0xFF, 0x00,
+    0x81, 0x00,
+    0xC0,
+    0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01,         // Consumer Control
+    0x85, 0x02,
+    0x15, 0x00, 0x26, 0xFF, 0x03, 0x19, 0x00, 0x2A, 0xFF, 0x03,
+    0x75, 0x10, 0x95, 0x01,
+    0x81, 0x00,
+    0xC0,
+    0x05, 0x01, 0x09, 0x80, 0xA1, 0x01,         // System Control
+    0x85, 0x03,
+    0x19, 0x81, 0x29, 0x83, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+    0x95, 0x05, 0x81, 0x01,
+    0xC0,
+};
+
+// N-key rollover: a 6-key array report (ID 1) for hosts that only read
+// that, and a bitmap of usages 0x00-0x67 (ID 4) for all further keys
+static const uint8_t hid_desc_nkro[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x85, 0x01,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+    0x81, 0x02,
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x01,
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x25, 0x65,
+    0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+    0x81, 0x00,
+    0xC0,
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x85, 0x04,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+    0x81, 0x02,
+    0x19, 0x00, 0x29, 0x67, 0x95, 0x68,
+    0x81, 0x02,                                 //   Input (Var): one bit per key
+    0xC0,
+};
+
+// Three-button mouse with a wheel: no keys at all
+static const uint8_t hid_desc_mouse[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01,
+    0x09, 0x01, 0xA1, 0x00,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03,
+    0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01,
+    0x81, 0x02,
+    0x95, 0x01, 0x75, 0x05, 0x81, 0x01,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x38,
+    0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x03,
+    0x81, 0x06,
+    0xC0,
+    0xC0,
+};
@@ -0,0 +1,17 @@
+/*
+ * murmprince - host stand-in for the Pico SDK's hardware/structs/sysinfo.h
+ *
+ * Enough for board_config.h to parse; get_psram_pin() must not be called
+ * on a host.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef volatile const uint32_t io_ro_32;
+
+#define SYSINFO_BASE 0x40000000u
+#define SYSINFO_PACKAGE_SEL_OFFSET 0x00000004u
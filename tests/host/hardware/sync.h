@@ -0,0 +1,15 @@
+/*
+ * murmprince - host stand-in for the Pico SDK's hardware/sync.h
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+static inline void __dsb(void) {
+    __asm__ volatile ("" ::: "memory");
+}
+
+static inline void __isb(void) {
+    __asm__ volatile ("" ::: "memory");
+}
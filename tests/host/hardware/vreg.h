@@ -0,0 +1,9 @@
+/*
+ * murmprince - host stand-in for the Pico SDK's hardware/vreg.h
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+enum vreg_voltage { VREG_VOLTAGE_1_50 = 0x0f };
@@ -0,0 +1,26 @@
+/*
+ * murmprince - host stand-in for the Pico SDK's pico/stdlib.h
+ *
+ * Only what the card code built into the host tests uses. Time is a
+ * counter that moves when the code sleeps (pico_host.c), so waits that
+ * poll the clock finish at once.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+uint get_core_num(void);
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
@@ -0,0 +1,54 @@
+/*
+ * murmprince - Pico SDK and firmware services for the host tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pico_host.h"
+
+#include "pico/stdlib.h"
+#include "crash_guard.h"
+#include "teardown.h"
+
+static uint64_t g_now_us;
+static unsigned g_core;
+static void (*g_sleep_hook)(uint64_t now_us);
+
+uint64_t pico_host_now_us(void) {
+    return g_now_us;
+}
+
+void pico_host_set_core(unsigned core) {
+    g_core = core;
+}
+
+void pico_host_set_sleep_hook(void (*hook)(uint64_t now_us)) {
+    g_sleep_hook = hook;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return g_now_us;
+}
+
+void sleep_us(uint64_t us) {
+    g_now_us += us;
+    if (g_sleep_hook) g_sleep_hook(g_now_us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+uint get_core_num(void) {
+    return g_core;
+}
+
+// No watchdog and no session teardown in the host tests
+void crash_guard_feed(void) {
+}
+
+void teardown_register(const char *name, teardown_hook_t reset, teardown_check_t check) {
+    (void)name;
+    (void)reset;
+    (void)check;
+}
@@ -0,0 +1,23 @@
+/*
+ * murmprince - Pico SDK and firmware services for the host tests
+ *
+ * src/pop_fs.c is built into the host tests unchanged; this supplies the
+ * SDK calls and firmware services it links against. The clock only moves
+ * when the code sleeps.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Microseconds slept so far.
+uint64_t pico_host_now_us(void);
+
+// Core the code under test believes it runs on (default 0).
+void pico_host_set_core(unsigned core);
+
+// Called with the new time whenever the code sleeps, e.g. to reinsert a
+// card the code waits for. NULL for none.
+void pico_host_set_sleep_hook(void (*hook)(uint64_t now_us));
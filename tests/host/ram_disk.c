@@ -0,0 +1,92 @@
+/*
+ * murmprince - RAM disk for host tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ram_disk.h"
+
+#include "ff.h"
+#include "diskio.h"
+#include "pop_fs.h"
+
+#include <string.h>
+
+#define RAM_DISK_SECTOR 512
+#define RAM_DISK_SECTORS 4096 // 2 MB: FAT12/16, small and quick to format
+
+static unsigned char g_disk[RAM_DISK_SECTORS][RAM_DISK_SECTOR];
+static int g_write_budget = -1;
+static bool g_inserted = true;
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    if (pdrv != 0) return STA_NOINIT;
+    return g_inserted ? 0 : STA_NOINIT | STA_NODISK;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return disk_initialize(pdrv);
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || sector + count > RAM_DISK_SECTORS) return RES_PARERR;
+    if (!g_inserted) return RES_NOTRDY;
+    memcpy(buff, g_disk[sector], (size_t)count * RAM_DISK_SECTOR);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || sector + count > RAM_DISK_SECTORS) return RES_PARERR;
+    if (!g_inserted) return RES_NOTRDY;
+    for (UINT i = 0; i < count; ++i) {
+        if (g_write_budget == 0) return RES_ERROR;
+        if (g_write_budget > 0) --g_write_budget;
+        memcpy(g_disk[sector + i], buff + (size_t)i * RAM_DISK_SECTOR, RAM_DISK_SECTOR);
+    }
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    if (pdrv != 0) return RES_PARERR;
+    if (!g_inserted) return RES_NOTRDY;
+    switch (cmd) {
+        case CTRL_SYNC: return RES_OK;
+        case GET_SECTOR_COUNT: *(LBA_t *)buff = RAM_DISK_SECTORS; return RES_OK;
+        case GET_SECTOR_SIZE: *(WORD *)buff = RAM_DISK_SECTOR; return RES_OK;
+        case GET_BLOCK_SIZE: *(DWORD *)buff = 1; return RES_OK;
+        case MMC_GET_TYPE: *(BYTE *)buff = 0x0C; return RES_OK; // SDHC
+        case MMC_GET_STATUS: ((BYTE *)buff)[0] = ((BYTE *)buff)[1] = 0; return RES_OK;
+        default: return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+    return ((DWORD)(2026 - 1980) << 25) | (1u << 21) | (1u << 16);
+}
+
+bool ram_disk_format(void) {
+    static unsigned char work[FF_MAX_SS * 4];
+    const MKFS_PARM opt = { FM_FAT | FM_SFD, 0, 0, 0, 0 };
+    g_write_budget = -1;
+    g_inserted = true;
+    f_mount(NULL, "0:", 0);
+    memset(g_disk, 0, sizeof(g_disk));
+    if (f_mkfs("0:", &opt, work, sizeof(work)) != FR_OK) return false;
+    pop_fs_reset();
+    return pop_fs_init();
+}
+
+void ram_disk_set_inserted(bool inserted) {
+    g_inserted = inserted;
+}
+
+void ram_disk_set_write_budget(int sectors) {
+    g_write_budget = sectors;
+}
+
+bool ram_disk_remount(void) {
+    g_write_budget = -1;
+    f_mount(NULL, "0:", 0);
+    pop_fs_reset();
+    return pop_fs_init();
+}
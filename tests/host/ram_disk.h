@@ -0,0 +1,29 @@
+/*
+ * murmprince - RAM disk for host tests
+ *
+ * FatFS drive 0 backed by memory instead of the SD card, so the modules
+ * that read and write the card run unchanged on a host. A write budget
+ * cuts the power after a number of sector writes, to check what a save
+ * leaves behind when it is interrupted, and the card can be pulled.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+// Format the disk (FAT) and mount it through pop_fs_init() as "0:";
+// everything on it is lost.
+bool ram_disk_format(void);
+
+// Sector writes allowed from now on before the disk stops taking them
+// (and reports an error); < 0 for no limit.
+void ram_disk_set_write_budget(int sectors);
+
+// Remount, as after a power cut: open files and cached sectors are gone.
+bool ram_disk_remount(void);
+
+// Pull (false) or reinsert (true) the card: while it is out every access
+// fails, the status query included. The contents stay.
+void ram_disk_set_inserted(bool inserted);
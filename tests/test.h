@@ -0,0 +1,60 @@
+/*
+ * murmprince - host test helpers
+ *
+ * Each test program is one file of static test functions run from main()
+ * with TEST_RUN(). A failed check prints where and what, and the program
+ * carries on; test_finish() returns the exit status for ctest.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_failures;
+static int test_checks;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        ++test_checks;                                                                \
+        if (!(cond)) {                                                                \
+            ++test_failures;                                                          \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);           \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_INT(actual, expected)                                                   \
+    do {                                                                              \
+        const long long a_ = (long long)(actual), e_ = (long long)(expected);         \
+        ++test_checks;                                                                \
+        if (a_ != e_) {                                                               \
+            ++test_failures;                                                          \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, \
+                   a_, e_);                                                           \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_STR(actual, expected)                                                   \
+    do {                                                                              \
+        const char *a_ = (actual), *e_ = (expected);                                  \
+        ++test_checks;                                                                \
+        if (strcmp(a_, e_) != 0) {                                                    \
+            ++test_failures;                                                          \
+            printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__,      \
+                   #actual, a_, e_);                                                  \
+        }                                                                             \
+    } while (0)
+
+#define TEST_RUN(fn)                                                                  \
+    do {                                                                              \
+        const int before_ = test_failures;                                            \
+        fn();                                                                         \
+        printf("%s %s\n", test_failures == before_ ? "ok  " : "FAIL", #fn);           \
+    } while (0)
+
+static inline int test_finish(void) {
+    printf("%d checks, %d failed\n", test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+/*
+ * murmprince - 8bpp blitter inner loop tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "blit_core.h"
+#include "test.h"
+
+#define W 6
+#define H 4
+
+static uint8_t dst[H][W];
+
+static void clear(uint8_t v) {
+    memset(dst, v, sizeof(dst));
+}
+
+static const blit_color_t colors[] = {
+    { 0, 0, 0, 255 },
+    { 255, 0, 0, 255 },
+    { 0, 255, 0, 255 },
+    { 0, 0, 255, 255 },
+    { 255, 0, 0, 255 },     // same as 1
+};
+
+static void test_nearest(void) {
+    const blit_palette_t pal = { colors, 5, false };
+    CHECK_INT(blit_core_nearest(&pal, 250, 10, 0), 1);
+    CHECK_INT(blit_core_nearest(&pal, 0, 200, 60), 2);
+    CHECK_INT(blit_core_nearest(&pal, 20, 20, 20), 0);
+    const blit_palette_t empty = { colors, 0, false };
+    CHECK_INT(blit_core_nearest(&empty, 255, 0, 0), 0);
+
+    // The screen palette's 240..243 are never picked
+    static blit_color_t screen[256];
+    for (int i = 0; i < 256; ++i) screen[i] = (blit_color_t){ 0, 0, 0, 255 };
+    screen[241] = (blit_color_t){ 255, 255, 255, 255 };
+    screen[250] = (blit_color_t){ 250, 250, 250, 255 };
+    blit_palette_t pal256 = { screen, 256, false };
+    CHECK_INT(blit_core_nearest(&pal256, 255, 255, 255), 241);
+    pal256.skip_reserved = true;
+    CHECK_INT(blit_core_nearest(&pal256, 255, 255, 255), 250);
+}
+
+static void test_fill(void) {
+    clear(0);
+    blit_core_fill8(&dst[1][2], W, 3, 2, 9);
+    CHECK_INT(dst[0][2], 0);
+    CHECK_INT(dst[1][1], 0);
+    CHECK_INT(dst[1][2], 9);
+    CHECK_INT(dst[2][4], 9);
+    CHECK_INT(dst[2][5], 0);
+    CHECK_INT(dst[3][2], 0);
+}
+
+static void test_key8(void) {
+    const uint8_t src[2][4] = { { 1, 0, 2, 3 }, { 0, 4, 5, 0 } };
+    clear(7);
+    blit_core_key8(&dst[0][0], W, &src[0][0], 4, 1, 4, 2, BLIT_CORE_NO_KEY, NULL);
+    CHECK(!memcmp(dst[0], "\1\0\2\3\7\7", W));
+    CHECK(!memcmp(dst[1], "\0\4\5\0\7\7", W));
+
+    clear(7);
+    blit_core_key8(&dst[1][1], W, &src[0][0], 4, 1, 4, 2, 0, NULL);
+    CHECK(!memcmp(dst[1], "\7\1\7\2\3\7", W));
+    CHECK(!memcmp(dst[2], "\7\7\4\5\7\7", W));
+
+    // Mirrored: src points at the last pixel of the row
+    clear(7);
+    blit_core_key8(&dst[0][0], W, &src[0][3], 4, -1, 4, 2, 0, NULL);
+    CHECK(!memcmp(dst[0], "\3\2\7\1\7\7", W));
+    CHECK(!memcmp(dst[1], "\7\5\4\7\7\7", W));
+
+    // Through a palette map; the key is compared before mapping
+    uint8_t map[256];
+    for (int i = 0; i < 256; ++i) map[i] = (uint8_t)(i + 10);
+    clear(7);
+    blit_core_key8(&dst[0][0], W, &src[0][0], 4, 1, 4, 1, 0, map);
+    CHECK(!memcmp(dst[0], "\13\7\14\15\7\7", W));
+    blit_core_key8(&dst[1][0], W, &src[0][0], 4, 1, 4, 1, BLIT_CORE_NO_KEY, map);
+    CHECK(!memcmp(dst[1], "\13\12\14\15\7\7", W));
+}
+
+static void test_xor_and_mono(void) {
+    const uint8_t src[2][3] = { { 1, 0, 6 }, { 0, 3, 0 } };
+    clear(5);
+    blit_core_xor8(&dst[0][0], W, &src[0][0], 3, 1, 3, 2);
+    CHECK(!memcmp(dst[0], "\4\5\3\5\5\5", W));
+    CHECK(!memcmp(dst[1], "\5\6\5\5\5\5", W));
+    clear(5);
+    blit_core_xor8(&dst[0][0], W, &src[0][2], 3, -1, 3, 1);
+    CHECK(!memcmp(dst[0], "\3\5\4\5\5\5", W));
+
+    clear(0);
+    blit_core_mono8(&dst[0][1], W, &src[0][0], 3, 1, 3, 2, 15);
+    CHECK(!memcmp(dst[0], "\0\17\0\17\0\0", W));
+    CHECK(!memcmp(dst[1], "\0\0\17\0\0\0", W));
+    clear(0);
+    blit_core_mono8(&dst[0][0], W, &src[1][2], 3, -1, 3, 1, 15);
+    CHECK(!memcmp(dst[0], "\0\17\0\0\0\0", W));
+}
+
+static void test_rgb24(void) {
+    const blit_palette_t pal = { colors, 4, false };
+    const uint8_t src[] = { 250, 0, 0,  0, 0, 0,  10, 0, 240 };
+    clear(7);
+    blit_core_rgb24_to8(&dst[0][0], W, src, sizeof(src), 3, 1, BLIT_CORE_NO_KEY, &pal);
+    CHECK(!memcmp(dst[0], "\1\0\3\7\7\7", W));
+    // The key is packed 0xRRGGBB
+    clear(7);
+    blit_core_rgb24_to8(&dst[0][0], W, src, sizeof(src), 3, 1, 0x0A00F0, &pal);
+    CHECK(!memcmp(dst[0], "\1\0\7\7\7\7", W));
+    // No palette
+    clear(7);
+    blit_core_rgb24_to8(&dst[0][0], W, src, sizeof(src), 3, 1, 0, NULL);
+    CHECK(!memcmp(dst[0], "\17\7\17\7\7\7", W));
+}
+
+static void test_rgba(void) {
+    const blit_palette_t pal = { colors, 4, false };
+    // 0xAABBGGRR
+    const uint32_t src[] = { 0xFF0000F0u, 0x00FF0000u, 0x8000FF00u, 0xFF000000u };
+    const blit_rgba_format_t abgr = { 0x000000FFu, 0x0000FF00u, 0x00FF0000u, 0xFF000000u };
+    clear(7);
+    blit_core_rgba_to8(&dst[0][0], W, src, sizeof(src), 4, 1, &abgr, BLIT_CORE_NO_KEY, false, &pal);
+    CHECK(!memcmp(dst[0], "\1\3\2\0\7\7", W));
+    // Fully clear pixels left alone
+    clear(7);
+    blit_core_rgba_to8(&dst[0][0], W, src, sizeof(src), 4, 1, &abgr, BLIT_CORE_NO_KEY, true, &pal);
+    CHECK(!memcmp(dst[0], "\1\7\2\0\7\7", W));
+    // The key compares the low 24 bits, whatever the alpha
+    clear(7);
+    blit_core_rgba_to8(&dst[0][0], W, src, sizeof(src), 4, 1, &abgr, 0x000000, false, &pal);
+    CHECK(!memcmp(dst[0], "\1\3\2\7\7\7", W));
+
+    // ARGB masks; without an alpha mask every pixel reads as clear
+    const uint32_t argb_src[] = { 0xFF00FF00u };
+    const blit_rgba_format_t argb = { 0x00FF0000u, 0x0000FF00u, 0x000000FFu, 0xFF000000u };
+    const blit_rgba_format_t rgb = { 0x00FF0000u, 0x0000FF00u, 0x000000FFu, 0 };
+    clear(7);
+    blit_core_rgba_to8(&dst[0][0], W, argb_src, 4, 1, 1, &argb, BLIT_CORE_NO_KEY, true, &pal);
+    CHECK_INT(dst[0][0], 2);
+    blit_core_rgba_to8(&dst[1][0], W, argb_src, 4, 1, 1, &rgb, BLIT_CORE_NO_KEY, true, &pal);
+    CHECK_INT(dst[1][0], 7);
+    blit_core_rgba_to8(&dst[1][0], W, argb_src, 4, 1, 1, &rgb, BLIT_CORE_NO_KEY, false, NULL);
+    CHECK_INT(dst[1][0], 15);
+}
+
+// Random sprite, clip and position; the mirrored blit (src_step -1 from the
+// last pixel of the row, as SDL_MIRROR_X surfaces are drawn) must match
+// flipping the sprite first and blitting it forwards, byte for byte.
+#define MIRROR_MAX_W 71
+#define MIRROR_MAX_H 40
+#define MIRROR_DST_W 64
+#define MIRROR_DST_H 48
+#define MIRROR_ITERATIONS 3000
+
+static uint32_t rng_seed = 0x2545F491u;
+
+static int rng(int n) {
+    rng_seed = rng_seed * 1664525u + 1013904223u;
+    return (int)((rng_seed >> 8) % (uint32_t)n);
+}
+
+typedef enum { MIRROR_KEY, MIRROR_COPY, MIRROR_MAP, MIRROR_XOR, MIRROR_MONO, MIRROR_KINDS } mirror_kind_t;
+
+static void mirror_blit(mirror_kind_t kind, uint8_t *d, const uint8_t *s, int pitch, int step,
+                        int w, int h, const uint8_t *map) {
+    switch (kind) {
+        case MIRROR_KEY: blit_core_key8(d, MIRROR_DST_W, s, pitch, step, w, h, 0, NULL); break;
+        case MIRROR_COPY: blit_core_key8(d, MIRROR_DST_W, s, pitch, step, w, h, BLIT_CORE_NO_KEY, NULL); break;
+        case MIRROR_MAP: blit_core_key8(d, MIRROR_DST_W, s, pitch, step, w, h, 5, map); break;
+        case MIRROR_XOR: blit_core_xor8(d, MIRROR_DST_W, s, pitch, step, w, h); break;
+        default: blit_core_mono8(d, MIRROR_DST_W, s, pitch, step, w, h, 15); break;
+    }
+}
+
+static void test_mirror_random(void) {
+    static uint8_t img[MIRROR_MAX_H][MIRROR_MAX_W + 5];
+    static uint8_t flipped[MIRROR_MAX_H][MIRROR_MAX_W + 5];
+    static uint8_t want[MIRROR_DST_H][MIRROR_DST_W];
+    static uint8_t got[MIRROR_DST_H][MIRROR_DST_W];
+    uint8_t map[256];
+    for (int i = 0; i < 256; ++i) map[i] = (uint8_t)(255 - i);
+    const int pitch = MIRROR_MAX_W + 5;
+    int mismatches = 0, blits = 0;
+
+    for (int it = 0; it < MIRROR_ITERATIONS; ++it) {
+        const mirror_kind_t kind = (mirror_kind_t)(it % MIRROR_KINDS);
+        // Odd widths half the time; ~1/3 of the pixels transparent
+        const int w = 1 + rng(MIRROR_MAX_W);
+        const int h = 1 + rng(MIRROR_MAX_H);
+        memset(img, 0xEE, sizeof(img));
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) img[y][x] = rng(3) ? (uint8_t)(1 + rng(255)) : 0;
+            for (int x = 0; x < w; ++x) flipped[y][x] = img[y][w - 1 - x];
+        }
+
+        // Source clip rect in logical (mirrored view) coordinates
+        const int sx = rng(w), sy = rng(h);
+        int cw = 1 + rng(w - sx), ch = 1 + rng(h - sy);
+        // Destination, possibly hanging off any edge; clipped like blit_xor()
+        int dx = rng(MIRROR_DST_W + cw) - cw / 2 - 8;
+        int dy = rng(MIRROR_DST_H + ch) - ch / 2 - 8;
+        const int x0 = dx < 0 ? -dx : 0, y0 = dy < 0 ? -dy : 0;
+        const int x1 = cw < MIRROR_DST_W - dx ? cw : MIRROR_DST_W - dx;
+        const int y1 = ch < MIRROR_DST_H - dy ? ch : MIRROR_DST_H - dy;
+        if (x1 <= x0 || y1 <= y0) continue;
+        ++blits;
+
+        const uint8_t fill = (uint8_t)rng(256);
+        memset(want, fill, sizeof(want));
+        memset(got, fill, sizeof(got));
+        uint8_t *d_want = &want[dy + y0][dx + x0];
+        uint8_t *d_got = &got[dy + y0][dx + x0];
+        const int src_x = sx + x0, src_y = sy + y0;
+        mirror_blit(kind, d_want, &flipped[src_y][src_x], pitch, 1, x1 - x0, y1 - y0, map);
+        mirror_blit(kind, d_got, &img[src_y][w - 1 - src_x], pitch, -1, x1 - x0, y1 - y0, map);
+        if (memcmp(want, got, sizeof(want)) != 0) {
+            if (mismatches++ < 5) {
+                printf("mirror mismatch: kind %d sprite %dx%d clip %d,%d %dx%d at %d,%d\n",
+                       (int)kind, w, h, sx, sy, cw, ch, dx, dy);
+            }
+        }
+    }
+    CHECK_INT(mismatches, 0);
+    // Most draws land on screen
+    CHECK(blits > MIRROR_ITERATIONS / 2);
+}
+
+int main(void) {
+    TEST_RUN(test_nearest);
+    TEST_RUN(test_fill);
+    TEST_RUN(test_key8);
+    TEST_RUN(test_xor_and_mono);
+    TEST_RUN(test_rgb24);
+    TEST_RUN(test_rgba);
+    TEST_RUN(test_mirror_random);
+    return test_finish();
+}
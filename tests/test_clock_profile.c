@@ -0,0 +1,190 @@
+/*
+ * murmprince - CPU clock profile state machine tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "clock_profile.h"
+#include "test.h"
+
+// The flash sector clock_select.c keeps the record in
+static uint8_t flash[CLOCK_PROFILE_RECORD_SIZE];
+
+// One boot as clock_select_boot() runs it: load (or start fresh), count
+// the attempt, store.
+static uint8_t boot(clock_profile_state_t *st) {
+    if (!clock_profile_decode(flash, st)) clock_profile_state_init(st, 0);
+    const uint8_t id = clock_profile_on_boot(st);
+    clock_profile_encode(st, flash);
+    return id;
+}
+
+static void store(const clock_profile_state_t *st) {
+    clock_profile_encode(st, flash);
+}
+
+static void erase(void) {
+    memset(flash, 0xFF, sizeof(flash));
+}
+
+static void test_table(void) {
+    CHECK_INT(clock_profile_find_mhz(252), 0);
+    CHECK_INT(clock_profile_find_mhz(378), 1);
+    CHECK_INT(clock_profile_find_mhz(504), 2);
+    CHECK_INT(clock_profile_find_mhz(300), CLOCK_PROFILE_NONE);
+    CHECK(clock_profile_get(CLOCK_PROFILE_COUNT) == NULL);
+    CHECK_INT(clock_profile_get(0)->vreg_mv, 0);
+    CHECK_INT(clock_profile_get(2)->psram_mhz, 166);
+}
+
+static void test_erased_page(void) {
+    clock_profile_state_t st = { 2, 1, 1, 4, 2 };
+    const clock_profile_state_t before = st;
+    erase();
+    CHECK(!clock_profile_decode(flash, &st));
+    CHECK(!memcmp(&st, &before, sizeof(st)));
+    memset(flash, 0, sizeof(flash));
+    CHECK(!clock_profile_decode(flash, &st));
+
+    // A first boot on an erased page runs the build default
+    erase();
+    clock_profile_state_t fresh;
+    CHECK_INT(boot(&fresh), 0);
+    CHECK_INT(fresh.pending, CLOCK_PROFILE_NONE);
+}
+
+static void test_record(void) {
+    clock_profile_state_t st = { 1, 2, 1, 0x04, 2 }, back;
+    store(&st);
+    CHECK(clock_profile_decode(flash, &back));
+    CHECK(!memcmp(&st, &back, sizeof(st)));
+
+    for (int i = 0; i < CLOCK_PROFILE_RECORD_SIZE; ++i) {
+        store(&st);
+        flash[i] ^= 0x10;
+        CHECK(!clock_profile_decode(flash, &back));
+    }
+    // Checksummed, but out of range
+    st.active = CLOCK_PROFILE_COUNT;
+    store(&st);
+    CHECK(!clock_profile_decode(flash, &back));
+    st.active = 0;
+    st.pending = CLOCK_PROFILE_COUNT;
+    store(&st);
+    CHECK(!clock_profile_decode(flash, &back));
+}
+
+static void test_trial_passes(void) {
+    clock_profile_state_t st;
+    erase();
+    CHECK_INT(boot(&st), 0);
+    CHECK(clock_profile_request(&st, 1));
+    store(&st);
+
+    CHECK_INT(boot(&st), 1);
+    CHECK_INT(st.attempts, 1);
+    clock_profile_on_selftest(&st, true);
+    store(&st);
+    CHECK_INT(st.active, 1);
+    CHECK_INT(st.pending, CLOCK_PROFILE_NONE);
+    CHECK_INT(st.attempts, 0);
+
+    // Committed: every later boot runs it, with nothing on trial
+    for (int i = 0; i < 3; ++i) CHECK_INT(boot(&st), 1);
+    CHECK_INT(st.failed_mask, 0);
+}
+
+static void test_watchdog_reset(void) {
+    // The trial boot hangs, so the watchdog resets it before the self-test
+    // reports. Attempts are counted before the clocks change, so the next
+    // boot sees the used-up trial and falls back
+    clock_profile_state_t st;
+    erase();
+    boot(&st);
+    clock_profile_request(&st, 2);
+    store(&st);
+    for (int i = 0; i < CLOCK_PROFILE_MAX_ATTEMPTS; ++i) {
+        CHECK_INT(boot(&st), 2);
+        CHECK_INT(st.attempts, i + 1);
+    }
+    CHECK_INT(boot(&st), 0);
+    CHECK_INT(st.pending, CLOCK_PROFILE_NONE);
+    CHECK_INT(st.failed_mask, 1u << 2);
+    CHECK_INT(boot(&st), 0);
+
+    // A self-test result on a non-trial boot changes nothing
+    clock_profile_on_selftest(&st, false);
+    CHECK_INT(st.active, 0);
+    CHECK_INT(st.failed_mask, 1u << 2);
+}
+
+static void test_selftest_fails(void) {
+    clock_profile_state_t st;
+    erase();
+    boot(&st);
+    clock_profile_request(&st, 1);
+    store(&st);
+    CHECK_INT(boot(&st), 1);
+    clock_profile_on_selftest(&st, false);
+    store(&st);
+    CHECK_INT(st.active, 0);
+    CHECK_INT(st.failed_mask, 1u << 1);
+    CHECK_INT(boot(&st), 0);
+
+    // The selector skips the failed profile...
+    CHECK_INT(clock_profile_next(&st, 0), 2);
+    CHECK_INT(clock_profile_next(&st, 2), 0);
+    // ...unless it is the only other choice
+    st.failed_mask = (1u << 1) | (1u << 2);
+    CHECK_INT(clock_profile_next(&st, 0), 0);
+
+    // Asking for it explicitly clears the mark and tries again
+    st.failed_mask = 1u << 1;
+    CHECK(clock_profile_request(&st, 1));
+    CHECK_INT(st.failed_mask, 0);
+    CHECK_INT(st.pending, 1);
+    // Going back to the committed profile cancels the trial
+    CHECK(clock_profile_request(&st, 0));
+    CHECK_INT(st.pending, CLOCK_PROFILE_NONE);
+    CHECK(!clock_profile_request(&st, 0));
+    CHECK(!clock_profile_request(&st, CLOCK_PROFILE_COUNT));
+}
+
+static void test_ini_override(void) {
+    clock_profile_state_t st;
+    erase();
+    boot(&st);
+    CHECK(clock_profile_request_ini(&st, 2));
+    CHECK_INT(st.pending, 2);
+    CHECK_INT(st.ini_seen, 2);
+    store(&st);
+    CHECK_INT(boot(&st), 2);
+    clock_profile_on_selftest(&st, false);
+    store(&st);
+
+    // The same INI value is not retried on every boot after it failed
+    CHECK_INT(boot(&st), 0);
+    CHECK(!clock_profile_request_ini(&st, 2));
+    CHECK_INT(st.pending, CLOCK_PROFILE_NONE);
+    // A changed value is acted on
+    CHECK(clock_profile_request_ini(&st, 1));
+    CHECK_INT(st.pending, 1);
+    CHECK(!clock_profile_request_ini(&st, CLOCK_PROFILE_NONE));
+    CHECK_INT(st.ini_seen, 1);
+
+    // The INI naming the running profile needs no reboot
+    clock_profile_state_init(&st, 0);
+    CHECK(!clock_profile_request_ini(&st, 0));
+    CHECK_INT(st.ini_seen, 0);
+}
+
+int main(void) {
+    TEST_RUN(test_table);
+    TEST_RUN(test_erased_page);
+    TEST_RUN(test_record);
+    TEST_RUN(test_trial_passes);
+    TEST_RUN(test_watchdog_reset);
+    TEST_RUN(test_selftest_fails);
+    TEST_RUN(test_ini_override);
+    return test_finish();
+}
@@ -0,0 +1,159 @@
+/*
+ * murmprince - crash record and log tail tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "crash_record.h"
+#include "test.h"
+
+static crash_info_t make_info(crash_reason_t reason, uint8_t core, uint32_t pc, uint32_t lr, uint32_t sp) {
+    crash_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.reason = reason;
+    info.core = core;
+    info.pc = pc;
+    info.lr = lr;
+    info.sp = sp;
+    return info;
+}
+
+static void test_round_trip(void) {
+    static const crash_reason_t reasons[] = {
+        CRASH_REASON_HARDFAULT, CRASH_REASON_WATCHDOG, CRASH_REASON_AUDIO_STALL,
+    };
+    static const uint32_t values[][3] = {
+        { 0x10001234u, 0x10005679u, 0x20081F00u },
+        { 0, 0, 0 },
+        { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu },
+        { 0x80000000u, 0x00000001u, 0x55AA55AAu },
+    };
+    for (size_t r = 0; r < sizeof(reasons) / sizeof(reasons[0]); ++r) {
+        for (uint8_t core = 0; core < 2; ++core) {
+            for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); ++v) {
+                const crash_info_t in = make_info(reasons[r], core, values[v][0], values[v][1], values[v][2]);
+                uint32_t words[CRASH_RECORD_WORDS];
+                crash_record_encode(&in, words);
+
+                crash_info_t out;
+                memset(&out, 0xEE, sizeof(out));
+                CHECK(crash_record_decode(words, &out));
+                CHECK_INT(out.reason, in.reason);
+                CHECK_INT(out.core, core);
+                CHECK(out.pc == in.pc && out.lr == in.lr && out.sp == in.sp);
+                // Not in the record: cleared, filled in from the tail later
+                CHECK(out.cfsr == 0 && out.last_feed_ms == 0 && out.tail[0] == '\0');
+            }
+        }
+    }
+}
+
+static void test_rejects(void) {
+    crash_info_t out = make_info(CRASH_REASON_WATCHDOG, 1, 1, 2, 3);
+    const crash_info_t before = out;
+
+    // Power-on: the scratch registers read back as zero
+    const uint32_t zero[CRASH_RECORD_WORDS] = { 0 };
+    CHECK(!crash_record_decode(zero, &out));
+
+    const crash_info_t in = make_info(CRASH_REASON_HARDFAULT, 0, 0x10000100u, 0x10000201u, 0x20082000u);
+    uint32_t good[CRASH_RECORD_WORDS], words[CRASH_RECORD_WORDS];
+    crash_record_encode(&in, good);
+
+    // Bad magic
+    memcpy(words, good, sizeof(words));
+    words[0] ^= 0x00010000u;
+    CHECK(!crash_record_decode(words, &out));
+    // Any single flipped bit outside the magic fails the checksum
+    for (int w = 0; w < CRASH_RECORD_WORDS; ++w) {
+        for (int bit = 0; bit < (w == 0 ? 16 : 32); ++bit) {
+            memcpy(words, good, sizeof(words));
+            words[w] ^= 1u << bit;
+            if (crash_record_decode(words, &out)) {
+                printf("  word %d bit %d: accepted\n", w, bit);
+                CHECK(false);
+            }
+        }
+    }
+    // A valid checksum over an unknown reason
+    crash_info_t odd = in;
+    odd.reason = CRASH_REASON_NONE;
+    crash_record_encode(&odd, words);
+    CHECK(!crash_record_decode(words, &out));
+    odd.reason = (crash_reason_t)9;
+    crash_record_encode(&odd, words);
+    CHECK(!crash_record_decode(words, &out));
+
+    // A rejected record leaves the output alone
+    CHECK(!memcmp(&out, &before, sizeof(out)));
+}
+
+static void test_scratch_layout(void) {
+    // crash_guard.c keeps the record in scratch[0 .. CRASH_RECORD_WORDS-1];
+    // the boot ROM owns the rest
+    CHECK(CRASH_RECORD_WORDS <= CRASH_RECORD_SCRATCH_FREE);
+
+    // Word 0: magic, reason and core do not run into the checksum byte,
+    // and bits 8..10 stay clear
+    const crash_info_t in = make_info(CRASH_REASON_AUDIO_STALL, 1, 0, 0, 0);
+    uint32_t words[CRASH_RECORD_WORDS];
+    crash_record_encode(&in, words);
+    CHECK_INT(words[0] >> 16, 0xC4A5);
+    CHECK_INT((words[0] >> 12) & 0xF, CRASH_REASON_AUDIO_STALL);
+    CHECK_INT((words[0] >> 11) & 1, 1);
+    CHECK_INT((words[0] >> 8) & 7, 0);
+    CHECK(CRASH_REASON_AUDIO_STALL <= 0xF);
+}
+
+static void test_tail(void) {
+    crash_tail_t tail;
+    char out[CRASH_TAIL_SIZE + 1];
+    crash_tail_reset(&tail);
+    CHECK(crash_tail_read(&tail, out, sizeof(out)));
+    CHECK_STR(out, "");
+    crash_tail_append(&tail, "boot");
+    crash_tail_append(&tail, "start");
+    CHECK(crash_tail_read(&tail, out, sizeof(out)));
+    CHECK_STR(out, "boot,start");
+
+    // Wraps: the newest bytes survive, oldest first
+    for (int i = 0; i < 40; ++i) crash_tail_append(&tail, "level 3");
+    crash_tail_append(&tail, "quit");
+    CHECK(crash_tail_read(&tail, out, sizeof(out)));
+    CHECK_INT(strlen(out), CRASH_TAIL_SIZE - 1);
+    CHECK_STR(out + strlen(out) - 12, "level 3,quit");
+
+    // Garbage after a power-on
+    tail.buf[5] ^= 1;
+    CHECK(!crash_tail_read(&tail, out, sizeof(out)));
+    CHECK_STR(out, "");
+    memset(&tail, 0xA5, sizeof(tail));
+    CHECK(!crash_tail_read(&tail, out, sizeof(out)));
+}
+
+static void test_format(void) {
+    char l1[48], l2[48];
+    crash_info_t info = make_info(CRASH_REASON_HARDFAULT, 1, 0x1000ABCDu, 0x10001235u, 0);
+    strcpy(info.tail, "boot,start,level 1,level 2");
+    crash_info_format(&info, l1, l2, sizeof(l1));
+    CHECK_STR(l1, "CRASH: HardFault core 1 PC 1000ABCD LR 10001235");
+    CHECK_STR(l2, "Last: boot,start,level 1,level 2");
+
+    info.reason = CRASH_REASON_WATCHDOG;
+    info.last_feed_ms = 12345;
+    strcpy(info.tail, "boot,start,level 1,level 2,level 3,level 4,level 5");
+    crash_info_format(&info, l1, l2, sizeof(l1));
+    CHECK_STR(l1, "CRASH: hang at 12.3s (watchdog reset)");
+    // The newest breadcrumbs that fit
+    CHECK_INT(strlen(l2), sizeof(l2) - 1);
+    CHECK_STR(l2 + strlen(l2) - 7, "level 5");
+}
+
+int main(void) {
+    TEST_RUN(test_round_trip);
+    TEST_RUN(test_rejects);
+    TEST_RUN(test_scratch_layout);
+    TEST_RUN(test_tail);
+    TEST_RUN(test_format);
+    return test_finish();
+}
@@ -0,0 +1,159 @@
+/*
+ * murmprince - USB HID device table tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "usbhid/hid_devices.h"
+#include "fixtures/hid_keyboards.h"
+#include "test.h"
+
+#define KEY_A 0x04
+#define KEY_B 0x05
+#define KEY_LSHIFT 0xE1
+
+// What the game sees: merged key state and how many events made it
+typedef struct {
+    bool down[256];
+    int presses;
+    int releases;
+} game_keys_t;
+
+static void game_key(void *ctx, uint8_t usage, bool down) {
+    game_keys_t *g = (game_keys_t *)ctx;
+    // Merged events never repeat a state
+    CHECK(g->down[usage] != down);
+    g->down[usage] = down;
+    if (down) ++g->presses;
+    else ++g->releases;
+}
+
+static hid_device_t *mount_keyboard(hid_devices_t *d, uint8_t addr, uint8_t instance,
+                                    const uint8_t *desc, size_t len) {
+    hid_device_t *dev = hid_devices_mount(d, addr, instance);
+    if (!dev) return NULL;
+    dev->is_keyboard = hid_kbd_parse_descriptor(&dev->kbd, desc, len);
+    return dev;
+}
+
+static void test_two_keyboards_hold_a_key(void) {
+    hid_devices_t d;
+    game_keys_t g = {0};
+    hid_devices_init(&d, game_key, &g);
+    // Behind a hub both keyboards have instance 0
+    hid_device_t *k1 = mount_keyboard(&d, 1, 0, hid_desc_boot, sizeof(hid_desc_boot));
+    hid_device_t *k2 = mount_keyboard(&d, 2, 0, hid_desc_composite, sizeof(hid_desc_composite));
+    CHECK(k1 && k2 && k1 != k2);
+    CHECK_INT(hid_devices_keyboard_count(&d), 2);
+    CHECK(hid_devices_find(&d, 2, 0) == k2);
+
+    const uint8_t a1[8] = {0, 0, KEY_A};
+    const uint8_t a2[9] = {1, 0, 0, KEY_A};
+    const uint8_t none2[9] = {1};
+    hid_devices_keyboard_report(&d, k1, a1, sizeof(a1));
+    hid_devices_keyboard_report(&d, k2, a2, sizeof(a2));
+    CHECK_INT(g.presses, 1);
+    hid_devices_keyboard_report(&d, k2, none2, sizeof(none2));
+    CHECK_INT(g.releases, 0);
+    CHECK(g.down[KEY_A]);
+
+    // Unplugging the keyboard that still holds A releases it
+    hid_devices_unmount(&d, 1, 0);
+    CHECK(!g.down[KEY_A]);
+    CHECK_INT(g.releases, 1);
+    CHECK_INT(hid_devices_keyboard_count(&d), 1);
+    CHECK(hid_devices_find(&d, 1, 0) == NULL);
+}
+
+static void test_unplug_keeps_other_keys(void) {
+    hid_devices_t d;
+    game_keys_t g = {0};
+    hid_devices_init(&d, game_key, &g);
+    hid_device_t *k1 = mount_keyboard(&d, 1, 0, hid_desc_boot, sizeof(hid_desc_boot));
+    hid_device_t *k2 = mount_keyboard(&d, 3, 1, hid_desc_nkro, sizeof(hid_desc_nkro));
+
+    const uint8_t shift_a[8] = {0x02, 0, KEY_A};
+    uint8_t bitmap[15] = {4};
+    bitmap[2 + KEY_B / 8] |= 1u << (KEY_B % 8);
+    bitmap[1] = 0x02; // LShift on this one too
+    hid_devices_keyboard_report(&d, k1, shift_a, sizeof(shift_a));
+    hid_devices_keyboard_report(&d, k2, bitmap, sizeof(bitmap));
+    CHECK_INT(g.presses, 3);
+
+    hid_kbd_keys_t held;
+    hid_devices_held_keys(&d, &held);
+    CHECK(hid_kbd_key_held(&held, KEY_A));
+    CHECK(hid_kbd_key_held(&held, KEY_B));
+    CHECK(hid_kbd_key_held(&held, KEY_LSHIFT));
+
+    hid_devices_unmount_all(&d, 3);
+    CHECK(g.down[KEY_A]);
+    CHECK(!g.down[KEY_B]);
+    CHECK(g.down[KEY_LSHIFT]);
+    hid_devices_unmount_all(&d, 1);
+    CHECK_INT(g.presses, g.releases);
+    CHECK_INT(hid_devices_keyboard_count(&d), 0);
+}
+
+static void test_composite_device(void) {
+    hid_devices_t d;
+    game_keys_t g = {0};
+    hid_devices_init(&d, game_key, &g);
+    // One device, keyboard on instance 0 and mouse on instance 1
+    hid_device_t *kbd = mount_keyboard(&d, 5, 0, hid_desc_boot, sizeof(hid_desc_boot));
+    hid_device_t *mouse = hid_devices_mount(&d, 5, 1);
+    CHECK(!hid_kbd_parse_descriptor(&mouse->kbd, hid_desc_mouse, sizeof(hid_desc_mouse)));
+    mouse->is_mouse = 1;
+    mouse->mouse_buttons = 0x01;
+    hid_device_t *mouse2 = hid_devices_mount(&d, 6, 0);
+    mouse2->is_mouse = 1;
+    mouse2->mouse_buttons = 0x04;
+    CHECK_INT(hid_devices_mouse_count(&d), 2);
+    CHECK_INT(hid_devices_mouse_buttons(&d), 0x05);
+
+    const uint8_t a[8] = {0, 0, KEY_A};
+    hid_devices_keyboard_report(&d, kbd, a, sizeof(a));
+    hid_devices_unmount_all(&d, 5);
+    CHECK(!g.down[KEY_A]);
+    CHECK_INT(hid_devices_mouse_count(&d), 1);
+    CHECK_INT(hid_devices_mouse_buttons(&d), 0x04);
+}
+
+static void test_remount_same_address(void) {
+    hid_devices_t d;
+    game_keys_t g = {0};
+    hid_devices_init(&d, game_key, &g);
+    hid_device_t *k = mount_keyboard(&d, 1, 0, hid_desc_boot, sizeof(hid_desc_boot));
+    const uint8_t a[8] = {0, 0, KEY_A};
+    hid_devices_keyboard_report(&d, k, a, sizeof(a));
+
+    // The unmount was missed and the address handed out again
+    hid_device_t *again = mount_keyboard(&d, 1, 0, hid_desc_boot, sizeof(hid_desc_boot));
+    CHECK(again == k);
+    CHECK(!g.down[KEY_A]);
+    CHECK_INT(hid_devices_keyboard_count(&d), 1);
+}
+
+static void test_table_full(void) {
+    hid_devices_t d;
+    game_keys_t g = {0};
+    hid_devices_init(&d, game_key, &g);
+    for (int i = 0; i < HID_DEVICES_MAX; ++i) {
+        CHECK(mount_keyboard(&d, (uint8_t)(i + 1), 0, hid_desc_boot, sizeof(hid_desc_boot)) != NULL);
+    }
+    CHECK(hid_devices_mount(&d, 100, 0) == NULL);
+    hid_devices_unmount(&d, 4, 0);
+    CHECK(hid_devices_mount(&d, 100, 0) != NULL);
+    // Unknown interfaces are ignored
+    hid_devices_unmount(&d, 42, 0);
+    CHECK_INT(hid_devices_keyboard_count(&d), HID_DEVICES_MAX - 1);
+}
+
+int main(void) {
+    TEST_RUN(test_two_keyboards_hold_a_key);
+    TEST_RUN(test_unplug_keeps_other_keys);
+    TEST_RUN(test_composite_device);
+    TEST_RUN(test_remount_same_address);
+    TEST_RUN(test_table_full);
+    return test_finish();
+}
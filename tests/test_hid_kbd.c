@@ -0,0 +1,228 @@
+/*
+ * murmprince - USB keyboard report parsing tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "usbhid/hid_kbd.h"
+#include "fixtures/hid_keyboards.h"
+#include "test.h"
+
+#define KEY_A 0x04
+#define KEY_B 0x05
+#define KEY_R 0x15
+#define KEY_LCTRL 0xE0
+#define KEY_LSHIFT 0xE1
+
+typedef struct {
+    int count;
+    uint8_t usage[64];
+    bool down[64];
+} changes_t;
+
+static void record(void *ctx, uint8_t usage, bool down) {
+    changes_t *c = (changes_t *)ctx;
+    if (c->count < 64) {
+        c->usage[c->count] = usage;
+        c->down[c->count] = down;
+    }
+    ++c->count;
+}
+
+static hid_kbd_result_t apply(const hid_kbd_layout_t *layout, hid_kbd_state_t *state,
+                              const uint8_t *report, size_t len, changes_t *c) {
+    memset(c, 0, sizeof(*c));
+    return hid_kbd_apply(layout, state, report, len, record, c);
+}
+
+static void test_boot_descriptor(void) {
+    hid_kbd_layout_t layout, boot;
+    CHECK(hid_kbd_parse_descriptor(&layout, hid_desc_boot, sizeof(hid_desc_boot)));
+    CHECK_INT(layout.uses_report_ids, 0);
+    CHECK_INT(layout.report_count, 1);
+    const hid_kbd_report_layout_t *r = &layout.reports[0];
+    CHECK_INT(r->min_len, 8);
+    CHECK_INT(r->field_count, 2);
+    CHECK_INT(r->fields[0].bit_offset, 0);
+    CHECK_INT(r->fields[0].is_array, 0);
+    CHECK_INT(r->fields[0].usage_min, KEY_LCTRL);
+    CHECK_INT(r->fields[1].bit_offset, 16);
+    CHECK_INT(r->fields[1].is_array, 1);
+    CHECK_INT(r->fields[1].count, 6);
+    CHECK_INT(r->fields[1].logical_max, 0x65);
+
+    // Decodes like the fixed boot layout
+    hid_kbd_layout_boot(&boot);
+    const uint8_t report[8] = {0x22, 0, KEY_A, 0x65, KEY_B, 0, 0, 0};
+    hid_kbd_keys_t a, b;
+    int index = -1;
+    CHECK_INT(hid_kbd_decode(&layout, report, 8, &a, &index), HID_KBD_CHANGED);
+    CHECK_INT(index, 0);
+    CHECK_INT(hid_kbd_decode(&boot, report, 8, &b, &index), HID_KBD_CHANGED);
+    CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+    CHECK(hid_kbd_key_held(&a, KEY_LSHIFT));
+    CHECK(hid_kbd_key_held(&a, 0xE5)); // RShift
+    CHECK(hid_kbd_key_held(&a, 0x65));
+    CHECK(!hid_kbd_key_held(&a, KEY_LCTRL));
+}
+
+static void test_boot_apply(void) {
+    hid_kbd_layout_t layout;
+    hid_kbd_state_t state;
+    changes_t c;
+    memset(&state, 0, sizeof(state));
+    hid_kbd_parse_descriptor(&layout, hid_desc_boot, sizeof(hid_desc_boot));
+
+    // Ctrl+R in one report: Ctrl first
+    const uint8_t ctrl_r[8] = {0x01, 0, KEY_R, 0, 0, 0, 0, 0};
+    CHECK_INT(apply(&layout, &state, ctrl_r, 8, &c), HID_KBD_CHANGED);
+    CHECK_INT(c.count, 2);
+    CHECK_INT(c.usage[0], KEY_LCTRL);
+    CHECK(c.down[0]);
+    CHECK_INT(c.usage[1], KEY_R);
+
+    // Same report again: nothing
+    CHECK_INT(apply(&layout, &state, ctrl_r, 8, &c), HID_KBD_CHANGED);
+    CHECK_INT(c.count, 0);
+
+    // R moves to another slot and A joins: only A is new
+    const uint8_t ctrl_a_r[8] = {0x01, 0, KEY_A, KEY_R, 0, 0, 0, 0};
+    apply(&layout, &state, ctrl_a_r, 8, &c);
+    CHECK_INT(c.count, 1);
+    CHECK_INT(c.usage[0], KEY_A);
+
+    // Ctrl up and B down: the release comes first
+    const uint8_t b_only[8] = {0, 0, KEY_B, 0, 0, 0, 0, 0};
+    apply(&layout, &state, b_only, 8, &c);
+    CHECK_INT(c.count, 4);
+    CHECK(!c.down[0] && !c.down[1] && !c.down[2]);
+    CHECK_INT(c.usage[3], KEY_B);
+    CHECK(c.down[3]);
+
+    // Too many keys: every slot says rollover, the state stays
+    const uint8_t rollover[8] = {0, 0, 1, 1, 1, 1, 1, 1};
+    CHECK_INT(apply(&layout, &state, rollover, 8, &c), HID_KBD_ROLLOVER);
+    CHECK_INT(c.count, 0);
+    CHECK(hid_kbd_key_held(&state.held, KEY_B));
+
+    // Short report: ignored
+    CHECK_INT(apply(&layout, &state, b_only, 7, &c), HID_KBD_SHORT);
+
+    hid_kbd_release_all(&state, record, &c);
+    CHECK_INT(c.count, 1);
+    CHECK_INT(c.usage[0], KEY_B);
+    CHECK(!c.down[0]);
+}
+
+static void test_logical_max_ff(void) {
+    hid_kbd_layout_t layout;
+    CHECK(hid_kbd_parse_descriptor(&layout, hid_desc_boot_ff, sizeof(hid_desc_boot_ff)));
+    CHECK_INT(layout.reports[0].fields[1].logical_max, 255);
+    const uint8_t report[8] = {0, 0, 0xC0, KEY_A, 0, 0, 0, 0};
+    hid_kbd_keys_t keys;
+    int index;
+    CHECK_INT(hid_kbd_decode(&layout, report, 8, &keys, &index), HID_KBD_CHANGED);
+    CHECK(hid_kbd_key_held(&keys, KEY_A));
+    CHECK(hid_kbd_key_held(&keys, 0xC0));
+}
+
+static void test_composite(void) {
+    hid_kbd_layout_t layout;
+    hid_kbd_state_t state;
+    changes_t c;
+    memset(&state, 0, sizeof(state));
+    CHECK(hid_kbd_parse_descriptor(&layout, hid_desc_composite, sizeof(hid_desc_composite)));
+    CHECK_INT(layout.uses_report_ids, 1);
+    CHECK_INT(layout.report_count, 1);
+    CHECK_INT(layout.reports[0].report_id, 1);
+    CHECK_INT(layout.reports[0].min_len, 8);
+
+    const uint8_t key[9] = {1, 0, 0, KEY_A, 0, 0, 0, 0, 0};
+    CHECK_INT(apply(&layout, &state, key, 9, &c), HID_KBD_CHANGED);
+    CHECK_INT(c.count, 1);
+    CHECK_INT(c.usage[0], KEY_A);
+
+    // Volume up and a system sleep leave the keys alone
+    const uint8_t volume[3] = {2, 0xE9, 0x00};
+    const uint8_t sleep[2] = {3, 0x02};
+    CHECK_INT(apply(&layout, &state, volume, 3, &c), HID_KBD_NOT_KEYBOARD);
+    CHECK_INT(apply(&layout, &state, sleep, 2, &c), HID_KBD_NOT_KEYBOARD);
+    CHECK_INT(c.count, 0);
+    CHECK(hid_kbd_key_held(&state.held, KEY_A));
+
+    // Report ID plus 7 bytes is short
+    CHECK_INT(apply(&layout, &state, key, 8, &c), HID_KBD_SHORT);
+    CHECK_INT(apply(&layout, &state, key, 0, &c), HID_KBD_NOT_KEYBOARD);
+}
+
+static void test_nkro(void) {
+    hid_kbd_layout_t layout;
+    hid_kbd_state_t state;
+    changes_t c;
+    memset(&state, 0, sizeof(state));
+    CHECK(hid_kbd_parse_descriptor(&layout, hid_desc_nkro, sizeof(hid_desc_nkro)));
+    CHECK_INT(layout.report_count, 2);
+    CHECK_INT(layout.reports[1].report_id, 4);
+    CHECK_INT(layout.reports[1].min_len, 1 + 13);
+    CHECK_INT(layout.reports[1].fields[1].count, 0x68);
+
+    // Ten letters at once through the bitmap
+    uint8_t bitmap[15] = {4};
+    for (int usage = KEY_A; usage < KEY_A + 10; ++usage) bitmap[2 + usage / 8] |= 1u << (usage % 8);
+    CHECK_INT(apply(&layout, &state, bitmap, sizeof(bitmap), &c), HID_KBD_CHANGED);
+    CHECK_INT(c.count, 10);
+    for (int usage = KEY_A; usage < KEY_A + 10; ++usage) {
+        CHECK(hid_kbd_key_held(&state.held, (uint8_t)usage));
+    }
+
+    // The array report holds R; emptying it keeps the bitmap's keys
+    const uint8_t array_r[9] = {1, 0, 0, KEY_R, 0, 0, 0, 0, 0};
+    const uint8_t array_none[9] = {1};
+    apply(&layout, &state, array_r, 9, &c);
+    CHECK_INT(c.count, 1);
+    apply(&layout, &state, array_none, 9, &c);
+    CHECK_INT(c.count, 1);
+    CHECK(!c.down[0]);
+    CHECK(hid_kbd_key_held(&state.held, KEY_A));
+
+    // A key held in both reports is released only when both let go
+    apply(&layout, &state, (const uint8_t[9]){1, 0, 0, KEY_A}, 9, &c);
+    CHECK_INT(c.count, 0);
+    const uint8_t bitmap_none[15] = {4};
+    apply(&layout, &state, bitmap_none, sizeof(bitmap_none), &c);
+    CHECK_INT(c.count, 9);
+    CHECK(hid_kbd_key_held(&state.held, KEY_A));
+}
+
+static void test_mouse(void) {
+    hid_kbd_layout_t layout;
+    CHECK(!hid_kbd_parse_descriptor(&layout, hid_desc_mouse, sizeof(hid_desc_mouse)));
+    CHECK_INT(layout.report_count, 0);
+}
+
+static void test_truncated(void) {
+    // Every cut of a descriptor parses without reading past it
+    const struct { const uint8_t *desc; size_t len; } all[] = {
+        {hid_desc_boot, sizeof(hid_desc_boot)},
+        {hid_desc_composite, sizeof(hid_desc_composite)},
+        {hid_desc_nkro, sizeof(hid_desc_nkro)},
+    };
+    for (size_t d = 0; d < sizeof(all) / sizeof(all[0]); ++d) {
+        for (size_t len = 0; len <= all[d].len; ++len) {
+            hid_kbd_layout_t layout;
+            hid_kbd_parse_descriptor(&layout, all[d].desc, len);
+            CHECK(layout.report_count <= HID_KBD_MAX_REPORTS);
+        }
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_boot_descriptor);
+    TEST_RUN(test_boot_apply);
+    TEST_RUN(test_logical_max_ff);
+    TEST_RUN(test_composite);
+    TEST_RUN(test_nkro);
+    TEST_RUN(test_mouse);
+    TEST_RUN(test_truncated);
+    return test_finish();
+}
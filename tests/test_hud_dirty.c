@@ -0,0 +1,145 @@
+/*
+ * murmprince - HUD strip dirty tracking tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "hud_dirty.h"
+#include "test.h"
+
+static hud_dirty_t hud;
+
+static void fresh(void) {
+    hud_dirty_init(&hud);
+    hud_dirty_frame_done(&hud);
+}
+
+static void check_rect(int i, int x, int y, int w, int h) {
+    CHECK_INT(hud.rects[i].x, x);
+    CHECK_INT(hud.rects[i].y, y);
+    CHECK_INT(hud.rects[i].w, w);
+    CHECK_INT(hud.rects[i].h, h);
+}
+
+static void test_track(void) {
+    hud_dirty_init(&hud);
+    CHECK(hud.all);
+    hud_dirty_track(&hud, 10, 194, 4, 4);
+    CHECK_INT(hud.count, 0);                // everything is dirty anyway
+    hud_dirty_frame_done(&hud);
+    CHECK(!hud.all);
+
+    // Above the strip: ignored; straddling: cut to the strip
+    hud_dirty_track(&hud, 0, 100, 50, 92);
+    CHECK_INT(hud.count, 0);
+    hud_dirty_track(&hud, 20, 188, 10, 10);
+    CHECK_INT(hud.count, 1);
+    check_rect(0, 20, 192, 10, 6);
+    // Off the left, right and bottom edges
+    hud_dirty_track(&hud, -5, 196, 10, 10);
+    check_rect(1, 0, 196, 5, 4);
+    hud_dirty_track(&hud, 316, 192, 10, 8);
+    check_rect(2, 316, 192, 4, 8);
+    CHECK_INT(hud.count, 3);
+    // Nothing left after clipping
+    hud_dirty_track(&hud, 320, 192, 4, 4);
+    hud_dirty_track(&hud, -4, 192, 4, 4);
+    CHECK_INT(hud.count, 3);
+}
+
+static void test_merge(void) {
+    fresh();
+    // Overlapping and touching rects merge into their union
+    hud_dirty_track(&hud, 10, 192, 5, 8);
+    hud_dirty_track(&hud, 13, 194, 5, 2);
+    CHECK_INT(hud.count, 1);
+    check_rect(0, 10, 192, 8, 8);
+    hud_dirty_track(&hud, 18, 192, 3, 8);   // touching on the right
+    CHECK_INT(hud.count, 1);
+    check_rect(0, 10, 192, 11, 8);
+    hud_dirty_track(&hud, 22, 192, 3, 8);   // one column apart
+    CHECK_INT(hud.count, 2);
+
+    // A 17th separate rect gives up on the list
+    fresh();
+    for (int i = 0; i < HUD_DIRTY_MAX_RECTS; ++i) hud_dirty_track(&hud, i * 10, 192, 5, 8);
+    CHECK_INT(hud.count, HUD_DIRTY_MAX_RECTS);
+    CHECK(!hud.all);
+    hud_dirty_track(&hud, 300, 192, 5, 8);
+    CHECK(hud.all);
+    hud_dirty_frame_done(&hud);
+    CHECK_INT(hud.count, 0);
+    CHECK(!hud.all);
+}
+
+// The HP row as seg000.c draws it: triangles 7 pixels apart from x = 314 leftwards.
+static const char full_hp[] = "full", empty_hp[] = "empty";
+
+static int draw_hp(int hp, int max_hp) {
+    int drawn = 0;
+    for (int i = 0; i < max_hp; ++i) {
+        const bool full = i < hp;
+        if (!hud_dirty_cell_unchanged(&hud, full ? full_hp : empty_hp, 314 - i * 7, 194, 7, 5, full ? 0 : 9)) {
+            ++drawn;
+        }
+    }
+    return drawn;
+}
+
+static void test_cells(void) {
+    fresh();
+    CHECK_INT(draw_hp(3, 5), 5);
+    CHECK_INT(hud.count, 1);                // adjacent cells coalesce
+    check_rect(0, 286, 194, 34, 5);
+    hud_dirty_frame_done(&hud);
+
+    // Same HP next frame: nothing drawn, nothing to present
+    CHECK_INT(draw_hp(3, 5), 0);
+    CHECK_INT(hud.count, 0);
+    CHECK_INT((int)hud.cells_skipped, 5);
+
+    // Losing a point redraws one cell, the masked empty one in its place;
+    // its neighbours are left alone
+    CHECK_INT(draw_hp(2, 5), 1);
+    CHECK_INT(hud.count, 1);
+    check_rect(0, 300, 194, 7, 5);
+    hud_dirty_frame_done(&hud);
+
+    // Same image, another blitter or height: not the same cell
+    CHECK(!hud_dirty_cell_unchanged(&hud, full_hp, 314, 194, 7, 5, 9));
+    CHECK(!hud_dirty_cell_unchanged(&hud, full_hp, 314, 195, 7, 5, 9));
+    CHECK(hud_dirty_cell_unchanged(&hud, full_hp, 314, 195, 7, 5, 9));
+}
+
+static void test_forget(void) {
+    fresh();
+    draw_hp(5, 5);
+    hud_dirty_frame_done(&hud);
+
+    // A text line over x 303..319 reaches three cells (300..306 too)
+    hud_dirty_track(&hud, 303, 192, 17, 8);
+    hud_dirty_frame_done(&hud);
+    CHECK_INT(draw_hp(5, 5), 3);
+
+    // A write that ends just left of a cell keeps it; one column in forgets it
+    hud_dirty_frame_done(&hud);
+    hud_dirty_track(&hud, 280, 192, 6, 8);  // up to x 285, cell at 286
+    CHECK_INT(draw_hp(5, 5), 0);
+    hud_dirty_track(&hud, 280, 192, 7, 8);
+    CHECK_INT(draw_hp(5, 5), 1);
+
+    // A write above the strip never touches the cells
+    hud_dirty_track(&hud, 280, 100, 40, 92);
+    CHECK_INT(draw_hp(5, 5), 0);
+
+    hud_dirty_reset_cells(&hud);
+    CHECK_INT(draw_hp(5, 5), 5);
+}
+
+int main(void) {
+    TEST_RUN(test_track);
+    TEST_RUN(test_merge);
+    TEST_RUN(test_cells);
+    TEST_RUN(test_forget);
+    return test_finish();
+}
@@ -0,0 +1,243 @@
+/*
+ * murmprince - key bindings tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "key_bindings.h"
+#include "pop_fs.h"
+#include "ram_disk.h"
+#include "test.h"
+
+// SDL scancodes and modifiers
+#define SC_A 4
+#define SC_D 7
+#define SC_R 21
+#define SC_ESCAPE 41
+#define SC_SPACE 44
+#define SC_F5 62
+#define SC_RIGHT 79
+#define SC_LEFT 80
+#define SC_DOWN 81
+#define SC_UP 82
+#define SC_KP_4 92
+#define SC_LCTRL 224
+#define SC_LSHIFT 225
+#define SC_LALT 226
+#define SC_RCTRL 228
+#define SC_RSHIFT 229
+#define SC_RALT 230
+#define MOD_LSHIFT 0x0001
+#define MOD_LCTRL 0x0040
+#define MOD_RCTRL 0x0080
+#define MOD_LALT 0x0100
+
+static void test_defaults(void) {
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    CHECK_INT(key_bindings_action_of(&kb, SC_LEFT), KEY_ACTION_LEFT);
+    CHECK_INT(key_bindings_action_of(&kb, SC_RSHIFT), KEY_ACTION_SHIFT);
+    CHECK_INT(key_bindings_action_of(&kb, SC_ESCAPE), KEY_ACTION_PAUSE);
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_SHIFT), 2);
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_RESTART), 0);
+    CHECK(!key_bindings_find_conflict(&kb, NULL, NULL, NULL));
+}
+
+static void test_resolve(void) {
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    CHECK(key_bindings_add(&kb, KEY_ACTION_LEFT, SC_A));
+    CHECK(key_bindings_add(&kb, KEY_ACTION_RESTART, SC_F5));
+    int sc, mod;
+
+    // A bound key becomes the action's own key
+    CHECK(key_bindings_resolve(&kb, SC_A, 0, &sc, &mod));
+    CHECK_INT(sc, SC_LEFT);
+    CHECK_INT(mod, 0);
+    CHECK(key_bindings_resolve(&kb, SC_F5, 0, &sc, &mod));
+    CHECK_INT(sc, SC_R);
+    CHECK_INT(mod, MOD_LCTRL);
+
+    // Unbound keys pass, unbound stock keys of an action are swallowed
+    CHECK(key_bindings_resolve(&kb, SC_SPACE, MOD_LSHIFT, &sc, &mod));
+    CHECK_INT(sc, SC_SPACE);
+    CHECK_INT(mod, 0);
+    CHECK(!key_bindings_resolve(&kb, SC_KP_4, 0, &sc, &mod));
+    key_bindings_remove(&kb, KEY_ACTION_UP, SC_UP);
+    CHECK(!key_bindings_resolve(&kb, SC_UP, 0, &sc, &mod));
+}
+
+static void test_resolve_held_mod(void) {
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    CHECK(key_bindings_add(&kb, KEY_ACTION_LEFT, SC_A));
+    key_bindings_remove(&kb, KEY_ACTION_UP, SC_UP);
+    int sc, mod;
+
+    // Ctrl+A is Ctrl+A, not Ctrl+Left
+    CHECK(key_bindings_resolve(&kb, SC_A, MOD_LCTRL, &sc, &mod));
+    CHECK_INT(sc, SC_A);
+    CHECK_INT(mod, 0);
+    CHECK(key_bindings_resolve(&kb, SC_A, MOD_RCTRL, &sc, &mod));
+    CHECK_INT(sc, SC_A);
+    CHECK(key_bindings_resolve(&kb, SC_A, MOD_LALT, &sc, &mod));
+    CHECK_INT(sc, SC_A);
+    // Not swallowed either while a shortcut modifier is down
+    CHECK(key_bindings_resolve(&kb, SC_UP, MOD_LALT, &sc, &mod));
+    CHECK_INT(sc, SC_UP);
+    // Shift is an action key, not a shortcut modifier
+    CHECK(key_bindings_resolve(&kb, SC_A, MOD_LSHIFT, &sc, &mod));
+    CHECK_INT(sc, SC_LEFT);
+}
+
+static void test_bindable(void) {
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        CHECK(!key_bindings_bindable((key_action_t)a, SC_LCTRL));
+        CHECK(!key_bindings_bindable((key_action_t)a, SC_RCTRL));
+        CHECK(!key_bindings_bindable((key_action_t)a, SC_LALT));
+        CHECK(!key_bindings_bindable((key_action_t)a, SC_RALT));
+        CHECK(key_bindings_bindable((key_action_t)a, SC_LSHIFT));
+        CHECK(key_bindings_bindable((key_action_t)a, SC_D));
+        CHECK_INT(key_bindings_bindable((key_action_t)a, SC_ESCAPE), a == KEY_ACTION_PAUSE);
+    }
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_SHIFT, SC_LCTRL));
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_LEFT, SC_ESCAPE));
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_LEFT, SC_LEFT)); // already bound
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_LEFT, 0));
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_LEFT, 512));
+}
+
+static void test_full_action(void) {
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    for (int i = 1; i < KEY_BINDINGS_PER_ACTION; ++i) {
+        CHECK(key_bindings_add(&kb, KEY_ACTION_LEFT, SC_A + i));
+    }
+    CHECK(!key_bindings_add(&kb, KEY_ACTION_LEFT, SC_SPACE));
+    CHECK(key_bindings_remove_last(&kb, KEY_ACTION_LEFT));
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_LEFT), KEY_BINDINGS_PER_ACTION - 1);
+    // Removing from the middle keeps the list packed
+    key_bindings_remove(&kb, KEY_ACTION_LEFT, SC_LEFT);
+    CHECK_INT(kb.keys[KEY_ACTION_LEFT][0], SC_A + 1);
+    CHECK_INT(kb.keys[KEY_ACTION_LEFT][KEY_BINDINGS_PER_ACTION - 1], 0);
+    CHECK(!key_bindings_remove_last(&kb, KEY_ACTION_RESTART));
+}
+
+static void test_find_conflict(void) {
+    key_bindings_t kb;
+    key_bindings_default(&kb);
+    CHECK(key_bindings_add(&kb, KEY_ACTION_DOWN, SC_D));
+    CHECK(key_bindings_add(&kb, KEY_ACTION_RIGHT, SC_D));
+    int sc = 0, a = -1, b = -1;
+    CHECK(key_bindings_find_conflict(&kb, &sc, &a, &b));
+    CHECK_INT(sc, SC_D);
+    CHECK_INT(a, KEY_ACTION_RIGHT);
+    CHECK_INT(b, KEY_ACTION_DOWN);
+    // Resolution takes the first action
+    int gsc, gmod;
+    CHECK(key_bindings_resolve(&kb, SC_D, 0, &gsc, &gmod));
+    CHECK_INT(gsc, SC_RIGHT);
+    key_bindings_remove(&kb, -1, SC_D);
+    CHECK(!key_bindings_find_conflict(&kb, &sc, &a, &b));
+}
+
+static void test_key_names(void) {
+    char name[16];
+    const int codes[] = {SC_A, 29, 30, 39, SC_F5, 69, SC_ESCAPE, SC_LEFT, SC_KP_4, SC_RSHIFT, 300};
+    for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); ++i) {
+        key_bindings_key_name(codes[i], name, sizeof(name));
+        CHECK_INT(key_bindings_key_from_name(name), codes[i]);
+    }
+    key_bindings_key_name(300, name, sizeof(name));
+    CHECK_STR(name, "Key300");
+    CHECK_INT(key_bindings_key_from_name("left"), SC_LEFT);
+    CHECK_INT(key_bindings_key_from_name("f13"), 0);
+    CHECK_INT(key_bindings_key_from_name("Key512"), 0);
+    CHECK_INT(key_bindings_key_from_name("Nope"), 0);
+}
+
+static void test_parse(void) {
+    key_bindings_t kb;
+    const char *text =
+        "# comment\n"
+        "; comment\n"
+        "  left = A, Left\r\n"
+        "restart=F5\n"
+        "up =\n"
+        "jump = Space\n"     // unknown action
+        "down = Down, Nope\n" // unknown key: the rest still counts
+        "shift = LCtrl\n"     // not bindable
+        "no equals sign\n";
+    CHECK_INT(key_bindings_parse(&kb, text), 4);
+    CHECK_INT(kb.keys[KEY_ACTION_LEFT][0], SC_A);
+    CHECK_INT(kb.keys[KEY_ACTION_LEFT][1], SC_LEFT);
+    CHECK_INT(kb.keys[KEY_ACTION_RESTART][0], SC_F5);
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_UP), 0);
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_DOWN), 1);
+    CHECK_INT(key_bindings_count(&kb, KEY_ACTION_SHIFT), 0);
+    // Not mentioned: defaults
+    CHECK_INT(kb.keys[KEY_ACTION_RIGHT][0], SC_RIGHT);
+    CHECK_INT(kb.keys[KEY_ACTION_PAUSE][0], SC_ESCAPE);
+}
+
+static void test_round_trip(void) {
+    key_bindings_t kb, back;
+    char text[KEY_BINDINGS_FILE_MAX];
+
+    key_bindings_default(&kb);
+    key_bindings_format(&kb, text, sizeof(text));
+    CHECK_INT(key_bindings_parse(&back, text), 0);
+    CHECK(memcmp(&kb, &back, sizeof(kb)) == 0);
+
+    // Every action full, empty actions, unnamed keys
+    memset(&kb, 0, sizeof(kb));
+    int sc = SC_A;
+    for (int a = 0; a < KEY_ACTION_COUNT; ++a) {
+        if (a == KEY_ACTION_UP) continue;
+        for (int i = 0; i < KEY_BINDINGS_PER_ACTION; ++i) {
+            CHECK(key_bindings_add(&kb, (key_action_t)a, sc++));
+        }
+    }
+    key_bindings_remove(&kb, KEY_ACTION_PAUSE, sc - 1);
+    CHECK(key_bindings_add(&kb, KEY_ACTION_PAUSE, 400));
+    key_bindings_format(&kb, text, sizeof(text));
+    CHECK_INT(key_bindings_parse(&back, text), 0);
+    CHECK(memcmp(&kb, &back, sizeof(kb)) == 0);
+
+    // Truncation keeps the terminator inside the buffer
+    char small[20];
+    CHECK_INT(key_bindings_format(&kb, small, sizeof(small)), sizeof(small) - 1);
+    CHECK_INT(strlen(small), sizeof(small) - 1);
+}
+
+static void test_file(void) {
+    CHECK(ram_disk_format());
+    key_bindings_t kb, back;
+    // Missing file: defaults, and that is fine
+    CHECK(key_bindings_load(&back));
+    key_bindings_default(&kb);
+    CHECK(memcmp(&kb, &back, sizeof(kb)) == 0);
+
+    CHECK(key_bindings_add(&kb, KEY_ACTION_SHIFT, SC_SPACE));
+    CHECK(key_bindings_save(&kb));
+    CHECK(pop_fs_exists(KEY_BINDINGS_FILE));
+    CHECK(!pop_fs_exists(KEY_BINDINGS_FILE ".tmp~"));
+    CHECK(key_bindings_load(&back));
+    CHECK(memcmp(&kb, &back, sizeof(kb)) == 0);
+}
+
+int main(void) {
+    TEST_RUN(test_defaults);
+    TEST_RUN(test_resolve);
+    TEST_RUN(test_resolve_held_mod);
+    TEST_RUN(test_bindable);
+    TEST_RUN(test_full_action);
+    TEST_RUN(test_find_conflict);
+    TEST_RUN(test_key_names);
+    TEST_RUN(test_parse);
+    TEST_RUN(test_round_trip);
+    TEST_RUN(test_file);
+    return test_finish();
+}
@@ -0,0 +1,82 @@
+/*
+ * murmprince - combined key state tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "key_state.h"
+#include "test.h"
+
+#define SC_A 4
+#define SC_LEFT 80
+#define SC_LSHIFT 225
+
+static void test_single_source(void) {
+    key_state_t ks;
+    key_state_init(&ks);
+    CHECK(key_state_update(&ks, KEY_SOURCE_PS2, SC_A, true));
+    CHECK(key_state_held_by(&ks, KEY_SOURCE_PS2, SC_A));
+    CHECK(!key_state_held_by(&ks, KEY_SOURCE_USB, SC_A));
+    // Typematic repeats are no new events
+    CHECK(!key_state_update(&ks, KEY_SOURCE_PS2, SC_A, true));
+    CHECK(key_state_update(&ks, KEY_SOURCE_PS2, SC_A, false));
+    // Release of a key never pressed
+    CHECK(!key_state_update(&ks, KEY_SOURCE_PS2, SC_A, false));
+    CHECK(!key_state_held_by(&ks, KEY_SOURCE_PS2, SC_A));
+}
+
+static void test_cross_source(void) {
+    key_state_t ks;
+    key_state_init(&ks);
+    CHECK(key_state_update(&ks, KEY_SOURCE_PS2, SC_LEFT, true));
+    CHECK(!key_state_update(&ks, KEY_SOURCE_USB, SC_LEFT, true));
+    // The PS/2 keyboard lets go, the USB one still holds it
+    CHECK(!key_state_update(&ks, KEY_SOURCE_PS2, SC_LEFT, false));
+    CHECK(ks.combined[SC_LEFT]);
+    CHECK(key_state_update(&ks, KEY_SOURCE_USB, SC_LEFT, false));
+    CHECK(!ks.combined[SC_LEFT]);
+
+    // Serial injection joins like a third keyboard
+    CHECK(key_state_update(&ks, KEY_SOURCE_SERIAL, SC_LSHIFT, true));
+    CHECK(!key_state_update(&ks, KEY_SOURCE_USB, SC_LSHIFT, true));
+    CHECK(!key_state_update(&ks, KEY_SOURCE_SERIAL, SC_LSHIFT, false));
+    CHECK(!key_state_update(&ks, KEY_SOURCE_PS2, SC_LSHIFT, false)); // not held there
+    CHECK(key_state_update(&ks, KEY_SOURCE_USB, SC_LSHIFT, false));
+}
+
+static void test_keys_independent(void) {
+    key_state_t ks;
+    key_state_init(&ks);
+    // Neighbours in one bitmap word, and the first and last scancode
+    const int codes[] = {0, 31, 32, 33, SC_A, KEY_STATE_SCANCODES - 1};
+    for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); ++i) {
+        CHECK(key_state_update(&ks, KEY_SOURCE_USB, codes[i], true));
+    }
+    CHECK(key_state_update(&ks, KEY_SOURCE_USB, 32, false));
+    CHECK(key_state_held_by(&ks, KEY_SOURCE_USB, 31));
+    CHECK(key_state_held_by(&ks, KEY_SOURCE_USB, 33));
+    CHECK(!key_state_held_by(&ks, KEY_SOURCE_USB, 32));
+    CHECK(key_state_held_by(&ks, KEY_SOURCE_USB, KEY_STATE_SCANCODES - 1));
+}
+
+static void test_unknown_scancodes(void) {
+    key_state_t ks, before;
+    key_state_init(&ks);
+    key_state_update(&ks, KEY_SOURCE_PS2, SC_A, true);
+    before = ks;
+    const int bad[] = {-1, -512, KEY_STATE_SCANCODES, KEY_STATE_SCANCODES + 31, 0x7FFFFFFF};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        CHECK(!key_state_update(&ks, KEY_SOURCE_PS2, bad[i], true));
+        CHECK(!key_state_update(&ks, KEY_SOURCE_USB, bad[i], false));
+        CHECK(!key_state_held_by(&ks, KEY_SOURCE_PS2, bad[i]));
+    }
+    CHECK(memcmp(&ks, &before, sizeof(ks)) == 0);
+}
+
+int main(void) {
+    TEST_RUN(test_single_source);
+    TEST_RUN(test_cross_source);
+    TEST_RUN(test_keys_independent);
+    TEST_RUN(test_unknown_scancodes);
+    return test_finish();
+}
@@ -0,0 +1,151 @@
+/*
+ * murmprince - log ring tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "log_ring.h"
+#include "test.h"
+
+// Unread bytes as a string
+static const char *contents(const log_ring_t *r) {
+    static char out[256];
+    const size_t n = log_ring_copy(r, out, sizeof(out) - 1);
+    out[n] = '\0';
+    return out;
+}
+
+static void test_drain_mode(void) {
+    char buf[16];
+    log_ring_t r;
+    log_ring_init(&r, buf, sizeof(buf), false);
+    CHECK_INT(log_ring_write(&r, "hello ", 6), 6);
+    CHECK_INT(log_ring_write(&r, "world", 5), 5);
+    CHECK_INT(log_ring_used(&r), 11);
+    // Does not fit: dropped whole, the rest kept
+    CHECK_INT(log_ring_write(&r, "123456", 6), 0);
+    CHECK_INT(r.dropped, 6);
+    CHECK_STR(contents(&r), "hello world");
+    CHECK_INT(log_ring_write(&r, "12345", 5), 5);
+    CHECK_INT(log_ring_used(&r), 16);
+    CHECK_INT(log_ring_write(&r, "x", 1), 0);
+    // Larger than the ring: dropped
+    CHECK_INT(log_ring_write(&r, "0123456789abcdefg", 17), 0);
+    CHECK_INT(r.dropped, 6 + 1 + 17);
+    CHECK_INT(log_ring_write(&r, "", 0), 0);
+}
+
+static void test_drain_wraps(void) {
+    char buf[8];
+    log_ring_t r;
+    log_ring_init(&r, buf, sizeof(buf), false);
+    log_ring_write(&r, "abcdef", 6);
+    log_ring_consume(&r, 4);
+    log_ring_write(&r, "ghij", 4); // wraps around the end
+    CHECK_STR(contents(&r), "efghij");
+
+    // Peek hands out the contiguous part, then the rest
+    const char *p;
+    size_t n = log_ring_peek(&r, &p);
+    CHECK_INT(n, 4);
+    CHECK(memcmp(p, "efgh", 4) == 0);
+    log_ring_consume(&r, n);
+    n = log_ring_peek(&r, &p);
+    CHECK_INT(n, 2);
+    CHECK(memcmp(p, "ij", 2) == 0);
+    log_ring_consume(&r, 100); // more than there is
+    CHECK_INT(log_ring_used(&r), 0);
+    CHECK_INT(log_ring_peek(&r, &p), 0);
+}
+
+static void test_overwrite_mode(void) {
+    char buf[8];
+    log_ring_t r;
+    log_ring_init(&r, buf, sizeof(buf), true);
+    log_ring_write(&r, "abcdef", 6);
+    CHECK_INT(log_ring_write(&r, "ghij", 4), 4);
+    CHECK_INT(r.dropped, 2);
+    CHECK_STR(contents(&r), "cdefghij");
+    // Larger than the ring: its last bytes
+    CHECK_INT(log_ring_write(&r, "0123456789", 10), 10);
+    CHECK_STR(contents(&r), "23456789");
+    CHECK_INT(r.dropped, 2 + 2 + 8);
+}
+
+static void test_counter_wrap(void) {
+    char buf[8];
+    log_ring_t r;
+    for (int overwrite = 0; overwrite < 2; ++overwrite) {
+        log_ring_init(&r, buf, sizeof(buf), overwrite != 0);
+        // Counters about to wrap, as after 4 GB of log
+        r.head = r.tail = 0xFFFFFFFCu;
+        CHECK_INT(log_ring_write(&r, "abcdef", 6), 6);
+        CHECK_INT(r.head, 2);
+        CHECK_INT(log_ring_used(&r), 6);
+        CHECK_STR(contents(&r), "abcdef");
+        CHECK_INT(log_ring_write(&r, "gh", 2), 2);
+        CHECK_INT(log_ring_write(&r, "ij", 2), overwrite ? 2 : 0);
+        CHECK_STR(contents(&r), overwrite ? "cdefghij" : "abcdefgh");
+        log_ring_consume(&r, 3);
+        CHECK_INT(log_ring_used(&r), 5);
+    }
+}
+
+static void test_copy_short(void) {
+    char buf[16];
+    log_ring_t r;
+    log_ring_init(&r, buf, sizeof(buf), false);
+    log_ring_write(&r, "oldest newest", 13);
+    char dst[6];
+    CHECK_INT(log_ring_copy(&r, dst, sizeof(dst)), 6);
+    CHECK(memcmp(dst, "oldest", 6) == 0);
+    CHECK_INT(log_ring_used(&r), 13); // not consumed
+}
+
+static size_t line(char *buf, size_t size, log_level_t level, uint32_t ms, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    const size_t n = log_format_line(buf, size, level, ms, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+static void test_format_line(void) {
+    char buf[64];
+    CHECK_INT(line(buf, sizeof(buf), LOG_INFO, 12345, "SD: %s", "mounted"), 21);
+    CHECK_STR(buf, "12.345 I SD: mounted\n");
+    line(buf, sizeof(buf), LOG_ERROR, 7, "x\n\n");
+    CHECK_STR(buf, "0.007 E x\n");
+    line(buf, sizeof(buf), LOG_DEBUG, 0, "");
+    CHECK_STR(buf, "0.000 D \n");
+    line(buf, sizeof(buf), (log_level_t)9, 1000, "odd");
+    CHECK_STR(buf, "1.000 ? odd\n");
+}
+
+static void test_format_truncation(void) {
+    char buf[16];
+    // Cut to fit, still ends in a newline
+    CHECK_INT(line(buf, sizeof(buf), LOG_WARN, 1, "a long message"), 15);
+    CHECK_STR(buf, "0.001 W a long\n");
+    // Time stamp alone longer than the buffer
+    char tiny[6];
+    CHECK_INT(line(tiny, sizeof(tiny), LOG_WARN, 4000000000u, "msg"), 5);
+    CHECK_STR(tiny, "4000\n");
+    char two[2];
+    CHECK_INT(line(two, sizeof(two), LOG_WARN, 1, "msg"), 1);
+    CHECK_STR(two, "\n");
+    char one[1];
+    CHECK_INT(line(one, sizeof(one), LOG_WARN, 1, "msg"), 0);
+    CHECK_STR(one, "");
+}
+
+int main(void) {
+    TEST_RUN(test_drain_mode);
+    TEST_RUN(test_drain_wraps);
+    TEST_RUN(test_overwrite_mode);
+    TEST_RUN(test_counter_wrap);
+    TEST_RUN(test_copy_short);
+    TEST_RUN(test_format_line);
+    TEST_RUN(test_format_truncation);
+    return test_finish();
+}
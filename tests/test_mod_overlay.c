@@ -0,0 +1,189 @@
+/*
+ * murmprince - data file index tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "mod_overlay.h"
+#include "pop_fs.h"
+#include "ram_disk.h"
+#include "test.h"
+
+static bool touch(const char *path) {
+    FIL *f = pop_fs_open(path, "wb");
+    if (!f) return false;
+    pop_fs_write("x", 1, 1, f);
+    return pop_fs_close(f) == 0;
+}
+
+// A card with the game and two mods
+static void make_card(void) {
+    CHECK(ram_disk_format());
+    CHECK(touch("PRINCE.DAT"));
+    CHECK(touch("SDLPoP.ini"));
+    CHECK(pop_fs_mkdir("other"));
+    CHECK(touch("other/notes.txt"));
+    CHECK(pop_fs_mkdir("prince"));
+    CHECK(touch("prince/KID.DAT"));
+    CHECK(pop_fs_mkdir("prince/KID"));
+    CHECK(touch("prince/KID/res400.png"));
+    CHECK(pop_fs_mkdir("prince/midi_cache"));
+    CHECK(touch("prince/midi_cache/song1.raw"));
+    CHECK(pop_fs_mkdir("mods"));
+    CHECK(pop_fs_mkdir("mods/MyMod"));
+    CHECK(touch("mods/MyMod/LEVELS.DAT"));
+    CHECK(pop_fs_mkdir("mods/MyMod/prince"));
+    CHECK(touch("mods/MyMod/prince/GUARD.DAT"));
+    CHECK(pop_fs_mkdir("mods/Other"));
+    CHECK(touch("mods/Other/LEVELS.DAT"));
+}
+
+static void test_base_game(void) {
+    make_card();
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, ""));
+    CHECK(ov.valid);
+    CHECK(mod_overlay_may_exist(&ov, "PRINCE.DAT"));
+    CHECK(mod_overlay_may_exist(&ov, "sdlpop.INI"));
+    CHECK(mod_overlay_may_exist(&ov, "prince/KID/res400.png"));
+    CHECK(mod_overlay_may_exist(&ov, "Prince\\kid\\RES400.PNG"));
+    CHECK(!mod_overlay_may_exist(&ov, "VDUNGEON.DAT"));
+    CHECK(!mod_overlay_may_exist(&ov, "prince/KID/res401.png"));
+    CHECK(!mod_overlay_may_exist(&ov, "prince/GUARD.DAT"));
+    // Directories are not files
+    CHECK(!mod_overlay_may_exist(&ov, "prince/KID"));
+    mod_overlay_free(&ov);
+}
+
+static void test_path_forms(void) {
+    make_card();
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, NULL));
+    CHECK(mod_overlay_may_exist(&ov, "./PRINCE.DAT"));
+    CHECK(mod_overlay_may_exist(&ov, "/PRINCE.DAT"));
+    CHECK(mod_overlay_may_exist(&ov, "0:/PRINCE.DAT"));
+    CHECK(mod_overlay_may_exist(&ov, "./prince/KID.DAT"));
+    CHECK(!mod_overlay_may_exist(&ov, "0:/prince/nothing.dat"));
+    mod_overlay_free(&ov);
+}
+
+static void test_uncovered_paths(void) {
+    make_card();
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, ""));
+    // Only the root's files are listed, not its other folders
+    CHECK(mod_overlay_may_exist(&ov, "other/notes.txt"));
+    CHECK(mod_overlay_may_exist(&ov, "other/missing.txt"));
+    // The MIDI cache changes under the index
+    CHECK(mod_overlay_may_exist(&ov, "prince/midi_cache/song2.raw"));
+    CHECK(mod_overlay_may_exist(&ov, "PRINCE/MIDI_CACHE/song2.raw"));
+    // Without a mod selected, mod folders are not listed
+    CHECK(mod_overlay_may_exist(&ov, "mods/MyMod/missing.dat"));
+    // FatFS folds these by code page: leave them to it
+    CHECK(mod_overlay_may_exist(&ov, "prince/caf\xe9.dat"));
+    CHECK(mod_overlay_may_exist(&ov, NULL));
+    mod_overlay_free(&ov);
+}
+
+static void test_mod(void) {
+    make_card();
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, "./mods/mymod/"));
+    CHECK_STR(ov.mod_dir, "mods/mymod");
+    CHECK(mod_overlay_may_exist(&ov, "mods/MyMod/LEVELS.DAT"));
+    CHECK(mod_overlay_may_exist(&ov, "mods/MyMod/prince/GUARD.DAT"));
+    CHECK(!mod_overlay_may_exist(&ov, "mods/MyMod/PRINCE.DAT"));
+    CHECK(!mod_overlay_may_exist(&ov, "mods/MyMod/prince/KID/res400.png"));
+    // Another mod, or a name that only starts like this one
+    CHECK(mod_overlay_may_exist(&ov, "mods/Other/missing.dat"));
+    CHECK(mod_overlay_may_exist(&ov, "mods/MyModX/missing.dat"));
+
+    // Rebuilt without the mod: its paths are "maybe" again
+    CHECK(mod_overlay_build(&ov, ""));
+    CHECK(mod_overlay_may_exist(&ov, "mods/MyMod/PRINCE.DAT"));
+    // A mod folder that is not there: nothing in it exists
+    CHECK(mod_overlay_build(&ov, "mods/Gone"));
+    CHECK(!mod_overlay_may_exist(&ov, "mods/Gone/LEVELS.DAT"));
+    mod_overlay_free(&ov);
+}
+
+static void test_short_names(void) {
+    CHECK(ram_disk_format());
+    CHECK(pop_fs_mkdir("prince"));
+    CHECK(touch("prince/LongFileName.dat"));
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, ""));
+    CHECK(mod_overlay_may_exist(&ov, "prince/LongFileName.dat"));
+    CHECK(mod_overlay_may_exist(&ov, "prince/LONGFI~1.DAT"));
+    CHECK(!mod_overlay_may_exist(&ov, "prince/LONGFI~2.DAT"));
+    mod_overlay_free(&ov);
+}
+
+static void test_many_files(void) {
+    CHECK(ram_disk_format());
+    CHECK(pop_fs_mkdir("prince"));
+    CHECK(pop_fs_mkdir("prince/PNG"));
+    char path[64];
+    for (int i = 0; i < 300; ++i) {
+        snprintf(path, sizeof(path), "prince/PNG/res%d.png", i);
+        CHECK(touch(path));
+    }
+    mod_overlay_t ov = {0};
+    CHECK(mod_overlay_build(&ov, ""));
+    // Grown past the first table, every name still found
+    CHECK(ov.mask + 1 > 256);
+    CHECK(ov.count * 2 <= ov.mask + 1);
+    int found = 0, absent = 0;
+    for (int i = 0; i < 600; ++i) {
+        snprintf(path, sizeof(path), "prince/PNG/res%d.png", i);
+        if (mod_overlay_may_exist(&ov, path)) ++found;
+        else ++absent;
+    }
+    CHECK_INT(found, 300);
+    CHECK_INT(absent, 300);
+    mod_overlay_free(&ov);
+}
+
+static void test_depth_limit(void) {
+    CHECK(ram_disk_format());
+    char path[64] = "prince";
+    CHECK(pop_fs_mkdir(path));
+    for (int depth = 1; depth <= MOD_OVERLAY_MAX_DEPTH + 1; ++depth) {
+        strcat(path, "/d");
+        CHECK(pop_fs_mkdir(path));
+    }
+    strcat(path, "/deep.dat");
+    CHECK(touch(path));
+    mod_overlay_t ov = {0};
+    // Too deep to list completely: no index, every lookup is "maybe"
+    CHECK(!mod_overlay_build(&ov, ""));
+    CHECK(!ov.valid);
+    CHECK(mod_overlay_may_exist(&ov, "prince/missing.dat"));
+    mod_overlay_free(&ov);
+}
+
+static void test_no_card(void) {
+    CHECK(ram_disk_format());
+    CHECK(touch("PRINCE.DAT"));
+    f_unmount("0:");
+    mod_overlay_t ov = {0};
+    CHECK(!mod_overlay_build(&ov, ""));
+    CHECK(mod_overlay_may_exist(&ov, "MISSING.DAT"));
+    CHECK(ram_disk_remount());
+    // No prince/ folder is not an error
+    CHECK(mod_overlay_build(&ov, ""));
+    CHECK(!mod_overlay_may_exist(&ov, "prince/KID.DAT"));
+    mod_overlay_free(&ov);
+}
+
+int main(void) {
+    TEST_RUN(test_base_game);
+    TEST_RUN(test_path_forms);
+    TEST_RUN(test_uncovered_paths);
+    TEST_RUN(test_mod);
+    TEST_RUN(test_short_names);
+    TEST_RUN(test_many_files);
+    TEST_RUN(test_depth_limit);
+    TEST_RUN(test_no_card);
+    return test_finish();
+}
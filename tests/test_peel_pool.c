@@ -0,0 +1,79 @@
+/*
+ * murmprince - peel slot pool tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "peel_pool.h"
+#include "test.h"
+
+static const peel_pool_class_t classes[] = {
+    { 100, 2 },
+    { 400, 1 },
+};
+
+static void test_layout(void) {
+    peel_pool_t pool;
+    CHECK_INT(peel_pool_init(&pool, classes, 2), 3);
+    CHECK_INT(pool.capacity[0], 100);
+    CHECK_INT(pool.capacity[1], 100);
+    CHECK_INT(pool.capacity[2], 400);
+    CHECK_INT((int)peel_pool_bytes(classes, 2), 600);
+
+    // The firmware's table: 24 slots, 44 KB
+    CHECK_INT(peel_pool_init(&pool, peel_pool_default_classes, PEEL_POOL_DEFAULT_CLASSES), 24);
+    CHECK_INT((int)peel_pool_bytes(peel_pool_default_classes, PEEL_POOL_DEFAULT_CLASSES), 45056);
+
+    // Capped at PEEL_POOL_MAX_SLOTS
+    const peel_pool_class_t many[] = { { 8, 40 } };
+    CHECK_INT(peel_pool_init(&pool, many, 1), PEEL_POOL_MAX_SLOTS);
+}
+
+static void test_best_fit(void) {
+    peel_pool_t pool;
+    peel_pool_init(&pool, classes, 2);
+    CHECK_INT(peel_pool_acquire(&pool, 300), 2);
+    CHECK_INT(peel_pool_acquire(&pool, 50), 0);
+    CHECK_INT(peel_pool_acquire(&pool, 100), 1);
+    // Small class used up, large one busy: a miss
+    CHECK_INT(peel_pool_acquire(&pool, 10), -1);
+    CHECK_INT(peel_pool_acquire(&pool, 401), -1);
+    CHECK_INT((int)pool.hits, 3);
+    CHECK_INT((int)pool.misses, 2);
+    CHECK_INT((int)pool.bytes_in_use, 600);
+    CHECK_INT((int)pool.peak_bytes, 600);
+
+    // A small peel takes a large slot when the small ones are busy
+    peel_pool_release(&pool, 2);
+    CHECK_INT(peel_pool_acquire(&pool, 10), 2);
+    peel_pool_release(&pool, 0);
+    CHECK_INT(peel_pool_acquire(&pool, 10), 0);
+}
+
+static void test_release(void) {
+    peel_pool_t pool;
+    peel_pool_init(&pool, classes, 2);
+    int a = peel_pool_acquire(&pool, 80);
+    int b = peel_pool_acquire(&pool, 200);
+    CHECK_INT((int)pool.bytes_in_use, 500);
+    peel_pool_release(&pool, a);
+    peel_pool_release(&pool, a);        // double release is ignored
+    peel_pool_release(&pool, -1);
+    peel_pool_release(&pool, 3);
+    CHECK_INT((int)pool.bytes_in_use, 400);
+    CHECK(pool.in_use[b]);
+
+    peel_pool_acquire(&pool, 1);
+    peel_pool_release_all(&pool);
+    CHECK_INT((int)pool.bytes_in_use, 0);
+    for (int i = 0; i < pool.slot_count; ++i) CHECK(!pool.in_use[i]);
+    CHECK_INT((int)pool.peak_bytes, 500);
+    CHECK_INT((int)pool.hits, 3);
+}
+
+int main(void) {
+    TEST_RUN(test_layout);
+    TEST_RUN(test_best_fit);
+    TEST_RUN(test_release);
+    return test_finish();
+}
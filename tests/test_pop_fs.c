@@ -0,0 +1,290 @@
+/*
+ * murmprince - pop_fs tests (src/pop_fs.c on the RAM disk)
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pico_host.h"
+#include "pop_fs.h"
+#include "ram_disk.h"
+#include "test.h"
+
+#define OLD_SIZE 1500   // three sectors
+#define NEW_SIZE 2600   // six: a mix of the two would show
+
+static uint8_t old_data[OLD_SIZE];
+static uint8_t new_data[NEW_SIZE];
+
+static void make_data(void) {
+    for (int i = 0; i < OLD_SIZE; ++i) old_data[i] = (uint8_t)(i * 7 + 1);
+    for (int i = 0; i < NEW_SIZE; ++i) new_data[i] = (uint8_t)(i * 13 + 5);
+}
+
+static bool write_file(const char *path, const uint8_t *data, size_t size) {
+    FIL *f = pop_fs_open(path, "wb");
+    if (!f) return false;
+    const bool written = pop_fs_write(data, 1, size, f) == size;
+    return pop_fs_close(f) == 0 && written;
+}
+
+// Size of the file, -1 if missing; its contents go to buf.
+static long read_file(const char *path, uint8_t *buf, size_t size) {
+    FIL *f = pop_fs_open(path, "rb");
+    if (!f) return -1;
+    const long n = (long)pop_fs_read(buf, 1, size, f);
+    pop_fs_close(f);
+    return n;
+}
+
+static bool holds(const char *path, const uint8_t *data, size_t size) {
+    static uint8_t buf[NEW_SIZE + 1];
+    return read_file(path, buf, sizeof(buf)) == (long)size && !memcmp(buf, data, size);
+}
+
+static void test_make_path(void) {
+    char path[64];
+    CHECK_STR(pop_fs_make_path(path, sizeof(path), "prince/PRINCE.DAT"), "0:/prince/PRINCE.DAT");
+    CHECK_STR(pop_fs_make_path(path, sizeof(path), "./data\\a.dat"), "0:/data/a.dat");
+    CHECK_STR(pop_fs_make_path(path, sizeof(path), "/x"), "0:/x");
+    CHECK_STR(pop_fs_make_path(path, sizeof(path), "0:/y"), "0:/y");
+    CHECK_STR(pop_fs_make_path(path, 5, "abcdef"), "0:/a");
+}
+
+static void test_replace_on_close(void) {
+    CHECK(ram_disk_format());
+    CHECK(write_file("f.bin", old_data, OLD_SIZE));
+
+    FIL *f = pop_fs_open("f.bin", "wb");
+    CHECK(f != NULL);
+    CHECK_INT(pop_fs_write(new_data, 1, NEW_SIZE, f), NEW_SIZE);
+    // Written aside until the close
+    CHECK(pop_fs_exists("f.bin.tmp~"));
+    CHECK(holds("f.bin", old_data, OLD_SIZE));
+    CHECK_INT(pop_fs_close(f), 0);
+    CHECK(holds("f.bin", new_data, NEW_SIZE));
+    CHECK(!pop_fs_exists("f.bin.tmp~"));
+    CHECK(!pop_fs_exists("f.bin.new~"));
+
+    // Discarded: the original stays
+    f = pop_fs_open("f.bin", "wb");
+    CHECK(f != NULL);
+    pop_fs_write(old_data, 1, OLD_SIZE, f);
+    pop_fs_discard(f);
+    CHECK(holds("f.bin", new_data, NEW_SIZE));
+    CHECK(!pop_fs_exists("f.bin.tmp~"));
+
+    // "r+" writes in place
+    f = pop_fs_open("f.bin", "r+b");
+    CHECK(f != NULL);
+    CHECK_INT(pop_fs_seek(f, 10, SEEK_SET), 0);
+    CHECK_INT(pop_fs_write("\0", 1, 1, f), 1);
+    CHECK_INT(pop_fs_tell(f), 11);
+    CHECK_INT(pop_fs_close(f), 0);
+    CHECK(!pop_fs_exists("f.bin.tmp~"));
+    uint8_t patched[NEW_SIZE];
+    memcpy(patched, new_data, NEW_SIZE);
+    patched[10] = 0;
+    CHECK(holds("f.bin", patched, NEW_SIZE));
+}
+
+static bool reject_small(FIL *fil, FSIZE_t size) {
+    (void)fil;
+    return size >= 100;
+}
+
+static void test_recover_dir(void) {
+    CHECK(ram_disk_format());
+    CHECK(pop_fs_mkdir("cache"));
+    CHECK(write_file("cache/a.bin", old_data, OLD_SIZE));
+    // Torn temporary, interrupted commits and a file failing its check
+    CHECK(write_file("cache/b.bin.tmp~", new_data, 10));
+    CHECK(write_file("cache/a.bin.new~", new_data, NEW_SIZE));
+    CHECK(write_file("cache/c.bin.new~", new_data, NEW_SIZE));
+    CHECK(write_file("cache/small.bin", old_data, 20));
+    CHECK(write_file("keep.bin", old_data, 20));
+
+    CHECK_INT(pop_fs_recover_dir("cache", reject_small), 4);
+    CHECK(!pop_fs_exists("cache/b.bin.tmp~"));
+    CHECK(!pop_fs_exists("cache/b.bin"));
+    CHECK(holds("cache/a.bin", new_data, NEW_SIZE));
+    CHECK(holds("cache/c.bin", new_data, NEW_SIZE));
+    CHECK(!pop_fs_exists("cache/a.bin.new~"));
+    CHECK(!pop_fs_exists("cache/small.bin"));
+    // Other directories are not touched, and a clean one needs nothing
+    CHECK(holds("keep.bin", old_data, 20));
+    CHECK_INT(pop_fs_recover_dir("cache/", reject_small), 0);
+}
+
+// Cut the power at every sector write of one replacement: after the
+// boot-time recovery the file holds all of the old contents or all of the
+// new, and nothing is left behind.
+static void power_cut_run(bool had_old) {
+    bool completed = false;
+    for (int budget = 0; budget < 64 && !completed; ++budget) {
+        CHECK(ram_disk_format());
+        if (had_old) CHECK(write_file("s.bin", old_data, OLD_SIZE));
+
+        ram_disk_set_write_budget(budget);
+        const bool ok = write_file("s.bin", new_data, NEW_SIZE);
+        CHECK(ram_disk_remount());
+        pop_fs_recover_dir("", NULL);
+
+        const bool is_new = holds("s.bin", new_data, NEW_SIZE);
+        const bool is_old = had_old ? holds("s.bin", old_data, OLD_SIZE) : !pop_fs_exists("s.bin");
+        if (!is_new && !is_old) {
+            printf("  budget %d: torn file\n", budget);
+            CHECK(false);
+        }
+        // A reported success is on the card
+        if (ok) CHECK(is_new);
+        CHECK(!pop_fs_exists("s.bin.tmp~"));
+        CHECK(!pop_fs_exists("s.bin.new~"));
+        completed = ok;
+    }
+    // The budget ran past the whole write
+    CHECK(completed);
+}
+
+static void test_power_cut_replace(void) {
+    power_cut_run(true);
+}
+
+static void test_power_cut_create(void) {
+    power_cut_run(false);
+}
+
+// Card removal: the card comes back once the code has slept out_ms.
+static uint64_t reinsert_us;
+static int waits_begun, waits_ended;
+
+static void reinsert_hook(uint64_t now_us) {
+    if (now_us >= reinsert_us) ram_disk_set_inserted(true);
+}
+
+static void wait_hook(bool waiting) {
+    if (waiting) ++waits_begun;
+    else ++waits_ended;
+}
+
+static void pull_card(uint32_t out_ms) {
+    ram_disk_set_inserted(false);
+    reinsert_us = pico_host_now_us() + (uint64_t)out_ms * 1000u;
+}
+
+static void setup_removal(void) {
+    CHECK(ram_disk_format());
+    CHECK(write_file("f.bin", old_data, OLD_SIZE));
+    pico_host_set_sleep_hook(reinsert_hook);
+    pop_fs_set_wait_hook(wait_hook);
+    waits_begun = waits_ended = 0;
+}
+
+static void test_mount_id(void) {
+    CHECK(ram_disk_format());
+    const uint16_t id = pop_fs_mount_id();
+    CHECK(id != 0);
+    CHECK(ram_disk_remount());
+    CHECK(pop_fs_mount_id() != id);
+    pop_fs_reset();
+    CHECK_INT(pop_fs_mount_id(), 0);
+    CHECK(pop_fs_init());
+    CHECK(pop_fs_mount_id() != 0);
+}
+
+static void test_pulled_read(void) {
+    setup_removal();
+    uint8_t buf[OLD_SIZE];
+    FIL *f = pop_fs_open("f.bin", "rb");
+    CHECK(f != NULL);
+    CHECK_INT(pop_fs_read(buf, 1, 600, f), 600);
+    const uint16_t id = pop_fs_mount_id();
+
+    // The read waits for the card, then goes on from the same place
+    pull_card(1000);
+    CHECK_INT(pop_fs_read(buf + 600, 1, OLD_SIZE - 600, f), OLD_SIZE - 600);
+    CHECK(!memcmp(buf, old_data, OLD_SIZE));
+    CHECK_INT(waits_begun, 1);
+    CHECK_INT(waits_ended, 1);
+    CHECK(pop_fs_card_present());
+    CHECK(pop_fs_mount_id() != id && pop_fs_mount_id() != 0);
+    pop_fs_info_t info;
+    CHECK(pop_fs_get_info(&info));
+    CHECK_INT(info.removals, 1);
+    CHECK_INT(pop_fs_close(f), 0);
+}
+
+static void test_pulled_nonblocking_read(void) {
+    setup_removal();
+    uint8_t buf[OLD_SIZE];
+    FIL *audio = pop_fs_open("f.bin", "rb");
+    CHECK(audio != NULL);
+    pop_fs_set_blocking(audio, false);
+    CHECK_INT(pop_fs_read(buf, 1, 1024, audio), 1024);
+
+    // Fails fast while the card is out...
+    pull_card(1000);
+    CHECK_INT(pop_fs_read(buf + 1024, 1, 100, audio), 0);
+    CHECK_INT(waits_begun, 0);
+    // ...and is reopened in place when a waiting access brings the card back
+    FIL *f = pop_fs_open("f.bin", "rb");
+    CHECK(f != NULL);
+    CHECK_INT(waits_ended, 1);
+    CHECK_INT(pop_fs_read(buf + 1024, 1, OLD_SIZE - 1024, audio), OLD_SIZE - 1024);
+    CHECK(!memcmp(buf, old_data, OLD_SIZE));
+    CHECK_INT(pop_fs_close(audio), 0);
+    CHECK_INT(pop_fs_close(f), 0);
+}
+
+static void test_pulled_write(void) {
+    setup_removal();
+    // The writer notices: it fails, and the close keeps the original
+    FIL *w = pop_fs_open("f.bin", "wb");
+    CHECK(w != NULL);
+    CHECK_INT(pop_fs_write(new_data, 1, 1000, w), 1000);
+    pull_card(1000);
+    CHECK_INT(pop_fs_write(new_data + 1000, 1, 1000, w), 0);
+    CHECK_INT(waits_ended, 1);
+    CHECK_INT(pop_fs_write(new_data + 1000, 1, 1000, w), 0);
+    CHECK_INT(pop_fs_seek(w, 0, SEEK_SET), -1);
+    CHECK_INT(pop_fs_close(w), -1);
+    CHECK(holds("f.bin", old_data, OLD_SIZE));
+    CHECK(!pop_fs_exists("f.bin.tmp~"));
+
+    // A reader notices: writers open at the time are lost all the same,
+    // whether they write in place or create a file
+    CHECK(write_file("r.bin", old_data, OLD_SIZE));
+    FIL *in_place = pop_fs_open("f.bin", "r+b");
+    FIL *created = pop_fs_open("g.bin", "wb");
+    FIL *r = pop_fs_open("r.bin", "rb");
+    CHECK(in_place && created && r);
+    CHECK_INT(pop_fs_write(new_data, 1, 100, created), 100);
+    uint8_t buf[OLD_SIZE];
+    pull_card(1000);
+    CHECK_INT(pop_fs_read(buf, 1, OLD_SIZE, r), OLD_SIZE);
+    CHECK_INT(waits_ended, 2);
+    CHECK_INT(pop_fs_write(new_data, 1, 10, in_place), 0);
+    CHECK_INT(pop_fs_close(in_place), -1);
+    CHECK_INT(pop_fs_close(created), -1);
+    CHECK_INT(pop_fs_close(r), 0);
+    CHECK(holds("f.bin", old_data, OLD_SIZE));
+    CHECK(!pop_fs_exists("g.bin"));
+    CHECK(!pop_fs_exists("g.bin.tmp~"));
+
+    // Files opened after the remount are fine
+    CHECK(write_file("f.bin", new_data, NEW_SIZE));
+    CHECK(holds("f.bin", new_data, NEW_SIZE));
+}
+
+int main(void) {
+    make_data();
+    TEST_RUN(test_make_path);
+    TEST_RUN(test_replace_on_close);
+    TEST_RUN(test_recover_dir);
+    TEST_RUN(test_power_cut_replace);
+    TEST_RUN(test_power_cut_create);
+    TEST_RUN(test_mount_id);
+    TEST_RUN(test_pulled_read);
+    TEST_RUN(test_pulled_nonblocking_read);
+    TEST_RUN(test_pulled_write);
+    return test_finish();
+}
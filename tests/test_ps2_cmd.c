@@ -0,0 +1,226 @@
+/*
+ * murmprince - PS/2 host command queue tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ps2kbd/ps2_cmd.h"
+#include "test.h"
+
+// Poll expecting a byte to go out
+static int send_next(ps2_cmd_t *c, uint32_t now) {
+    uint8_t byte = 0;
+    if (ps2_cmd_poll(c, now, &byte) != PS2_CMD_ACT_SEND) return -1;
+    return byte;
+}
+
+// A keyboard that takes the byte on the line and answers with reply
+static int exchange(ps2_cmd_t *c, uint32_t now, uint8_t reply) {
+    const int byte = send_next(c, now);
+    if (byte >= 0) {
+        ps2_cmd_line_done(c, now + 1, true);
+        ps2_cmd_on_reply(c, reply, now + 2);
+    }
+    return byte;
+}
+
+static void test_set_leds(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    CHECK(!ps2_cmd_busy(&c));
+    CHECK(ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, PS2_LED_CAPS));
+    CHECK(ps2_cmd_busy(&c));
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_SET_LEDS);
+    CHECK_INT(c.stats.completed, 0);
+    CHECK_INT(exchange(&c, 10, 0xFA), PS2_LED_CAPS);
+    CHECK_INT(c.stats.completed, 1);
+    CHECK_INT(c.stats.bytes_sent, 2);
+    CHECK(!ps2_cmd_busy(&c));
+    uint8_t byte;
+    CHECK_INT(ps2_cmd_poll(&c, 1000, &byte), PS2_CMD_ACT_NONE);
+}
+
+static void test_resend(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_TYPEMATIC, 0x20);
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_TYPEMATIC);
+    // FE repeats only the byte it answers
+    CHECK_INT(exchange(&c, 10, 0xFE), 0x20);
+    CHECK_INT(exchange(&c, 20, 0xFA), 0x20);
+    CHECK_INT(c.stats.resends, 1);
+    CHECK_INT(c.stats.completed, 1);
+
+    // No line ACK bit counts as a resend too
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0);
+    CHECK_INT(send_next(&c, 30), PS2_CMD_SET_LEDS);
+    ps2_cmd_line_done(&c, 31, false);
+    CHECK_INT(c.stats.resends, 2);
+    CHECK_INT(exchange(&c, 40, 0xFA), PS2_CMD_SET_LEDS);
+}
+
+static void test_fa_before_line_done(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, PS2_LED_NUM);
+    CHECK_INT(send_next(&c, 0), PS2_CMD_SET_LEDS);
+    ps2_cmd_on_reply(&c, 0xFA, 1);
+    ps2_cmd_line_done(&c, 2, true); // late, ignored
+    CHECK_INT(exchange(&c, 3, 0xFA), PS2_LED_NUM);
+    CHECK_INT(c.stats.completed, 1);
+    // Stray replies while idle change nothing
+    ps2_cmd_on_reply(&c, 0xFE, 4);
+    CHECK_INT(c.stats.resends, 0);
+}
+
+static void test_timeouts(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, PS2_LED_SCROLL);
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_SET_LEDS);
+
+    // The argument's reply never comes: the command starts over
+    CHECK_INT(send_next(&c, 10), PS2_LED_SCROLL);
+    ps2_cmd_line_done(&c, 11, true);
+    uint8_t byte;
+    CHECK_INT(ps2_cmd_poll(&c, 11 + PS2_CMD_REPLY_TIMEOUT_MS - 1, &byte), PS2_CMD_ACT_NONE);
+    CHECK_INT(ps2_cmd_poll(&c, 11 + PS2_CMD_REPLY_TIMEOUT_MS, &byte), PS2_CMD_ACT_SEND);
+    CHECK_INT(byte, PS2_CMD_SET_LEDS);
+    CHECK_INT(c.stats.timeouts, 1);
+
+    // The keyboard never clocks the byte out: release the lines first
+    CHECK_INT(ps2_cmd_poll(&c, 100 + PS2_CMD_LINE_TIMEOUT_MS, &byte), PS2_CMD_ACT_ABORT);
+    CHECK_INT(c.stats.timeouts, 2);
+    CHECK_INT(send_next(&c, 200), PS2_CMD_SET_LEDS);
+}
+
+static void test_gives_up(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0);
+    ps2_cmd_queue(&c, PS2_CMD_TYPEMATIC, 0);
+    uint32_t now = 0;
+    for (int i = 0; i <= PS2_CMD_RETRIES; ++i, now += 10) {
+        CHECK_INT(exchange(&c, now, 0xFE), PS2_CMD_SET_LEDS);
+    }
+    CHECK_INT(c.stats.failed, 1);
+    // The next command still goes out
+    CHECK_INT(exchange(&c, now, 0xFA), PS2_CMD_TYPEMATIC);
+    CHECK_INT(exchange(&c, now + 10, 0xFA), 0);
+    CHECK_INT(c.stats.completed, 1);
+    CHECK(!ps2_cmd_busy(&c));
+
+    // No keyboard at all: line timeouts until dropped
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0);
+    uint8_t byte;
+    int aborts = 0;
+    for (now = 1000; ps2_cmd_busy(&c) && now < 2000; now += PS2_CMD_LINE_TIMEOUT_MS) {
+        if (ps2_cmd_poll(&c, now, &byte) == PS2_CMD_ACT_ABORT) ++aborts;
+    }
+    CHECK(!ps2_cmd_busy(&c));
+    CHECK_INT(aborts, PS2_CMD_RETRIES + 1);
+    CHECK_INT(c.stats.failed, 2);
+}
+
+static void test_reset(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_RESET, -1);
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_RESET);
+    CHECK_INT(c.state, PS2_CMD_WAIT_BAT);
+    CHECK(ps2_cmd_busy(&c));
+    uint8_t byte;
+    CHECK_INT(ps2_cmd_poll(&c, 500, &byte), PS2_CMD_ACT_NONE);
+    CHECK(ps2_cmd_on_reset(&c));
+    CHECK_INT(c.stats.completed, 1);
+    CHECK(!ps2_cmd_busy(&c));
+
+    // Self-test never reported: reset again
+    ps2_cmd_queue(&c, PS2_CMD_RESET, -1);
+    exchange(&c, 1000, 0xFA);
+    CHECK_INT(ps2_cmd_poll(&c, 1002 + PS2_CMD_RESET_TIMEOUT_MS, &byte), PS2_CMD_ACT_SEND);
+    CHECK_INT(byte, PS2_CMD_RESET);
+}
+
+static void test_unasked_reset(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    // Plugged in with nothing queued
+    CHECK(!ps2_cmd_on_reset(&c));
+    CHECK(!ps2_cmd_busy(&c));
+
+    // Replugged between a command and its argument
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, PS2_LED_CAPS);
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_SET_LEDS);
+    CHECK(!ps2_cmd_on_reset(&c));
+    CHECK_INT(exchange(&c, 10, 0xFA), PS2_CMD_SET_LEDS);
+    CHECK_INT(exchange(&c, 20, 0xFA), PS2_LED_CAPS);
+    CHECK_INT(c.stats.completed, 1);
+
+    // A byte on the line finishes first
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0);
+    CHECK_INT(send_next(&c, 30), PS2_CMD_SET_LEDS);
+    CHECK(!ps2_cmd_on_reset(&c));
+    CHECK_INT(c.state, PS2_CMD_SENDING);
+}
+
+static void test_queue(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    // LEDs set every frame collapse into one command
+    for (int i = 0; i < 20; ++i) CHECK(ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, i & 7));
+    CHECK_INT((uint8_t)(c.head - c.tail), 1);
+    CHECK_INT(exchange(&c, 0, 0xFA), PS2_CMD_SET_LEDS);
+    // Between command and argument the argument can still change
+    CHECK(ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, PS2_LED_NUM));
+    CHECK_INT((uint8_t)(c.head - c.tail), 1);
+    // Once the argument is on the line, a change is queued after it
+    CHECK_INT(send_next(&c, 10), PS2_LED_NUM);
+    CHECK(ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0));
+    CHECK_INT((uint8_t)(c.head - c.tail), 2);
+    ps2_cmd_line_done(&c, 11, true);
+    ps2_cmd_on_reply(&c, 0xFA, 12);
+    CHECK_INT(exchange(&c, 20, 0xFA), PS2_CMD_SET_LEDS);
+    CHECK_INT(exchange(&c, 30, 0xFA), 0);
+
+    // Full
+    for (int i = 0; i < PS2_CMD_QUEUE_SIZE; ++i) CHECK(ps2_cmd_queue(&c, (uint8_t)(0xE0 + i), -1));
+    CHECK(!ps2_cmd_queue(&c, PS2_CMD_TYPEMATIC, 0));
+    // A command and the same without argument are different entries
+    CHECK(ps2_cmd_queue(&c, 0xE0, -1));
+    ps2_cmd_clear(&c);
+    CHECK(!ps2_cmd_busy(&c));
+    CHECK_INT(c.stats.completed, 2);
+}
+
+static void test_deadline_wrap(void) {
+    ps2_cmd_t c;
+    ps2_cmd_init(&c);
+    ps2_cmd_queue(&c, PS2_CMD_SET_LEDS, 0);
+    const uint32_t t = 0xFFFFFFF8u;
+    CHECK_INT(send_next(&c, t), PS2_CMD_SET_LEDS);
+    uint8_t byte;
+    CHECK_INT(ps2_cmd_poll(&c, t + 5, &byte), PS2_CMD_ACT_NONE);
+    CHECK_INT(ps2_cmd_poll(&c, t + PS2_CMD_LINE_TIMEOUT_MS, &byte), PS2_CMD_ACT_ABORT);
+}
+
+static void test_tx_frame(void) {
+    // ED has six ones: parity 1; everything inverted
+    CHECK_INT(ps2_cmd_tx_frame(0xED), 0x012);
+    CHECK_INT(ps2_cmd_tx_frame(0x00), 0x0FF);
+    CHECK_INT(ps2_cmd_tx_frame(0xFF), 0x000);
+}
+
+int main(void) {
+    TEST_RUN(test_set_leds);
+    TEST_RUN(test_resend);
+    TEST_RUN(test_fa_before_line_done);
+    TEST_RUN(test_timeouts);
+    TEST_RUN(test_gives_up);
+    TEST_RUN(test_reset);
+    TEST_RUN(test_unasked_reset);
+    TEST_RUN(test_queue);
+    TEST_RUN(test_deadline_wrap);
+    TEST_RUN(test_tx_frame);
+    return test_finish();
+}
@@ -0,0 +1,166 @@
+/*
+ * murmprince - PS/2 receive path and scancode set 2 decoder tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ps2kbd/ps2_rx.h"
+#include "test.h"
+
+// A frame as the PIO program leaves it; bad_parity / bad_stop spoil it
+static uint32_t frame(uint8_t byte, bool bad_parity, bool bad_stop) {
+    int ones = 0;
+    for (uint8_t v = byte; v; v &= (uint8_t)(v - 1)) ++ones;
+    uint32_t parity = (ones & 1) ? 0 : 1;
+    if (bad_parity) parity ^= 1;
+    const uint32_t bits = byte | (parity << 8) | ((bad_stop ? 0u : 1u) << 9);
+    // Start bit and whatever was below it are shifted out
+    return (bits << 22) | 0x155555u;
+}
+
+// Decode a byte sequence; returns the events
+static int decode(const uint8_t *bytes, int n, ps2_event_t *events) {
+    ps2_decoder_t d;
+    ps2_decoder_init(&d);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (ps2_decoder_feed(&d, bytes[i], &events[count])) ++count;
+    }
+    return count;
+}
+
+#define CHECK_KEY(ev, pfx, c, rel)        \
+    do {                                  \
+        CHECK_INT((ev).type, PS2_EV_KEY); \
+        CHECK_INT((ev).prefix, (pfx));    \
+        CHECK_INT((ev).code, (c));        \
+        CHECK_INT((ev).release, (rel));   \
+    } while (0)
+
+static void test_frames(void) {
+    for (int b = 0; b < 256; ++b) {
+        uint8_t out = 0;
+        CHECK_INT(ps2_rx_decode_frame(frame((uint8_t)b, false, false), &out), PS2_FRAME_OK);
+        CHECK_INT(out, b);
+        CHECK_INT(ps2_rx_decode_frame(frame((uint8_t)b, true, false), &out), PS2_FRAME_PARITY);
+        CHECK_INT(ps2_rx_decode_frame(frame((uint8_t)b, false, true), &out), PS2_FRAME_STOP);
+    }
+}
+
+static void test_ring(void) {
+    ps2_rx_ring_t r;
+    ps2_rx_init(&r);
+    ps2_rx_push_frame(&r, frame(0x1C, false, false));
+    ps2_rx_push_frame(&r, frame(0x1C, true, false));
+    ps2_rx_push_frame(&r, frame(0x1C, false, true));
+    ps2_rx_push_frame(&r, frame(0x00, false, false));
+    CHECK_INT(r.stats.frames, 2);
+    CHECK_INT(r.stats.parity_errors, 1);
+    CHECK_INT(r.stats.framing_errors, 1);
+    CHECK_INT(r.stats.kbd_overruns, 1);
+
+    uint16_t e;
+    CHECK(ps2_rx_pop(&r, &e) && e == 0x1C);
+    CHECK(ps2_rx_pop(&r, &e) && e == PS2_RX_LINE_ERROR);
+    CHECK(ps2_rx_pop(&r, &e) && e == PS2_RX_LINE_ERROR);
+    CHECK(ps2_rx_pop(&r, &e) && e == 0x00);
+    CHECK(!ps2_rx_pop(&r, &e));
+    CHECK(!ps2_rx_take_overflow(&r));
+
+    // Full: the newest entries are dropped and flagged once
+    for (int i = 0; i < PS2_RX_RING_SIZE + 3; ++i) ps2_rx_push_frame(&r, frame((uint8_t)i, false, false));
+    CHECK_INT(r.stats.ring_overflows, 3);
+    CHECK(ps2_rx_take_overflow(&r));
+    CHECK(!ps2_rx_take_overflow(&r));
+    int n = 0;
+    while (ps2_rx_pop(&r, &e)) CHECK_INT(e, (uint8_t)n++);
+    CHECK_INT(n, PS2_RX_RING_SIZE);
+}
+
+static void test_plain_keys(void) {
+    // A down, A up, Left (E0 6B) down and up
+    const uint8_t bytes[] = {0x1C, 0xF0, 0x1C, 0xE0, 0x6B, 0xE0, 0xF0, 0x6B};
+    ps2_event_t ev[8];
+    CHECK_INT(decode(bytes, sizeof(bytes), ev), 4);
+    CHECK_KEY(ev[0], 0, 0x1C, false);
+    CHECK_KEY(ev[1], 0, 0x1C, true);
+    CHECK_KEY(ev[2], 0xE0, 0x6B, false);
+    CHECK_KEY(ev[3], 0xE0, 0x6B, true);
+}
+
+static void test_print_screen(void) {
+    // Make E0 12 E0 7C, break E0 F0 7C E0 F0 12
+    const uint8_t bytes[] = {0xE0, 0x12, 0xE0, 0x7C, 0xE0, 0xF0, 0x7C, 0xE0, 0xF0, 0x12};
+    ps2_event_t ev[8];
+    CHECK_INT(decode(bytes, sizeof(bytes), ev), 4);
+    CHECK_KEY(ev[0], 0xE0, 0x12, false);
+    CHECK_KEY(ev[1], 0xE0, 0x7C, false);
+    CHECK_KEY(ev[2], 0xE0, 0x7C, true);
+    CHECK_KEY(ev[3], 0xE0, 0x12, true);
+}
+
+static void test_pause(void) {
+    // Pause sends make and break at once: E1 14 77 E1 F0 14 F0 77
+    const uint8_t bytes[] = {0xE1, 0x14, 0x77, 0xE1, 0xF0, 0x14, 0xF0, 0x77, 0x1C};
+    ps2_event_t ev[8];
+    CHECK_INT(decode(bytes, sizeof(bytes), ev), 3);
+    CHECK_KEY(ev[0], 0xE1, 0x77, false);
+    CHECK_KEY(ev[1], 0xE1, 0x77, true);
+    // Back to plain keys afterwards
+    CHECK_KEY(ev[2], 0, 0x1C, false);
+
+    // An E1 sequence that is not Pause gives nothing
+    const uint8_t odd[] = {0xE1, 0x33, 0x44, 0x1C};
+    CHECK_INT(decode(odd, sizeof(odd), ev), 1);
+    CHECK_KEY(ev[0], 0, 0x1C, false);
+}
+
+static void test_replies_and_errors(void) {
+    const uint8_t bytes[] = {0xAA, 0xFA, 0xFE, 0xEE, 0xFC, 0x00, 0xFF};
+    ps2_event_t ev[8];
+    CHECK_INT(decode(bytes, sizeof(bytes), ev), 7);
+    CHECK_INT(ev[0].type, PS2_EV_RESET);
+    CHECK_INT(ev[1].type, PS2_EV_REPLY);
+    CHECK_INT(ev[1].code, 0xFA);
+    CHECK_INT(ev[2].code, 0xFE);
+    CHECK_INT(ev[3].code, 0xEE);
+    CHECK_INT(ev[4].type, PS2_EV_ERROR);
+    CHECK_INT(ev[5].type, PS2_EV_ERROR);
+    CHECK_INT(ev[6].type, PS2_EV_ERROR);
+
+    // An ACK between prefix and code does not lose the prefix
+    const uint8_t acked[] = {0xE0, 0xFA, 0x75};
+    CHECK_INT(decode(acked, sizeof(acked), ev), 2);
+    CHECK_KEY(ev[1], 0xE0, 0x75, false);
+}
+
+static void test_line_error_resets(void) {
+    ps2_decoder_t d;
+    ps2_event_t ev;
+    ps2_decoder_init(&d);
+    // E0 F0 then a damaged byte: the next code is a plain press
+    CHECK(!ps2_decoder_feed(&d, 0xE0, &ev));
+    CHECK(!ps2_decoder_feed(&d, 0xF0, &ev));
+    CHECK(ps2_decoder_feed(&d, PS2_RX_LINE_ERROR, &ev));
+    CHECK_INT(ev.type, PS2_EV_ERROR);
+    CHECK(ps2_decoder_feed(&d, 0x74, &ev));
+    CHECK_KEY(ev, 0, 0x74, false);
+
+    // Keyboard replugged halfway through a release
+    CHECK(!ps2_decoder_feed(&d, 0xF0, &ev));
+    CHECK(ps2_decoder_feed(&d, 0xAA, &ev));
+    CHECK_INT(ev.type, PS2_EV_RESET);
+    CHECK(ps2_decoder_feed(&d, 0x1C, &ev));
+    CHECK_KEY(ev, 0, 0x1C, false);
+}
+
+int main(void) {
+    TEST_RUN(test_frames);
+    TEST_RUN(test_ring);
+    TEST_RUN(test_plain_keys);
+    TEST_RUN(test_print_screen);
+    TEST_RUN(test_pause);
+    TEST_RUN(test_replies_and_errors);
+    TEST_RUN(test_line_error_resets);
+    return test_finish();
+}
@@ -0,0 +1,199 @@
+/*
+ * murmprince - PSRAM calibration tests (search, pattern test, size detection)
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "psram_cal.h"
+#include "test.h"
+
+#include <stdlib.h>
+
+// Simulated chip: bit r of pass[d] set if divisor d works with rxdelay r
+typedef struct {
+    unsigned pass[8];
+    int calls[8];
+} chip_t;
+
+static bool probe(void *ctx, int divisor, int rxdelay) {
+    chip_t *c = (chip_t *)ctx;
+    if (divisor < 0 || divisor >= 8) return false;
+    c->calls[divisor]++;
+    return (c->pass[divisor] >> rxdelay) & 1;
+}
+
+static void test_fastest_divisor_wins(void) {
+    chip_t c = {0};
+    c.pass[2] = 0x0C;        // 2-3: too narrow
+    c.pass[3] = 0x3C;        // 2-5
+    c.pass[4] = 0xFF;
+    psram_cal_result_t r;
+    psram_cal_search(2, 5, 3, probe, &c, &r);
+    CHECK(r.ok);
+    CHECK_INT(r.divisor, 3);
+    CHECK_INT(r.window_lo, 2);
+    CHECK_INT(r.window_hi, 5);
+    // Centre of an even window rounds towards the later sample
+    CHECK_INT(r.rxdelay, 4);
+    CHECK_INT(r.margin, 1);
+    // Stops at the winner: every setting of 2 and 3, none of 4
+    CHECK_INT(r.probes, 2 * (PSRAM_CAL_RXDELAY_MAX + 1));
+    CHECK_INT(c.calls[4], 0);
+}
+
+static void test_widest_run(void) {
+    chip_t c = {0};
+    c.pass[2] = 0xE3;        // 0-1 and 5-7: the later one is wider
+    psram_cal_result_t r;
+    psram_cal_search(2, 2, 2, probe, &c, &r);
+    CHECK(r.ok);
+    CHECK_INT(r.window_lo, 5);
+    CHECK_INT(r.window_hi, 7);
+    CHECK_INT(r.rxdelay, 6);
+    CHECK_INT(r.margin, 1);
+
+    // Equal runs: the first
+    c.pass[2] = 0x33;        // 0-1 and 4-5
+    psram_cal_search(2, 2, 2, probe, &c, &r);
+    CHECK_INT(r.window_lo, 0);
+    CHECK_INT(r.window_hi, 1);
+    CHECK_INT(r.rxdelay, 1);
+    CHECK_INT(r.margin, 0);
+}
+
+static void test_run_to_the_end(void) {
+    chip_t c = {0};
+    c.pass[1] = 0xF0;        // 4-7 runs into the end of the field
+    psram_cal_result_t r;
+    psram_cal_search(1, 1, 4, probe, &c, &r);
+    CHECK(r.ok);
+    CHECK_INT(r.window_lo, 4);
+    CHECK_INT(r.window_hi, PSRAM_CAL_RXDELAY_MAX);
+    CHECK_INT(r.rxdelay, 6);
+
+    c.pass[1] = 0xFF;        // all pass
+    psram_cal_search(1, 1, 1, probe, &c, &r);
+    CHECK_INT(r.rxdelay, 4);
+    CHECK_INT(r.margin, 3);
+}
+
+static void test_nothing_passes(void) {
+    chip_t c = {0};
+    c.pass[3] = 0x08;        // a single setting, below min_width
+    psram_cal_result_t r;
+    psram_cal_search(2, 4, 2, probe, &c, &r);
+    CHECK(!r.ok);
+    CHECK_INT(r.probes, 3 * (PSRAM_CAL_RXDELAY_MAX + 1));
+    // With min_width 1 it is enough
+    psram_cal_search(2, 4, 1, probe, &c, &r);
+    CHECK(r.ok);
+    CHECK_INT(r.divisor, 3);
+    CHECK_INT(r.rxdelay, 3);
+    CHECK_INT(r.margin, 0);
+}
+
+static void test_bad_arguments(void) {
+    chip_t c = {0};
+    c.pass[1] = 0x02;
+    psram_cal_result_t r;
+    // Divisor 0 does not exist; min_width 0 means 1
+    psram_cal_search(0, 1, 0, probe, &c, &r);
+    CHECK(r.ok);
+    CHECK_INT(r.divisor, 1);
+    CHECK_INT(c.calls[0], 0);
+    // Empty range
+    psram_cal_search(3, 2, 1, probe, &c, &r);
+    CHECK(!r.ok);
+    CHECK_INT(r.probes, 0);
+}
+
+// Simulated chip for the pattern test: chip_bytes of storage, address bits
+// above that ignored (the access wraps onto the start), optionally one
+// stuck address line or data bit.
+typedef struct {
+    uint32_t *words;
+    uint32_t mask;          // chip words - 1
+    uint32_t stuck_addr;    // address bits that read as 0
+    uint32_t stuck_data;    // data bits that read as 0
+    long writes;
+} sim_chip_t;
+
+static void sim_write(void *ctx, uint32_t word, uint32_t value) {
+    sim_chip_t *c = (sim_chip_t *)ctx;
+    c->words[word & c->mask & ~c->stuck_addr] = value;
+    c->writes++;
+}
+
+static uint32_t sim_read(void *ctx, uint32_t word) {
+    sim_chip_t *c = (sim_chip_t *)ctx;
+    return c->words[word & c->mask & ~c->stuck_addr] & ~c->stuck_data;
+}
+
+static psram_cal_mem_t sim_chip(sim_chip_t *c, size_t chip_bytes) {
+    memset(c, 0, sizeof(*c));
+    c->words = calloc(chip_bytes / 4, 4);
+    c->mask = (uint32_t)(chip_bytes / 4 - 1);
+    return (psram_cal_mem_t){ sim_write, sim_read, c };
+}
+
+#define MB (1024u * 1024u)
+#define WINDOW (16u * MB)
+
+static void test_detect_size(void) {
+    static const size_t sizes[] = { 1 * MB, 2 * MB, 8 * MB, 16 * MB };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        sim_chip_t c;
+        const psram_cal_mem_t mem = sim_chip(&c, sizes[i]);
+        CHECK_INT(psram_cal_detect_size(&mem, WINDOW), sizes[i]);
+        free(c.words);
+    }
+    // Nothing holds a value: no chip
+    sim_chip_t c;
+    psram_cal_mem_t mem = sim_chip(&c, 2 * MB);
+    c.stuck_data = 0xFFFFFFFFu;
+    CHECK_INT(psram_cal_detect_size(&mem, WINDOW), 0);
+    free(c.words);
+}
+
+static void test_pattern_2mb(void) {
+    // A 2 MB chip aliases every 2 MB: walking the address lines of an
+    // 8 MB window lands on word 0 and fails at any timing
+    sim_chip_t c;
+    const psram_cal_mem_t mem = sim_chip(&c, 2 * MB);
+    const size_t size = psram_cal_detect_size(&mem, WINDOW);
+    CHECK_INT(size, 2 * MB);
+    CHECK(!psram_cal_pattern(&mem, 8 * MB, false, 0x0102));
+    CHECK(psram_cal_pattern(&mem, size, false, 0x0102));
+    CHECK(psram_cal_pattern(&mem, size, true, 0x0203));
+    free(c.words);
+}
+
+static void test_pattern_faults(void) {
+    sim_chip_t c;
+    const psram_cal_mem_t mem = sim_chip(&c, 8 * MB);
+    CHECK(psram_cal_pattern(&mem, 8 * MB, false, 1));
+    const long full = c.writes;
+    c.writes = 0;
+    CHECK(psram_cal_pattern(&mem, 8 * MB, true, 1));
+    CHECK(c.writes < full / 10);
+
+    // The top address line of the chip, and a data bit
+    c.stuck_addr = 1u << 20;
+    CHECK(!psram_cal_pattern(&mem, 8 * MB, true, 1));
+    c.stuck_addr = 0;
+    c.stuck_data = 1u << 17;
+    CHECK(!psram_cal_pattern(&mem, 8 * MB, true, 1));
+    free(c.words);
+}
+
+int main(void) {
+    TEST_RUN(test_fastest_divisor_wins);
+    TEST_RUN(test_widest_run);
+    TEST_RUN(test_run_to_the_end);
+    TEST_RUN(test_nothing_passes);
+    TEST_RUN(test_bad_arguments);
+    TEST_RUN(test_detect_size);
+    TEST_RUN(test_pattern_2mb);
+    TEST_RUN(test_pattern_faults);
+    return test_finish();
+}
@@ -0,0 +1,277 @@
+/*
+ * murmprince - save slot tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "save_slots.h"
+#include "pop_fs.h"
+#include "ram_disk.h"
+#include "test.h"
+
+static save_slot_t make_slot(uint16_t level, uint16_t rem_min, const char *levelset) {
+    save_slot_t s;
+    memset(&s, 0, sizeof(s));
+    s.status = SAVE_SLOT_OK;
+    s.seq = 77;
+    s.level = level;
+    s.rem_min = rem_min;
+    s.rem_tick = 719;
+    s.hitp = 4;
+    snprintf(s.levelset, sizeof(s.levelset), "%s", levelset);
+    return s;
+}
+
+// Same CRC as the records, to forge one that passes the checksum
+static uint32_t crc32(const uint8_t *p, size_t n) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (n--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static void resign(uint8_t rec[SAVE_SLOTS_RECORD_SIZE]) {
+    const uint32_t crc = crc32(rec, SAVE_SLOTS_RECORD_SIZE - 4);
+    for (int i = 0; i < 4; ++i) rec[SAVE_SLOTS_RECORD_SIZE - 4 + i] = (uint8_t)(crc >> (8 * i));
+}
+
+static bool write_file(const char *path, const void *data, size_t len) {
+    FIL *f = pop_fs_open(path, "wb");
+    if (!f) return false;
+    const bool ok = pop_fs_write(data, 1, len, f) == len;
+    return pop_fs_close(f) == 0 && ok;
+}
+
+static void test_codec(void) {
+    const save_slot_t s = make_slot(7, 42, "Prince of Persia 4D");
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    save_slot_encode(&s, 3, rec);
+    CHECK(memcmp(rec, "PSLT", 4) == 0);
+    CHECK_INT(rec[5], 3);
+
+    save_slot_t back;
+    CHECK_INT(save_slot_decode(rec, 3, &back), SAVE_SLOT_OK);
+    CHECK(memcmp(&s, &back, sizeof(s)) == 0);
+    // Another slot's record
+    CHECK_INT(save_slot_decode(rec, 4, &back), SAVE_SLOT_DAMAGED);
+
+    // Any flipped bit is caught
+    for (int i = 0; i < SAVE_SLOTS_RECORD_SIZE; i += 7) {
+        rec[i] ^= 0x10;
+        CHECK_INT(save_slot_decode(rec, 3, &back), SAVE_SLOT_DAMAGED);
+        rec[i] ^= 0x10;
+    }
+
+    // A correct checksum does not make a bad record good
+    uint8_t forged[SAVE_SLOTS_RECORD_SIZE];
+    memcpy(forged, rec, sizeof(forged));
+    forged[4] = 2;
+    resign(forged);
+    CHECK_INT(save_slot_decode(forged, 3, &back), SAVE_SLOT_DAMAGED);
+    memcpy(forged, rec, sizeof(forged));
+    memset(forged + 20, 'x', SAVE_SLOTS_LEVELSET_NAME); // name without its terminator
+    resign(forged);
+    CHECK_INT(save_slot_decode(forged, 3, &back), SAVE_SLOT_DAMAGED);
+
+    memset(rec, 0, sizeof(rec));
+    CHECK_INT(save_slot_decode(rec, 0, &back), SAVE_SLOT_EMPTY);
+}
+
+static void test_codec_long_name(void) {
+    save_slot_t s = make_slot(1, 60, "");
+    memset(s.levelset, 'n', sizeof(s.levelset)); // no terminator at all
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    save_slot_encode(&s, 0, rec);
+    save_slot_t back;
+    CHECK_INT(save_slot_decode(rec, 0, &back), SAVE_SLOT_OK);
+    CHECK_INT(strlen(back.levelset), SAVE_SLOTS_LEVELSET_NAME - 1);
+}
+
+static void test_from_legacy(void) {
+    // 60 minutes, 719 ticks, level 5, 3 hit points
+    const uint8_t good[SAVE_SLOTS_LEGACY_SIZE] = {60, 0, 0xCF, 0x02, 5, 0, 3, 0};
+    save_slot_t s;
+    CHECK(save_slot_from_legacy(good, "mymod", &s));
+    CHECK_INT(s.status, SAVE_SLOT_OK);
+    CHECK_INT(s.rem_min, 60);
+    CHECK_INT(s.rem_tick, 719);
+    CHECK_INT(s.level, 5);
+    CHECK_INT(s.hitp, 3);
+    CHECK_STR(s.levelset, "mymod");
+    CHECK(save_slot_from_legacy(good, NULL, &s));
+    CHECK_STR(s.levelset, "");
+
+    const uint8_t bad[][SAVE_SLOTS_LEGACY_SIZE] = {
+        {60, 0, 0, 0, 0, 0, 3, 0},        // level 0 (demo)
+        {60, 0, 0, 0, 16, 0, 3, 0},       // level 16
+        {60, 0, 0, 0, 5, 0, 0, 0},        // no hit points
+        {60, 0, 0, 0, 5, 0, 16, 0},
+        {0xFF, 0xFF, 0, 0, 5, 0, 3, 0},   // negative time
+        {60, 0, 0, 0x80, 5, 0, 3, 0},
+        {'h', 'e', 'l', 'l', 'o', '!', '\n', 0},
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        CHECK(!save_slot_from_legacy(bad[i], "", &s));
+    }
+}
+
+static void test_write_read(void) {
+    CHECK(ram_disk_format());
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    CHECK(save_slots_read_all(slots));
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) CHECK_INT(slots[i].status, SAVE_SLOT_EMPTY);
+    CHECK_INT(save_slots_latest(slots), -1);
+
+    save_slot_t a = make_slot(2, 55, ""), b = make_slot(9, 20, "mymod");
+    CHECK(save_slots_write(2, &a));
+    CHECK_INT(a.seq, 1);
+    CHECK(save_slots_write(5, &b));
+    CHECK_INT(b.seq, 2);
+    a.level = 3;
+    CHECK(save_slots_write(2, &a));
+    CHECK_INT(a.seq, 3);
+
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "rb");
+    CHECK(f && f_size(f) == SAVE_SLOTS_COUNT * SAVE_SLOTS_RECORD_SIZE);
+    pop_fs_close(f);
+
+    CHECK(save_slots_read_all(slots));
+    CHECK_INT(save_slots_latest(slots), 2);
+    CHECK_INT(slots[2].level, 3);
+    CHECK_STR(slots[5].levelset, "mymod");
+    CHECK_INT(slots[0].status, SAVE_SLOT_EMPTY);
+
+    save_slot_t one;
+    CHECK(save_slots_read(5, &one));
+    CHECK_INT(one.level, 9);
+    CHECK(!save_slots_read(0, &one));
+    CHECK(!save_slots_read(SAVE_SLOTS_COUNT, &one));
+    CHECK(!save_slots_write(-1, &a));
+}
+
+static void test_damaged_record(void) {
+    CHECK(ram_disk_format());
+    save_slot_t a = make_slot(4, 30, ""), b = make_slot(6, 25, "");
+    CHECK(save_slots_write(0, &a));
+    CHECK(save_slots_write(1, &b));
+    // Garbage over slot 0 only
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "r+b");
+    CHECK(f != NULL);
+    pop_fs_write("garbage", 1, 7, f);
+    pop_fs_close(f);
+
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    CHECK(save_slots_read_all(slots));
+    CHECK_INT(slots[0].status, SAVE_SLOT_DAMAGED);
+    CHECK_INT(slots[1].status, SAVE_SLOT_OK);
+    // Not counted as empty by the import, but can be saved over
+    CHECK(save_slots_write(0, &a));
+    CHECK(save_slots_read(0, &a));
+}
+
+static void test_short_file(void) {
+    CHECK(ram_disk_format());
+    // A file cut while it was created: its records then are empty
+    save_slot_t a = make_slot(4, 30, "");
+    uint8_t rec[SAVE_SLOTS_RECORD_SIZE];
+    save_slot_encode(&a, 0, rec);
+    CHECK(write_file(SAVE_SLOTS_FILE, rec, sizeof(rec)));
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    CHECK(save_slots_read_all(slots));
+    CHECK_INT(slots[0].status, SAVE_SLOT_OK);
+    CHECK_INT(slots[1].status, SAVE_SLOT_EMPTY);
+    // The next save rebuilds it at full size
+    CHECK(save_slots_write(3, &a));
+    FIL *f = pop_fs_open(SAVE_SLOTS_FILE, "rb");
+    CHECK(f && f_size(f) == SAVE_SLOTS_COUNT * SAVE_SLOTS_RECORD_SIZE);
+    pop_fs_close(f);
+}
+
+static void test_power_cut(void) {
+    // Cut the power after every possible number of sector writes: the
+    // slot holds the old save or the new one, and the others stay
+    for (int budget = 0; budget < 8; ++budget) {
+        CHECK(ram_disk_format());
+        save_slot_t old = make_slot(3, 40, ""), other = make_slot(8, 12, "");
+        CHECK(save_slots_write(1, &old));
+        CHECK(save_slots_write(6, &other));
+
+        save_slot_t next = make_slot(4, 39, "");
+        ram_disk_set_write_budget(budget);
+        save_slots_write(1, &next);
+        CHECK(ram_disk_remount());
+        pop_fs_reset();
+
+        save_slot_t slots[SAVE_SLOTS_COUNT];
+        CHECK(save_slots_read_all(slots));
+        CHECK_INT(slots[1].status, SAVE_SLOT_OK);
+        CHECK(slots[1].level == 3 || slots[1].level == 4);
+        CHECK_INT(slots[6].level, 8);
+        for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+            if (i != 1 && i != 6) CHECK_INT(slots[i].status, SAVE_SLOT_EMPTY);
+        }
+    }
+}
+
+static void test_import_legacy(void) {
+    CHECK(ram_disk_format());
+    const uint8_t sav[SAVE_SLOTS_LEGACY_SIZE] = {50, 0, 0, 0, 6, 0, 4, 0};
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), -1); // none there
+
+    save_slot_t taken = make_slot(2, 60, "");
+    CHECK(save_slots_write(0, &taken));
+    CHECK(write_file(SAVE_SLOTS_LEGACY_FILE, sav, sizeof(sav)));
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), 1);
+    CHECK(!pop_fs_exists(SAVE_SLOTS_LEGACY_FILE));
+    // Gone, so a second start screen visit imports nothing
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), -1);
+
+    // A levelset's own save
+    CHECK(pop_fs_mkdir("mods"));
+    CHECK(pop_fs_mkdir("mods/mymod"));
+    CHECK(write_file("mods/mymod/" SAVE_SLOTS_LEGACY_FILE, sav, sizeof(sav)));
+    CHECK_INT(save_slots_import_legacy("mods/mymod/" SAVE_SLOTS_LEGACY_FILE, "mymod"), 2);
+
+    save_slot_t slots[SAVE_SLOTS_COUNT];
+    CHECK(save_slots_read_all(slots));
+    CHECK_INT(slots[1].level, 6);
+    CHECK_INT(slots[1].rem_min, 50);
+    CHECK_STR(slots[1].levelset, "");
+    CHECK_STR(slots[2].levelset, "mymod");
+    // Imported last, so it is the one to continue
+    CHECK_INT(save_slots_latest(slots), 2);
+
+    // Not a save, or too short: it stays where it is
+    CHECK(write_file(SAVE_SLOTS_LEGACY_FILE, "not a save", 10));
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), -1);
+    CHECK(write_file(SAVE_SLOTS_LEGACY_FILE, sav, 4));
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), -1);
+    CHECK(pop_fs_exists(SAVE_SLOTS_LEGACY_FILE));
+}
+
+static void test_import_no_free_slot(void) {
+    CHECK(ram_disk_format());
+    for (int i = 0; i < SAVE_SLOTS_COUNT; ++i) {
+        save_slot_t s = make_slot((uint16_t)(i + 1), 60, "");
+        CHECK(save_slots_write(i, &s));
+    }
+    const uint8_t sav[SAVE_SLOTS_LEGACY_SIZE] = {50, 0, 0, 0, 6, 0, 4, 0};
+    CHECK(write_file(SAVE_SLOTS_LEGACY_FILE, sav, sizeof(sav)));
+    CHECK_INT(save_slots_import_legacy(SAVE_SLOTS_LEGACY_FILE, ""), -1);
+    CHECK(pop_fs_exists(SAVE_SLOTS_LEGACY_FILE));
+}
+
+int main(void) {
+    TEST_RUN(test_codec);
+    TEST_RUN(test_codec_long_name);
+    TEST_RUN(test_from_legacy);
+    TEST_RUN(test_write_read);
+    TEST_RUN(test_damaged_record);
+    TEST_RUN(test_short_file);
+    TEST_RUN(test_power_cut);
+    TEST_RUN(test_import_legacy);
+    TEST_RUN(test_import_no_free_slot);
+    return test_finish();
+}
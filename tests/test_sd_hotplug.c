@@ -0,0 +1,148 @@
+/*
+ * murmprince - SD card removal tracking tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "sd_hotplug.h"
+#include "pop_fs.h"
+#include "ram_disk.h"
+#include "test.h"
+
+#define RETRY_MS 250
+
+// The card slot: the RAM disk, which can be pulled out
+typedef struct {
+    bool inserted;
+    int queries;
+    int remount_tries;
+} slot_t;
+
+static bool slot_card_ok(void *ctx) {
+    slot_t *s = (slot_t *)ctx;
+    s->queries++;
+    return s->inserted;
+}
+
+static bool slot_remount(void *ctx) {
+    slot_t *s = (slot_t *)ctx;
+    s->remount_tries++;
+    return s->inserted && ram_disk_remount();
+}
+
+static void setup(sd_hotplug_t *hp, slot_t *s) {
+    static bool formatted;
+    if (!formatted) formatted = ram_disk_format();
+    memset(s, 0, sizeof(*s));
+    s->inserted = true;
+    const sd_hotplug_ops_t ops = {slot_card_ok, slot_remount, s};
+    sd_hotplug_init(hp, &ops, RETRY_MS);
+}
+
+static void test_other_errors(void) {
+    sd_hotplug_t hp;
+    slot_t s;
+    setup(&hp, &s);
+    CHECK(sd_hotplug_present(&hp));
+    // The card answers: the error was something else
+    CHECK(sd_hotplug_on_io_error(&hp, 10));
+    CHECK(sd_hotplug_present(&hp));
+    CHECK_INT(s.queries, 1);
+    CHECK_INT(hp.removals, 0);
+    CHECK(sd_hotplug_poll(&hp, 20));
+    CHECK_INT(s.remount_tries, 0);
+}
+
+static void test_remove_and_reinsert(void) {
+    sd_hotplug_t hp;
+    slot_t s;
+    setup(&hp, &s);
+    s.inserted = false;
+    CHECK(!sd_hotplug_on_io_error(&hp, 1000));
+    CHECK(!sd_hotplug_present(&hp));
+    CHECK_INT(hp.removals, 1);
+    // Further errors while gone do not query the card again
+    CHECK(!sd_hotplug_on_io_error(&hp, 1001));
+    CHECK_INT(s.queries, 1);
+    CHECK_INT(hp.removals, 1);
+
+    // Retries once per interval, the first a full interval after the loss
+    CHECK(!sd_hotplug_poll(&hp, 1000 + RETRY_MS - 1));
+    CHECK_INT(s.remount_tries, 0);
+    CHECK(!sd_hotplug_poll(&hp, 1000 + RETRY_MS));
+    CHECK_INT(s.remount_tries, 1);
+    CHECK(!sd_hotplug_poll(&hp, 1000 + RETRY_MS + 100));
+    CHECK_INT(s.remount_tries, 1);
+
+    s.inserted = true;
+    // Inserted, but the next try is not due yet
+    CHECK(!sd_hotplug_poll(&hp, 1000 + 2 * RETRY_MS - 1));
+    CHECK(sd_hotplug_poll(&hp, 1000 + 2 * RETRY_MS));
+    CHECK(sd_hotplug_present(&hp));
+    CHECK_INT(hp.generation, 1);
+    CHECK_INT(hp.remounts, 1);
+    CHECK_INT(s.remount_tries, 2);
+}
+
+static void test_generation_per_remount(void) {
+    sd_hotplug_t hp;
+    slot_t s;
+    setup(&hp, &s);
+    uint32_t now = 0;
+    for (int i = 1; i <= 3; ++i) {
+        s.inserted = false;
+        sd_hotplug_on_io_error(&hp, now);
+        s.inserted = true;
+        now += RETRY_MS;
+        CHECK(sd_hotplug_poll(&hp, now));
+        CHECK_INT(hp.generation, i);
+    }
+    CHECK_INT(hp.removals, 3);
+    CHECK_INT(hp.remounts, 3);
+}
+
+static void test_clock_wrap(void) {
+    sd_hotplug_t hp;
+    slot_t s;
+    setup(&hp, &s);
+    s.inserted = false;
+    const uint32_t t = 0xFFFFFF00u;
+    sd_hotplug_on_io_error(&hp, t);
+    s.inserted = true;
+    CHECK(!sd_hotplug_poll(&hp, t + RETRY_MS - 1));
+    CHECK(sd_hotplug_poll(&hp, t + RETRY_MS)); // past 2^32
+}
+
+static void test_card_contents_survive(void) {
+    sd_hotplug_t hp;
+    slot_t s;
+    CHECK(ram_disk_format());
+    FIL *f = pop_fs_open("PRINCE.DAT", "wb");
+    CHECK(f != NULL);
+    pop_fs_write("data", 1, 4, f);
+    CHECK_INT(pop_fs_close(f), 0);
+
+    setup(&hp, &s);
+    s.inserted = false;
+    sd_hotplug_on_io_error(&hp, 0);
+    s.inserted = true;
+    CHECK(sd_hotplug_poll(&hp, RETRY_MS));
+    // The same card, mounted again
+    char buf[8] = {0};
+    f = pop_fs_open("PRINCE.DAT", "rb");
+    CHECK(f != NULL);
+    if (f) {
+        CHECK_INT(pop_fs_read(buf, 1, sizeof(buf), f), 4);
+        pop_fs_close(f);
+    }
+    CHECK_STR(buf, "data");
+}
+
+int main(void) {
+    TEST_RUN(test_other_errors);
+    TEST_RUN(test_remove_and_reinsert);
+    TEST_RUN(test_generation_per_remount);
+    TEST_RUN(test_clock_wrap);
+    TEST_RUN(test_card_contents_survive);
+    return test_finish();
+}
@@ -0,0 +1,340 @@
+/*
+ * murmprince - serial test command tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "serial_cmd.h"
+#include "test.h"
+
+// Test host: collects what is sent, serves a small screen and a state
+typedef struct {
+    uint8_t out[16384];
+    size_t out_len;
+    bool playing;
+    int level_asked;
+    uint8_t screen[40 * 20];
+} host_t;
+
+static void host_write(void *ctx, const uint8_t *data, size_t len) {
+    host_t *h = (host_t *)ctx;
+    if (h->out_len + len <= sizeof(h->out)) memcpy(h->out + h->out_len, data, len);
+    h->out_len += len;
+}
+
+static bool host_state(void *ctx, serial_game_state_t *s) {
+    host_t *h = (host_t *)ctx;
+    if (!h->playing) return false;
+    s->level = 3;
+    s->room = 7;
+    s->rem_min = 0x1234;
+    s->rem_tick = 0x0ABC;
+    s->kid_room = 7;
+    s->kid_x = 100;
+    s->kid_y = 55;
+    s->kid_dir = 0xFF;
+    s->kid_frame = 15;
+    s->kid_action = 1;
+    s->kid_alive = -1;
+    s->kid_hp = 3;
+    s->kid_max_hp = 4;
+    s->guard_room = 7;
+    s->guard_x = 140;
+    s->guard_y = 118;
+    s->guard_dir = 0;
+    s->guard_hp = 2;
+    return true;
+}
+
+static bool host_level(void *ctx, int level) {
+    host_t *h = (host_t *)ctx;
+    h->level_asked = level;
+    return level <= 14;
+}
+
+static const uint8_t *host_screen(void *ctx, int *w, int *hgt) {
+    host_t *h = (host_t *)ctx;
+    *w = 40;
+    *hgt = 20;
+    return h->screen;
+}
+
+static uint32_t host_palette(void *ctx, uint8_t index) {
+    (void)ctx;
+    return 0x010203u * index;
+}
+
+static host_t g_host;
+static const serial_cmd_host_t g_hooks = {
+    &g_host, host_write, host_state, host_level, host_screen, host_palette,
+};
+
+static void reset(serial_cmd_t *c) {
+    memset(&g_host, 0, sizeof(g_host));
+    serial_cmd_init(c, &g_hooks);
+}
+
+// Frame at *pos in the output: checked, payload returned, *pos moved on
+static const uint8_t *next_frame(size_t *pos, uint8_t *type, uint8_t *seq, uint16_t *len) {
+    const uint8_t *f = g_host.out + *pos;
+    if (*pos + 8 > g_host.out_len || f[0] != SERIAL_CMD_SYNC0 || f[1] != SERIAL_CMD_SYNC1) return NULL;
+    *type = f[2];
+    *seq = f[3];
+    *len = (uint16_t)(f[4] | (f[5] << 8));
+    if (*pos + 8 + *len > g_host.out_len) return NULL;
+    const uint16_t crc = (uint16_t)(f[6 + *len] | (f[7 + *len] << 8));
+    if (crc != serial_cmd_crc16(0xFFFF, f + 2, 4 + (size_t)*len)) return NULL;
+    *pos += 8 + (size_t)*len;
+    return f + 6;
+}
+
+static void send_cmd(serial_cmd_t *c, uint8_t type, uint8_t seq, const void *payload, size_t len,
+                     uint32_t now_ms) {
+    uint8_t frame[SERIAL_CMD_MAX_PAYLOAD + 8];
+    const size_t n = serial_cmd_encode(frame, sizeof(frame), type, seq, payload, len);
+    CHECK(n == len + 8);
+    serial_cmd_feed(c, frame, n, now_ms);
+}
+
+static void put_key(uint8_t *p, uint32_t at_ms, uint16_t scancode, uint8_t down) {
+    p[0] = (uint8_t)at_ms;
+    p[1] = (uint8_t)(at_ms >> 8);
+    p[2] = (uint8_t)(at_ms >> 16);
+    p[3] = (uint8_t)(at_ms >> 24);
+    p[4] = (uint8_t)scancode;
+    p[5] = (uint8_t)(scancode >> 8);
+    p[6] = down;
+}
+
+static void test_crc(void) {
+    // CRC-16/CCITT-FALSE check value
+    CHECK_INT(serial_cmd_crc16(0xFFFF, (const uint8_t *)"123456789", 9), 0x29B1);
+    // In pieces gives the same
+    uint16_t crc = serial_cmd_crc16(0xFFFF, (const uint8_t *)"1234", 4);
+    CHECK_INT(serial_cmd_crc16(crc, (const uint8_t *)"56789", 5), 0x29B1);
+    uint8_t small[8];
+    CHECK_INT(serial_cmd_encode(small, sizeof(small), 1, 0, "x", 1), 0);
+}
+
+static void test_ping(void) {
+    serial_cmd_t c;
+    reset(&c);
+    send_cmd(&c, SERIAL_CMD_PING, 42, NULL, 0, 0x11223344);
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p != NULL);
+    if (!p) return;
+    CHECK_INT(type, SERIAL_CMD_PING | SERIAL_CMD_REPLY);
+    CHECK_INT(seq, 42);
+    CHECK_INT(len, 6);
+    CHECK_INT(p[0], SERIAL_CMD_OK);
+    CHECK_INT(p[1], SERIAL_CMD_VERSION);
+    CHECK_INT(p[2] | (p[3] << 8) | (p[4] << 16) | ((uint32_t)p[5] << 24), 0x11223344);
+    CHECK_INT(pos, g_host.out_len);
+    CHECK_INT(c.frames, 1);
+}
+
+static void test_resync(void) {
+    serial_cmd_t c;
+    reset(&c);
+    uint8_t stream[64];
+    size_t n = 0;
+    // Log text, a lone sync byte, and A5 A5 5A before a real frame
+    const char *noise = "boot ok\r\n";
+    memcpy(stream, noise, strlen(noise));
+    n += strlen(noise);
+    stream[n++] = SERIAL_CMD_SYNC0;
+    stream[n++] = 0x00;
+    stream[n++] = SERIAL_CMD_SYNC0;
+    n += serial_cmd_encode(stream + n, sizeof(stream) - n, SERIAL_CMD_PING, 1, NULL, 0);
+    // Fed one byte at a time
+    for (size_t i = 0; i < n; ++i) serial_cmd_feed(&c, stream + i, 1, 0);
+    CHECK_INT(c.frames, 1);
+    CHECK_INT(c.crc_errors, 0);
+
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    CHECK(next_frame(&pos, &type, &seq, &len) != NULL);
+    CHECK_INT(seq, 1);
+}
+
+static void test_bad_frames(void) {
+    serial_cmd_t c;
+    reset(&c);
+    uint8_t frame[SERIAL_CMD_MAX_PAYLOAD + 8];
+    size_t n = serial_cmd_encode(frame, sizeof(frame), SERIAL_CMD_LEVEL, 5, "\x03", 1);
+    frame[6] ^= 0x40;
+    serial_cmd_feed(&c, frame, n, 0);
+    CHECK_INT(c.crc_errors, 1);
+    CHECK_INT(c.frames, 0);
+    CHECK_INT(g_host.out_len, 0);
+    CHECK_INT(g_host.level_asked, 0);
+
+    // Longer than any command: dropped at the length, the next frame works
+    uint8_t big[SERIAL_CMD_MAX_PAYLOAD + 1 + 8];
+    n = serial_cmd_encode(big, sizeof(big), SERIAL_CMD_KEY, 6, big, SERIAL_CMD_MAX_PAYLOAD + 1);
+    CHECK(n != 0);
+    serial_cmd_feed(&c, big, 6, 0);
+    CHECK_INT(c.oversized, 1);
+    send_cmd(&c, SERIAL_CMD_PING, 7, NULL, 0, 0);
+    CHECK_INT(c.frames, 1);
+
+    // Unknown command and wrong lengths get a status
+    send_cmd(&c, 0x33, 8, NULL, 0, 0);
+    send_cmd(&c, SERIAL_CMD_KEY, 9, "abc", 3, 0);
+    send_cmd(&c, SERIAL_CMD_LEVEL, 10, "ab", 2, 0);
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    next_frame(&pos, &type, &seq, &len); // ping
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && type == (0x33 | SERIAL_CMD_REPLY) && p[0] == SERIAL_CMD_UNKNOWN);
+    p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && seq == 9 && p[0] == SERIAL_CMD_BAD_LENGTH);
+    p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && seq == 10 && p[0] == SERIAL_CMD_BAD_LENGTH);
+}
+
+static void test_key_timing(void) {
+    serial_cmd_t c;
+    reset(&c);
+    uint8_t keys[3 * SERIAL_CMD_KEY_SIZE];
+    put_key(keys, 0, 79, 1);                            // at once
+    put_key(keys + SERIAL_CMD_KEY_SIZE, 1100, 79, 0);
+    put_key(keys + 2 * SERIAL_CMD_KEY_SIZE, 1050, 80, 1); // earlier, but sent later
+    send_cmd(&c, SERIAL_CMD_KEY, 1, keys, sizeof(keys), 1000);
+
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && p[0] == SERIAL_CMD_OK && p[1] == 3);
+
+    int sc;
+    bool down;
+    CHECK(serial_cmd_next_key(&c, 1000, &sc, &down));
+    CHECK_INT(sc, 79);
+    CHECK(down);
+    CHECK(!serial_cmd_next_key(&c, 1099, &sc, &down));
+    CHECK(serial_cmd_next_key(&c, 1100, &sc, &down));
+    CHECK(!down);
+    // In the order sent: the third is already due
+    CHECK(serial_cmd_next_key(&c, 1100, &sc, &down));
+    CHECK_INT(sc, 80);
+    CHECK(!serial_cmd_next_key(&c, 5000, &sc, &down));
+
+    // Times across the 32-bit wrap
+    reset(&c);
+    put_key(keys, 0x00000010, 4, 1);
+    send_cmd(&c, SERIAL_CMD_KEY, 2, keys, SERIAL_CMD_KEY_SIZE, 0xFFFFFFF0u);
+    CHECK(!serial_cmd_next_key(&c, 0xFFFFFFF0u, &sc, &down));
+    CHECK(serial_cmd_next_key(&c, 0x00000010, &sc, &down));
+}
+
+static void test_key_queue_full(void) {
+    serial_cmd_t c;
+    reset(&c);
+    uint8_t keys[10 * SERIAL_CMD_KEY_SIZE];
+    for (int i = 0; i < 10; ++i) put_key(keys + i * SERIAL_CMD_KEY_SIZE, 0, (uint16_t)(4 + i), 1);
+    for (int i = 0; i < SERIAL_CMD_KEY_QUEUE / 10; ++i) {
+        send_cmd(&c, SERIAL_CMD_KEY, (uint8_t)i, keys, sizeof(keys), 0);
+    }
+    const int room = SERIAL_CMD_KEY_QUEUE % 10;
+    send_cmd(&c, SERIAL_CMD_KEY, 99, keys, sizeof(keys), 0);
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = NULL;
+    while (pos < g_host.out_len) p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && seq == 99 && p[0] == SERIAL_CMD_QUEUE_FULL && p[1] == room);
+    int sc;
+    bool down;
+    int played = 0;
+    while (serial_cmd_next_key(&c, 0, &sc, &down)) ++played;
+    CHECK_INT(played, SERIAL_CMD_KEY_QUEUE);
+}
+
+static void test_state_layout(void) {
+    serial_cmd_t c;
+    reset(&c);
+    send_cmd(&c, SERIAL_CMD_STATE, 3, NULL, 0, 0);
+    g_host.playing = true;
+    send_cmd(&c, SERIAL_CMD_STATE, 4, NULL, 0, 0);
+
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && p[0] == SERIAL_CMD_REFUSED && len == 1);
+    p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p != NULL);
+    if (!p) return;
+    CHECK_INT(len, 1 + SERIAL_CMD_STATE_SIZE);
+    const uint8_t expect[1 + SERIAL_CMD_STATE_SIZE] = {
+        SERIAL_CMD_OK, 3, 7, 0x34, 0x12, 0xBC, 0x0A, 7, 100, 55, 0xFF,
+        15, 1, 0xFF, 3, 4, 7, 140, 118, 0, 2,
+    };
+    CHECK(memcmp(p, expect, sizeof(expect)) == 0);
+}
+
+static void test_level(void) {
+    serial_cmd_t c;
+    reset(&c);
+    send_cmd(&c, SERIAL_CMD_LEVEL, 1, "\x05", 1, 0);
+    CHECK_INT(g_host.level_asked, 5);
+    send_cmd(&c, SERIAL_CMD_LEVEL, 2, "\x20", 1, 0);
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && p[0] == SERIAL_CMD_OK);
+    p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && p[0] == SERIAL_CMD_REFUSED);
+}
+
+static void test_screen(void) {
+    serial_cmd_t c;
+    reset(&c);
+    for (size_t i = 0; i < sizeof(g_host.screen); ++i) g_host.screen[i] = (uint8_t)(i * 7);
+    send_cmd(&c, SERIAL_CMD_SCREEN, 9, NULL, 0, 0);
+
+    size_t pos = 0;
+    uint8_t type, seq;
+    uint16_t len;
+    const uint8_t *p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && p[0] == SERIAL_CMD_OK && p[1] == 40 && p[3] == 20);
+    p = next_frame(&pos, &type, &seq, &len);
+    CHECK(p && type == SERIAL_CMD_PALETTE && len == 768);
+    if (p) CHECK(p[3 * 10] == 10 && p[3 * 10 + 1] == 20 && p[3 * 10 + 2] == 30);
+
+    // Bands of SERIAL_CMD_SCREEN_ROWS rows cover the screen once
+    uint8_t copy[sizeof(g_host.screen)] = {0};
+    int rows = 0;
+    while ((p = next_frame(&pos, &type, &seq, &len)) != NULL) {
+        CHECK_INT(type, SERIAL_CMD_ROWS);
+        CHECK_INT(seq, 9);
+        const int y = p[0] | (p[1] << 8);
+        CHECK_INT(len, 3 + p[2] * 40);
+        memcpy(copy + y * 40, p + 3, (size_t)p[2] * 40);
+        rows += p[2];
+    }
+    CHECK_INT(rows, 20);
+    CHECK_INT(pos, g_host.out_len);
+    CHECK(memcmp(copy, g_host.screen, sizeof(copy)) == 0);
+}
+
+int main(void) {
+    TEST_RUN(test_crc);
+    TEST_RUN(test_ping);
+    TEST_RUN(test_resync);
+    TEST_RUN(test_bad_frames);
+    TEST_RUN(test_key_timing);
+    TEST_RUN(test_key_queue_full);
+    TEST_RUN(test_state_layout);
+    TEST_RUN(test_level);
+    TEST_RUN(test_screen);
+    return test_finish();
+}
@@ -0,0 +1,122 @@
+/*
+ * murmprince - start screen menu tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "start_menu.h"
+#include "test.h"
+
+#define SC_A 4
+#define SC_D 7
+#define SC_ESCAPE 41
+#define SC_SPACE 44
+#define SC_LEFT 80
+#define SC_LCTRL 224
+#define SC_RALT 230
+
+static start_menu_t menu(void) {
+    start_menu_t m;
+    start_menu_init(&m, 0, 3);
+    m.can_start = true;
+    return m;
+}
+
+// Controls page with the given action selected and waiting for a key
+static void capture_for(start_menu_t *m, key_action_t action) {
+    m->cursor = START_MENU_ITEM_CONTROLS;
+    start_menu_key(m, START_MENU_KEY_ENTER);
+    CHECK(m->controls);
+    for (int i = 0; i < (int)action; ++i) start_menu_key(m, START_MENU_KEY_DOWN);
+    start_menu_key(m, START_MENU_KEY_ENTER);
+    CHECK(m->capturing);
+}
+
+static void test_capture_binds(void) {
+    start_menu_t m = menu();
+    capture_for(&m, KEY_ACTION_LEFT);
+    start_menu_capture(&m, SC_A);
+    CHECK(!m.capturing);
+    CHECK(m.bindings_changed);
+    CHECK_INT(m.bindings.keys[KEY_ACTION_LEFT][1], SC_A);
+    CHECK_INT(start_menu_key(&m, START_MENU_KEY_BACK), START_MENU_SAVE_BINDINGS);
+    CHECK(!m.controls);
+}
+
+static void test_capture_moves_key(void) {
+    start_menu_t m = menu();
+    capture_for(&m, KEY_ACTION_RIGHT);
+    start_menu_capture(&m, SC_LEFT);
+    // Taken off "left": edits never create conflicts
+    CHECK_INT(key_bindings_count(&m.bindings, KEY_ACTION_LEFT), 0);
+    CHECK_INT(key_bindings_action_of(&m.bindings, SC_LEFT), KEY_ACTION_RIGHT);
+    CHECK(!key_bindings_find_conflict(&m.bindings, NULL, NULL, NULL));
+}
+
+static void test_capture_rejects(void) {
+    start_menu_t m = menu();
+    const key_bindings_t before = m.bindings;
+
+    capture_for(&m, KEY_ACTION_SHIFT);
+    start_menu_capture(&m, SC_ESCAPE); // cancels
+    CHECK(!m.capturing);
+    start_menu_key(&m, START_MENU_KEY_ENTER);
+    start_menu_capture(&m, SC_LCTRL);
+    start_menu_key(&m, START_MENU_KEY_ENTER);
+    start_menu_capture(&m, SC_RALT);
+    CHECK(memcmp(&m.bindings, &before, sizeof(before)) == 0);
+    CHECK(!m.bindings_changed);
+    // Nothing changed, nothing to save
+    CHECK_INT(start_menu_key(&m, START_MENU_KEY_BACK), START_MENU_NONE);
+
+    // A full action keeps its keys, and the key stays where it was
+    m = menu();
+    for (int i = 1; i < KEY_BINDINGS_PER_ACTION; ++i) {
+        CHECK(key_bindings_add(&m.bindings, KEY_ACTION_UP, SC_A + i));
+    }
+    capture_for(&m, KEY_ACTION_UP);
+    start_menu_capture(&m, SC_LEFT);
+    CHECK_INT(key_bindings_action_of(&m.bindings, SC_LEFT), KEY_ACTION_LEFT);
+    CHECK(!m.bindings_changed);
+
+    // Not capturing: ignored
+    start_menu_capture(&m, SC_SPACE);
+    CHECK_INT(key_bindings_action_of(&m.bindings, SC_SPACE), -1);
+}
+
+static void test_capture_pause_esc(void) {
+    start_menu_t m = menu();
+    capture_for(&m, KEY_ACTION_PAUSE);
+    start_menu_key(&m, START_MENU_KEY_LEFT); // drop Esc
+    CHECK_INT(key_bindings_count(&m.bindings, KEY_ACTION_PAUSE), 0);
+    start_menu_capture(&m, SC_D);
+    CHECK_INT(m.bindings.keys[KEY_ACTION_PAUSE][0], SC_D);
+    // Esc during a capture always cancels, even for pause
+    start_menu_key(&m, START_MENU_KEY_ENTER);
+    start_menu_capture(&m, SC_ESCAPE);
+    CHECK_INT(key_bindings_count(&m.bindings, KEY_ACTION_PAUSE), 1);
+}
+
+static void test_lighting_arg(void) {
+    start_menu_t m = menu();
+    char *argv[16];
+    char buf[64];
+    int argc = start_menu_build_args(&m, argv, 16, buf, sizeof(buf));
+    for (int i = 0; i < argc; ++i) CHECK(strncmp(argv[i], "lighting=", 9) != 0);
+
+    m.cursor = START_MENU_ITEM_LIGHTING;
+    start_menu_key(&m, START_MENU_KEY_RIGHT);
+    argc = start_menu_build_args(&m, argv, 16, buf, sizeof(buf));
+    CHECK_STR(argv[argc - 2], "lighting=1");
+    CHECK_STR(argv[argc - 1], "music=1");
+    CHECK(argv[argc] == NULL);
+}
+
+int main(void) {
+    TEST_RUN(test_capture_binds);
+    TEST_RUN(test_capture_moves_key);
+    TEST_RUN(test_capture_rejects);
+    TEST_RUN(test_capture_pause_esc);
+    TEST_RUN(test_lighting_arg);
+    return test_finish();
+}
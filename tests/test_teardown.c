@@ -0,0 +1,136 @@
+/*
+ * murmprince - session teardown tests
+ *
+ * Runs the start -> play -> quit cycle of main.c a hundred times against
+ * the real SRAM heap (mallinfo), with a fake PSRAM bump allocator. A game
+ * subsystem allocates while "playing" and frees from its reset hook, as
+ * quit() leaves everything to teardown.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "teardown.h"
+#include "psram_allocator.h"
+#include "test.h"
+
+#include <stdlib.h>
+
+#define SESSIONS 100
+#define GAME_BLOCKS 16
+
+// Fake PSRAM: only the watermark calls teardown makes.
+static size_t psram_offset = 4096;
+static int temp_resets;
+
+size_t psram_get_offset(void) { return psram_offset; }
+void psram_set_offset(size_t offset) { psram_offset = offset; }
+void psram_reset_temp(void) { ++temp_resets; }
+
+// A game subsystem: per-session SRAM blocks freed by its reset hook.
+static void *game_blocks[GAME_BLOCKS];
+static int game_resets;
+static bool game_check_fails;
+
+static void game_reset(void) {
+    for (int i = 0; i < GAME_BLOCKS; ++i) {
+        free(game_blocks[i]);
+        game_blocks[i] = NULL;
+    }
+    ++game_resets;
+}
+
+static bool game_check(void) {
+    return !game_check_fails;
+}
+
+static void *one_time;          // allocated by the first session, kept
+static void *pinned_cache;      // allocated later, kept, pinned
+static void *leaked;
+
+// One start -> play -> quit cycle; returns teardown_end_session().
+static bool run_session(int n) {
+    teardown_begin_session();
+    for (int i = 0; i < GAME_BLOCKS; ++i) {
+        game_blocks[i] = malloc((size_t)(32 + ((n * 7 + i * 13) % 64) * 16));
+        psram_offset += 1024 + (size_t)i * 256;
+    }
+    if (one_time == NULL) one_time = malloc(2048);
+    return teardown_end_session();
+}
+
+static void test_clean_sessions(void) {
+    teardown_register("game", game_reset, game_check);
+    teardown_register("game", game_reset, game_check);  // registered again each session: no-op
+
+    int failed = 0;
+    for (int n = 0; n < SESSIONS; ++n) {
+        if (!run_session(n)) ++failed;
+        CHECK_INT(psram_offset, 4096);
+    }
+    CHECK_INT(failed, 0);
+    CHECK_INT(game_resets, SESSIONS);
+    CHECK_INT(temp_resets, SESSIONS);
+    CHECK(one_time != NULL);
+}
+
+static void test_pinned_cache(void) {
+    // A cache allocated on first use in a later session, kept for good
+    teardown_begin_session();
+    size_t mark = teardown_pin_begin();
+    pinned_cache = malloc(4096);
+    teardown_pin_end("cache", mark);
+    CHECK(teardown_end_session());
+
+    int failed = 0;
+    for (int n = 0; n < SESSIONS; ++n) {
+        if (!run_session(n)) ++failed;
+    }
+    CHECK_INT(failed, 0);
+}
+
+static void test_unpinned_cache(void) {
+    // The same cache without a pin is growth
+    teardown_begin_session();
+    void *cache = malloc(4096);
+    CHECK(!teardown_end_session());
+    free(cache);
+    CHECK(run_session(1));
+}
+
+static void test_leak(void) {
+    // Session 50 keeps a block its reset hook does not know about
+    int failed = 0;
+    for (int n = 0; n < SESSIONS; ++n) {
+        teardown_begin_session();
+        game_blocks[0] = malloc(256);
+        if (n == 50) leaked = malloc(256);
+        bool ok = teardown_end_session();
+        if (n < 50) CHECK(ok);
+        if (!ok) ++failed;
+    }
+    // Reported by the leaking session and every one after it
+    CHECK_INT(failed, SESSIONS - 50);
+
+    free(leaked);
+    CHECK(run_session(0));
+}
+
+static void test_failed_check(void) {
+    game_check_fails = true;
+    CHECK(!run_session(0));
+    game_check_fails = false;
+    CHECK(run_session(0));
+}
+
+int main(void) {
+    // stdout's buffer is allocated on first use: before the baseline
+    printf("teardown: %d sessions per run\n", SESSIONS);
+    TEST_RUN(test_clean_sessions);
+    TEST_RUN(test_pinned_cache);
+    TEST_RUN(test_unpinned_cache);
+    TEST_RUN(test_leak);
+    TEST_RUN(test_failed_check);
+    free(pinned_cache);
+    free(one_time);
+    return test_finish();
+}
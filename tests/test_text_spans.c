@@ -0,0 +1,91 @@
+/*
+ * murmprince - batched text span tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "text_spans.h"
+#include "test.h"
+
+#define W 12
+#define H 4
+
+static uint8_t dst[H][W];
+
+// 3x2 glyphs: "A" = X.X / XXX, "B" = .X. / ...
+static const uint8_t glyph_a[2][3] = { { 1, 0, 1 }, { 1, 1, 1 } };
+static const uint8_t glyph_b[2][4] = { { 0, 7, 0, 9 }, { 0, 0, 0, 9 } };   // pitch 4, w 3
+
+static const text_spans_glyph_t glyphs[] = {
+    { &glyph_a[0][0], 3, 2, 3 },
+    { &glyph_b[0][0], 3, 2, 4 },
+};
+
+static text_spans_line_t line;
+
+static void test_layout(void) {
+    CHECK(text_spans_layout(&line, glyphs, 2, 1));
+    CHECK_INT(line.n_spans, 4);
+    CHECK_INT(line.width, 8);
+    CHECK_INT(line.bbox_w, 7);
+    CHECK_INT(line.bbox_h, 2);
+    // A: (0,0,1) (2,0,1) (0,1,3); B one pen step (4) further: (5,0,1)
+    CHECK_INT(line.spans[0].x, 0);
+    CHECK_INT(line.spans[1].x, 2);
+    CHECK_INT(line.spans[2].len, 3);
+    CHECK_INT(line.spans[2].y, 1);
+    CHECK_INT(line.spans[3].x, 5);
+    CHECK_INT(line.spans[3].len, 1);
+
+    text_spans_line_t empty;
+    CHECK(text_spans_layout(&empty, glyphs, 0, 1));
+    CHECK_INT(empty.n_spans, 0);
+    CHECK_INT(empty.width, 0);
+}
+
+static void test_too_many_spans(void) {
+    // 1-pixel gaps: every other pixel is a span
+    static uint8_t comb[1][TEXT_SPANS_MAX * 2 + 2];
+    for (int x = 0; x < (int)sizeof(comb[0]); x += 2) comb[0][x] = 1;
+    const text_spans_glyph_t g = { &comb[0][0], (int)sizeof(comb[0]), 1, (int)sizeof(comb[0]) };
+    static text_spans_line_t big;
+    CHECK(!text_spans_layout(&big, &g, 1, 0));
+    const text_spans_glyph_t fits = { &comb[0][0], TEXT_SPANS_MAX * 2, 1, (int)sizeof(comb[0]) };
+    CHECK(text_spans_layout(&big, &fits, 1, 0));
+    CHECK_INT(big.n_spans, TEXT_SPANS_MAX);
+}
+
+static void test_emit(void) {
+    const text_spans_clip_t all = { 0, 0, W, H };
+    memset(dst, 0, sizeof(dst));
+    text_spans_emit(&line, &dst[0][0], W, &all, 1, 1, 5);
+    CHECK(!memcmp(dst[0], "\0\0\0\0\0\0\0\0\0\0\0\0", W));
+    CHECK(!memcmp(dst[1], "\0\5\0\5\0\0\5\0\0\0\0\0", W));
+    CHECK(!memcmp(dst[2], "\0\5\5\5\0\0\0\0\0\0\0\0", W));
+
+    // Clipped on the left and at the bottom
+    const text_spans_clip_t box = { 2, 0, 8, 2 };
+    memset(dst, 0, sizeof(dst));
+    text_spans_emit(&line, &dst[0][0], W, &box, 1, 1, 5);
+    CHECK(!memcmp(dst[1], "\0\0\0\5\0\0\5\0\0\0\0\0", W));
+    CHECK(!memcmp(dst[2], "\0\0\0\0\0\0\0\0\0\0\0\0", W));
+
+    // Clipped on the right, through the middle of a span
+    const text_spans_clip_t right = { 0, 0, 3, H };
+    memset(dst, 0, sizeof(dst));
+    text_spans_emit(&line, &dst[0][0], W, &right, 1, 0, 5);
+    CHECK(!memcmp(dst[1], "\0\5\5\0\0\0\0\0\0\0\0\0", W));
+
+    // Fully outside
+    memset(dst, 0, sizeof(dst));
+    text_spans_emit(&line, &dst[0][0], W, &box, 10, 0, 5);
+    text_spans_emit(&line, &dst[0][0], W, &all, -7, 0, 5);
+    for (int y = 0; y < H; ++y) CHECK(!memcmp(dst[y], "\0\0\0\0\0\0\0\0\0\0\0\0", W));
+}
+
+int main(void) {
+    TEST_RUN(test_layout);
+    TEST_RUN(test_too_many_spans);
+    TEST_RUN(test_emit);
+    return test_finish();
+}
@@ -0,0 +1,230 @@
+/*
+ * murmprince - tile inspector tests
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "tile_inspect.h"
+#include "test.h"
+
+#define TILES (TILE_INSPECT_ROOMS * TILE_INSPECT_COLS * TILE_INSPECT_ROWS)
+
+static uint8_t fg[TILES], bg[TILES];
+static uint8_t doorlinks1[256], doorlinks2[256];
+static uint8_t guards_tile[TILE_INSPECT_ROOMS], guards_skill[TILE_INSPECT_ROOMS];
+
+static const tile_inspect_level_t level = { fg, bg, doorlinks1, doorlinks2, guards_tile, guards_skill };
+
+static void clear_level(void) {
+    memset(fg, 0, sizeof(fg));
+    memset(bg, 0, sizeof(bg));
+    memset(doorlinks1, 0, sizeof(doorlinks1));
+    memset(doorlinks2, 0, sizeof(doorlinks2));
+    memset(guards_tile, 30, sizeof(guards_tile));
+    memset(guards_skill, 0, sizeof(guards_skill));
+}
+
+static void set_tile(int room, int tile, int type, int modif) {
+    fg[(room - 1) * 30 + tile] = (uint8_t)type;
+    bg[(room - 1) * 30 + tile] = (uint8_t)modif;
+}
+
+// A doorlink entry as SDLPoP stores it: tile and room low bits in the
+// first byte, room high bits in the second, bit 7 ends a button's list.
+static void set_link(int index, int room, int tile, bool last) {
+    doorlinks1[index] = (uint8_t)((tile & 0x1F) | ((room & 3) << 5) | (last ? 0x80 : 0));
+    doorlinks2[index] = (uint8_t)((room >> 2) << 5);
+}
+
+static void test_at(void) {
+    int col, row;
+    CHECK(tile_inspect_at(0, 0, &col, &row));
+    CHECK_INT(col, 0);
+    CHECK_INT(row, 0);
+    // Rows run from y_land[r] to y_land[r + 1]: -8, 55, 118, 181
+    CHECK(tile_inspect_at(31, 54, &col, &row));
+    CHECK_INT(col, 0);
+    CHECK_INT(row, 0);
+    CHECK(tile_inspect_at(32, 55, &col, &row));
+    CHECK_INT(col, 1);
+    CHECK_INT(row, 1);
+    CHECK(tile_inspect_at(319, 117, &col, &row));
+    CHECK_INT(col, 9);
+    CHECK_INT(row, 1);
+    CHECK(tile_inspect_at(160, 118, &col, &row));
+    CHECK_INT(row, 2);
+    // Below the last floor line: still the bottom row
+    CHECK(tile_inspect_at(160, 191, &col, &row));
+    CHECK_INT(row, 2);
+    // The status strip and outside the screen are not inspected
+    CHECK(!tile_inspect_at(160, 192, &col, &row));
+    CHECK(!tile_inspect_at(-1, 10, &col, &row));
+    CHECK(!tile_inspect_at(320, 10, &col, &row));
+    CHECK(!tile_inspect_at(10, -1, &col, &row));
+}
+
+static void test_lookup(void) {
+    tile_inspect_info_t info;
+    clear_level();
+    set_tile(3, 14, 11 | 0x20, 2);          // loose floor, flag bits above the type
+    CHECK(tile_inspect_lookup(&level, 3, 4, 1, &info));
+    CHECK_INT(info.room, 3);
+    CHECK_INT(info.tile, 14);
+    CHECK_INT(info.col, 4);
+    CHECK_INT(info.row, 1);
+    CHECK_INT(info.type, 11);
+    CHECK_INT(info.modif, 2);
+    CHECK(!info.guard);
+    CHECK_INT(info.target_count, 0);
+    CHECK_INT(info.trigger_count, 0);
+
+    CHECK(!tile_inspect_lookup(&level, 0, 0, 0, &info));
+    CHECK(!tile_inspect_lookup(&level, 25, 0, 0, &info));
+    CHECK(!tile_inspect_lookup(&level, 1, 10, 0, &info));
+    CHECK(!tile_inspect_lookup(&level, 1, 0, 3, &info));
+    CHECK(tile_inspect_lookup(&level, 24, 9, 2, &info));
+    CHECK_INT(info.tile, 29);
+
+    // An opener in room 1 whose list (from entry 10) opens gates in rooms 1, 6 and 21
+    set_tile(1, 5, TILE_INSPECT_OPENER, 10);
+    set_link(10, 1, 7, false);
+    set_link(11, 6, 0, false);
+    set_link(12, 21, 29, true);
+    set_link(13, 2, 2, true);               // past the end marker
+    set_tile(21, 29, TILE_INSPECT_GATE, 0);
+    CHECK(tile_inspect_lookup(&level, 1, 5, 0, &info));
+    CHECK_INT(info.type, TILE_INSPECT_OPENER);
+    CHECK_INT(info.target_count, 3);
+    CHECK(!info.targets_more);
+    CHECK_INT(info.targets[1].room, 6);
+    CHECK_INT(info.targets[1].tile, 0);
+    CHECK_INT(info.targets[2].room, 21);
+    CHECK_INT(info.targets[2].tile, 29);
+
+    // The gate lists the button, and a closer elsewhere that shares the entry
+    set_tile(9, 0, TILE_INSPECT_CLOSER, 12);
+    CHECK(tile_inspect_lookup(&level, 21, 9, 2, &info));
+    CHECK_INT(info.trigger_count, 2);
+    CHECK_INT(info.triggers[0].room, 1);
+    CHECK_INT(info.triggers[0].tile, 5);
+    CHECK_INT(info.triggers[1].room, 9);
+    CHECK_INT(info.triggers[1].tile, 0);
+    // Not a target of anything
+    CHECK(tile_inspect_lookup(&level, 2, 2, 0, &info));
+    CHECK_INT(info.trigger_count, 0);
+
+    // More than TILE_INSPECT_LINKS targets
+    set_tile(4, 0, TILE_INSPECT_CLOSER, 40);
+    for (int i = 0; i < 8; ++i) set_link(40 + i, 4, i + 1, i == 7);
+    CHECK(tile_inspect_lookup(&level, 4, 0, 0, &info));
+    CHECK_INT(info.target_count, TILE_INSPECT_LINKS);
+    CHECK(info.targets_more);
+
+    // A list that never ends stops at the table's end
+    set_tile(5, 0, TILE_INSPECT_OPENER, 250);
+    for (int i = 250; i < 256; ++i) set_link(i, 5, 1, false);
+    CHECK(tile_inspect_lookup(&level, 5, 0, 0, &info));
+    CHECK_INT(info.target_count, 6);
+    CHECK(!info.targets_more);
+
+    // The room's guard stands on the tile
+    guards_tile[6] = 12;
+    guards_skill[6] = 7;
+    CHECK(tile_inspect_lookup(&level, 7, 2, 1, &info));
+    CHECK(info.guard);
+    CHECK_INT(info.guard_skill, 7);
+    CHECK(tile_inspect_lookup(&level, 7, 3, 1, &info));
+    CHECK(!info.guard);
+}
+
+static void test_format(void) {
+    char lines[TILE_INSPECT_LINES][TILE_INSPECT_LINE];
+    tile_inspect_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.room = 3;
+    info.tile = 14;
+    info.col = 4;
+    info.row = 1;
+    info.type = 11;
+    info.modif = 2;
+    CHECK_INT(tile_inspect_format(&info, lines), 2);
+    CHECK_STR(lines[0], "room 3 tile 14 (4,1)");
+    CHECK_STR(lines[1], "loose mod 2");
+
+    info.guard = true;
+    info.guard_skill = 7;
+    tile_inspect_format(&info, lines);
+    CHECK_STR(lines[1], "loose mod 2 guard 7");
+
+    // Buttons: what they do, then who triggers the tile
+    info.guard = false;
+    info.type = TILE_INSPECT_OPENER;
+    info.target_count = 2;
+    info.targets[0] = (tile_inspect_link_t){ 1, 7 };
+    info.targets[1] = (tile_inspect_link_t){ 21, 29 };
+    info.trigger_count = 1;
+    info.triggers[0] = (tile_inspect_link_t){ 9, 0 };
+    CHECK_INT(tile_inspect_format(&info, lines), 4);
+    CHECK_STR(lines[1], "opener mod 2");
+    CHECK_STR(lines[2], "opens 1:7 21:29");
+    CHECK_STR(lines[3], "by 9:0");
+    info.type = TILE_INSPECT_CLOSER;
+    tile_inspect_format(&info, lines);
+    CHECK_STR(lines[2], "closes 1:7 21:29");
+
+    // A full list is cut with " ..", and still fits the line
+    info.target_count = TILE_INSPECT_LINKS;
+    info.targets_more = true;
+    for (int i = 0; i < TILE_INSPECT_LINKS; ++i) info.targets[i] = (tile_inspect_link_t){ 24, (uint8_t)(20 + i) };
+    info.trigger_count = 0;
+    CHECK_INT(tile_inspect_format(&info, lines), 3);
+    CHECK_STR(lines[2], "closes 24:20 24:21 24:22 24:23 24:24 24:25 ..");
+    CHECK((int)strlen(lines[2]) < TILE_INSPECT_LINE);
+
+    // Triggers only (a gate)
+    info.type = TILE_INSPECT_GATE;
+    info.target_count = 0;
+    info.targets_more = false;
+    info.trigger_count = 1;
+    info.triggers[0] = (tile_inspect_link_t){ 2, 3 };
+    CHECK_INT(tile_inspect_format(&info, lines), 3);
+    CHECK_STR(lines[1], "gate mod 2");
+    CHECK_STR(lines[2], "by 2:3");
+
+    CHECK_STR(tile_inspect_type_name(0), "empty");
+    CHECK_STR(tile_inspect_type_name(30), "torch debris");
+    CHECK_STR(tile_inspect_type_name(31), "?");
+    CHECK_STR(tile_inspect_type_name(-1), "?");
+}
+
+static void test_draw(void) {
+    static uint8_t buf[10][12];
+    memset(buf, 0, sizeof(buf));
+    // Clipped box
+    tile_inspect_fill(&buf[0][0], 12, 10, -2, 8, 5, 5, 3);
+    CHECK_INT(buf[8][0], 3);
+    CHECK_INT(buf[9][2], 3);
+    CHECK_INT(buf[9][3], 0);
+    CHECK_INT(buf[7][0], 0);
+
+    // "-" is the middle row of its glyph, partly off the right edge
+    memset(buf, 0, sizeof(buf));
+    tile_inspect_text(&buf[0][0], 12, 10, 9, 0, "-", 5);
+    CHECK(!memcmp(buf[3], "\0\0\0\0\0\0\0\0\0\5\5\5", 12));
+    CHECK(!memcmp(buf[2], "\0\0\0\0\0\0\0\0\0\0\0\0", 12));
+
+    // Cursor tip at (1, 1): outline there, color inside
+    memset(buf, 0, sizeof(buf));
+    tile_inspect_cursor(&buf[0][0], 12, 10, 1, 1, 7, 1);
+    CHECK_INT(buf[1][1], 1);
+    CHECK_INT(buf[3][2], 7);
+    CHECK_INT(buf[0][0], 0);
+}
+
+int main(void) {
+    TEST_RUN(test_at);
+    TEST_RUN(test_lookup);
+    TEST_RUN(test_format);
+    TEST_RUN(test_draw);
+    return test_finish();
+}
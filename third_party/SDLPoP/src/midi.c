@@ -68,6 +68,7 @@ extern int digi_unavailable; // seg009.c
 #include "pico/stdlib.h"  // for time_us_32
 
 #include "pop_fs.h"
+#include "crash_guard.h"
 
 // Streaming state for SD card playback
 static FIL* midi_stream_file = NULL;
@@ -81,6 +82,20 @@ int midi_cache_playing = 0;  // Not static - needs to be accessed from seg009.c
 static void midi_cache_filename(int sound_id, char* buf, size_t bufsize) {
     snprintf(buf, bufsize, "prince/midi_cache/snd%02d.pcm", sound_id);
 }
+
+// Header + stereo 16-bit frames
+static FSIZE_t midi_cache_expected_size(int sample_count) {
+	return (FSIZE_t)(3 * sizeof(int)) + (FSIZE_t)sample_count * 2 * sizeof(int16_t);
+}
+
+// Boot-time check (pop_fs_recover_dir): a cache file whose size disagrees
+// with its header was cut short and is deleted, to be re-rendered on demand.
+bool midi_cache_file_ok(FIL* f, FSIZE_t size) {
+	int header[3]; // version, sample count, max_sample
+	if (pop_fs_read(header, sizeof(int), 3, f) != 3) return false;
+	return header[0] == MIDI_CACHE_VERSION && header[1] > 0 &&
+	       size == midi_cache_expected_size(header[1]);
+}
 #endif
 
 // Nuked OPL3 emulator
@@ -700,10 +715,22 @@ void free_midi_resources(void) {
 #endif
 }
 
+static bool midi_initialized = false;
+
+#ifdef POP_RP2350
+// Session teardown: instruments_data may sit in session PSRAM that is about to
+// be reclaimed, so forget it and let the next session's init_midi() reload it.
+void rp2350_midi_teardown(void) {
+	psram_free(instruments_data);
+	instruments_data = NULL;
+	instruments = &hardcoded_instrument;
+	midi_initialized = false;
+}
+#endif
+
 void init_midi() {
-	static bool initialized = false;
-	if (initialized) return;
-	initialized = true;
+	if (midi_initialized) return;
+	midi_initialized = true;
 
 	instruments = &hardcoded_instrument; // unused if instruments can be loaded normally.
 	int size;
@@ -752,8 +779,8 @@ void play_midi_sound(sound_buffer_type* buffer) {
 	}
 	
 	MIDI_DBG("[MIDI @%ums] calling midi_play_from_cache\n", time_us_32() / 1000);
-	// Check if cached PCM file exists on SD card
-	if (sound_id >= 0 && midi_play_from_cache(sound_id)) {
+	// Check if cached PCM file exists on SD card (skipped in safe mode)
+	if (sound_id >= 0 && !crash_guard_safe_mode() && midi_play_from_cache(sound_id)) {
 		MIDI_DBG("[MIDI @%ums] play_midi_sound END (cached)\n", time_us_32() / 1000);
 		return;  // Playing from cache
 	}
@@ -994,7 +1021,11 @@ static void midi_render_to_file(int sound_id, sound_buffer_type* buffer) {
 	pop_fs_write(&samples_rendered, sizeof(int), 1, outfile);
 	int max_sample_int = (int)max_sample_value;
 	pop_fs_write(&max_sample_int, sizeof(int), 1, outfile);
-	pop_fs_close(outfile);
+	// Only now does the cache replace anything (written to a temporary until close).
+	if (pop_fs_close(outfile) != 0) {
+		printf("midi_render: failed to commit %s\n", filename);
+		return;
+	}
 	
 	printf("midi_render: snd %d done, %d samples, %d KB, note_ons=%d, max_sample=%d\n", 
 	       sound_id, samples_rendered, (samples_rendered * 4 + 4) / 1024, note_on_count, max_sample_value);
@@ -1069,6 +1100,10 @@ int midi_play_from_cache(int sound_id) {
 	} else if (total_samples <= 0) {
 		printf("midi_play_from_cache: bad sample count=%d, regenerating\n", total_samples);
 		needs_regen = 1;
+	} else if (f_size(f) != midi_cache_expected_size(total_samples)) {
+		printf("midi_play_from_cache: truncated cache (%u bytes for %d samples), regenerating\n",
+		       (unsigned)f_size(f), total_samples);
+		needs_regen = 1;
 	} else if (file_max_sample < 100) {
 		// If max_sample is too low, the cache is corrupt/silent
 		printf("midi_play_from_cache: corrupt cache (max_sample=%d < 100), regenerating\n", file_max_sample);
@@ -1090,7 +1125,8 @@ int midi_play_from_cache(int sound_id) {
 				read_count2 = pop_fs_read(&total_samples, sizeof(int), 1, f);
 				read_count3 = pop_fs_read(&file_max_sample, sizeof(int), 1, f);
 				if (read_count == 1 && read_count2 == 1 && read_count3 == 1 &&
-				    file_version == MIDI_CACHE_VERSION && total_samples > 0 && file_max_sample >= 100) {
+				    file_version == MIDI_CACHE_VERSION && total_samples > 0 && file_max_sample >= 100 &&
+				    f_size(f) == midi_cache_expected_size(total_samples)) {
 					printf("midi_play_from_cache: regeneration successful, samples=%d, max_sample=%d\n", 
 					       total_samples, file_max_sample);
 					goto play_from_file;
@@ -1103,6 +1139,8 @@ int midi_play_from_cache(int sound_id) {
 
 play_from_file:
 	
+	// Read from the audio callback: never block there if the card is pulled.
+	pop_fs_set_blocking(f, false);
 	midi_stream_file = f;
 	midi_stream_samples_remaining = total_samples;
 	midi_stream_buffer_pos = 0;
@@ -1202,6 +1240,21 @@ void midi_cached_callback(void *userdata, Uint8 *stream, int len) {
 	}
 }
 
+// Card wait (pop_fs wait hook): the callback on core 1 must not read the
+// stream while core 0 remounts. Pause it, and resume it once pop_fs has
+// reopened the file on the new mount.
+void midi_cache_hold(bool hold) {
+	static int held = 0;
+	if (hold) {
+		if (!midi_cache_playing || held) return;
+		SDL_PauseAudio(1);  // returns once a running callback is done
+		held = 1;
+	} else if (held) {
+		held = 0;
+		SDL_PauseAudio(0);
+	}
+}
+
 // Initialize MIDI cache directory (called at startup, non-blocking)
 void midi_generate_cache_files(void) {
 	extern sound_buffer_type* sound_pointers[];
@@ -19,6 +19,9 @@ The authors of this program may be contacted at https://forum.princed.org
 */
 
 #include "common.h"
+#ifdef POP_RP2350
+#include "ff.h"
+#endif
 #include <ctype.h>
 #ifdef __amigaos4__
 	#define strtoimax(a,b,c) strtoll(a,b,c)
@@ -241,6 +244,13 @@ static int global_ini_callback(const char *section, const char *name, const char
 #endif
 	}
 
+#if defined(POP_RP2350) && defined(USE_DEBUG_CHEATS)
+	// No command line on the device: this stands in for the "debug" argument.
+	if (check_ini_section("RP2350")) {
+		process_boolean("debug_cheats", &debug_cheats_enabled);
+	}
+#endif
+
 	if (check_ini_section("Enhancements")) {
 		if (strcasecmp(name, "use_fixes_and_enhancements") == 0) {
 			if (strcasecmp(value, "true") == 0) use_fixes_and_enhancements = 1;
@@ -786,9 +796,16 @@ void load_mod_options() {
 		const char* located_folder_name = locate_file(folder_name);
 		//printf("located_folder_name = %s\n", located_folder_name);
 		bool ok = false;
+#ifdef POP_RP2350
+		// No stdio filesystem on the device: ask FatFS.
+		FILINFO info;
+		if (f_stat(located_folder_name, &info) == FR_OK) {
+			if (info.fattrib & AM_DIR) {
+#else
 		struct stat info;
 		if (stat(located_folder_name, &info) == 0) {
 			if (S_ISDIR(info.st_mode)) {
+#endif
 				// It's a directory
 				ok = true;
 				snprintf_check(mod_data_path, sizeof(mod_data_path), "%s", located_folder_name);
@@ -819,6 +836,10 @@ void load_mod_options() {
 			levelset_name[0] = '\0';
 		}
 	}
+#ifdef POP_RP2350
+	// Every data file lookup from here on goes through this index.
+	rp2350_index_data_files();
+#endif
 	turn_fixes_and_enhancements_on_off(use_fixes_and_enhancements);
 	turn_custom_options_on_off(use_custom_options);
 }
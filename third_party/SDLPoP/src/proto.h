@@ -733,4 +733,8 @@ void play_midi_sound(sound_buffer_type* buffer);
 void midi_cached_callback(void *userdata, Uint8 *stream, int len);
 int midi_play_from_cache(int sound_id);
 void midi_generate_cache_files(void);
+void rp2350_seg009_teardown(void);
+void rp2350_peel_pool_init(void);
+void rp2350_index_data_files(void);
+void rp2350_midi_teardown(void);
 #endif
@@ -25,7 +25,35 @@ The authors of this program may be contacted at https://forum.princed.org
 #ifdef POP_RP2350
 #include "psram_allocator.h"
 #include "pico/stdlib.h"  // for sleep_ms
+#include "teardown.h"
+#include "crash_guard.h"
+#include "pop_fs.h"
+#include "save_slots.h"
+#include "serial_link.h"
 extern uint32_t graphics_get_hdmi_irq_count(void);
+static void rp2350_sdlpop_teardown(void);
+// Save slot used by save_game()/load_game(), from the "slot=" argument.
+static int save_slot_index = 0;
+#endif
+
+#ifdef POP_RP2350
+// Save files (FatFS): there is no stdio filesystem on the device. Files
+// opened with "wb" only replace the old save once closed successfully.
+typedef FIL save_file_t;
+static inline save_file_t* save_open(const char* path, const char* mode) { return pop_fs_open(path, mode); }
+static inline size_t save_read(void* ptr, size_t sz, size_t n, save_file_t* fp) { return pop_fs_read(ptr, sz, n, fp); }
+static inline size_t save_write(const void* ptr, size_t sz, size_t n, save_file_t* fp) { return pop_fs_write(ptr, sz, n, fp); }
+static inline int save_seek(save_file_t* fp, long ofs, int whence) { return pop_fs_seek(fp, ofs, whence); }
+static inline int save_close(save_file_t* fp) { return pop_fs_close(fp); }
+static inline void save_abort(save_file_t* fp, const char* path) { (void)path; pop_fs_discard(fp); }
+#else
+typedef FILE save_file_t;
+static inline save_file_t* save_open(const char* path, const char* mode) { return fopen(path, mode); }
+static inline size_t save_read(void* ptr, size_t sz, size_t n, save_file_t* fp) { return fread(ptr, sz, n, fp); }
+static inline size_t save_write(const void* ptr, size_t sz, size_t n, save_file_t* fp) { return fwrite(ptr, sz, n, fp); }
+static inline int save_seek(save_file_t* fp, long ofs, int whence) { return fseek(fp, ofs, whence); }
+static inline int save_close(save_file_t* fp) { return fclose(fp); }
+static inline void save_abort(save_file_t* fp, const char* path) { fclose(fp); remove(path); }
 #endif
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -67,6 +95,9 @@ void fix_sound_priorities(void);
 // seg000:0000
 void pop_main() {
 	DBG_PRINTF("[pop_main] enter\n");
+	#ifdef POP_RP2350
+	teardown_register("sdlpop", rp2350_sdlpop_teardown, NULL);
+	#endif
 	if (check_param("--version") || check_param("-v")) {
 		printf ("SDLPoP v%s\n", SDLPOP_VERSION);
 		exit(0);
@@ -100,6 +131,13 @@ void pop_main() {
 	load_ingame_settings();
 #endif
 	if (check_param("mute")) is_sound_on = 0;
+#if defined(POP_RP2350) && defined(USE_LIGHTING)
+	// Start menu choice (src/start_menu.c)
+	temp = check_param("lighting=");
+	if (temp != NULL) enable_lighting = atoi(temp+9) != 0;
+	// Safe mode (requested after a crash) runs without the lighting pass.
+	if (crash_guard_safe_mode()) enable_lighting = 0;
+#endif
 	turn_sound_on_off((is_sound_on != 0) * 15); // Turn off sound/music if those options were set.
 
 #ifdef USE_REPLAY
@@ -155,7 +193,12 @@ void pop_main() {
 	set_joy_mode();
 	cheats_enabled = check_param("megahit") != NULL;
 #ifdef USE_DEBUG_CHEATS
+#ifdef POP_RP2350
+	// Already set if SDLPoP.ini asks for it
+	if (check_param("debug") != NULL) debug_cheats_enabled = 1;
+#else
 	debug_cheats_enabled = check_param("debug") != NULL;
+#endif
 	if (debug_cheats_enabled) cheats_enabled = 1; // param 'megahit' not necessary if 'debug' is used
 #endif
 	draw_mode = check_param("draw") != NULL && cheats_enabled;
@@ -186,6 +229,24 @@ void pop_main() {
 		}
 	}
 
+#ifdef POP_RP2350
+	// Start menu choice: start level without the 'megahit' cheats.
+	temp = check_param("level=");
+	if (temp != NULL) {
+		int level = atoi(temp+6);
+		if (level >= 1 && level <= 14) start_level = level;
+	}
+	// Save slot for Ctrl+G / Ctrl+L; "loadslot" starts straight into it.
+	temp = check_param("slot=");
+	if (temp != NULL) {
+		int slot = atoi(temp+5);
+		if (slot >= 1 && slot <= SAVE_SLOTS_COUNT) save_slot_index = slot - 1;
+	}
+	if (check_param("loadslot") && !load_game()) {
+		start_level = -1;
+	}
+#endif
+
 	play_demo_level = (check_param("playdemo") != NULL);
 
 #ifdef USE_SCREENSHOT
@@ -244,6 +305,23 @@ void init_game_main() {
 word first_start = 1;
 // data:4C38
 jmp_buf setjmp_buf;
+
+#ifdef POP_RP2350
+// Runs after quit() has longjmp'ed back to sdlpop_entry's caller.
+static void rp2350_sdlpop_teardown(void) {
+	stop_sounds();
+	rp2350_midi_teardown();
+	free_all_chtabs_from(id_chtab_0_sword);
+	rp2350_seg009_teardown();
+	offscreen_surface = NULL;
+	// Next session must set up its own restart point; setjmp_buf is stale.
+	first_start = 1;
+	// Start level and levelset come from the start menu each session.
+	start_level = -1;
+	use_custom_levelset = 0;
+	levelset_name[0] = '\0';
+}
+#endif
 // seg000:0358
 void start_game() {
 #ifdef USE_COPYPROT
@@ -304,14 +382,14 @@ void start_game() {
 #ifdef USE_QUICKSAVE
 // All these functions return true on success, false otherwise.
 
-FILE* quick_fp;
+save_file_t* quick_fp;
 
 int process_save(void* data, size_t data_size) {
-	return fwrite(data, data_size, 1, quick_fp) == 1;
+	return save_write(data, data_size, 1, quick_fp) == 1;
 }
 
 int process_load(void* data, size_t data_size) {
-	return fread(data, data_size, 1, quick_fp) == 1;
+	return save_read(data, data_size, 1, quick_fp) == 1;
 }
 
 typedef int process_func_type(void* data, size_t data_size);
@@ -323,7 +401,7 @@ int quick_process(process_func_type process_func) {
 #ifdef USE_DEBUG_CHEATS
 	// Don't load the level if the user holds either Shift key while pressing F9.
 	if (debug_cheats_enabled && (key_states[SDL_SCANCODE_LSHIFT] & KEYSTATE_HELD || key_states[SDL_SCANCODE_RSHIFT] & KEYSTATE_HELD)) {
-		fseek(quick_fp, sizeof(level), SEEK_CUR);
+		save_seek(quick_fp, sizeof(level), SEEK_CUR);
 	} else
 #endif
 	{
@@ -441,11 +519,15 @@ int quick_save(void) {
 	int ok = 0;
 	char custom_quick_path[POP_MAX_PATH];
 	const char* path = get_quick_path(custom_quick_path, sizeof(custom_quick_path));
-	quick_fp = fopen(path, "wb");
+	quick_fp = save_open(path, "wb");
 	if (quick_fp != NULL) {
 		process_save((void*) quick_version, COUNT(quick_version));
 		ok = quick_process(process_save);
-		fclose(quick_fp);
+		if (!ok) {
+			save_abort(quick_fp, path); // keep the previous quicksave
+		} else if (save_close(quick_fp) != 0) {
+			ok = 0;
+		}
 		quick_fp = NULL;
 	} else {
 		perror("quick_save: fopen");
@@ -499,12 +581,12 @@ int quick_load(void) {
 	int ok = 0;
 	char custom_quick_path[POP_MAX_PATH];
 	const char* path = get_quick_path(custom_quick_path, sizeof(custom_quick_path));
-	quick_fp = fopen(path, "rb");
+	quick_fp = save_open(path, "rb");
 	if (quick_fp != NULL) {
 		// check quicksave version is compatible
 		process_load(quick_control, COUNT(quick_control));
 		if (strcmp(quick_control, quick_version) != 0) {
-			fclose(quick_fp);
+			save_close(quick_fp);
 			quick_fp = NULL;
 			return 0;
 		}
@@ -518,7 +600,7 @@ int quick_load(void) {
 		word old_rem_tick = rem_tick;
 
 		ok = quick_process(process_load);
-		fclose(quick_fp);
+		save_close(quick_fp);
 		quick_fp = NULL;
 
 		restore_room_after_quick_load();
@@ -937,8 +1019,44 @@ int process_key() {
 	return 1;
 }
 
+#ifdef POP_RP2350
+// Game state for the serial test link's STATE command.
+bool sdlpop_serial_state(serial_game_state_t* state) {
+	if (current_level == (word)-1) return false; // no level loaded
+	state->level = (uint8_t)current_level;
+	state->room = (uint8_t)drawn_room;
+	state->rem_min = (uint16_t)rem_min;
+	state->rem_tick = rem_tick;
+	state->kid_room = Kid.room;
+	state->kid_x = Kid.x;
+	state->kid_y = Kid.y;
+	state->kid_dir = (uint8_t)Kid.direction;
+	state->kid_frame = Kid.frame;
+	state->kid_action = Kid.action;
+	state->kid_alive = Kid.alive;
+	state->kid_hp = (uint8_t)hitp_curr;
+	state->kid_max_hp = (uint8_t)hitp_max;
+	if (Guard.direction != dir_56_none) {
+		state->guard_room = Guard.room;
+		state->guard_x = Guard.x;
+		state->guard_y = Guard.y;
+		state->guard_dir = (uint8_t)Guard.direction;
+		state->guard_hp = (uint8_t)guardhp_curr;
+	}
+	return true;
+}
+#endif
+
 // seg000:08EB
 void play_frame() {
+#ifdef POP_RP2350
+	// Level jump from the serial test link, the way Shift+L does it.
+	int serial_level = serial_link_take_level();
+	if (serial_level > 0) {
+		next_level = serial_level;
+		stop_sounds();
+	}
+#endif
 	// play feather fall music if there is more than 1 second of feather fall left
 	if (fixes->fix_quicksave_during_feather && is_feather_fall >= 10 && !check_sound_playing()) {
 		play_sound(sound_39_low_weight);
@@ -2373,6 +2491,45 @@ void load_kid_sprite() {
 	load_chtab_from_file(id_chtab_2_kid, 400, "KID.DAT", 1<<7);
 }
 
+#ifdef POP_RP2350
+// Saves go to one of the slots in PRINCE.SLT (src/save_slots.c).
+void save_game() {
+	save_slot_t slot = {0};
+	slot.level = current_level;
+	slot.rem_min = rem_min;
+	slot.rem_tick = rem_tick;
+	slot.hitp = hitp_beg_lev;
+	if (use_custom_levelset) snprintf_check(slot.levelset, sizeof(slot.levelset), "%s", levelset_name);
+
+	if (save_slots_write(save_slot_index, &slot)) {
+		char text[32];
+		snprintf(text, sizeof(text), "GAME SAVED IN SLOT %d", save_slot_index + 1);
+		display_text_bottom(text);
+	} else {
+		display_text_bottom("UNABLE TO SAVE GAME");
+	}
+	text_time_remaining = 24;
+}
+
+short load_game() {
+	save_slot_t slot;
+	if (!save_slots_read(save_slot_index, &slot)) {
+		printf("load_game: slot %d is empty or damaged\n", save_slot_index + 1);
+		return 0;
+	}
+	rem_min = slot.rem_min;
+	rem_tick = slot.rem_tick;
+	start_level = slot.level;
+	hitp_beg_lev = slot.hitp;
+#ifdef USE_COPYPROT
+	if (enable_copyprot && custom->copyprot_level > 0) {
+		custom->copyprot_level = start_level;
+	}
+#endif
+	dont_reset_time = 1;
+	return 1;
+}
+#else
 const char* save_file = "PRINCE.SAV";
 
 const char* get_save_path(char* custom_path_buffer, size_t max_len) {
@@ -2385,20 +2542,20 @@ void save_game() {
 	char custom_save_path[POP_MAX_PATH];
 	const char* save_path = get_save_path(custom_save_path, sizeof(custom_save_path));
 
-	FILE* handle = fopen(save_path, "wb");
+	save_file_t* handle = save_open(save_path, "wb");
 	if (handle != NULL) {
-		if (fwrite(&rem_min, 1, 2, handle) != 2) goto error;
-		if (fwrite(&rem_tick, 1, 2, handle) != 2) goto error;
-		if (fwrite(&current_level, 1, 2, handle) != 2) goto error;
-		if (fwrite(&hitp_beg_lev, 1, 2, handle) != 2) goto error;
+		if (save_write(&rem_min, 1, 2, handle) != 2) goto error;
+		if (save_write(&rem_tick, 1, 2, handle) != 2) goto error;
+		if (save_write(&current_level, 1, 2, handle) != 2) goto error;
+		if (save_write(&hitp_beg_lev, 1, 2, handle) != 2) goto error;
 		success = 1;
 		error:
 		if (!success) {
 			printf("save_game: fwrite: Can not write to: %s\n", save_path);
-		}
-		fclose(handle);
-		if (!success) {
-			remove(save_path);
+			save_abort(handle, save_path);
+		} else if (save_close(handle) != 0) {
+			printf("save_game: fclose: Can not write to: %s\n", save_path);
+			success = 0;
 		}
 	} else {
 		perror("save_game: fopen");
@@ -2420,12 +2577,12 @@ short load_game() {
 	char custom_save_path[POP_MAX_PATH];
 	const char* save_path = get_save_path(custom_save_path, sizeof(custom_save_path));
 
-	FILE* handle = fopen(save_path, "rb");
+	save_file_t* handle = save_open(save_path, "rb");
 	if (handle != NULL) {
-		if (fread(&rem_min, 1, 2, handle) != 2) goto error;
-		if (fread(&rem_tick, 1, 2, handle) != 2) goto error;
-		if (fread(&start_level, 1, 2, handle) != 2) goto error;
-		if (fread(&hitp_beg_lev, 1, 2, handle) != 2) goto error;
+		if (save_read(&rem_min, 1, 2, handle) != 2) goto error;
+		if (save_read(&rem_tick, 1, 2, handle) != 2) goto error;
+		if (save_read(&start_level, 1, 2, handle) != 2) goto error;
+		if (save_read(&hitp_beg_lev, 1, 2, handle) != 2) goto error;
 #ifdef USE_COPYPROT
 		if (enable_copyprot && custom->copyprot_level > 0) {
 			custom->copyprot_level = start_level;
@@ -2437,13 +2594,14 @@ short load_game() {
 		if (!success) {
 			printf("load_game: fread: Can not read from: %s\n", save_path);
 		}
-		fclose(handle);
+		save_close(handle);
 	} else {
 		perror("load_game: fopen");
 		printf("Tried to open for reading: %s\n", save_path);
 	}
 	return success;
 }
+#endif
 
 // seg000:1F02
 void clear_screen_and_sounds() {
@@ -2480,6 +2638,8 @@ void parse_cmdline_sound() {
 	sound_mode = smSblast;
 	is_sound_on = 1;       // Sound enabled by default
 	enable_music = 1;      // Enable MIDI music (emu8950 OPL2 synthesis)
+	const char* music = check_param("music="); // start menu choice
+	if (music != NULL) enable_music = atoi(music+6) != 0;
 	return;
 	#endif
 
@@ -23,6 +23,7 @@ The authors of this program may be contacted at https://forum.princed.org
 #ifdef POP_RP2350
 #include "HDMI.h"
 #include "pico/stdlib.h"  // for time_us_32
+#include "pop_fs.h"
 #endif
 
 #ifndef _MSC_VER // unistd.h does not exist in the Windows SDK.
@@ -958,6 +959,18 @@ const char* get_hof_path(char* custom_path_buffer, size_t max_len) {
 void hof_write() {
 	char custom_hof_path[POP_MAX_PATH];
 	const char* hof_path = get_hof_path(custom_hof_path, sizeof(custom_hof_path));
+#ifdef POP_RP2350
+	// FatFS; the old table stays in place unless the new one is complete.
+	FIL* handle = pop_fs_open(hof_path, "wb");
+	if (handle == NULL ||
+		pop_fs_write(&hof_count, 1, 2, handle) != 2 ||
+		pop_fs_write(&hof, 1, sizeof(hof), handle) != sizeof(hof)) {
+		printf("hof_write: Can not write to: %s\n", hof_path);
+		pop_fs_discard(handle);
+	} else if (pop_fs_close(handle) != 0) {
+		printf("hof_write: Can not write to: %s\n", hof_path);
+	}
+#else
 	FILE* handle = fopen(hof_path, "wb");
 	if (handle == NULL ||
 		fwrite(&hof_count, 1, 2, handle) != 2 ||
@@ -965,6 +978,7 @@ void hof_write() {
 		perror(hof_path);
 	if (handle != NULL)
 		fclose(handle);
+#endif
 }
 
 // seg001:0F6C
@@ -972,6 +986,17 @@ void hof_read() {
 	hof_count = 0;
 	char custom_hof_path[POP_MAX_PATH];
 	const char* hof_path = get_hof_path(custom_hof_path, sizeof(custom_hof_path));
+#ifdef POP_RP2350
+	FIL* handle = pop_fs_open(hof_path, "rb");
+	if (handle == NULL)
+		return;
+	if (pop_fs_read(&hof_count, 1, 2, handle) != 2 ||
+		pop_fs_read(&hof, 1, sizeof(hof), handle) != sizeof(hof)) {
+		printf("hof_read: Can not read from: %s\n", hof_path);
+		hof_count = 0;
+	}
+	pop_fs_close(handle);
+#else
 	FILE* handle = fopen(hof_path, "rb");
 	if (handle == NULL)
 		return;
@@ -981,6 +1006,7 @@ void hof_read() {
 		hof_count = 0;
 	}
 	fclose(handle);
+#endif
 }
 
 // seg001:0FC3
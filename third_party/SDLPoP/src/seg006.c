@@ -19,6 +19,9 @@ The authors of this program may be contacted at https://forum.princed.org
 */
 
 #include "common.h"
+#ifdef POP_RP2350
+#include "latency_probe.h"
+#endif
 
 #define SEQTBL_BASE 0x196E
 #define SEQTBL_0 (seqtbl - SEQTBL_BASE)
@@ -1544,6 +1547,9 @@ void clear_saved_ctrl() {
 
 // seg006:0EAF
 void read_user_control() {
+	#ifdef POP_RP2350
+	latency_probe_tick();
+	#endif
 	if (control_forward >= CONTROL_RELEASED) {
 		if (control_x == CONTROL_HELD_FORWARD) {
 			if (control_forward == CONTROL_RELEASED) {
@@ -1108,12 +1108,26 @@ void draw_mid(int index) {
 		}
 		set_clip_rect(&game_area_clip);
 	}
+#endif
+#if defined(POP_RP2350) && defined(SDL_MIRROR_X)
+	// RP2350: 8bpp blitters can read the source right-to-left, so draw through a
+	// mirrored view of the image instead of allocating a flipped copy per draw.
+	SDL_Surface mirrored_view;
 #endif
 	if (blit_flip) {
 		xpos -= image->w/*width*/;
-		// for this version:
-		need_free_image = 1;
-		image = hflip(image);
+#if defined(POP_RP2350) && defined(SDL_MIRROR_X)
+		if (image->format->BytesPerPixel == 1 && current_target_surface->format->BytesPerPixel == 1) {
+			mirrored_view = *image;
+			mirrored_view.flags |= SDL_MIRROR_X;
+			image = &mirrored_view;
+		} else
+#endif
+		{
+			// for this version:
+			need_free_image = 1;
+			image = hflip(image);
+		}
 	}
 
 	if (midtable_entry->peel) {
@@ -19,6 +19,7 @@ The authors of this program may be contacted at https://forum.princed.org
 */
 
 #include "common.h"
+#include "blit_core.h"
 #ifdef POP_RP2350
 #include "psram_allocator.h"
 #include "HDMI.h"
@@ -33,6 +34,15 @@ int pop_quit_requested = 0;
 
 #ifdef POP_RP2350
 #include "pop_fs.h"
+#include "boot_timeline.h"
+#include "crash_guard.h"
+#include "latency_probe.h"
+#include "tile_inspect.h"
+#include "font_5x7.h"
+#include "mod_overlay.h"
+#include "peel_pool.h"
+#include "text_spans.h"
+#include "hud_dirty.h"
 #include "ff.h"
 #endif
 
@@ -51,7 +61,12 @@ int pop_quit_requested = 0;
 #ifdef POP_RP2350
 // PSRAM-backed file I/O wrappers (FatFS)
 typedef FIL pop_file_t;
-static inline pop_file_t* pop_open(const char* path, const char* mode) { return pop_fs_open(path, mode); }
+static bool rp2350_data_file_may_exist(const char* path);
+static inline pop_file_t* pop_open(const char* path, const char* mode) {
+	// Data lookups skip files the index knows are absent (no failed f_open).
+	if (mode[0] == 'r' && !rp2350_data_file_may_exist(path)) return NULL;
+	return pop_fs_open(path, mode);
+}
 static inline int pop_seek(pop_file_t* fp, long ofs, int whence) { return pop_fs_seek(fp, ofs, whence); }
 static inline size_t pop_read(void* ptr, size_t sz, size_t n, pop_file_t* fp) { return pop_fs_read(ptr, sz, n, fp); }
 static inline int pop_close(pop_file_t* fp) { return pop_fs_close(fp); }
@@ -74,6 +89,17 @@ static inline void pop_heap_free(void* p) {
 }
 
 static byte lzg_window[0x400];
+
+#ifdef USE_TEXT
+// Batched text renderer (defined next to draw_text_line).
+static void rp2350_text_cache_flush(void);
+static void rp2350_text_stats_frame(void);
+#endif
+
+// HUD strip tracking (defined next to update_screen).
+static void rp2350_hud_reset_cells(void);
+static void rp2350_hud_track(surface_type* target, int x, int y, int w, int h);
+static bool rp2350_hud_cell_unchanged(image_type* image, int xpos, int ypos, int blit);
 #else
 // Desktop file I/O wrappers (stdio)
 typedef FILE pop_file_t;
@@ -488,11 +514,11 @@ int pop_wait(int timer_index,int time) {
 
 #ifdef POP_RP2350
 static FIL* open_dat_from_root_or_data_dir(const char* filename) {
-	FIL* fp = pop_fs_open(filename, "rb");
+	FIL* fp = pop_open(filename, "rb");
 	if (fp == NULL) {
 		char data_path[POP_MAX_PATH];
 		snprintf_check(data_path, sizeof(data_path), "prince/%s", filename);
-		fp = pop_fs_open(data_path, "rb");
+		fp = pop_open(data_path, "rb");
 	}
 	return fp;
 }
@@ -543,7 +569,7 @@ dat_type* open_dat(const char* filename, int optional) {
 			// before checking the root directory, first try mods/MODNAME/
 			snprintf_check(filename_mod, sizeof(filename_mod), "%s/%s", mod_data_path, filename);
 			#ifdef POP_RP2350
-			fp = pop_fs_open(filename_mod, "rb");
+			fp = pop_open(filename_mod, "rb");
 			#else
 			fp = fopen(filename_mod, "rb");
 			#endif
@@ -748,6 +774,12 @@ void free_chtab(chtab_type *chtab_ptr) {
 		}
 	}
 	#ifdef POP_RP2350
+	#ifdef USE_TEXT
+	// Cached text layouts may reference this chtab's glyphs.
+	rp2350_text_cache_flush();
+	#endif
+	// The HUD cell shadow compares image pointers.
+	rp2350_hud_reset_cells();
 	psram_free(chtab_ptr);
 	#else
 	free(chtab_ptr);
@@ -1333,8 +1365,114 @@ void free_surface(surface_type* surface) {
 	SDL_FreeSurface(surface);
 }
 
+#ifdef POP_RP2350
+// Peel pool: moving objects save the background under them every frame, so peels
+// are served from preallocated SRAM slots (src/peel_pool.c) instead of a calloc +
+// SDL_CreateRGBSurface pair per object. Slot surfaces are created once at boot with
+// a fixed pixel capacity and reshaped per use. Peels that don't fit (or arrive when
+// a class is exhausted, e.g. long-lived dialog peels) fall back to the heap path.
+#ifndef RP2350_TRACE_PEEL
+#define RP2350_TRACE_PEEL 0
+#endif
+
+typedef struct rp2350_peel_slot_type {
+	peel_type peel; // must stay first: free_peel() gets this pointer back
+	SDL_Surface* surface;
+} rp2350_peel_slot_type;
+
+static rp2350_peel_slot_type rp2350_peel_slots[PEEL_POOL_MAX_SLOTS];
+static peel_pool_t rp2350_peel_pool;
+
+// Peel cost accounting, reported from update_screen() via rp2350_peel_stats_frame().
+static struct {
+	uint32_t frame_us;
+	uint32_t frame_peels;
+	uint32_t max_frame_us;
+	uint32_t total_us;
+	uint32_t peel_frames;
+} rp2350_peel_stats;
+
+// One-time slot allocation (SRAM: peels are copied to/from the screen every frame).
+// Called from main() before the first game session, so the slots are never counted
+// as a session's SRAM growth by teardown.
+void rp2350_peel_pool_init(void) {
+	if (rp2350_peel_pool.slot_count != 0) return;
+	peel_pool_init(&rp2350_peel_pool, peel_pool_default_classes, PEEL_POOL_DEFAULT_CLASSES);
+	psram_set_sram_mode(1);
+	for (int i = 0; i < rp2350_peel_pool.slot_count; ++i) {
+		SDL_Surface* surface = SDL_CreateRGBSurface(SDL_NO_PALETTE, rp2350_peel_pool.capacity[i], 1, 8, 0, 0, 0, 0);
+		if (surface == NULL) {
+			rp2350_peel_pool.slot_count = i;
+			break;
+		}
+		rp2350_peel_slots[i].surface = surface;
+	}
+	psram_set_sram_mode(0);
+	DBG_PRINTF("[peel] pool: %d slots, %u bytes\n", rp2350_peel_pool.slot_count,
+		(unsigned)peel_pool_bytes(peel_pool_default_classes, PEEL_POOL_DEFAULT_CLASSES));
+}
+
+// Smallest free slot that holds w*h pixels, reshaped to w x h; NULL on a pool miss.
+static peel_type* rp2350_peel_acquire(int w, int h) {
+	#if RP2350_TRACE_PEEL
+	printf("PEEL,%u,%d,%d\n", (unsigned)rp2350_peel_stats.peel_frames, w, h);
+	#endif
+	int index = peel_pool_acquire(&rp2350_peel_pool, w * h);
+	if (index < 0) return NULL;
+	rp2350_peel_slot_type* slot = &rp2350_peel_slots[index];
+	SDL_Surface* surface = slot->surface;
+	surface->w = w;
+	surface->h = h;
+	surface->pitch = w;
+	surface->clip_rect.x = 0;
+	surface->clip_rect.y = 0;
+	surface->clip_rect.w = w;
+	surface->clip_rect.h = h;
+	SDL_SurfaceAdoptPalette(surface, current_target_surface->format->palette);
+	slot->peel.peel = surface;
+	return &slot->peel;
+}
+
+// Give a pooled peel back; false if the peel came from the heap.
+static bool rp2350_peel_release(peel_type* peel_ptr) {
+	rp2350_peel_slot_type* slot = (rp2350_peel_slot_type*)peel_ptr;
+	if (slot < rp2350_peel_slots || slot >= rp2350_peel_slots + rp2350_peel_pool.slot_count) return false;
+	int index = (int)(slot - rp2350_peel_slots);
+	if (rp2350_peel_pool.in_use[index]) {
+		SDL_SurfaceAdoptPalette(slot->surface, NULL);
+		peel_pool_release(&rp2350_peel_pool, index);
+	}
+	return true;
+}
+
+// Called once per presented frame: fold this frame's peel cost into the totals.
+static void rp2350_peel_stats_frame(void) {
+	if (rp2350_peel_stats.frame_peels == 0) return;
+	uint32_t us = rp2350_peel_stats.frame_us;
+	rp2350_peel_stats.total_us += us;
+	if (us > rp2350_peel_stats.max_frame_us) rp2350_peel_stats.max_frame_us = us;
+	++rp2350_peel_stats.peel_frames;
+	if ((rp2350_peel_stats.peel_frames % 600) == 0) {
+		uint32_t total = rp2350_peel_pool.hits + rp2350_peel_pool.misses;
+		DBG_PRINTF("[peel] frames=%u avg=%uus max=%uus hits=%u misses=%u hit_rate=%u%% peak_bytes=%u\n",
+			(unsigned)rp2350_peel_stats.peel_frames,
+			(unsigned)(rp2350_peel_stats.total_us / rp2350_peel_stats.peel_frames),
+			(unsigned)rp2350_peel_stats.max_frame_us,
+			(unsigned)rp2350_peel_pool.hits,
+			(unsigned)rp2350_peel_pool.misses,
+			(unsigned)(total ? rp2350_peel_pool.hits * 100u / total : 0),
+			(unsigned)rp2350_peel_pool.peak_bytes);
+	}
+	rp2350_peel_stats.frame_us = 0;
+	rp2350_peel_stats.frame_peels = 0;
+}
+#endif
+
 // seg009:17EA
 void free_peel(peel_type* peel_ptr) {
+#ifdef POP_RP2350
+	if (rp2350_peel_release(peel_ptr)) return;
+#endif
 	SDL_FreeSurface(peel_ptr->peel);
 	free(peel_ptr);
 }
@@ -1661,6 +1799,8 @@ int draw_text_character(byte character) {
 					(int)textstate.current_x,
 					(int)(textstate.current_y - font->height_above_baseline));
 			}
+			rp2350_hud_track(current_target_surface, textstate.current_x,
+				textstate.current_y - font->height_above_baseline, image->w, image->h);
 			#endif
 			method_3_blit_mono(image, textstate.current_x, textstate.current_y - font->height_above_baseline, textstate.textblit, textstate.textcolor);
 			width = font->space_between_chars + image->w;
@@ -1670,10 +1810,155 @@ int draw_text_character(byte character) {
 	return width;
 }
 
+#ifdef POP_RP2350
+// Batched small-text renderer.
+// HUD strings ("N MINUTES LEFT", "LEVEL N", bottom messages) are redrawn every
+// frame while they are shown. Drawing them glyph by glyph goes through
+// method_3_blit_mono(), which sets the colorkey and re-reads the clip rect for
+// every character. Instead, lay out the whole line once into a list of
+// horizontal foreground spans (src/text_spans.c), cache it per
+// (string, color, font), and emit it with a single clip computation.
+#define RP2350_TEXT_CACHE_ENTRIES 6
+#define RP2350_TEXT_CACHE_MAX_CHARS 48
+
+typedef struct rp2350_text_cache_entry_type {
+	const font_type* font;
+	const chtab_type* chtab;
+	uint32_t last_used;
+	short length; // 0 = unused slot
+	byte color;
+	char text[RP2350_TEXT_CACHE_MAX_CHARS];
+	text_spans_line_t line; // relative to (current_x, current_y - height_above_baseline)
+} rp2350_text_cache_entry_type;
+
+static rp2350_text_cache_entry_type rp2350_text_cache[RP2350_TEXT_CACHE_ENTRIES];
+static uint32_t rp2350_text_cache_clock = 0;
+
+// Text cost accounting, reported from update_screen() via rp2350_text_stats_frame().
+static struct {
+	uint32_t frame_us;
+	uint32_t frame_lines;
+	uint32_t max_frame_us;
+	uint32_t total_us;
+	uint32_t text_frames;
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t fallbacks;
+} rp2350_text_stats;
+
+// Drop all cached layouts (font images are about to go away).
+static void rp2350_text_cache_flush(void) {
+	for (int i = 0; i < RP2350_TEXT_CACHE_ENTRIES; ++i) {
+		rp2350_text_cache[i].length = 0;
+	}
+}
+
+// Rasterise one line into entry->line. Returns false if the line can't be
+// represented (non-8bpp glyphs or too many spans); the caller then falls back
+// to the per-glyph path.
+static bool rp2350_text_layout(rp2350_text_cache_entry_type* entry, const font_type* font, const char* text, int length) {
+	text_spans_glyph_t glyphs[RP2350_TEXT_CACHE_MAX_CHARS];
+	int count = 0;
+	for (int i = 0; i < length; ++i) {
+		byte character = (byte)text[i];
+		if (character > font->last_char || character < font->first_char) continue;
+		image_type* image = font->chtab->images[character - font->first_char];
+		if (image == NULL) continue;
+		if (image->format->BytesPerPixel != 1) return false;
+		glyphs[count++] = (text_spans_glyph_t){ (const uint8_t*)image->pixels, image->w, image->h, image->pitch };
+	}
+	return text_spans_layout(&entry->line, glyphs, count, font->space_between_chars);
+}
+
+static rp2350_text_cache_entry_type* rp2350_text_cache_lookup(const font_type* font, const char* text, int length, byte color) {
+	rp2350_text_cache_entry_type* victim = &rp2350_text_cache[0];
+	++rp2350_text_cache_clock;
+	for (int i = 0; i < RP2350_TEXT_CACHE_ENTRIES; ++i) {
+		rp2350_text_cache_entry_type* entry = &rp2350_text_cache[i];
+		if (entry->length == length && entry->color == color &&
+			entry->font == font && entry->chtab == font->chtab &&
+			memcmp(entry->text, text, length) == 0
+		) {
+			entry->last_used = rp2350_text_cache_clock;
+			++rp2350_text_stats.hits;
+			return entry;
+		}
+		if (entry->length == 0) {
+			if (victim->length != 0) victim = entry;
+		} else if (victim->length != 0 && entry->last_used < victim->last_used) {
+			victim = entry;
+		}
+	}
+	++rp2350_text_stats.misses;
+	victim->length = 0;
+	if (!rp2350_text_layout(victim, font, text, length)) return NULL;
+	victim->font = font;
+	victim->chtab = font->chtab;
+	victim->color = color;
+	victim->length = (short)length;
+	memcpy(victim->text, text, length);
+	victim->last_used = rp2350_text_cache_clock;
+	return victim;
+}
+
+// Draw one line of text through the span cache.
+// Returns false if the caller must use the per-glyph path instead.
+static bool rp2350_draw_text_line_batched(const char* text, int length, int* width_out) {
+	font_type* font = textstate.ptr_font;
+	SDL_Surface* target = current_target_surface;
+	if (font == NULL || target == NULL || target->format->BytesPerPixel != 1) return false;
+	if (length <= 0 || length > RP2350_TEXT_CACHE_MAX_CHARS) {
+		++rp2350_text_stats.fallbacks;
+		return false;
+	}
+	uint32_t start_us = time_us_32();
+	// method_3_blit_mono() ignores the blitter for 8bpp fonts, so it isn't part of the key.
+	rp2350_text_cache_entry_type* entry = rp2350_text_cache_lookup(font, text, length, (byte)textstate.textcolor);
+	if (entry == NULL) {
+		++rp2350_text_stats.fallbacks;
+		return false;
+	}
+	const int xpos = textstate.current_x;
+	const int ypos = textstate.current_y - font->height_above_baseline;
+	// One dirty rect per line (the per-glyph path tracks every character).
+	rp2350_hud_track(target, xpos, ypos, entry->line.bbox_w, entry->line.bbox_h);
+	const text_spans_clip_t clip = { target->clip_rect.x, target->clip_rect.y, target->clip_rect.w, target->clip_rect.h };
+	text_spans_emit(&entry->line, (uint8_t*)target->pixels, target->pitch, &clip, xpos, ypos, entry->color);
+	textstate.current_x += entry->line.width;
+	*width_out = entry->line.width;
+	rp2350_text_stats.frame_us += time_us_32() - start_us;
+	++rp2350_text_stats.frame_lines;
+	return true;
+}
+
+// Called once per presented frame: fold this frame's text cost into the totals.
+static void rp2350_text_stats_frame(void) {
+	if (rp2350_text_stats.frame_lines == 0) return;
+	uint32_t us = rp2350_text_stats.frame_us;
+	rp2350_text_stats.total_us += us;
+	if (us > rp2350_text_stats.max_frame_us) rp2350_text_stats.max_frame_us = us;
+	++rp2350_text_stats.text_frames;
+	if ((rp2350_text_stats.text_frames & 63) == 0) {
+		DBG_PRINTF("[text] frames=%u avg=%uus max=%uus hits=%u misses=%u fallbacks=%u\n",
+			(unsigned)rp2350_text_stats.text_frames,
+			(unsigned)(rp2350_text_stats.total_us / rp2350_text_stats.text_frames),
+			(unsigned)rp2350_text_stats.max_frame_us,
+			(unsigned)rp2350_text_stats.hits,
+			(unsigned)rp2350_text_stats.misses,
+			(unsigned)rp2350_text_stats.fallbacks);
+	}
+	rp2350_text_stats.frame_us = 0;
+	rp2350_text_stats.frame_lines = 0;
+}
+#endif
+
 // seg009:377F
 int draw_text_line(const char* text,int length) {
 	//hide_cursor();
 	int width = 0;
+	#ifdef POP_RP2350
+	if (rp2350_draw_text_line_batched(text, length, &width)) return width;
+	#endif
 	const char* text_pos = text;
 	while (--length >= 0) {
 		width += draw_text_character(*text_pos);
@@ -2175,16 +2460,12 @@ rect_type *shrink2_rect(rect_type* target_rect,const rect_type* source_rect,int
 	return target_rect;
 }
 
-// seg009:3BBA
-void restore_peel(peel_type* peel_ptr) {
-	//printf("restoring peel at (x=%d, y=%d)\n", peel_ptr.rect.left, peel_ptr.rect.top); // debug
 #ifdef POP_RP2350
+// Copy a peel back onto the target surface (does not free it).
+static void rp2350_restore_peel_pixels(const peel_type* peel_ptr) {
 	// Direct memcpy for 8bpp indexed → 8bpp indexed (same format)
 	SDL_Surface* peel = peel_ptr->peel;
-	if (!peel || !peel->pixels) {
-		free_peel(peel_ptr);
-		return;
-	}
+	if (!peel || !peel->pixels) return;
 	
 	// Use peel surface dimensions directly (rect was already clipped in read_peel_from_screen)
 	int peel_w = peel->w;
@@ -2198,14 +2479,10 @@ void restore_peel(peel_type* peel_ptr) {
 	
 	if (dst_x < 0 || dst_y < 0 || dst_x + peel_w > screen_w || dst_y + peel_h > screen_h) {
 		// Rect was not properly clipped - skip to avoid corruption
-		free_peel(peel_ptr);
 		return;
 	}
 	
-	if (peel_w <= 0 || peel_h <= 0) {
-		free_peel(peel_ptr);
-		return;
-	}
+	if (peel_w <= 0 || peel_h <= 0) return;
 	
 	uint8_t* src_pixels = (uint8_t*)peel->pixels;
 	uint8_t* dst_pixels = (uint8_t*)current_target_surface->pixels;
@@ -2217,23 +2494,29 @@ void restore_peel(peel_type* peel_ptr) {
 		       src_pixels + y * src_pitch,
 		       peel_w);
 	}
+}
+#endif
+
+// seg009:3BBA
+void restore_peel(peel_type* peel_ptr) {
+	//printf("restoring peel at (x=%d, y=%d)\n", peel_ptr.rect.left, peel_ptr.rect.top); // debug
+#ifdef POP_RP2350
+	uint32_t start_us = time_us_32();
+	rp2350_restore_peel_pixels(peel_ptr);
+	free_peel(peel_ptr);
+	rp2350_peel_stats.frame_us += time_us_32() - start_us;
+	++rp2350_peel_stats.frame_peels;
 #else
 	method_6_blit_img_to_scr(peel_ptr->peel, peel_ptr->rect.left, peel_ptr->rect.top, /*0x10*/0);
-#endif
 	free_peel(peel_ptr);
+#endif
 	//SDL_FreeSurface(peel_ptr.peel);
 }
 
 // seg009:3BE9
 peel_type* read_peel_from_screen(const rect_type* rect) {
 #ifdef POP_RP2350
-	// Use SRAM mode so peels can be properly freed later
-	psram_set_sram_mode(1);
-#endif
-	// stub
-	peel_type* result = calloc(1, sizeof(peel_type));
-	//memset(&result, 0, sizeof(result));
-#ifdef POP_RP2350
+	uint32_t start_us = time_us_32();
 	// On RP2350, screen is 8bpp indexed. Create peel in same format for direct copy.
 	// IMPORTANT: Clip rectangle to screen bounds BEFORE creating the surface
 	int screen_w = current_target_surface->w;
@@ -2250,53 +2533,57 @@ peel_type* read_peel_from_screen(const rect_type* rect) {
 	if (clip_right > screen_w) { clip_right = screen_w; }
 	if (clip_bottom > screen_h) { clip_bottom = screen_h; }
 	
-	// Store the CLIPPED rectangle so restore_peel uses correct coordinates
-	result->rect.left = clip_left;
-	result->rect.top = clip_top;
-	result->rect.right = clip_right;
-	result->rect.bottom = clip_bottom;
-	
 	int peel_w = clip_right - clip_left;
 	int peel_h = clip_bottom - clip_top;
+	// Completely off screen - a 1x1 dummy peel (restore_peel skips it)
+	bool empty = peel_w <= 0 || peel_h <= 0;
+	int surface_w = empty ? 1 : peel_w;
+	int surface_h = empty ? 1 : peel_h;
 	
-	if (peel_w <= 0 || peel_h <= 0) {
-		// Completely off screen - return dummy peel (no palette needed)
-		SDL_Surface* peel_surface = SDL_CreateRGBSurface(SDL_NO_PALETTE, 1, 1, 8, 0, 0, 0, 0);
+	peel_type* result = rp2350_peel_acquire(surface_w, surface_h);
+	if (result == NULL) {
+		// Pool miss: heap peel. Use SRAM mode so it can be properly freed later
+		psram_set_sram_mode(1);
+		result = calloc(1, sizeof(peel_type));
+		// Use SDL_NO_PALETTE to avoid allocating a 1KB palette - we'll adopt screen's palette
+		SDL_Surface* peel_surface = SDL_CreateRGBSurface(SDL_NO_PALETTE, surface_w, surface_h, 8, 0, 0, 0, 0);
 		psram_set_sram_mode(0);
-		if (peel_surface) {
+		if (peel_surface == NULL) {
+			sdlperror("read_peel_from_screen: SDL_CreateRGBSurface");
+			// Don't quit - return NULL peel and hope for the best
+		} else {
+			// Share palette reference instead of copying (saves memory)
 			SDL_SurfaceAdoptPalette(peel_surface, current_target_surface->format->palette);
 		}
 		result->peel = peel_surface;
-		return result;
-	}
-	
-	// Use SDL_NO_PALETTE to avoid allocating a 1KB palette - we'll adopt screen's palette
-	SDL_Surface* peel_surface = SDL_CreateRGBSurface(SDL_NO_PALETTE, peel_w, peel_h, 8, 0, 0, 0, 0);
-	psram_set_sram_mode(0);
-	if (peel_surface == NULL) {
-		sdlperror("read_peel_from_screen: SDL_CreateRGBSurface");
-		// Don't quit - return NULL peel and hope for the best
-		result->peel = NULL;
-		return result;
 	}
-	// Share palette reference instead of copying (saves memory)
-	SDL_SurfaceAdoptPalette(peel_surface, current_target_surface->format->palette);
 	
-	// Direct memcpy for 8bpp indexed → 8bpp indexed (same format)
-	uint8_t* src_pixels = (uint8_t*)current_target_surface->pixels;
-	uint8_t* dst_pixels = (uint8_t*)peel_surface->pixels;
-	int src_pitch = current_target_surface->pitch;
-	int dst_pitch = peel_surface->pitch;
+	// Store the CLIPPED rectangle so restore_peel uses correct coordinates
+	result->rect.left = clip_left;
+	result->rect.top = clip_top;
+	result->rect.right = clip_right;
+	result->rect.bottom = clip_bottom;
 	
-	for (int y = 0; y < peel_h; ++y) {
-		memcpy(dst_pixels + y * dst_pitch,
-		       src_pixels + (clip_top + y) * src_pitch + clip_left,
-		       peel_w);
+	SDL_Surface* peel_surface = result->peel;
+	if (!empty && peel_surface != NULL) {
+		// Direct memcpy for 8bpp indexed → 8bpp indexed (same format)
+		uint8_t* src_pixels = (uint8_t*)current_target_surface->pixels;
+		uint8_t* dst_pixels = (uint8_t*)peel_surface->pixels;
+		int src_pitch = current_target_surface->pitch;
+		int dst_pitch = peel_surface->pitch;
+		
+		for (int y = 0; y < peel_h; ++y) {
+			memcpy(dst_pixels + y * dst_pitch,
+			       src_pixels + (clip_top + y) * src_pitch + clip_left,
+			       peel_w);
+		}
 	}
 	
-	result->peel = peel_surface;
+	rp2350_peel_stats.frame_us += time_us_32() - start_us;
+	++rp2350_peel_stats.frame_peels;
 	return result;
 #else
+	peel_type* result = calloc(1, sizeof(peel_type));
 	result->rect = *rect;
 #ifndef USE_ALPHA
 	SDL_Surface* peel_surface = SDL_CreateRGBSurface(0, rect->right - rect->left, rect->bottom - rect->top,
@@ -3445,8 +3732,156 @@ void draw_overlay(void) {
 }
 
 static int update_screen_debug = 0;
+#ifdef POP_RP2350
+// HUD strip presentation.
+// Rows 192..199 of the onscreen surface (HP triangles, bottom text) are kept out
+// of the game dirty rects by the RP2350 clip in add_drect(), so every write that
+// reaches the strip is recorded in src/hud_dirty.c instead, and during gameplay
+// update_screen() presents the game area plus only those rects. HP triangles
+// drawn with method_6_blit_img_to_scr() also keep a cell shadow there, so a
+// cell that hasn't changed is neither redrawn nor presented.
+#define RP2350_HUD_TOP HUD_DIRTY_TOP
+#define RP2350_HUD_WIDTH HUD_DIRTY_WIDTH
+
+#ifndef RP2350_TRACE_HUD
+#define RP2350_TRACE_HUD 0
+#endif
+
+static hud_dirty_t rp2350_hud = { .all = true };
+
+static struct {
+	uint32_t frames;
+	uint32_t partial_frames;
+	uint32_t hud_bytes;
+} rp2350_hud_stats;
+
+static void rp2350_hud_reset_cells(void) {
+	hud_dirty_reset_cells(&rp2350_hud);
+}
+
+// Note a write to `target` that isn't a tracked HUD cell.
+static void rp2350_hud_track(surface_type* target, int x, int y, int w, int h) {
+	if (target != onscreen_surface_ || onscreen_surface_ == NULL) return;
+	hud_dirty_track(&rp2350_hud, x, y, w, h);
+}
+
+// Called by method_6_blit_img_to_scr() before drawing to the onscreen surface.
+// Returns true if the exact same cell is already on screen and the blit can be skipped.
+static bool rp2350_hud_cell_unchanged(image_type* image, int xpos, int ypos, int blit) {
+	if (ypos + image->h <= RP2350_HUD_TOP) return false;
+	// HP triangles: opaque copies (blitters_0_no_transp) and masked black
+	// (blitters_9_black, the empty slots). Redrawing either over the pixels it
+	// left gives the same result; any other write there forgets the cell.
+	if (start_level < 0 || ypos < RP2350_HUD_TOP ||
+		(blit != blitters_0_no_transp && blit != blitters_9_black) ||
+		(image->flags & SDL_MIRROR_X) != 0 || // stack views have no stable identity
+		xpos < 0 || xpos >= RP2350_HUD_WIDTH || image->w > HUD_DIRTY_MAX_CELL_W
+	) {
+		rp2350_hud_track(current_target_surface, xpos, ypos, image->w, image->h);
+		return false;
+	}
+	return hud_dirty_cell_unchanged(&rp2350_hud, image, xpos, ypos, image->w, image->h, (byte)blit);
+}
+
+// Present the onscreen surface: the full frame outside gameplay (or when the
+// strip overflowed its dirty list), otherwise the game area plus HUD dirty rects.
+static void rp2350_present_onscreen(SDL_Surface* screen) {
+	uint32_t hud_bytes = 0;
+	bool partial = start_level >= 0 && !rp2350_hud.all &&
+		screen->format->BytesPerPixel == 1 && screen->h > RP2350_HUD_TOP;
+	#ifdef USE_MENU
+	if (is_menu_shown) partial = false;
+	#endif
+	if (partial) {
+		SDL_Rect game_rect = {0, 0, screen->w, RP2350_HUD_TOP};
+		SDL_UpdateTexture(NULL, &game_rect, screen->pixels, screen->pitch);
+		for (int i = 0; i < rp2350_hud.count; ++i) {
+			const hud_dirty_rect_t* r = &rp2350_hud.rects[i];
+			const SDL_Rect rect = {r->x, r->y, r->w, r->h};
+			const byte* src = (const byte*)screen->pixels + r->y * screen->pitch + r->x;
+			SDL_UpdateTexture(NULL, &rect, src, screen->pitch);
+			hud_bytes += (uint32_t)(r->w * r->h);
+		}
+		++rp2350_hud_stats.partial_frames;
+	} else {
+		SDL_UpdateTexture(NULL, NULL, screen->pixels, screen->pitch);
+		if (screen->h > RP2350_HUD_TOP) {
+			hud_bytes = (uint32_t)(RP2350_HUD_WIDTH * (screen->h - RP2350_HUD_TOP));
+		}
+		// Outside gameplay not every strip writer is tracked; don't trust the cell shadow.
+		if (start_level < 0) rp2350_hud_reset_cells();
+	}
+	#if RP2350_TRACE_HUD
+	if (hud_bytes != 0) {
+		printf("[hud] frame=%u %s rects=%d bytes=%u\n",
+			(unsigned)rp2350_hud_stats.frames, partial ? "partial" : "full",
+			partial ? rp2350_hud.count : 1, (unsigned)hud_bytes);
+	}
+	#endif
+	rp2350_hud_stats.hud_bytes += hud_bytes;
+	++rp2350_hud_stats.frames;
+	if ((rp2350_hud_stats.frames % 600) == 0) {
+		DBG_PRINTF("[hud] frames=%u partial=%u hud_bytes=%u cells drawn=%u skipped=%u\n",
+			(unsigned)rp2350_hud_stats.frames, (unsigned)rp2350_hud_stats.partial_frames,
+			(unsigned)rp2350_hud_stats.hud_bytes, (unsigned)rp2350_hud.cells_drawn,
+			(unsigned)rp2350_hud.cells_skipped);
+	}
+	hud_dirty_frame_done(&rp2350_hud);
+}
+#endif
+
+#if defined(POP_RP2350) && defined(USE_DEBUG_CHEATS)
+// Debug cheats: a USB mouse cursor and what is under it (src/tile_inspect.h).
+// Drawn over the frame just copied to the scanout buffer and only inside the
+// game area, which every copy rewrites: the onscreen surface and its dirty
+// rects never see it, and it is gone with the next copy unless redrawn.
+static void rp2350_draw_tile_inspector(void) {
+	static int last_x = -1, last_y = -1;
+	static bool mouse_seen = false;
+	int x, y;
+	Uint32 buttons = SDL_GetMouseState(&x, &y);
+	// The cursor starts in the middle: show it once a mouse has moved it
+	if (last_x >= 0 && (x != last_x || y != last_y || buttons)) mouse_seen = true;
+	last_x = x;
+	last_y = y;
+	if (!debug_cheats_enabled || !mouse_seen || start_level <= 0 || drawn_room == 0) return;
+
+	uint8_t* fb = graphics_get_buffer();
+	const int width = (int)graphics_get_width();
+	const int height = (int)graphics_get_height();
+	if (!fb || width != TILE_INSPECT_ROOM_W || height < 200) return;
+	uint8_t* room_fb = fb + (height - 200) / 2 * width;
+
+	int col, row;
+	tile_inspect_info_t info;
+	const tile_inspect_level_t tiles = {
+		level.fg, level.bg, level.doorlinks1, level.doorlinks2, level.guards_tile, level.guards_skill,
+	};
+	if (tile_inspect_at(x, y, &col, &row) && tile_inspect_lookup(&tiles, drawn_room, col, row, &info)) {
+		char lines[TILE_INSPECT_LINES][TILE_INSPECT_LINE];
+		int count = tile_inspect_format(&info, lines);
+		int box_w = 0;
+		for (int i = 0; i < count; ++i) {
+			int w = (int)strlen(lines[i]) * FONT_5X7_ADVANCE;
+			if (w > box_w) box_w = w;
+		}
+		box_w += 4;
+		int box_h = count * 9 + 3;
+		// Top left, unless the cursor is there
+		int box_y = (x < box_w + 8 && y < box_h + 8) ? TILE_INSPECT_ROOM_H - box_h : 0;
+		tile_inspect_fill(room_fb, width, TILE_INSPECT_ROOM_H, 0, box_y, box_w, box_h, color_0_black);
+		for (int i = 0; i < count; ++i) {
+			tile_inspect_text(room_fb, width, TILE_INSPECT_ROOM_H, 2, box_y + 2 + i * 9, lines[i], color_15_brightwhite);
+		}
+	}
+	tile_inspect_cursor(room_fb, width, TILE_INSPECT_ROOM_H, x, y, color_15_brightwhite, color_0_black);
+}
+#endif
+
 void update_screen() {
 	#ifdef POP_RP2350
+	// Fed before the fade check: a long fully faded stretch is still alive.
+	crash_guard_feed();
 	// Don't update screen while fade is at full black - scene is already in HDMI from load_intro
 	if (graphics_get_fade_level() >= 48) {
 		return;
@@ -3455,9 +3890,23 @@ void update_screen() {
 	// Bypass SDL2 scaling/texture logic (which assumes 24bpp/renderer features).
 	SDL_Surface* screen = onscreen_surface_;
 	if (screen && screen->pixels) {
-		SDL_UpdateTexture(NULL, NULL, screen->pixels, screen->pitch);
+		rp2350_present_onscreen(screen);
+		#ifdef USE_DEBUG_CHEATS
+		rp2350_draw_tile_inspector();
+		#endif
+		latency_probe_present();
 	}
 	SDL_RenderPresent(renderer_);
+	#ifdef USE_TEXT
+	rp2350_text_stats_frame();
+	#endif
+	rp2350_peel_stats_frame();
+	static bool boot_reported = false;
+	if (!boot_reported) {
+		boot_reported = true;
+		boot_timeline_mark("first_frame");
+		boot_timeline_report();
+	}
 	return;
 	#endif
 	draw_overlay();
@@ -3694,6 +4143,49 @@ void close_dat(dat_type* pointer) {
 	// stub
 }
 
+#ifdef POP_RP2350
+// Index of the base game and mod data files (src/mod_overlay.c). Built once
+// per session by load_mod_options(); stale after the card was remounted.
+static mod_overlay_t data_file_index;
+static uint16_t data_file_index_mount;
+
+void rp2350_index_data_files(void) {
+	uint32_t t0 = time_us_32();
+	const char* mod_dir = use_custom_levelset ? mod_data_path : "";
+	bool ok = mod_overlay_build(&data_file_index, mod_dir);
+	data_file_index_mount = pop_fs_mount_id();
+	DBG_PRINTF("[data_index] %s%s: %u files, %u us%s\n", mod_dir[0] ? "base + " : "base", mod_dir,
+		(unsigned)data_file_index.count, (unsigned)(time_us_32() - t0), ok ? "" : " (failed, probing instead)");
+}
+
+static bool rp2350_data_file_may_exist(const char* path) {
+	if (data_file_index_mount != pop_fs_mount_id()) return true;
+	return mod_overlay_may_exist(&data_file_index, path);
+}
+
+// Session teardown (called from the SDLPoP teardown hook in seg000.c): drop
+// leftover peels, close data files left open by quit(), release sounds and
+// drop caches keyed on image pointers, which are about to be reclaimed with
+// the session's PSRAM.
+void rp2350_seg009_teardown(void) {
+	// Peels still saved when quit() longjmp'd out; pooled slots stay allocated.
+	free_peels();
+	while (dat_chain_ptr != NULL) {
+		close_dat(dat_chain_ptr);
+	}
+	// load_sounds() skips slots that are already filled; PSRAM ones go with the session.
+	for (int i = 0; i < COUNT(sound_pointers); ++i) {
+		if (sound_pointers[i] != NULL && !IS_PSRAM(sound_pointers[i])) free_sound(sound_pointers[i]);
+		sound_pointers[i] = NULL;
+	}
+	#ifdef USE_TEXT
+	rp2350_text_cache_flush();
+	#endif
+	rp2350_hud_reset_cells();
+	mod_overlay_free(&data_file_index);
+}
+#endif
+
 // seg009:9F80
 void *load_from_opendats_alloc(int resource, const char* extension, data_location* out_result, int* out_size) {
 	// stub
@@ -3784,6 +4276,9 @@ void method_1_blit_rect(surface_type* target_surface,surface_type* source_surfac
 	rect_to_sdlrect(source_rect, &src_rect);
 	SDL_Rect dest_rect;
 	rect_to_sdlrect(target_rect, &dest_rect);
+	#ifdef POP_RP2350
+	rp2350_hud_track(target_surface, dest_rect.x, dest_rect.y, dest_rect.w, dest_rect.h);
+	#endif
 
 	if (blit == blitters_0_no_transp) {
 		// Disable transparency.
@@ -3863,17 +4358,14 @@ image_type* method_3_blit_mono(image_type* image,int xpos,int ypos,int blitter,b
 			DBG_PRINTF("[method_3_blit_mono] src total: fg=%d bg=%d (of %d)\n", fg_total, bg_total, w*h);
 		}
 		
-		for (int y = 0; y < h; ++y) {
-			int dy = ypos + y;
-			if (dy < clip_top || dy >= clip_bottom) continue;
-			for (int x = 0; x < w; ++x) {
-				int dx = xpos + x;
-				if (dx < clip_left || dx >= clip_right) continue;
-				uint8_t src_pix = src_pixels[y * src_pitch + x];
-				if (src_pix == 0) continue; // Transparent (colorkey)
-				// Foreground pixel: write the destination palette index 'color'
-				dst_pixels[dy * dst_pitch + dx] = color;
-			}
+		// Mirrored view (see draw_mid): read each row right-to-left.
+		const bool mirrored = (image->flags & SDL_MIRROR_X) != 0;
+		int x0 = MAX(0, clip_left - xpos), x1 = MIN(w, clip_right - xpos);
+		int y0 = MAX(0, clip_top - ypos), y1 = MIN(h, clip_bottom - ypos);
+		if (x1 > x0 && y1 > y0) {
+			blit_core_mono8(dst_pixels + (ypos + y0) * dst_pitch + xpos + x0, dst_pitch,
+				src_pixels + y0 * src_pitch + (mirrored ? w - 1 - x0 : x0), src_pitch, mirrored ? -1 : 1,
+				x1 - x0, y1 - y0, color);
 		}
 		if (rp2350_m3_calls < 16) {
 			DBG_PRINTF("[method_3_blit_mono] 8bpp direct blit ok (color_idx=%u)\n", (unsigned)color);
@@ -3977,6 +4469,9 @@ int safe_SDL_FillRect(SDL_Surface* dst, const SDL_Rect* rect, Uint32 color) {
 const rect_type* method_5_rect(const rect_type* rect,int blit,byte color) {
 	SDL_Rect dest_rect;
 	rect_to_sdlrect(rect, &dest_rect);
+	#ifdef POP_RP2350
+	rp2350_hud_track(current_target_surface, dest_rect.x, dest_rect.y, dest_rect.w, dest_rect.h);
+	#endif
 	rgb_type palette_color = palette[color];
 #ifndef USE_ALPHA
 	uint32_t rgb_color = SDL_MapRGBA(current_target_surface->format, palette_color.r<<2, palette_color.g<<2, palette_color.b<<2, 0xFF);
@@ -3993,6 +4488,9 @@ const rect_type* method_5_rect(const rect_type* rect,int blit,byte color) {
 void draw_rect_with_alpha(const rect_type* rect, byte color, byte alpha) {
 	SDL_Rect dest_rect;
 	rect_to_sdlrect(rect, &dest_rect);
+	#ifdef POP_RP2350
+	rp2350_hud_track(current_target_surface, dest_rect.x, dest_rect.y, dest_rect.w, dest_rect.h);
+	#endif
 	rgb_type palette_color = palette[color];
 	uint32_t rgb_color = SDL_MapRGBA(overlay_surface->format, palette_color.r<<2, palette_color.g<<2, palette_color.b<<2, alpha);
 	if (safe_SDL_FillRect(current_target_surface, &dest_rect, rgb_color) != 0) {
@@ -4009,6 +4507,9 @@ void draw_rect_contours(const rect_type* rect, byte color) {
 	}
 	SDL_Rect dest_rect;
 	rect_to_sdlrect(rect, &dest_rect);
+	#ifdef POP_RP2350
+	rp2350_hud_track(current_target_surface, dest_rect.x, dest_rect.y, dest_rect.w, dest_rect.h);
+	#endif
 	rgb_type palette_color = palette[color];
 	uint32_t rgb_color = SDL_MapRGBA(overlay_surface->format, palette_color.r<<2, palette_color.g<<2, palette_color.b<<2, 0xFF);
 	if (SDL_LockSurface(current_target_surface) != 0) {
@@ -4065,26 +4566,19 @@ void blit_xor(SDL_Surface* target_surface, SDL_Rect* dest_rect, SDL_Surface* ima
 	int dst_bpp = target_surface->format->BytesPerPixel;
 	
 	if (src_bpp == 1 && dst_bpp == 1) {
-		// 8-bit indexed: XOR the palette indices directly
-		for (int y = 0; y < dest_rect->h; y++) {
-			int src_y = src_rect->y + y;
-			int dst_y = dest_rect->y + y;
-			if (dst_y < 0 || dst_y >= target_surface->h) continue;
-			
-			byte* src_row = (byte*)image->pixels + src_y * image->pitch + src_rect->x;
-			byte* dst_row = (byte*)target_surface->pixels + dst_y * target_surface->pitch + dest_rect->x;
-			
-			for (int x = 0; x < dest_rect->w; x++) {
-				int dst_x = dest_rect->x + x;
-				if (dst_x < 0 || dst_x >= target_surface->w) continue;
-				
-				byte src_pixel = src_row[x];
-				// Skip transparent pixels (color 0)
-				if (src_pixel != 0) {
-					// XOR the palette index for the shadow effect
-					dst_row[x] ^= src_pixel;
-				}
-			}
+		// 8-bit indexed: XOR the palette indices of non-transparent (non-zero)
+		// pixels, clipped to the target surface.
+		int x0 = MAX(0, -dest_rect->x), x1 = MIN(dest_rect->w, target_surface->w - dest_rect->x);
+		int y0 = MAX(0, -dest_rect->y), y1 = MIN(dest_rect->h, target_surface->h - dest_rect->y);
+		if (x1 > x0 && y1 > y0) {
+			// Mirrored view (see draw_mid): read the rows right-to-left.
+			const bool mirrored = (image->flags & SDL_MIRROR_X) != 0;
+			const int src_x = src_rect->x + x0;
+			const byte* src = (const byte*)image->pixels + (src_rect->y + y0) * image->pitch
+				+ (mirrored ? image->w - 1 - src_x : src_x);
+			byte* dst = (byte*)target_surface->pixels + (dest_rect->y + y0) * target_surface->pitch
+				+ dest_rect->x + x0;
+			blit_core_xor8(dst, target_surface->pitch, src, image->pitch, mirrored ? -1 : 1, x1 - x0, y1 - y0);
 		}
 	}
 	
@@ -4210,6 +4704,9 @@ image_type* method_6_blit_img_to_scr(image_type* image,int xpos,int ypos,int bli
 			clipped_debug++;
 		}
 	}
+	if (current_target_surface == onscreen_surface_ && rp2350_hud_cell_unchanged(image, xpos, ypos, blit)) {
+		return image;
+	}
 #endif
 
 	if (blit == blitters_9_black) {
@@ -4335,72 +4832,16 @@ image_type* method_6_blit_img_to_scr(image_type* image,int xpos,int ypos,int bli
 		#endif
 		
 		if (copy_w > 0 && copy_h > 0 && pal && pal->ncolors > 0) {
-			// Get the pixel format masks
-			uint32_t rmask = image->format->Rmask;
-			uint32_t gmask = image->format->Gmask;
-			uint32_t bmask = image->format->Bmask;
-			uint32_t amask = image->format->Amask;
-			
-			// Calculate shifts from masks (find first set bit)
-			int rshift = 0, gshift = 0, bshift = 0, ashift = 0;
-			if (rmask) { uint32_t m = rmask; while (!(m & 1)) { m >>= 1; rshift++; } }
-			if (gmask) { uint32_t m = gmask; while (!(m & 1)) { m >>= 1; gshift++; } }
-			if (bmask) { uint32_t m = bmask; while (!(m & 1)) { m >>= 1; bshift++; } }
-			if (amask) { uint32_t m = amask; while (!(m & 1)) { m >>= 1; ashift++; } }
-			
-			#ifdef POP_RP2350
-			int pixels_written = 0, pixels_skipped = 0;
-			#endif
-			
-			for (int y = 0; y < copy_h; ++y) {
-				uint32_t* src_row = (uint32_t*)(src_pixels + (src_y + y) * src_pitch) + src_x;
-				uint8_t* dst_row = dst_pixels + (dst_y + y) * dst_pitch + dst_x;
-				
-				for (int x = 0; x < copy_w; ++x) {
-					uint32_t pixel = src_row[x];
-					uint8_t alpha = (pixel & amask) >> ashift;
-					
-					// If respecting alpha: only copy opaque pixels (alpha > 0)
-					// If not respecting alpha (blit=0x00): copy all pixels
-					if (!respect_alpha || alpha > 0) {
-						uint8_t r = (pixel & rmask) >> rshift;
-						uint8_t g = (pixel & gmask) >> gshift;
-						uint8_t b = (pixel & bmask) >> bshift;
-						
-						// Find nearest palette color (simple brute force)
-						int best_dist = 0x7FFFFFFF;
-						int best_idx = 0;
-						for (int i = 0; i < pal->ncolors; ++i) {
-							int dr = (int)r - pal->colors[i].r;
-							int dg = (int)g - pal->colors[i].g;
-							int db = (int)b - pal->colors[i].b;
-							int dist = dr*dr + dg*dg + db*db;
-							if (dist < best_dist) {
-								best_dist = dist;
-								best_idx = i;
-							}
-						}
-						dst_row[x] = (uint8_t)best_idx;
-						#ifdef POP_RP2350
-						pixels_written++;
-						#endif
-					} else {
-						#ifdef POP_RP2350
-						pixels_skipped++;
-						#endif
-					}
-					// If alpha == 0 and respect_alpha, don't write (preserve destination = transparency)
-				}
-			}
-			
-			#ifdef POP_RP2350
-			static int blit_stats_count = 0;
-			if (blit_stats_count < 10 && respect_alpha) {
-				DBG_PRINTF("[BLIT_STATS] written=%d skipped=%d total=%d\n", 
-					pixels_written, pixels_skipped, pixels_written + pixels_skipped);
-				blit_stats_count++;
-			}
-			#endif
+			// If respecting alpha: only copy opaque pixels (alpha > 0), leaving
+			// the destination (transparency) under the rest.
+			// If not respecting alpha (blit=0x00): copy all pixels.
+			const blit_rgba_format_t fmt = {
+				image->format->Rmask, image->format->Gmask, image->format->Bmask, image->format->Amask
+			};
+			const blit_palette_t bpal = { (const blit_color_t*)pal->colors, pal->ncolors, false };
+			blit_core_rgba_to8(dst_pixels + dst_y * dst_pitch + dst_x, dst_pitch,
+				(const uint32_t*)(src_pixels + src_y * src_pitch) + src_x, src_pitch,
+				copy_w, copy_h, &fmt, BLIT_CORE_NO_KEY, respect_alpha, &bpal);
 		}
 		
 		return image;
@@ -0,0 +1,289 @@
+/*
+ * murmprince - blitter micro-benchmark (host tool)
+ *
+ * Runs the cases of src/blit_bench.c (RP2350_BLIT_BENCH=1) through the
+ * same pixel loops (src/blit_core.c) on a PC, so a change to a blit path
+ * can be measured and its output diffed without hardware. Each case is
+ * the blit_core call its firmware path ends in:
+ *
+ *   m6_no_transp, m1_rect   blit_core_key8, no colorkey
+ *   m6_transp, m6_or        blit_core_key8, colorkey 0 (the port draws
+ *                           blitters_2_or as a transparent copy)
+ *   m6_xor                  blit_core_xor8
+ *   m6_rgba                 blit_core_rgba_to8, alpha 0 skipped
+ *   mono                    blit_core_mono8
+ *   conv_24_to_8            blit_core_rgb24_to8
+ *   conv_32_to_8            blit_core_rgba_to8
+ *   fill_rect               blit_core_fill8
+ *
+ * Clipping, SDL surface bookkeeping and the SRAM/PSRAM split are left
+ * out: buffers are plain host memory ("host" in the src/dst columns).
+ * The CSV lines have the device's format:
+ *
+ *   BENCH,<case>,<sprite>,<w>,<h>,<src_mem>,<dst_mem>,<iters>,<total_us>,
+ *         <ns_per_px>,<bytes_per_iter>,<mb_per_s>
+ *
+ * Build and run from the repository root:
+ *
+ *   cc -O2 -Isrc -o blit_bench tools/blit_bench.c src/blit_core.c
+ *   ./blit_bench [-t target_us] [-c case]
+ *
+ * -t sets the time per line (default 20000 us), -c runs only the named case.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "blit_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MIN_ITERS 4
+#define BENCH_MAX_ITERS 100000000
+#define BENCH_DST_W 320
+#define BENCH_DST_H 200
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef enum {
+    BENCH_M6_NO_TRANSP,
+    BENCH_M6_TRANSP,
+    BENCH_M6_OR,
+    BENCH_M6_XOR,
+    BENCH_M6_RGBA,
+    BENCH_MONO,
+    BENCH_CONV_24_TO_8,
+    BENCH_CONV_32_TO_8,
+    BENCH_M1_RECT,
+    BENCH_FILL_RECT,
+    BENCH_CASE_COUNT
+} bench_case_t;
+
+static const char *const bench_case_names[BENCH_CASE_COUNT] = {
+    "m6_no_transp",
+    "m6_transp",
+    "m6_or",
+    "m6_xor",
+    "m6_rgba",
+    "mono",
+    "conv_24_to_8",
+    "conv_32_to_8",
+    "m1_rect",
+    "fill_rect",
+};
+
+typedef struct {
+    const char *name;
+    int w;
+    int h;
+} bench_size_t;
+
+// The sizes of src/blit_bench.c.
+static const bench_size_t sprite_sizes[] = {
+    { "font_glyph", 7, 8 },
+    { "hp_cell", 7, 5 },
+    { "kid_frame", 26, 44 },
+    { "guard_frame", 36, 44 },
+    { "tile_wall", 32, 63 },
+};
+
+static const bench_size_t rect_sizes[] = {
+    { "peel", 40, 64 },
+    { "room_half", 320, 96 },
+};
+
+// stbi's byte order, as SDL_port.c reads 32bpp sources
+static const blit_rgba_format_t rgba_format = { 0x000000FFu, 0x0000FF00u, 0x00FF0000u, 0xFF000000u };
+
+static blit_color_t palette_colors[256];
+static const blit_palette_t palette = { palette_colors, 256, false };
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_src_depth(bench_case_t c) {
+    switch (c) {
+        case BENCH_M6_RGBA:
+        case BENCH_CONV_32_TO_8:
+            return 32;
+        case BENCH_CONV_24_TO_8:
+            return 24;
+        default:
+            return 8;
+    }
+}
+
+// The pattern of src/blit_bench.c: ~1/4 transparent (0), the rest spread
+// over the palette (mono sources use 0/1 only).
+static void bench_fill_source(uint8_t *pixels, int pitch, int w, int h, int depth, bool mono) {
+    uint32_t seed = 0x12345678u;
+    for (int y = 0; y < h; ++y) {
+        uint8_t *row = pixels + y * pitch;
+        for (int x = 0; x < w; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            const uint8_t v = (uint8_t)(seed >> 24);
+            const bool transparent = (v & 3) == 0;
+            if (depth == 8) {
+                row[x] = transparent ? 0 : (mono ? 1 : (uint8_t)(1 + (v % 200)));
+            } else if (depth == 24) {
+                row[x * 3 + 0] = transparent ? 0 : v;
+                row[x * 3 + 1] = (uint8_t)(v * 3);
+                row[x * 3 + 2] = (uint8_t)(v * 7);
+            } else {
+                uint32_t *row32 = (uint32_t *)row;
+                row32[x] = transparent ? 0 : (0xff000000u | (seed & 0x00ffffffu));
+            }
+        }
+    }
+}
+
+static void bench_blit_once(bench_case_t c, const uint8_t *src, int src_pitch, int w, int h,
+                            uint8_t *dst, int iter) {
+    const int max_x = BENCH_DST_W - w;
+    const int max_y = BENCH_DST_H - h;
+    const int x = max_x > 0 ? (iter * 37) % (max_x + 1) : 0;
+    const int y = max_y > 0 ? (iter * 13) % (max_y + 1) : 0;
+    uint8_t *d = dst + y * BENCH_DST_W + x;
+
+    switch (c) {
+        case BENCH_M6_NO_TRANSP:
+        case BENCH_M1_RECT:
+            blit_core_key8(d, BENCH_DST_W, src, src_pitch, 1, w, h, BLIT_CORE_NO_KEY, NULL);
+            break;
+        case BENCH_M6_TRANSP:
+        case BENCH_M6_OR:
+            blit_core_key8(d, BENCH_DST_W, src, src_pitch, 1, w, h, 0, NULL);
+            break;
+        case BENCH_M6_XOR:
+            blit_core_xor8(d, BENCH_DST_W, src, src_pitch, 1, w, h);
+            break;
+        case BENCH_M6_RGBA:
+        case BENCH_CONV_32_TO_8:
+            blit_core_rgba_to8(d, BENCH_DST_W, (const uint32_t *)src, src_pitch, w, h, &rgba_format,
+                               BLIT_CORE_NO_KEY, c == BENCH_M6_RGBA, &palette);
+            break;
+        case BENCH_MONO:
+            blit_core_mono8(d, BENCH_DST_W, src, src_pitch, 1, w, h, 15);
+            break;
+        case BENCH_CONV_24_TO_8:
+            blit_core_rgb24_to8(d, BENCH_DST_W, src, src_pitch, w, h, BLIT_CORE_NO_KEY, &palette);
+            break;
+        case BENCH_FILL_RECT:
+            blit_core_fill8(d, BENCH_DST_W, w, h, (uint8_t)iter);
+            break;
+        default:
+            break;
+    }
+}
+
+static void bench_run_case(bench_case_t c, const bench_size_t *size, uint64_t target_us) {
+    static uint8_t dst[BENCH_DST_W * BENCH_DST_H];
+    const int depth = bench_src_depth(c);
+    const int pitch = size->w * depth / 8;
+    uint8_t *src = malloc((size_t)pitch * (size_t)size->h);
+    if (!src) {
+        printf("BENCH_SKIP,%s,%s,alloc_failed\n", bench_case_names[c], size->name);
+        return;
+    }
+    bench_fill_source(src, pitch, size->w, size->h, depth, c == BENCH_MONO);
+    memset(dst, 0, sizeof(dst));
+
+    // Warm up, then double the count until a run takes a quarter of the target.
+    bench_blit_once(c, src, pitch, size->w, size->h, dst, 0);
+    long iters = BENCH_MIN_ITERS;
+    uint64_t elapsed_ns;
+    for (;;) {
+        const uint64_t t0 = now_ns();
+        for (long i = 0; i < iters; ++i) bench_blit_once(c, src, pitch, size->w, size->h, dst, (int)i);
+        elapsed_ns = now_ns() - t0;
+        if (elapsed_ns * 4 >= target_us * 1000u || iters >= BENCH_MAX_ITERS / 2) break;
+        iters *= 2;
+    }
+    if (elapsed_ns > 0) {
+        const double scaled = (double)iters * (double)target_us * 1000.0 / (double)elapsed_ns;
+        iters = scaled < BENCH_MIN_ITERS ? BENCH_MIN_ITERS
+              : scaled > BENCH_MAX_ITERS ? BENCH_MAX_ITERS : (long)scaled;
+    }
+
+    const uint64_t t0 = now_ns();
+    for (long i = 0; i < iters; ++i) bench_blit_once(c, src, pitch, size->w, size->h, dst, (int)i);
+    const uint64_t total_ns = now_ns() - t0;
+
+    const uint32_t pixels = (uint32_t)(size->w * size->h);
+    const uint32_t bytes_per_iter = pixels * (uint32_t)(c == BENCH_FILL_RECT ? 0 : depth / 8) + pixels;
+    const double ns_per_px = (double)total_ns / ((double)iters * (double)pixels);
+    const double mb_per_s = total_ns ? (double)bytes_per_iter * (double)iters * 1000.0 / (double)total_ns : 0.0;
+
+    printf("BENCH,%s,%s,%d,%d,%s,host,%ld,%llu,%.3f,%lu,%.2f\n",
+           bench_case_names[c], size->name, size->w, size->h,
+           c == BENCH_FILL_RECT ? "none" : "host",
+           iters, (unsigned long long)(total_ns / 1000u), ns_per_px,
+           (unsigned long)bytes_per_iter, mb_per_s);
+    free(src);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-t target_us] [-c case]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    uint64_t target_us = 20000;
+    const char *only = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *v = argv[++i];
+        switch (arg[1]) {
+            case 't': target_us = strtoull(v, NULL, 0); break;
+            case 'c': only = v; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (target_us == 0) {
+        fprintf(stderr, "need target_us > 0\n");
+        return 2;
+    }
+    if (only) {
+        int c = 0;
+        while (c < BENCH_CASE_COUNT && strcmp(only, bench_case_names[c])) ++c;
+        if (c == BENCH_CASE_COUNT) {
+            fprintf(stderr, "unknown case %s\n", only);
+            return 2;
+        }
+    }
+
+    // The device bench's palette: 3-3-2 RGB
+    for (int i = 0; i < 256; ++i) {
+        palette_colors[i].r = (uint8_t)(i & 0xE0);
+        palette_colors[i].g = (uint8_t)((i & 0x1C) << 3);
+        palette_colors[i].b = (uint8_t)((i & 0x03) << 6);
+        palette_colors[i].a = 255;
+    }
+
+    printf("BENCH_BEGIN,host\n");
+    printf("BENCH_HEADER,case,sprite,w,h,src_mem,dst_mem,iters,total_us,ns_per_px,bytes_per_iter,mb_per_s\n");
+    for (int c = 0; c < BENCH_CASE_COUNT; ++c) {
+        if (only && strcmp(only, bench_case_names[c])) continue;
+        const bool rect_case = (c == BENCH_M1_RECT || c == BENCH_FILL_RECT);
+        const bench_size_t *sizes = rect_case ? rect_sizes : sprite_sizes;
+        const int n_sizes = rect_case ? (int)COUNT(rect_sizes) : (int)COUNT(sprite_sizes);
+        for (int s = 0; s < n_sizes; ++s) {
+            // Glyph-sized mono sources are the only realistic mono case.
+            if (c == BENCH_MONO && sizes[s].w > 8) continue;
+            bench_run_case((bench_case_t)c, &sizes[s], target_us);
+        }
+    }
+    printf("BENCH_END\n");
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * murmprince - input latency pipeline simulation (host tool)
+ *
+ * Models the firmware's input path and runs it through the same tracker
+ * (src/latency.c) that RP2350_LATENCY=1 uses on the device, printing the
+ * report in the same format, so a change to the game loop's timing can
+ * be checked for latency without hardware:
+ *
+ *   key press      uniform over a game tick
+ *   input          PS/2: stamped at the first byte, decodable input_us
+ *                  later; USB: stamped in the poll that reads it
+ *   event          next SDL_PollEvent: every poll_us in do_wait(), none
+ *                  while a tick is played and drawn (busy_us)
+ *   tick           read_user_control() play_us into the next tick
+ *   present        update_screen() busy_us into that tick
+ *   scanout        next 59.94 Hz vsync, at a random phase
+ *
+ * Build and run from the repository root:
+ *
+ *   cc -O2 -Isrc -o latency_sim tools/latency_sim.c src/latency.c
+ *   ./latency_sim [-n samples] [-s seed] [-f fps] [-p play_us] [-b busy_us]
+ *                 [-w poll_us] [-i input_us] [-u] [-m max_p95_ms]
+ *
+ * With -m the exit status is 1 if the total's 95th percentile is above
+ * max_p95_ms.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "latency.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    unsigned samples;
+    uint32_t seed;
+    unsigned fps;
+    uint32_t play_us;       // tick start to read_user_control()
+    uint32_t busy_us;       // tick start to the end of update_screen()
+    uint32_t poll_us;       // SDL_PollEvent period while waiting
+    uint32_t input_us;      // PS/2: first byte to a decodable key
+    uint32_t frame_us;
+    int usb;
+} sim_params_t;
+
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// First SDL_PollEvent at or after t
+static uint64_t next_poll(const sim_params_t *p, uint64_t tick_us, uint64_t t) {
+    uint64_t k = t / tick_us;
+    uint64_t start = k * tick_us + p->busy_us;
+    if (t <= start) return start;
+    uint64_t poll = start + (t - start + p->poll_us - 1) / p->poll_us * p->poll_us;
+    // Past the tick: the next one plays and draws first
+    if (poll >= (k + 1) * tick_us) poll = (k + 1) * tick_us + p->busy_us;
+    return poll;
+}
+
+static void run(const sim_params_t *p, latency_t *l) {
+    const uint64_t tick_us = 1000000u / p->fps;
+    const uint64_t phase = rng_next() % p->frame_us;
+
+    for (unsigned i = 0; i < p->samples; i++) {
+        // Each press well after the last one's frame is on screen
+        const uint64_t base = (uint64_t)i * 8 * tick_us;
+        const uint64_t press = base + rng_next() % tick_us;
+        const uint64_t event = next_poll(p, tick_us, p->usb ? press : press + p->input_us);
+        const uint64_t stamp = p->usb ? event : press;
+        const uint64_t tick = (event / tick_us + 1) * tick_us;
+        const uint64_t present = tick + p->busy_us;
+        // vsync n starts at phase + n * frame_us; count = vsyncs so far
+        const uint64_t present_count = present < phase ? 0 : (present - phase) / p->frame_us + 1;
+        const uint64_t scan_count = present_count + 1;
+        const uint64_t scan = phase + (scan_count - 1) * p->frame_us;
+
+        latency_event(l, (uint32_t)stamp, (uint32_t)event);
+        latency_tick(l, (uint32_t)(tick + p->play_us));
+        latency_present(l, (uint32_t)present, (uint32_t)present_count);
+        latency_poll(l, (uint32_t)scan, (uint32_t)scan_count, (uint32_t)scan, p->frame_us);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n samples] [-s seed] [-f fps] [-p play_us] [-b busy_us]\n"
+            "          [-w poll_us] [-i input_us] [-u] [-m max_p95_ms]\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    sim_params_t p = {
+        .samples = 1000,
+        .seed = 1,
+        .fps = 12,
+        .play_us = 1000,
+        .busy_us = 15000,
+        .poll_us = 1000,
+        .input_us = 2200,       // E0-prefixed make code, two 11-bit frames
+        .frame_us = 16683,
+        .usb = 0,
+    };
+    unsigned max_p95_ms = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (!strcmp(arg, "-u")) {
+            p.usb = 1;
+            continue;
+        }
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        unsigned long v = strtoul(argv[++i], NULL, 0);
+        switch (arg[1]) {
+            case 'n': p.samples = (unsigned)v; break;
+            case 's': p.seed = (uint32_t)v; break;
+            case 'f': p.fps = (unsigned)v; break;
+            case 'p': p.play_us = (uint32_t)v; break;
+            case 'b': p.busy_us = (uint32_t)v; break;
+            case 'w': p.poll_us = (uint32_t)v; break;
+            case 'i': p.input_us = (uint32_t)v; break;
+            case 'm': max_p95_ms = (unsigned)v; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (p.fps == 0 || p.poll_us == 0 || p.play_us > p.busy_us || p.busy_us >= 1000000u / p.fps) {
+        fprintf(stderr, "need fps > 0, poll_us > 0 and play_us <= busy_us < one tick\n");
+        return 2;
+    }
+    rng_state = p.seed ? p.seed : 1;
+
+    static latency_t l;
+    latency_init(&l);
+    run(&p, &l);
+
+    char line[160];
+    printf("latency sim: %s, %u fps, play %lu us, busy %lu us, poll %lu us\n",
+           p.usb ? "USB" : "PS/2", p.fps, (unsigned long)p.play_us,
+           (unsigned long)p.busy_us, (unsigned long)p.poll_us);
+    printf("latency: %u samples, %lu skipped, %lu timed out\n", p.samples,
+           (unsigned long)l.skipped, (unsigned long)l.timeouts);
+    for (int i = 0; i < LATENCY_SPAN_COUNT; i++) {
+        latency_format_span(&l, (latency_span_t)i, line, sizeof(line));
+        printf("latency: %s\n", line);
+    }
+    latency_format_hist(&l.hist[LATENCY_TOTAL], 4, line, sizeof(line));
+    printf("latency: total by 4 ms: %s\n", line);
+
+    const uint32_t p95 = latency_hist_percentile(&l.hist[LATENCY_TOTAL], 95);
+    if (max_p95_ms && p95 > max_p95_ms * 1000u) {
+        printf("latency: total p95 %lu us is above %u ms\n", (unsigned long)p95, max_p95_ms);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+/*
+ * murmprince - peel pool replay (host tool)
+ *
+ * Replays the backgrounds saved under moving objects ("peels") against the
+ * slot pool of src/peel_pool.c, to check its size classes without
+ * hardware. Every frame saves one peel per object, and the previous
+ * frame's peels are restored (and their slots freed) first, as in
+ * restore_peels()/draw_people(). Each peel is copied in and out of a
+ * 320x192 screen, once through the pool and once through malloc/free
+ * (the firmware's miss path), to compare the per-frame cost. A PC's
+ * malloc is far cheaper than the device's miss path, which also builds an
+ * SDL_Surface, so the heap column is a lower bound.
+ *
+ * Input is a built-in scene or a device trace: build the firmware with
+ * -DRP2350_TRACE_PEEL=1 and keep the log's lines
+ *
+ *   PEEL,<frame>,<w>,<h>
+ *
+ * (other lines are skipped). Scenes: run (the kid alone), fight (kid,
+ * guard, swords, debris) and crowd (kid, guard, shadow, three swords,
+ * loose floors and potions in one room, more than the game ever shows).
+ * The CSV line per scene:
+ *
+ *   PEEL_REPLAY,<scene>,<classes>,<pool_bytes>,<frames>,<peels>,<hits>,
+ *               <misses>,<hit_rate>,<peak_bytes>,<pool_ns_per_frame>,
+ *               <heap_ns_per_frame>
+ *
+ * Build and run from the repository root:
+ *
+ *   cc -O2 -Isrc -o peel_replay tools/peel_replay.c src/peel_pool.c
+ *   ./peel_replay [-p classes] [-s scene] [-f trace] [-n frames]
+ *
+ * -p sets the classes as capacity x count (default "640x16,3072x6,8192x2",
+ * the firmware's), -s runs only the named scene, -f replays a trace
+ * instead, -n sets the frames per scene (default 20000).
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "peel_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_SCREEN_W 320
+#define REPLAY_SCREEN_H 192
+#define REPLAY_MAX_PEELS 50         // peels_table[]
+#define REPLAY_MAX_CLASSES 8
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+    int w, h;
+} replay_peel_t;
+
+typedef struct {
+    int count;
+    replay_peel_t peels[REPLAY_MAX_PEELS];
+} replay_frame_t;
+
+// A moving object: its sprite size range. tall_pct of its frames are
+// climbing/hanging frames up to tall_h.
+typedef struct {
+    int min_w, max_w;
+    int min_h, max_h;
+    int tall_pct, tall_h;
+} replay_object_t;
+
+static const replay_object_t obj_kid = { 16, 40, 36, 63, 5, 80 };
+static const replay_object_t obj_guard = { 20, 44, 40, 63, 0, 0 };
+static const replay_object_t obj_sword = { 8, 30, 4, 16, 0, 0 };
+static const replay_object_t obj_debris = { 16, 32, 6, 16, 0, 0 };
+static const replay_object_t obj_potion = { 8, 12, 8, 14, 0, 0 };
+
+typedef struct {
+    const char *name;
+    const replay_object_t *objects[12];
+} replay_scene_t;
+
+static const replay_scene_t scenes[] = {
+    { "run", { &obj_kid } },
+    { "fight", { &obj_kid, &obj_guard, &obj_sword, &obj_sword, &obj_debris } },
+    { "crowd", { &obj_kid, &obj_guard, &obj_kid, &obj_sword, &obj_sword, &obj_sword,
+                 &obj_debris, &obj_debris, &obj_debris, &obj_debris, &obj_potion, &obj_potion } },
+};
+
+static uint8_t screen[REPLAY_SCREEN_W * REPLAY_SCREEN_H];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+static int rng_range(uint32_t *seed, int lo, int hi) {
+    return lo + (int)(rng_next(seed) % (uint32_t)(hi - lo + 1));
+}
+
+// One frame of a scene. add_peel() widens the sprite to whole bytes of the
+// original 1bpp screen, i.e. both sides to a multiple of 8 pixels.
+static void scene_frame(const replay_scene_t *scene, uint32_t *seed, replay_frame_t *frame) {
+    frame->count = 0;
+    for (size_t i = 0; i < COUNT(scene->objects) && scene->objects[i]; ++i) {
+        const replay_object_t *o = scene->objects[i];
+        // Swords and debris are not always on screen
+        if (o != &obj_kid && o != &obj_guard && rng_range(seed, 0, 3) == 0) continue;
+        int w = rng_range(seed, o->min_w, o->max_w);
+        int h = rng_range(seed, o->min_h, o->max_h);
+        if (o->tall_pct && rng_range(seed, 0, 99) < o->tall_pct) h = rng_range(seed, o->max_h, o->tall_h);
+        int x = rng_range(seed, 0, REPLAY_SCREEN_W - w);
+        int left = x & ~7;
+        int right = (x + w + 7) & ~7;
+        if (right > REPLAY_SCREEN_W) right = REPLAY_SCREEN_W;
+        frame->peels[frame->count++] = (replay_peel_t){ right - left, h };
+    }
+}
+
+typedef struct {
+    replay_frame_t *frames;
+    int count;
+} replay_trace_t;
+
+static bool trace_load(const char *path, replay_trace_t *trace) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    int cap = 0;
+    long last = -1;
+    char line[128];
+    trace->frames = NULL;
+    trace->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        long frame;
+        int w, h;
+        if (sscanf(line, "PEEL,%ld,%d,%d", &frame, &w, &h) != 3) continue;
+        if (frame != last || trace->count == 0) {
+            if (trace->count == cap) {
+                cap = cap ? cap * 2 : 256;
+                replay_frame_t *grown = realloc(trace->frames, (size_t)cap * sizeof(*grown));
+                if (!grown) {
+                    fclose(f);
+                    return false;
+                }
+                trace->frames = grown;
+            }
+            trace->frames[trace->count++].count = 0;
+            last = frame;
+        }
+        replay_frame_t *cur = &trace->frames[trace->count - 1];
+        if (cur->count < REPLAY_MAX_PEELS) cur->peels[cur->count++] = (replay_peel_t){ w, h };
+    }
+    fclose(f);
+    return true;
+}
+
+// Copy a peel out of the screen and back, as read_peel_from_screen() and
+// restore_peel() do.
+static void peel_save(uint8_t *dst, const replay_peel_t *p, int i) {
+    const uint8_t *src = screen + (i * 17 % (REPLAY_SCREEN_H - p->h + 1)) * REPLAY_SCREEN_W;
+    for (int y = 0; y < p->h; ++y) memcpy(dst + y * p->w, src + y * REPLAY_SCREEN_W, (size_t)p->w);
+}
+
+static void peel_restore(const uint8_t *src, const replay_peel_t *p, int i) {
+    uint8_t *dst = screen + (i * 17 % (REPLAY_SCREEN_H - p->h + 1)) * REPLAY_SCREEN_W;
+    for (int y = 0; y < p->h; ++y) memcpy(dst + y * REPLAY_SCREEN_W, src + y * p->w, (size_t)p->w);
+}
+
+typedef struct {
+    int frames;
+    uint32_t peels;
+    uint64_t pool_ns;
+    uint64_t heap_ns;
+} replay_result_t;
+
+static void replay_frames(const replay_frame_t *frames, int count, peel_pool_t *pool,
+                          uint8_t *const *slot_mem, replay_result_t *r) {
+    int slots[REPLAY_MAX_PEELS];
+    uint8_t *heap[REPLAY_MAX_PEELS];
+    const replay_frame_t *prev = NULL;
+
+    // Pool path: hits copy into their slot, misses pay the heap.
+    uint64_t t0 = now_ns();
+    for (int f = 0; f < count; ++f) {
+        const replay_frame_t *frame = &frames[f];
+        for (int i = 0; prev && i < prev->count; ++i) {
+            const replay_peel_t *p = &prev->peels[i];
+            if (slots[i] >= 0) {
+                peel_restore(slot_mem[slots[i]], p, i);
+                peel_pool_release(pool, slots[i]);
+            } else if (heap[i]) {
+                peel_restore(heap[i], p, i);
+                free(heap[i]);
+            }
+        }
+        for (int i = 0; i < frame->count; ++i) {
+            const replay_peel_t *p = &frame->peels[i];
+            slots[i] = peel_pool_acquire(pool, p->w * p->h);
+            heap[i] = NULL;
+            if (slots[i] >= 0) {
+                peel_save(slot_mem[slots[i]], p, i);
+            } else if ((heap[i] = malloc((size_t)(p->w * p->h))) != NULL) {
+                peel_save(heap[i], p, i);
+            }
+        }
+        r->peels += (uint32_t)frame->count;
+        prev = frame;
+    }
+    for (int i = 0; prev && i < prev->count; ++i) {
+        if (slots[i] >= 0) peel_pool_release(pool, slots[i]);
+        else free(heap[i]);
+    }
+    r->pool_ns += now_ns() - t0;
+
+    // Heap path: every peel is a malloc/free pair.
+    prev = NULL;
+    t0 = now_ns();
+    for (int f = 0; f < count; ++f) {
+        const replay_frame_t *frame = &frames[f];
+        for (int i = 0; prev && i < prev->count; ++i) {
+            if (!heap[i]) continue;
+            peel_restore(heap[i], &prev->peels[i], i);
+            free(heap[i]);
+        }
+        for (int i = 0; i < frame->count; ++i) {
+            const replay_peel_t *p = &frame->peels[i];
+            heap[i] = malloc((size_t)(p->w * p->h));
+            if (heap[i]) peel_save(heap[i], p, i);
+        }
+        prev = frame;
+    }
+    for (int i = 0; prev && i < prev->count; ++i) free(heap[i]);
+    r->heap_ns += now_ns() - t0;
+    r->frames += count;
+}
+
+static void report(const char *name, const char *classes_arg, const peel_pool_class_t *classes,
+                   int n_classes, const peel_pool_t *pool, const replay_result_t *r) {
+    const uint32_t total = pool->hits + pool->misses;
+    printf("PEEL_REPLAY,%s,%s,%lu,%d,%lu,%lu,%lu,%.2f,%lu,%.0f,%.0f\n",
+           name, classes_arg, (unsigned long)peel_pool_bytes(classes, n_classes), r->frames,
+           (unsigned long)r->peels, (unsigned long)pool->hits, (unsigned long)pool->misses,
+           total ? 100.0 * pool->hits / total : 100.0, (unsigned long)pool->peak_bytes,
+           r->frames ? (double)r->pool_ns / r->frames : 0.0,
+           r->frames ? (double)r->heap_ns / r->frames : 0.0);
+}
+
+// "640x16,3072x6" -> classes; returns their number, 0 on a malformed list.
+static int parse_classes(const char *arg, peel_pool_class_t *classes) {
+    int n = 0;
+    const char *p = arg;
+    while (*p && n < REPLAY_MAX_CLASSES) {
+        char *end;
+        long cap = strtol(p, &end, 10);
+        if (end == p || *end != 'x') return 0;
+        p = end + 1;
+        long count = strtol(p, &end, 10);
+        if (end == p || cap <= 0 || count <= 0) return 0;
+        classes[n++] = (peel_pool_class_t){ (int)cap, (int)count };
+        p = end;
+        if (*p == ',') ++p;
+        else if (*p) return 0;
+    }
+    return *p ? 0 : n;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-p classes] [-s scene] [-f trace] [-n frames]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *classes_arg = "640x16,3072x6,8192x2";
+    const char *only = NULL;
+    const char *trace_path = NULL;
+    int n_frames = 20000;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *v = argv[++i];
+        switch (arg[1]) {
+            case 'p': classes_arg = v; break;
+            case 's': only = v; break;
+            case 'f': trace_path = v; break;
+            case 'n': n_frames = atoi(v); break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    peel_pool_class_t classes[REPLAY_MAX_CLASSES];
+    const int n_classes = parse_classes(classes_arg, classes);
+    if (n_classes == 0) {
+        fprintf(stderr, "bad classes %s (want capacity x count, e.g. 640x16,3072x6)\n", classes_arg);
+        return 2;
+    }
+    if (n_frames <= 0) {
+        fprintf(stderr, "need frames > 0\n");
+        return 2;
+    }
+    if (only) {
+        size_t s = 0;
+        while (s < COUNT(scenes) && strcmp(only, scenes[s].name)) ++s;
+        if (s == COUNT(scenes)) {
+            fprintf(stderr, "unknown scene %s\n", only);
+            return 2;
+        }
+    }
+
+    peel_pool_t pool;
+    const int slot_count = peel_pool_init(&pool, classes, n_classes);
+    uint8_t *slot_mem[PEEL_POOL_MAX_SLOTS];
+    for (int i = 0; i < slot_count; ++i) {
+        slot_mem[i] = malloc((size_t)pool.capacity[i]);
+        if (!slot_mem[i]) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+    for (size_t i = 0; i < sizeof(screen); ++i) screen[i] = (uint8_t)(i * 7);
+
+    printf("PEEL_REPLAY_HEADER,scene,classes,pool_bytes,frames,peels,hits,misses,hit_rate,"
+           "peak_bytes,pool_ns_per_frame,heap_ns_per_frame\n");
+    if (trace_path) {
+        replay_trace_t trace;
+        if (!trace_load(trace_path, &trace)) {
+            fprintf(stderr, "cannot read %s\n", trace_path);
+            return 1;
+        }
+        replay_result_t r = { 0 };
+        peel_pool_init(&pool, classes, n_classes);
+        replay_frames(trace.frames, trace.count, &pool, slot_mem, &r);
+        report("trace", classes_arg, classes, n_classes, &pool, &r);
+        free(trace.frames);
+    } else {
+        replay_frame_t *frames = malloc((size_t)n_frames * sizeof(*frames));
+        if (!frames) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        for (size_t s = 0; s < COUNT(scenes); ++s) {
+            if (only && strcmp(only, scenes[s].name)) continue;
+            uint32_t seed = 0x12345678u;
+            for (int f = 0; f < n_frames; ++f) scene_frame(&scenes[s], &seed, &frames[f]);
+            replay_result_t r = { 0 };
+            peel_pool_init(&pool, classes, n_classes);
+            replay_frames(frames, n_frames, &pool, slot_mem, &r);
+            report(scenes[s].name, classes_arg, classes, n_classes, &pool, &r);
+        }
+        free(frames);
+    }
+    for (int i = 0; i < slot_count; ++i) free(slot_mem[i]);
+    return 0;
+}
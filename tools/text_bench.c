@@ -0,0 +1,262 @@
+/*
+ * murmprince - per-frame text cost (host tool)
+ *
+ * Times the text a frame draws, the way seg009.c draws it on the device:
+ *
+ *   per_glyph    draw_text_character(): clip every glyph against the clip
+ *                rect, then blit_core_mono8 (method_3_blit_mono's loop)
+ *   spans_miss   the batched path on a cache miss: text_spans_layout()
+ *                plus text_spans_emit()
+ *   spans_hit    the batched path on a hit: text_spans_emit() only
+ *
+ * Each frame is the set of lines one screen shows at once: the bottom
+ * message ("N MINUTES LEFT", "LEVEL N"), a save/quit dialog, and a
+ * story screen whose lines come close to RP2350_TEXT_CACHE_MAX_CHARS. The
+ * glyphs are src/font_5x7.c's as 8bpp images (the game's small font is
+ * loaded from PRINCE.DAT, 7-8 pixels high). Lines sit in a box at the
+ * bottom of a 320x200 screen, the longest hanging off its right edge. The
+ * CSV lines:
+ *
+ *   TEXT_BENCH,<frame>,<path>,<lines>,<chars>,<fallbacks>,<iters>,<total_us>,
+ *              <ns_per_frame>
+ *
+ * <fallbacks> counts lines over TEXT_SPANS_MAX spans, which the batched
+ * path hands back to per_glyph as the device does.
+ *
+ * Build and run from the repository root:
+ *
+ *   cc -O2 -Isrc -o text_bench tools/text_bench.c src/text_spans.c src/blit_core.c src/font_5x7.c
+ *   ./text_bench [-t target_us] [-f frame]
+ *
+ * -t sets the time per line (default 20000 us), -f runs only the named frame.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "blit_core.h"
+#include "font_5x7.h"
+#include "text_spans.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MIN_ITERS 4
+#define BENCH_MAX_ITERS 100000000
+#define SCREEN_W 320
+#define SCREEN_H 200
+#define GLYPH_W 5
+#define GLYPH_H 7
+#define GLYPH_SPACE 1
+#define MAX_LINES 4
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef enum {
+    PATH_PER_GLYPH,
+    PATH_SPANS_MISS,
+    PATH_SPANS_HIT,
+    PATH_COUNT
+} text_path_t;
+
+static const char *const path_names[PATH_COUNT] = {
+    "per_glyph",
+    "spans_miss",
+    "spans_hit",
+};
+
+typedef struct {
+    const char *name;
+    const char *lines[MAX_LINES];
+} text_frame_t;
+
+static const text_frame_t frames[] = {
+    { "minutes_left", { "60 MINUTES LEFT" } },
+    { "level", { "LEVEL 12" } },
+    { "dialog", { "SAVE GAME?", "PRESS ENTER TO SAVE", "ESC TO CANCEL" } },
+    { "long_lines", { "THE GRAND VIZIER JAFFAR RULES IN THE SULTAN'S", "ABSENCE. HE HAS LOCKED YOU IN THE DUNGEONS",
+                      "AND GIVES THE PRINCESS AN HOUR TO MARRY HIM", "OR DIE. FIND YOUR WAY OUT IN TIME." } },
+};
+
+static uint8_t screen[SCREEN_H][SCREEN_W];
+// Glyph images, indexed by character
+static uint8_t glyph_pixels[128][GLYPH_H][GLYPH_W];
+
+// Clip rect of a text box at the bottom (cut 8 pixels short of the right edge)
+static const text_spans_clip_t clip = { 0, 160, SCREEN_W - 8, 40 };
+#define LINE_STEP 9
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void glyphs_init(void) {
+    for (int ch = 32; ch < 128; ++ch) {
+        const uint8_t *rows = font_5x7_glyph((char)ch);
+        for (int y = 0; y < GLYPH_H; ++y) {
+            for (int x = 0; x < GLYPH_W; ++x) glyph_pixels[ch][y][x] = (rows[y] >> (4 - x)) & 1;
+        }
+    }
+}
+
+static int line_glyphs(const char *text, text_spans_glyph_t *glyphs) {
+    int n = 0;
+    for (; *text; ++text) {
+        const unsigned char ch = (unsigned char)*text;
+        if (ch < 32 || ch >= 128) continue;
+        glyphs[n++] = (text_spans_glyph_t){ &glyph_pixels[ch][0][0], GLYPH_W, GLYPH_H, GLYPH_W };
+    }
+    return n;
+}
+
+// method_3_blit_mono() for one glyph: clip, then the mono loop.
+static void blit_glyph(const uint8_t *pixels, int x, int y, uint8_t color) {
+    int x0 = 0, y0 = 0, x1 = GLYPH_W, y1 = GLYPH_H;
+    if (x + x0 < clip.x) x0 = clip.x - x;
+    if (y + y0 < clip.y) y0 = clip.y - y;
+    if (x + x1 > clip.x + clip.w) x1 = clip.x + clip.w - x;
+    if (y + y1 > clip.y + clip.h) y1 = clip.y + clip.h - y;
+    if (x1 <= x0 || y1 <= y0) return;
+    blit_core_mono8(&screen[y + y0][x + x0], SCREEN_W, pixels + y0 * GLYPH_W + x0, GLYPH_W, 1,
+                    x1 - x0, y1 - y0, color);
+}
+
+typedef struct {
+    int n_lines;
+    int chars;
+    int x[MAX_LINES];
+    text_spans_glyph_t glyphs[MAX_LINES][64];
+    int n_glyphs[MAX_LINES];
+    text_spans_line_t cached[MAX_LINES];
+    bool batched[MAX_LINES];        // false: too many spans, per-glyph fallback
+} frame_state_t;
+
+static void draw_frame(text_path_t path, frame_state_t *st, uint8_t color) {
+    for (int l = 0; l < st->n_lines; ++l) {
+        const int x = st->x[l];
+        const int y = clip.y + 2 + l * LINE_STEP;
+        if (path == PATH_PER_GLYPH || !st->batched[l]) {
+            int pen = x;
+            for (int i = 0; i < st->n_glyphs[l]; ++i) {
+                blit_glyph(st->glyphs[l][i].pixels, pen, y, color);
+                pen += GLYPH_W + GLYPH_SPACE;
+            }
+        } else {
+            if (path == PATH_SPANS_MISS) {
+                text_spans_layout(&st->cached[l], st->glyphs[l], st->n_glyphs[l], GLYPH_SPACE);
+            }
+            text_spans_emit(&st->cached[l], &screen[0][0], SCREEN_W, &clip, x, y, color);
+        }
+    }
+}
+
+static void bench_frame(const text_frame_t *frame, text_path_t path, uint64_t target_us) {
+    static frame_state_t st;
+    memset(&st, 0, sizeof(st));
+    for (int l = 0; l < MAX_LINES && frame->lines[l]; ++l) {
+        st.n_glyphs[l] = line_glyphs(frame->lines[l], st.glyphs[l]);
+        st.chars += st.n_glyphs[l];
+        // Centred, as draw_text() aligns the bottom message
+        st.x[l] = (SCREEN_W - st.n_glyphs[l] * (GLYPH_W + GLYPH_SPACE)) / 2 + l * 3;
+        st.batched[l] = text_spans_layout(&st.cached[l], st.glyphs[l], st.n_glyphs[l], GLYPH_SPACE);
+        ++st.n_lines;
+    }
+
+    draw_frame(path, &st, 15);
+    long iters = BENCH_MIN_ITERS;
+    uint64_t elapsed_ns;
+    for (;;) {
+        const uint64_t t0 = now_ns();
+        for (long i = 0; i < iters; ++i) draw_frame(path, &st, (uint8_t)i);
+        elapsed_ns = now_ns() - t0;
+        if (elapsed_ns * 4 >= target_us * 1000u || iters >= BENCH_MAX_ITERS / 2) break;
+        iters *= 2;
+    }
+    if (elapsed_ns > 0) {
+        const double scaled = (double)iters * (double)target_us * 1000.0 / (double)elapsed_ns;
+        iters = scaled < BENCH_MIN_ITERS ? BENCH_MIN_ITERS
+              : scaled > BENCH_MAX_ITERS ? BENCH_MAX_ITERS : (long)scaled;
+    }
+
+    const uint64_t t0 = now_ns();
+    for (long i = 0; i < iters; ++i) draw_frame(path, &st, (uint8_t)i);
+    const uint64_t total_ns = now_ns() - t0;
+
+    int fallbacks = 0;
+    for (int l = 0; l < st.n_lines; ++l) fallbacks += !st.batched[l];
+    printf("TEXT_BENCH,%s,%s,%d,%d,%d,%ld,%llu,%.1f\n", frame->name, path_names[path], st.n_lines,
+           st.chars, path == PATH_PER_GLYPH ? 0 : fallbacks, iters,
+           (unsigned long long)(total_ns / 1000u), (double)total_ns / (double)iters);
+}
+
+// Both paths must leave the same pixels.
+static bool paths_agree(const text_frame_t *frame) {
+    static uint8_t first[SCREEN_H][SCREEN_W];
+    static frame_state_t st;
+    memset(&st, 0, sizeof(st));
+    for (int l = 0; l < MAX_LINES && frame->lines[l]; ++l) {
+        st.n_glyphs[l] = line_glyphs(frame->lines[l], st.glyphs[l]);
+        st.x[l] = (SCREEN_W - st.n_glyphs[l] * (GLYPH_W + GLYPH_SPACE)) / 2 + l * 3;
+        st.batched[l] = text_spans_layout(&st.cached[l], st.glyphs[l], st.n_glyphs[l], GLYPH_SPACE);
+        ++st.n_lines;
+    }
+    memset(screen, 0, sizeof(screen));
+    draw_frame(PATH_PER_GLYPH, &st, 15);
+    memcpy(first, screen, sizeof(screen));
+    memset(screen, 0, sizeof(screen));
+    draw_frame(PATH_SPANS_MISS, &st, 15);
+    return memcmp(first, screen, sizeof(screen)) == 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-t target_us] [-f frame]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    uint64_t target_us = 20000;
+    const char *only = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *v = argv[++i];
+        switch (arg[1]) {
+            case 't': target_us = strtoull(v, NULL, 0); break;
+            case 'f': only = v; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (target_us == 0) {
+        fprintf(stderr, "need target_us > 0\n");
+        return 2;
+    }
+    if (only) {
+        size_t f = 0;
+        while (f < COUNT(frames) && strcmp(only, frames[f].name)) ++f;
+        if (f == COUNT(frames)) {
+            fprintf(stderr, "unknown frame %s\n", only);
+            return 2;
+        }
+    }
+
+    glyphs_init();
+    printf("TEXT_BENCH_HEADER,frame,path,lines,chars,fallbacks,iters,total_us,ns_per_frame\n");
+    int status = 0;
+    for (size_t f = 0; f < COUNT(frames); ++f) {
+        if (only && strcmp(only, frames[f].name)) continue;
+        if (!paths_agree(&frames[f])) {
+            printf("TEXT_MISMATCH,%s\n", frames[f].name);
+            status = 1;
+        }
+        for (int p = 0; p < PATH_COUNT; ++p) bench_frame(&frames[f], (text_path_t)p, target_us);
+    }
+    return status;
+}